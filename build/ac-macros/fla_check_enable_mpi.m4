@@ -0,0 +1,94 @@
+dnl
+dnl  libflame
+dnl  An object-based infrastructure for developing high-performance
+dnl  dense linear algebra libraries.
+dnl
+dnl  Copyright (C) 2011, The University of Texas
+dnl
+dnl  libflame is free software; you can redistribute it and/or modify
+dnl  it under the terms of the GNU Lesser General Public License as
+dnl  published by the Free Software Foundation; either version 2.1 of
+dnl  the License, or (at your option) any later version.
+dnl
+dnl  libflame is distributed in the hope that it will be useful, but
+dnl  WITHOUT ANY WARRANTY; without even the implied warranty of
+dnl  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+dnl  Lesser General Public License for more details.
+dnl
+dnl  You should have received a copy of the GNU Lesser General Public
+dnl  License along with libflame; if you did not receive a copy, see
+dnl  http://www.gnu.org/licenses/.
+dnl
+dnl  For more information, please contact us at flame@cs.utexas.edu or
+dnl  send mail to:
+dnl
+dnl  Field G. Van Zee and/or
+dnl  Robert A. van de Geijn
+dnl  The University of Texas at Austin
+dnl  Department of Computer Sciences
+dnl  1 University Station C0500
+dnl  Austin TX 78712
+dnl
+AC_DEFUN([FLA_CHECK_ENABLE_MPI],
+[
+	dnl Tell the user we're checking whether to enable the option.
+	AC_MSG_CHECKING([whether user requested MPI extensions])
+	
+	dnl Determine whether the user gave the --enable-<option> or
+	dnl --disable-<option>. If so, then run the first snippet of code;
+	dnl otherwise, run the second code block.
+	AC_ARG_ENABLE([mpi],
+	              AC_HELP_STRING([--enable-mpi],[Enable the distributed-memory tensor routines, which use MPI. The library and the programs linked against it must then be compiled with an MPI compiler wrapper, e.g. --with-cc=mpicc. (Disabled by default.)]),
+	[
+		dnl If any form of the option is given, handle each case.
+		if test "$enableval" = "no" ; then
+
+			dnl User provided --enable-<option>=no or --disable-<option>.
+			fla_enable_mpi=no
+
+		elif test "$enableval" = "yes" ; then
+
+			dnl User provided --enable-<option>=yes or --enable-<option>.
+			fla_enable_mpi=yes
+		else
+
+			dnl We don't need an else branch because the configure script
+			dnl should detect whether the user provided an unexpected argument
+			dnl with the option.
+			AC_MSG_ERROR([[Reached unreachable branch in FLA_CHECK_ENABLE_MPI!]])
+		fi
+	],
+	[
+		dnl User did not specify whether to enable or disable the option.
+		dnl Default behavior is to disable the option.
+		fla_enable_mpi=no
+	]
+	)
+
+	dnl Now act according to whether the option was requested.
+	if   test "$fla_enable_mpi" = "yes" ; then
+		
+		dnl Output the result.
+		AC_MSG_RESULT([yes])
+		
+		dnl Define the macro.
+		AC_DEFINE(FLA_ENABLE_MPI,1,
+		          [Determines whether MPI-specific blocks of code should be compiled.])
+		
+	elif test "$fla_enable_mpi" = "no" ; then
+		
+		dnl Output the result.
+		AC_MSG_RESULT([no])
+		
+	else
+
+		dnl Only "yes" and "no" are accepted, so this block is empty.
+		AC_MSG_ERROR([[Reached unreachable branch in FLA_CHECK_ENABLE_MPI!]])
+
+	fi
+	
+	dnl Substitute the output variable.
+	AC_SUBST(fla_enable_mpi)
+
+])
+
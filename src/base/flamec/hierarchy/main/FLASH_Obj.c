@@ -194,6 +194,64 @@ FLA_Error FLASH_Obj_create_without_buffer_ext( FLA_Datatype datatype, dim_t m, d
 }
 
 
+#ifdef FLA_ENABLE_SUPERMATRIX
+static dim_t FLASH_Obj_count_leaves( FLA_Obj H )
+{
+	FLA_Obj* buffer_H;
+	dim_t    i, n_leaves = 0;
+
+	if ( FLA_Obj_elemtype( H ) != FLA_MATRIX )
+		return 1;
+
+	buffer_H = ( FLA_Obj* ) FLA_Obj_base_buffer( H );
+	for ( i = 0; i < FLA_Obj_length( H ) * FLA_Obj_width( H ); i++ )
+		n_leaves += FLASH_Obj_count_leaves( buffer_H[i] );
+
+	return n_leaves;
+}
+
+
+static void FLASH_Obj_collect_leaves( FLA_Obj H, dim_t* n_leaves, void* buffers[], size_t bytes[], unsigned int owner[], unsigned int n_threads )
+{
+	FLA_Obj* buffer_H;
+	dim_t    i;
+
+	if ( FLA_Obj_elemtype( H ) != FLA_MATRIX )
+	{
+		buffers[*n_leaves] = H.base->buffer;
+		bytes[*n_leaves]   = FLA_Obj_length( H ) * FLA_Obj_width( H ) *
+		                     FLA_Obj_datatype_size( FLA_Obj_datatype( H ) );
+		owner[*n_leaves]   = FLASH_Queue_affinity_owner( H.base->m_index, H.base->n_index,
+		                                                 *n_leaves, n_threads );
+		(*n_leaves)++;
+		return;
+	}
+
+	buffer_H = ( FLA_Obj* ) FLA_Obj_base_buffer( H );
+	for ( i = 0; i < FLA_Obj_length( H ) * FLA_Obj_width( H ); i++ )
+		FLASH_Obj_collect_leaves( buffer_H[i], n_leaves, buffers, bytes, owner, n_threads );
+}
+
+
+static void FLASH_Obj_place_leaves( FLA_Obj H )
+{
+	unsigned int  n_threads = FLASH_Queue_get_num_threads();
+	dim_t         n_leaves  = FLASH_Obj_count_leaves( H );
+	void**        buffers   = ( void** ) FLA_malloc( n_leaves * sizeof( void* ) );
+	size_t*       bytes     = ( size_t* ) FLA_malloc( n_leaves * sizeof( size_t ) );
+	unsigned int* owner     = ( unsigned int* ) FLA_malloc( n_leaves * sizeof( unsigned int ) );
+
+	n_leaves = 0;
+	FLASH_Obj_collect_leaves( H, &n_leaves, buffers, bytes, owner, n_threads );
+	FLASH_Queue_first_touch( n_leaves, buffers, bytes, owner, n_threads );
+
+	FLA_free( buffers );
+	FLA_free( bytes );
+	FLA_free( owner );
+}
+#endif
+
+
 FLA_Error FLASH_Obj_create_helper( FLA_Bool without_buffer, FLA_Datatype datatype, dim_t m, dim_t n, dim_t depth, dim_t* b_m, dim_t* b_n, FLA_Obj* H )
 {
 	dim_t     i;
@@ -269,6 +327,15 @@ FLA_Error FLASH_Obj_create_helper( FLA_Bool without_buffer, FLA_Datatype datatyp
 		
 		// Recursively create the matrix hierarchy.
 		FLASH_Obj_create_hierarchy( datatype, m, n, depth, elem_sizes_m, elem_sizes_n, flat_matrix, H, 0, depth, depth_sizes_m, depth_sizes_n, m_offsets, n_offsets );
+
+#ifdef FLA_ENABLE_SUPERMATRIX
+		// Let the thread owning each leaf under the data affinity touch it
+		// first, so that its pages are placed near that thread.
+		if ( without_buffer == FALSE &&
+		     FLASH_Queue_get_data_affinity() != FLASH_QUEUE_AFFINITY_NONE &&
+		     FLASH_Queue_get_num_threads() > 1 )
+			FLASH_Obj_place_leaves( *H );
+#endif
 		
 		// Free the flat_matrix object, but not its buffer. If we created a
 		// normal object with a buffer, we don't want to free the buffer because
@@ -62,6 +62,9 @@ extern "C" {
   #include <math.h>
   #include <float.h>
   #include <signal.h>
+  #ifdef FLA_ENABLE_MPI
+    #include <mpi.h>
+  #endif
 
   // Include prototypes for BLAS-like interfaces.
   #ifndef BLIS_FROM_LIBFLAME
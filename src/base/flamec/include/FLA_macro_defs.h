@@ -356,4 +356,69 @@
 
 // --- Tensor stuff
 #define FLA_MAX_ORDER 12
+
+// Padding of blocks within the slab of a blocked tensor (bytes)
+#define TLA_ALIGN_NONE        0
+#define TLA_ALIGN_CACHE_LINE  64
+#define TLA_ALIGN_PAGE        4096
+
+// Allocation-free queries on tensor views.  FLA_Obj_size() and friends
+// return heap copies; these give the arrays of the view (or its base) in place
+#define TLA_OBJ_SIZE( obj )         ( ( const dim_t* ) ( obj ).size )
+#define TLA_OBJ_OFFSET( obj )       ( ( const dim_t* ) ( obj ).offset )
+#define TLA_OBJ_PERMUTATION( obj )  ( ( const dim_t* ) ( obj ).permutation )
+#define TLA_OBJ_STRIDE( obj )       ( ( const dim_t* ) ( obj ).base->stride )
+#define TLA_OBJ_BASE_SIZE( obj )    ( ( const dim_t* ) ( obj ).base->size )
+
+// Bytes per element of the base of obj (a block for blocked tensors)
+#define TLA_OBJ_ELEM_SIZE( obj ) \
+  ( ( obj ).base->elemtype == FLA_SCALAR ? \
+    ( size_t ) FLA_Obj_datatype_size( ( obj ).base->datatype ) : sizeof( FLA_Obj ) )
+
+// First element of the view obj (an lvalue); FLA_Obj_tensor_buffer_at_view()
+// without the call by value
+#define TLA_OBJ_BUFFER_AT_VIEW( obj ) \
+  ( ( void* ) ( ( char* ) ( obj ).base->buffer + \
+                TLA_Obj_view_offset( &( obj ) ) * TLA_OBJ_ELEM_SIZE( obj ) ) )
+
+// Symmetric partitions splitting up to TLA_PART_STACK_MODES modes at once
+// keep their views on the stack (2^m parts, 3^m repartitions)
+#define TLA_PART_STACK_MODES    4
+#define TLA_PART_STACK_NPART    16
+#define TLA_PART_STACK_NREPART  81
+
+// Order-specialized routines.  TLA_ORDER_INSTANTIATE( def, name ) expands the
+// definition macro def( fname, ORDER ) into name##_o2 .. name##_o6, whose loops
+// over the order have a compile-time trip count, and name##_on, which takes
+// the order from its first argument order_.  TLA_ORDER_DISPATCH calls the
+// instance matching order (all instances take the same arguments)
+#define TLA_ORDER_INSTANTIATE( def, name ) \
+  def( name##_o2, 2 ) def( name##_o3, 3 ) def( name##_o4, 4 ) \
+  def( name##_o5, 5 ) def( name##_o6, 6 ) def( name##_on, order_ )
+
+#define TLA_ORDER_DISPATCH( order, name, args ) \
+  ( ( order ) == 2 ? name##_o2 args : \
+    ( order ) == 3 ? name##_o3 args : \
+    ( order ) == 4 ? name##_o4 args : \
+    ( order ) == 5 ? name##_o5 args : \
+    ( order ) == 6 ? name##_o6 args : name##_on args )
+
+// Entries an FLA_Ttm_batch holds before it allocates
+#define FLA_TTM_BATCH_STORE     32
+
+// FLA_Ttm_leaf::geom of products recorded as block objects
+#define FLA_TTM_LEAF_OBJS       ((dim_t)-1)
+
+// Flags of TLA_Obj_read_blocked_psym_tensor: block updates stay private to
+// the process (copy-on-write) or are written through to the file
+#define TLA_FILE_MAP_PRIVATE  0
+#define TLA_FILE_MAP_SHARED   1
+
+// Mode products of an out-of-core sttsm whose blocks are prefetched ahead of
+// the one running (see TLA_Sttsm_plan_execute_ooc)
+#define TLA_STTSM_OOC_LOOKAHEAD    4
+
+// Flags of TLA_Sttsm_plan_create
+#define TLA_STTSM_PLAN_DEFAULT     0
+#define TLA_STTSM_PLAN_PSYM_TEMPS  1
 #define FLA_TENSOR    152
@@ -189,6 +189,16 @@ void          FLA_free( void *ptr );
  
 
 
+// -----------------------------------------------------------------------------
+
+#ifdef FLA_ENABLE_MULTITHREADING
+void          FLA_Lock_init( FLA_Lock* fla_lock_ptr );
+void          FLA_Lock_destroy( FLA_Lock* fla_lock_ptr );
+void          FLA_Lock_acquire( FLA_Lock* fla_lock_ptr );
+void          FLA_Lock_release( FLA_Lock* fla_lock_ptr );
+#endif
+
+
 // -----------------------------------------------------------------------------
 
 FLA_Error     FLA_Obj_copy_view( FLA_Obj A, FLA_Obj* B );
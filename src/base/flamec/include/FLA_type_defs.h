@@ -121,9 +121,10 @@ struct FLA_Lock_s
 };
 #endif
 
+typedef int                   FLASH_Data_aff;
+
 #ifdef FLA_ENABLE_SUPERMATRIX
 typedef int                   FLASH_Verbose;
-typedef int                   FLASH_Data_aff;
 
 typedef struct FLASH_Queue_s  FLASH_Queue;
 typedef struct FLASH_Task_s   FLASH_Task;
@@ -131,6 +132,14 @@ typedef struct FLASH_Dep_s    FLASH_Dep;
 #endif
 typedef struct FLASH_Thread_s FLASH_Thread;
 
+typedef struct TLA_symmetry
+{
+    dim_t       nSymGroups;
+    dim_t       symGroupLens[FLA_MAX_ORDER];
+    dim_t       order;
+    dim_t       symModes[FLA_MAX_ORDER];
+} TLA_sym;
+
 typedef struct FLA_Obj_struct
 {
   // Basic object description fields
@@ -159,6 +168,19 @@ typedef struct FLA_Obj_struct
   dim_t         size_inner[FLA_MAX_ORDER];
   dim_t         index[FLA_MAX_ORDER];
 
+  // Blocked tensors: single allocations backing all blocks (NULL otherwise)
+  struct FLA_Obj_struct* blk_bases;
+  void*         blk_slab;
+  size_t        blk_slab_mapped;  // bytes of blk_slab if it maps a file (0 otherwise)
+  FLA_Bool      blk_slab_shared;  // the mapping writes through to the file
+
+  // Blocked psym tensors: block -> unique block lookup (NULL otherwise)
+  struct TLA_unique_map_s* blk_unique_map;
+
+  // Diagonal blocks of psym tensors: entries kept packed along packed_sym
+  FLA_Bool      isPacked;
+  TLA_sym       packed_sym;
+
 #ifdef FLA_ENABLE_SUPERMATRIX
   // Fields for supermatrix
   int           n_read_blocks;
@@ -174,13 +196,17 @@ typedef struct FLA_Obj_struct
 #endif
 } FLA_Base_obj;
 
-typedef struct TLA_symmetry
+// Maps every block of a blocked psym tensor to its unique (stored) block
+typedef struct TLA_unique_map_s
 {
-    dim_t       nSymGroups;
-    dim_t       symGroupLens[FLA_MAX_ORDER];
-    dim_t       order;
-    dim_t       symModes[FLA_MAX_ORDER];
-} TLA_sym;
+    dim_t          order;
+    dim_t          nBlocks;
+    dim_t          nUniques;
+    dim_t*         uniqueLinIndex;  // [nUniques] linear index of each unique block
+    dim_t*         orbitSize;       // [nUniques] number of blocks sharing it
+    dim_t*         repOf;           // [nBlocks] entry of uniqueLinIndex representing the block
+    unsigned char* perm;            // [nBlocks * order] permutation of the block
+} TLA_unique_map;
 
 typedef struct FLA_Obj_view
 {
@@ -206,6 +232,106 @@ typedef struct FLA_Obj_view
 
 } FLA_Obj;
 
+// Compact view for the tensor kernels (see TLA_View_from_obj).  Only the first
+// order entries of offset/size are meaningful; permutation and sym point into
+// the FLA_Obj the view was taken from, which must outlive it.  Sub-views made
+// by TLA_View_slice keep the symmetry of that object (it is not split)
+typedef struct TLA_View_s
+{
+  dim_t         order;
+  dim_t         offset[FLA_MAX_ORDER];
+  dim_t         size[FLA_MAX_ORDER];
+  const dim_t*  permutation;
+  const TLA_sym* sym;
+  FLA_Base_obj* base;
+} TLA_View;
+
+// Mode-n product of scalar blocks as GEMMs on their own layouts:
+// C(m x n) := alpha C + beta B(m x k) A(k x n), repeated over nOther
+// collapsed modes of A and C (see FLA_Ttm_geometry)
+typedef struct FLA_Ttm_geom_s
+{
+  FLA_Datatype  datatype;
+  dim_t         m;
+  dim_t         k;
+  dim_t         n;
+  dim_t         rs_A, cs_A;
+  dim_t         rs_B, cs_B;
+  dim_t         rs_C, cs_C;
+  dim_t         nOther;
+  dim_t         n_o[FLA_MAX_ORDER];
+  dim_t         sa_o[FLA_MAX_ORDER];
+  dim_t         sc_o[FLA_MAX_ORDER];
+} FLA_Ttm_geom;
+
+// Block triples of a mode-n product sharing one geometry, executed in
+// insertion order by FLA_Ttm_batch_flush.  Only the first product into a
+// block of C scales it by alpha (overwriting it if alpha is zero), the later
+// ones accumulate
+typedef struct FLA_Ttm_batch_s
+{
+  FLA_Ttm_geom  geom;
+  FLA_Obj       alpha;
+  FLA_Obj       beta;
+  dim_t         nEntries;
+  dim_t         capacity;
+  char**        buf;            // [3 * capacity] A, B, C buffer of each entry
+  FLA_Bool*     first;          // [capacity] the entry is the first into its C
+  char*         store[3 * FLA_TTM_BATCH_STORE];  // buf until it outgrows it
+  FLA_Bool      first_store[FLA_TTM_BATCH_STORE];
+} FLA_Ttm_batch;
+
+// One recorded block product of FLA_Ttm_batch_add (see FLA_Ttm_record_begin).
+// Products GEMM can express keep the geometry and buffers they run on, the
+// others the block objects for FLA_Ttm_scalar_permC
+typedef struct FLA_Ttm_leaf_s
+{
+  dim_t         geom;           // index into geoms, FLA_TTM_LEAF_OBJS if none
+  dim_t         mode;
+  FLA_Bool      first;
+  char*         buf[3];         // A, B, C buffers of a GEMM leaf
+  dim_t         obj;            // index of A in objs (B and C follow) otherwise
+} FLA_Ttm_leaf;
+
+typedef struct FLA_Ttm_leaves_s
+{
+  dim_t         nLeaves;
+  dim_t         nGeoms;
+  dim_t         nObjs;
+  dim_t         leafCapacity;
+  dim_t         geomCapacity;
+  dim_t         objCapacity;
+  FLA_Ttm_leaf* leaves;
+  FLA_Ttm_geom* geoms;
+  FLA_Obj*      objs;
+} FLA_Ttm_leaves;
+
+// One mode product of the sttsm recursion on fixed views: C := alpha C +
+// beta (B x_mode A), or C := B x_mode A into a temporary if overwriteC.  Its
+// block products are leaves[leafBegin, leafEnd) of the plan
+typedef struct TLA_Sttsm_op_s
+{
+  dim_t         mode;
+  FLA_Bool      overwriteC;
+  FLA_Bool      psttm;
+  FLA_Obj       A;
+  FLA_Obj       B;
+  FLA_Obj       C;
+  dim_t         leafBegin;
+  dim_t         leafEnd;
+} TLA_Sttsm_op;
+
+// Precomputed sttsm of fixed A, B and C (see TLA_Sttsm_plan_create)
+typedef struct TLA_Sttsm_plan_s
+{
+  dim_t          order;
+  dim_t          flags;
+  FLA_Obj*       temps[FLA_MAX_ORDER];
+  dim_t          nOps;
+  TLA_Sttsm_op*  ops;
+  FLA_Ttm_leaves leaves;
+} TLA_Sttsm_plan;
+
 #ifdef FLA_ENABLE_SUPERMATRIX
 struct FLASH_Queue_s
 {
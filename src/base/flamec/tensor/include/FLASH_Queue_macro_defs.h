@@ -34,6 +34,15 @@
 #define FLASH_QUEUE_MACRO_DEFS_H
 
 
+// FLASH_Data_aff (placement of blocks and of the work on them, see
+// FLASH_Queue_set_data_affinity)
+#define FLASH_QUEUE_AFFINITY_NONE                    0
+#define FLASH_QUEUE_AFFINITY_2D_BLOCK_CYCLIC         1
+#define FLASH_QUEUE_AFFINITY_1D_ROW_BLOCK_CYCLIC     2
+#define FLASH_QUEUE_AFFINITY_1D_COLUMN_BLOCK_CYCLIC  3
+#define FLASH_QUEUE_AFFINITY_ROUND_ROBIN             4
+
+
 #ifdef FLA_ENABLE_SUPERMATRIX
 
 
@@ -44,13 +53,6 @@
 #define FLASH_QUEUE_VERBOSE_READABLE                 1
 #define FLASH_QUEUE_VERBOSE_GRAPHVIZ                 2
 
-// FLASH_Data_aff
-#define FLASH_QUEUE_AFFINITY_NONE                    0
-#define FLASH_QUEUE_AFFINITY_2D_BLOCK_CYCLIC         1
-#define FLASH_QUEUE_AFFINITY_1D_ROW_BLOCK_CYCLIC     2
-#define FLASH_QUEUE_AFFINITY_1D_COLUMN_BLOCK_CYCLIC  3
-#define FLASH_QUEUE_AFFINITY_ROUND_ROBIN             4
-
 /*
 Reminder to create a macro to enqueue when SuperMatrix is configured, and
 also to create a macro for when it is not below to return an error code.
@@ -41,5 +41,29 @@ FLA_Bool       FLASH_Queue_get_enabled( void );
 FLA_Error      FLASH_Queue_enable( void );
 FLA_Error      FLASH_Queue_disable( void );
 
+void           FLASH_Queue_set_num_threads( unsigned int n_threads );
+unsigned int   FLASH_Queue_get_num_threads( void );
+void           FLASH_Queue_set_data_affinity( FLASH_Data_aff data_affinity );
+FLASH_Data_aff FLASH_Queue_get_data_affinity( void );
+unsigned int   FLASH_Queue_affinity_owner( dim_t row, dim_t col, dim_t lin, unsigned int n_threads );
+void           FLASH_Queue_bind_thread( unsigned int id );
+void           FLASH_Queue_first_touch( dim_t n_blocks, void* buffers[], const size_t bytes[],
+                                        const unsigned int owner[], unsigned int n_threads );
+
+#ifdef FLA_ENABLE_SUPERMATRIX
+void           FLASH_Queue_init( void );
+void           FLASH_Queue_finalize( void );
+
+void           FLASH_Queue_set_verbose_output( FLASH_Verbose verbose );
+FLASH_Verbose  FLASH_Queue_get_verbose_output( void );
+void           FLASH_Queue_set_block_size( dim_t size );
+dim_t          FLASH_Queue_get_block_size( void );
+unsigned int   FLASH_Queue_get_num_tasks( void );
+
+void           FLASH_Queue_push( void* func, void* cntl, char* name, FLA_Bool enabled_gpu,
+                                 int n_int_args, int n_fla_args, int n_input_args, int n_output_args, ... );
+void           FLASH_Queue_exec( void );
+#endif
+
 #endif // FLASH_QUEUE_MAIN_PROTOTYPES_H
 
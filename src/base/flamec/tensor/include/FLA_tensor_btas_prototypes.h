@@ -36,31 +36,89 @@
 // --- Permute routines --------------------------------------------------------
 FLA_Error FLA_Permute_helper( FLA_Obj A, const dim_t permutation[], FLA_Obj B, dim_t repart_mode_index);
 FLA_Error FLA_Permute( FLA_Obj A, const dim_t permutation[], FLA_Obj* B );
+FLA_Error FLA_Permute_single( FLA_Obj A, const dim_t permutation[], FLA_Obj* B );
+FLA_Error FLA_Permute_blocked( FLA_Obj A, const dim_t permutation[], FLA_Obj B );
 
 // --- Sttsm routines --------------------------------------------------------
 FLA_Error FLA_Sttsm_single( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C, dim_t maxIndex, FLA_Obj* temps[] );
 FLA_Error FLA_Sttsm_without_psym_temps( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
 FLA_Error FLA_Sttsm_with_psym_temps( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+FLA_Error FLA_Sttsm_without_psym_temps_ext( FLA_Datatype datatype, FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+FLA_Error FLA_Sttsm_with_psym_temps_ext( FLA_Datatype datatype, FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+void      FLA_Sttsm_set_num_threads( dim_t n_threads );
+dim_t     FLA_Sttsm_get_num_threads( void );
+void      FLA_Sttsm_initialize_temporaries( FLA_Datatype datatype, FLA_Obj A, FLA_Obj C, FLA_Obj* temps[] );
+void      FLA_Sttsm_destroy_temporaries( dim_t order, FLA_Obj* temps[] );
+void      FLA_Sttsm_initialize_psym_temporaries( FLA_Datatype datatype, FLA_Obj A, FLA_Obj C, FLA_Obj* temps[] );
+void      FLA_Sttsm_destroy_psym_temporaries( dim_t order, FLA_Obj* temps[] );
+FLA_Error TLA_Sttsm_plan_create( FLA_Obj A, FLA_Obj B, FLA_Obj C, dim_t flags, TLA_Sttsm_plan* plan );
+FLA_Error TLA_Sttsm_plan_execute( TLA_Sttsm_plan* plan, FLA_Obj alpha, FLA_Obj beta );
+FLA_Error TLA_Sttsm_plan_execute_ops( TLA_Sttsm_plan* plan, dim_t begin, dim_t end, FLA_Obj alpha, FLA_Obj beta );
+FLA_Error TLA_Sttsm_plan_destroy( TLA_Sttsm_plan* plan );
+FLA_Error TLA_Sttsm_plan_execute_ooc( TLA_Sttsm_plan* plan, FLA_Obj alpha, FLA_Obj beta, size_t budget );
+FLA_Error TLA_Sttsm_ooc( FLA_Obj alpha, const char* pathA, FLA_Obj beta, FLA_Obj B, const char* pathC, dim_t flags, size_t budget );
+#ifdef FLA_ENABLE_MPI
+FLA_Error FLA_Sttsm_mpi( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C, MPI_Comm comm );
+int       FLA_Sttsm_mpi_owner( FLA_Obj A, const dim_t blkIndex[], int nRanks );
+FLA_Error FLA_Obj_mpi_allgather_psym_tensor( FLA_Obj A, MPI_Comm comm );
+#endif
 
 // --- Copy_col routine --------------------------------------------------------
 FLA_Error TLA_Copy_col_mode(FLA_Obj A, dim_t mode_A, FLA_Obj B, dim_t mode_B);
 
 // --- Psttm routines --------------------------------------------------------
 FLA_Error FLA_Psttm( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+#ifdef FLA_ENABLE_MULTITHREADING
+FLA_Error FLA_Psttm_ws( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+#endif
 
 // --- Sttv routines --------------------------------------------------------
 FLA_Error FLA_Psttv( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+void      FLA_Psttv_set_num_threads( dim_t n_threads );
+dim_t     FLA_Psttv_get_num_threads( void );
+void      FLA_Psttv_set_cutoff( dim_t n_blocks );
+dim_t     FLA_Psttv_get_cutoff( void );
+#ifdef FLA_ENABLE_MULTITHREADING
+FLA_Error FLA_Psttv_ws( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, dim_t nTasks, FLA_Obj B[], FLA_Obj C[] );
+#endif
+FLA_Error TLA_Sttv_all( FLA_Obj A, FLA_Obj x, FLA_Obj rho );
+FLA_Error TLA_Sttv_all_but_one( FLA_Obj alpha, FLA_Obj A, FLA_Obj x, FLA_Obj beta, FLA_Obj y );
+
+// --- Dot and norm routines --------------------------------------------------------
+FLA_Error TLA_Dot( FLA_Obj A, FLA_Obj B, FLA_Obj rho );
+FLA_Error TLA_Norm_frob( FLA_Obj A, FLA_Obj norm );
+void      TLA_Dot_set_num_threads( dim_t n_threads );
+dim_t     TLA_Dot_get_num_threads( void );
+
+// --- Mttkrp routines --------------------------------------------------------
+FLA_Error TLA_Mttkrp( FLA_Obj A, const FLA_Obj factors[], dim_t mode, FLA_Obj M );
+FLA_Error TLA_Mttkrp_all( FLA_Obj A, const FLA_Obj factors[], FLA_Obj M[] );
 
 // --- check routine prototypes ------------------------------------------------
 
 // --- Ttm routines
 FLA_Error FLA_Ttm_single_mode_helper( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, dim_t repart_mode, FLA_Obj C );
 FLA_Error FLA_Ttm_single_mode( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+FLA_Error FLA_Ttm_single_mode_view( FLA_Obj alpha, const TLA_View* A, dim_t mode, FLA_Obj beta, const TLA_View* B, const TLA_View* C );
 FLA_Error FLA_Ttm_scalar_permC( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
 FLA_Error FLA_Ttm_scalar_no_permC( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
-
-//Work in progress
-//FLA_Error FLA_Ttm( FLA_Obj alpha, FLA_Obj A, dim_t nModes, const dim_t mode[], FLA_Obj beta, const FLA_Obj B[], FLA_Obj C );
+FLA_Error FLA_Ttm_geometry( const FLA_Obj* A, dim_t mode, const FLA_Obj* B, const FLA_Obj* C, FLA_Ttm_geom* geom, char** buf_A, char** buf_B, char** buf_C );
+void      FLA_Ttm_geom_exec_blis( FLA_Ttm_geom* geom, FLA_Obj alpha, FLA_Obj beta, char* buf_A, char* buf_B, char* buf_C );
+void      FLA_Ttm_batch_init( FLA_Obj alpha, FLA_Obj beta, FLA_Ttm_batch* batch );
+FLA_Error FLA_Ttm_batch_add( FLA_Ttm_batch* batch, const FLA_Obj* A, dim_t mode, const FLA_Obj* B, const FLA_Obj* C, FLA_Bool first );
+FLA_Error FLA_Ttm_batch_flush( FLA_Ttm_batch* batch );
+void      FLA_Ttm_batch_free( FLA_Ttm_batch* batch );
+FLA_Error FLA_Ttm_batch_add_leaves( FLA_Ttm_batch* batch, const FLA_Ttm_leaves* leaves, dim_t begin, dim_t end );
+void      FLA_Ttm_leaves_init( FLA_Ttm_leaves* leaves );
+void      FLA_Ttm_leaves_free( FLA_Ttm_leaves* leaves );
+void      FLA_Ttm_record_begin( FLA_Ttm_leaves* leaves );
+void      FLA_Ttm_record_end( void );
+FLA_Bool  FLA_Ttm_record_add( const FLA_Obj* A, dim_t mode, const FLA_Obj* B, const FLA_Obj* C, FLA_Bool first );
+
+//Multi-mode ttm
+FLA_Error FLA_Ttm( FLA_Obj alpha, FLA_Obj A, dim_t nModes, const dim_t mode[], FLA_Obj beta, const FLA_Obj B[], FLA_Obj C );
+FLA_Error FLA_Ttm_ext( FLA_Obj alpha, FLA_Obj A, dim_t nModes, const dim_t mode[], FLA_Obj beta, const FLA_Obj B[], FLA_Obj C, dim_t order_out[], dim_t* flops );
 
 // --- Sttsm_but_one routines
 FLA_Error FLA_Sttsm_but_one( FLA_Obj alpha, FLA_Obj A, dim_t ignore_mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+FLA_Error FLA_Sttsm_but_one_all( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C[] );
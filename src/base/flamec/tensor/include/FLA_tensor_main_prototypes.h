@@ -47,6 +47,15 @@ FLA_Error FLA_Obj_create_blocked_tensor_without_buffer(FLA_Datatype datatype, di
 FLA_Error FLA_Obj_create_blocked_psym_tensor_without_buffer(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blk_size[], TLA_sym sym, FLA_Obj *obj);
 FLA_Error FLA_Obj_create_blocked_tensor(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], FLA_Obj *obj);
 FLA_Error FLA_Obj_create_blocked_psym_tensor(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], TLA_sym sym, FLA_Obj *obj);
+FLA_Error FLA_Obj_create_blocked_tensor_aligned(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], dim_t align, FLA_Obj *obj);
+FLA_Error FLA_Obj_create_blocked_psym_tensor_aligned(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], TLA_sym sym, dim_t align, FLA_Obj *obj);
+FLA_Error FLA_Obj_create_blocked_psym_tensor_packed(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], TLA_sym sym, FLA_Obj *obj);
+FLA_Error TLA_Obj_create_blocked_tensor_scratch(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], FLA_Obj *obj);
+FLA_Error TLA_Obj_create_blocked_psym_tensor_scratch(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], TLA_sym sym, FLA_Obj *obj);
+
+//--- File functions --------------
+FLA_Error TLA_Obj_write_blocked_psym_tensor( const char* path, FLA_Obj A );
+FLA_Error TLA_Obj_read_blocked_psym_tensor( const char* path, dim_t flags, FLA_Obj* obj );
 
 //--- Query functions --------------
 
@@ -63,6 +72,8 @@ FLA_Error	FLA_Obj_blocked_psym_tensor_free_buffer( FLA_Obj *obj);
 dim_t*		FLA_Obj_base_scalar_size(FLA_Obj A);
 dim_t		FLA_Obj_base_scalar_dimsize(FLA_Obj A, dim_t mode);
 void*		FLA_Obj_tensor_buffer_at_view( FLA_Obj obj );
+size_t		TLA_Obj_view_offset( const FLA_Obj* obj );
+TLA_unique_map* FLA_Obj_unique_map( FLA_Obj obj );
 
 //--- Symmetry related queries --------------------------
 dim_t		TLA_mode_at_sym_pos( TLA_sym S, dim_t pos );
@@ -126,6 +137,13 @@ FLA_Error   FLA_Cont_with_3powm_to_2powm( FLA_Obj* Apart[], FLA_Obj* Arepart[],
                                           dim_t nModes_repart, const dim_t repart_modes[],
                                           const FLA_Side sides[]);
 
+//--------------------------------------------------------------------------
+// --- TLA_View functions (compact kernel views) -------------------------------
+void        TLA_View_from_obj( const FLA_Obj* A, TLA_View* V );
+void        TLA_View_to_obj( const TLA_View* V, FLA_Obj* A );
+void        TLA_View_slice( const TLA_View* A, dim_t mode, dim_t index, TLA_View* A1 );
+void*       TLA_View_buffer_at_view( const TLA_View* V );
+
 // -------------------------------------------------------------------------
 // ---  Check functions
 
@@ -34,6 +34,7 @@
 
 FLA_Error FLA_Set_zero_tensor( FLA_Obj A );
 FLA_Error FLA_Adjust_2D_info( FLA_Obj *A );
+FLA_Error TLA_Adjust_2D_info_blocks( FLA_Obj A );
 FLA_Error FLA_Random_tensor(FLA_Obj A);
 FLA_Error FLA_Random_psym_tensor(FLA_Obj obj);
 
@@ -42,10 +43,25 @@ int compare_pairwise_sort(const void* a, const void* b);
 int compare_dim_t(const void* a, const void* b);
 dim_t binomial(dim_t n, dim_t k);
 dim_t FLA_get_unique_info( TLA_sym sym, const dim_t index[], dim_t* sortedIndex, dim_t* permutation, dim_t* ipermutation);
+FLA_Bool TLA_next_unique_index( TLA_sym sym, const dim_t blked_size[], dim_t index[] );
+FLA_Error TLA_Unique_map_create( TLA_sym sym, const dim_t blked_size[], const dim_t stride[], TLA_unique_map* map );
+FLA_Error TLA_Unique_map_free( TLA_unique_map* map );
+dim_t TLA_packed_sym_size( TLA_sym sym, const dim_t size[] );
+dim_t TLA_packed_sym_offset( TLA_sym sym, const dim_t size[], const dim_t index[] );
+dim_t TLA_sym_index_multiplicity( TLA_sym sym, const dim_t index[] );
+dim_t TLA_sym_value_count( TLA_sym sym, dim_t group, dim_t j, const dim_t index[] );
+FLA_Bool TLA_sym_of_diagonal_block( TLA_sym sym, const dim_t blkIndex[], TLA_sym* blkSym );
+FLA_Error TLA_Pack_sym_block( FLA_Obj A, TLA_sym sym, void* packed );
+FLA_Error TLA_Unpack_sym_block( TLA_sym sym, const void* packed, FLA_Obj A );
+FLA_Error FLA_Obj_pack_blocked_psym_tensor( FLA_Obj A, FLA_Obj B );
+FLA_Error FLA_Obj_unpack_blocked_psym_tensor( FLA_Obj A, FLA_Obj B );
+FLA_Error TLA_Copy_buffer_convert( dim_t nElem, FLA_Datatype dt_from, void* from, FLA_Datatype dt_to, void* to );
+FLA_Error TLA_Copy_matrix_convert( dim_t m, dim_t n, FLA_Datatype dt_from, void* from, dim_t rs_from, dim_t cs_from, FLA_Datatype dt_to, void* to, dim_t rs_to, dim_t cs_to );
 FLA_Error FLA_Set_tensor_stride( dim_t order, const dim_t size[], dim_t* stride);
 dim_t FLA_TIndex_to_LinIndex( dim_t order, dim_t const stride[], dim_t const index[]);
 FLA_Error FLA_LinIndex_to_TIndex( dim_t order, dim_t const stride[], dim_t const linIndex, dim_t index[]);
 dim_t FLA_Ttm_Ops( dim_t order, const dim_t size_A[], const dim_t size_B[2], dim_t mode);
+dim_t FLA_Ttm_Ops_order( dim_t order, const dim_t size_A[], dim_t nModes, const dim_t mode[], const dim_t size_B[], dim_t seq[] );
 
 //---  Array routines --------------
 void print_array(const char* header, dim_t nElem, const dim_t arr[]);
@@ -55,6 +71,7 @@ FLA_Error FLA_array_elemwise_quotient( dim_t order, const dim_t arr1[], const di
 
 //--- Symmetry View routines ---------
 FLA_Error TLA_create_part_obj( dim_t nPart, FLA_Obj* partitions[]);
+FLA_Error TLA_init_part_obj( dim_t nPart, FLA_Obj store[], FLA_Obj* partitions[]);
 FLA_Error TLA_destroy_part_obj( dim_t nPart, FLA_Obj* partitions[]);
 
 //--- TLA_sym routines ------------
@@ -32,9 +32,815 @@
 
 #include "FLAME.h"
 
+// sched_setaffinity() and the CPU_* macros (FLASH_Queue_bind_thread); the
+// configuration defines _GNU_SOURCE
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#ifdef FLA_ENABLE_SUPERMATRIX
+
+#include <stdarg.h>
+
+// Task wrappers take their integer arguments, the first constant, the inputs,
+// the second constant and the outputs, in that order, followed by cntl.
+// These are the argument shapes used by the BLAS ENQUEUE_FLASH_* macros.
+typedef FLA_Error(*flash_task_2221_p)(int, int, FLA_Obj, FLA_Obj, FLA_Obj, FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_2211_p)(int, int, FLA_Obj, FLA_Obj, FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_4111_p)(int, int, int, int, FLA_Obj, FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_1221_p)(int, FLA_Obj, FLA_Obj, FLA_Obj, FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_3011_p)(int, int, int, FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_1111_p)(int, FLA_Obj, FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_0111_p)(FLA_Obj, FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_1011_p)(int, FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_0011_p)(FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_1101_p)(int, FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_0101_p)(FLA_Obj, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_2001_p)(int, int, FLA_Obj, void*);
+typedef FLA_Error(*flash_task_0001_p)(FLA_Obj, void*);
+
+#define FLASH_TASK_SHAPE( n_int, n_fla, n_input, n_output ) \
+        ( ( ( n_int ) << 12 ) | ( ( n_fla ) << 8 ) | ( ( n_input ) << 4 ) | ( n_output ) )
+
+// Enqueuing is off until FLASH_Queue_enable: the queue is global and not
+// thread safe, so flat FLASH calls made from concurrent kernels (the ttm
+// leaves of FLA_Sttsm_par and FLA_Psttv) must run their leaves directly.
+static unsigned int   flash_queue_stack           = 0;
+static FLA_Bool       flash_queue_enabled         = FALSE;
+static FLA_Bool       flash_queue_initialized     = FALSE;
+static FLASH_Data_aff flash_queue_data_affinity   = FLASH_QUEUE_AFFINITY_NONE;
+static unsigned int   flash_queue_n_threads       = 1;
+static dim_t          flash_queue_block_size      = 0;
+static FLASH_Verbose  flash_queue_verbose         = FLASH_QUEUE_VERBOSE_NONE;
+
+// Tasks in the order they were enqueued.
+static FLASH_Queue    flash_queue_tasks;
+
+// Tasks whose dependencies are all satisfied, linked through prev/next_wait:
+// one queue per thread, a task waiting in the queue of the thread owning its
+// output under the data affinity (queue 0 for all if there is none).
+static FLASH_Queue*   flash_queue_ready           = NULL;
+static unsigned int   flash_queue_n_ready         = 0;
+static unsigned int   flash_queue_n_done          = 0;
+
+#ifdef FLA_ENABLE_MULTITHREADING
+static FLA_Lock       flash_queue_lock;
+#if FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+static pthread_cond_t flash_queue_cond;
+#endif
+#endif
+
+
+void FLASH_Queue_init( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_init
+
+----------------------------------------------------------------------------*/
+{
+   if ( flash_queue_initialized )
+      return;
+
+   flash_queue_tasks.n_tasks = 0;
+   flash_queue_tasks.head    = NULL;
+   flash_queue_tasks.tail    = NULL;
+
+   flash_queue_ready       = NULL;
+   flash_queue_n_ready     = 0;
+
+#ifdef FLA_ENABLE_MULTITHREADING
+   FLA_Lock_init( &flash_queue_lock );
+#if FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+   pthread_cond_init( &flash_queue_cond, NULL );
+#endif
+#endif
+
+   flash_queue_stack       = 0;
+   flash_queue_initialized = TRUE;
+
+   return;
+}
+
+
+void FLASH_Queue_finalize( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_finalize
+
+----------------------------------------------------------------------------*/
+{
+   if ( !flash_queue_initialized )
+      return;
+
+   // Run anything still pending so no task outlives the library.
+   if ( flash_queue_tasks.n_tasks > 0 )
+      FLASH_Queue_exec();
+
+#ifdef FLA_ENABLE_MULTITHREADING
+   FLA_Lock_destroy( &flash_queue_lock );
+#if FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+   pthread_cond_destroy( &flash_queue_cond );
+#endif
+#endif
+
+   flash_queue_initialized = FALSE;
+
+   return;
+}
+
+
+void FLASH_Queue_begin( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_begin
+
+----------------------------------------------------------------------------*/
+{
+   // Push onto the stack.
+   flash_queue_stack++;
+
+   return;
+}
+
+
+void FLASH_Queue_end( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_end
+
+----------------------------------------------------------------------------*/
+{
+   // Pop off the stack.
+   flash_queue_stack--;
+
+   // The outermost FLASH operation has finished enqueuing; run the DAG.
+   if ( flash_queue_stack == 0 && flash_queue_tasks.n_tasks > 0 )
+      FLASH_Queue_exec();
+
+   return;
+}
+
+
+FLA_Bool FLASH_Queue_get_enabled( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_get_enabled
+
+----------------------------------------------------------------------------*/
+{
+   return flash_queue_enabled;
+}
+
+
+FLA_Error FLASH_Queue_enable( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_enable
+
+----------------------------------------------------------------------------*/
+{
+   // Switching modes halfway through an enqueued operation is not allowed.
+   if ( flash_queue_stack != 0 )
+      return FLA_FAILURE;
+
+   flash_queue_enabled = TRUE;
+   return FLA_SUCCESS;
+}
+
+
+FLA_Error FLASH_Queue_disable( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_disable
+
+----------------------------------------------------------------------------*/
+{
+   if ( flash_queue_stack != 0 )
+      return FLA_FAILURE;
+
+   flash_queue_enabled = FALSE;
+   return FLA_SUCCESS;
+}
+
+
+void FLASH_Queue_set_num_threads( unsigned int n_threads )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_set_num_threads
+
+----------------------------------------------------------------------------*/
+{
+   flash_queue_n_threads = ( n_threads < 1 ? 1 : n_threads );
+
+   return;
+}
+
+
+unsigned int FLASH_Queue_get_num_threads( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_get_num_threads
+
+----------------------------------------------------------------------------*/
+{
+   return flash_queue_n_threads;
+}
+
+
+void FLASH_Queue_set_verbose_output( FLASH_Verbose verbose )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_set_verbose_output
+
+----------------------------------------------------------------------------*/
+{
+   flash_queue_verbose = verbose;
+
+   return;
+}
+
+
+FLASH_Verbose FLASH_Queue_get_verbose_output( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_get_verbose_output
+
+----------------------------------------------------------------------------*/
+{
+   return flash_queue_verbose;
+}
+
+
+void FLASH_Queue_set_block_size( dim_t size )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_set_block_size
+
+----------------------------------------------------------------------------*/
+{
+   // Remember the largest leaf block seen; only used for reporting.
+   if ( size > flash_queue_block_size )
+      flash_queue_block_size = size;
+
+   return;
+}
+
+
+dim_t FLASH_Queue_get_block_size( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_get_block_size
+
+----------------------------------------------------------------------------*/
+{
+   return flash_queue_block_size;
+}
+
+
+unsigned int FLASH_Queue_get_num_tasks( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_get_num_tasks
+
+----------------------------------------------------------------------------*/
+{
+   return flash_queue_tasks.n_tasks;
+}
+
+
+static void FLASH_Queue_add_dep( FLASH_Task* t_from, FLASH_Task* t_to )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_add_dep
+
+   Records that t_to may not start before t_from has finished.
+
+----------------------------------------------------------------------------*/
+{
+   FLASH_Dep* d;
+
+   // A task never waits on itself, and one edge per pair of tasks is enough.
+   if ( t_from == NULL || t_from == t_to )
+      return;
+   if ( t_from->dep_arg_tail != NULL && t_from->dep_arg_tail->task == t_to )
+      return;
+
+   d = ( FLASH_Dep* ) FLA_malloc( sizeof( FLASH_Dep ) );
+   d->task     = t_to;
+   d->next_dep = NULL;
+
+   if ( t_from->dep_arg_head == NULL )
+      t_from->dep_arg_head = d;
+   else
+      t_from->dep_arg_tail->next_dep = d;
+   t_from->dep_arg_tail = d;
+   t_from->n_dep_args++;
+
+   t_to->n_ready++;
+}
+
+
+static void FLASH_Queue_clear_reads( FLA_Base_obj* base )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_clear_reads
+
+----------------------------------------------------------------------------*/
+{
+   FLASH_Dep* d = base->read_task_head;
+   FLASH_Dep* next;
+
+   while ( d != NULL )
+   {
+      next = d->next_dep;
+      FLA_free( d );
+      d = next;
+   }
+
+   base->n_read_tasks   = 0;
+   base->read_task_head = NULL;
+   base->read_task_tail = NULL;
+}
+
+
+static void FLASH_Queue_track_input( FLASH_Task* t, FLA_Obj obj )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_track_input
+
+----------------------------------------------------------------------------*/
+{
+   FLA_Base_obj* base = obj.base;
+   FLASH_Dep*    d;
+
+   // Read after write: wait for the last writer of the block.
+   FLASH_Queue_add_dep( base->write_task, t );
+
+   // Remember the reader so the next writer waits for it.
+   if ( base->read_task_tail != NULL && base->read_task_tail->task == t )
+      return;
+
+   d = ( FLASH_Dep* ) FLA_malloc( sizeof( FLASH_Dep ) );
+   d->task     = t;
+   d->next_dep = NULL;
+
+   if ( base->read_task_head == NULL )
+      base->read_task_head = d;
+   else
+      base->read_task_tail->next_dep = d;
+   base->read_task_tail = d;
+   base->n_read_tasks++;
+}
+
+
+static void FLASH_Queue_track_output( FLASH_Task* t, FLA_Obj obj )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_track_output
+
+----------------------------------------------------------------------------*/
+{
+   FLA_Base_obj* base = obj.base;
+   FLASH_Dep*    d;
+
+   // Write after write: keep updates to the block in program order.
+   FLASH_Queue_add_dep( base->write_task, t );
+
+   // Write after read: wait for every reader since the last write.
+   for ( d = base->read_task_head; d != NULL; d = d->next_dep )
+   {
+      FLASH_Queue_add_dep( d->task, t );
+      t->n_war_args++;
+   }
+
+   FLASH_Queue_clear_reads( base );
+   base->write_task = t;
+}
+
+
+void FLASH_Queue_push( void* func, void* cntl, char* name, FLA_Bool enabled_gpu,
+                       int n_int_args, int n_fla_args, int n_input_args, int n_output_args, ... )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_push
+
+   Arguments after n_output_args are, in order: n_int_args ints, then
+   n_fla_args constant FLA_Objs, then n_input_args and n_output_args FLA_Objs.
+
+----------------------------------------------------------------------------*/
+{
+   FLASH_Task* t;
+   va_list     var_arg_list;
+   int         i;
+
+   t = ( FLASH_Task* ) FLA_malloc( sizeof( FLASH_Task ) );
+
+   t->n_ready       = 0;
+   t->order         = flash_queue_tasks.n_tasks;
+   t->queue         = 0;
+   t->height        = 0;
+   t->thread        = -1;
+   t->cache         = -1;
+   t->hit           = FALSE;
+   t->func          = func;
+   t->cntl          = cntl;
+   t->name          = name;
+   t->enabled_gpu   = enabled_gpu;
+   t->n_int_args    = n_int_args;
+   t->n_fla_args    = n_fla_args;
+   t->n_input_args  = n_input_args;
+   t->n_output_args = n_output_args;
+   t->n_macro_args  = 0;
+   t->n_war_args    = 0;
+   t->n_dep_args    = 0;
+   t->dep_arg_head  = NULL;
+   t->dep_arg_tail  = NULL;
+   t->prev_task     = flash_queue_tasks.tail;
+   t->next_task     = NULL;
+   t->prev_wait     = NULL;
+   t->next_wait     = NULL;
+
+   t->int_arg    = ( int* )     FLA_malloc( ( n_int_args    > 0 ? n_int_args    : 1 ) * sizeof( int ) );
+   t->fla_arg    = ( FLA_Obj* ) FLA_malloc( ( n_fla_args    > 0 ? n_fla_args    : 1 ) * sizeof( FLA_Obj ) );
+   t->input_arg  = ( FLA_Obj* ) FLA_malloc( ( n_input_args  > 0 ? n_input_args  : 1 ) * sizeof( FLA_Obj ) );
+   t->output_arg = ( FLA_Obj* ) FLA_malloc( ( n_output_args > 0 ? n_output_args : 1 ) * sizeof( FLA_Obj ) );
+
+   va_start( var_arg_list, n_output_args );
+
+   for ( i = 0; i < n_int_args; i++ )
+      t->int_arg[i] = va_arg( var_arg_list, int );
+   for ( i = 0; i < n_fla_args; i++ )
+      t->fla_arg[i] = va_arg( var_arg_list, FLA_Obj );
+   for ( i = 0; i < n_input_args; i++ )
+      t->input_arg[i] = va_arg( var_arg_list, FLA_Obj );
+   for ( i = 0; i < n_output_args; i++ )
+      t->output_arg[i] = va_arg( var_arg_list, FLA_Obj );
+
+   va_end( var_arg_list );
+
+   // Inputs first so an operand that is both read and written (e.g. the
+   // pivots of an LU) is ordered by its write.
+   for ( i = 0; i < n_input_args; i++ )
+      FLASH_Queue_track_input( t, t->input_arg[i] );
+   for ( i = 0; i < n_output_args; i++ )
+      FLASH_Queue_track_output( t, t->output_arg[i] );
+
+   if ( flash_queue_tasks.head == NULL )
+      flash_queue_tasks.head = t;
+   else
+      flash_queue_tasks.tail->next_task = t;
+   flash_queue_tasks.tail = t;
+   flash_queue_tasks.n_tasks++;
+
+   return;
+}
+
+
+static FLA_Error FLASH_Queue_exec_task( FLASH_Task* t )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_exec_task
+
+   Calls the task wrapper through the signature implied by its argument
+   counts, so the runtime does not have to link every wrapper it can run.
+
+----------------------------------------------------------------------------*/
+{
+   void*    f = t->func;
+   int*     i = t->int_arg;
+   FLA_Obj* c = t->fla_arg;
+   FLA_Obj* r = t->input_arg;
+   FLA_Obj* w = t->output_arg;
+
+   switch ( FLASH_TASK_SHAPE( t->n_int_args, t->n_fla_args, t->n_input_args, t->n_output_args ) )
+   {
+      // Gemm, Hemm, Symm, Her2k, Syr2k
+      case FLASH_TASK_SHAPE( 2, 2, 2, 1 ):
+         return ( ( flash_task_2221_p ) f )( i[0], i[1], c[0], r[0], r[1], c[1], w[0], t->cntl );
+      // Herk, Syrk
+      case FLASH_TASK_SHAPE( 2, 2, 1, 1 ):
+         return ( ( flash_task_2211_p ) f )( i[0], i[1], c[0], r[0], c[1], w[0], t->cntl );
+      // Trmm, Trsm
+      case FLASH_TASK_SHAPE( 4, 1, 1, 1 ):
+         return ( ( flash_task_4111_p ) f )( i[0], i[1], i[2], i[3], c[0], r[0], w[0], t->cntl );
+      // Gemv
+      case FLASH_TASK_SHAPE( 1, 2, 2, 1 ):
+         return ( ( flash_task_1221_p ) f )( i[0], c[0], r[0], r[1], c[1], w[0], t->cntl );
+      // Trsv
+      case FLASH_TASK_SHAPE( 3, 0, 1, 1 ):
+         return ( ( flash_task_3011_p ) f )( i[0], i[1], i[2], r[0], w[0], t->cntl );
+      // Axpyt
+      case FLASH_TASK_SHAPE( 1, 1, 1, 1 ):
+         return ( ( flash_task_1111_p ) f )( i[0], c[0], r[0], w[0], t->cntl );
+      // Axpy
+      case FLASH_TASK_SHAPE( 0, 1, 1, 1 ):
+         return ( ( flash_task_0111_p ) f )( c[0], r[0], w[0], t->cntl );
+      // Copyt, Copyr
+      case FLASH_TASK_SHAPE( 1, 0, 1, 1 ):
+         return ( ( flash_task_1011_p ) f )( i[0], r[0], w[0], t->cntl );
+      // Copy
+      case FLASH_TASK_SHAPE( 0, 0, 1, 1 ):
+         return ( ( flash_task_0011_p ) f )( r[0], w[0], t->cntl );
+      // Scalr
+      case FLASH_TASK_SHAPE( 1, 1, 0, 1 ):
+         return ( ( flash_task_1101_p ) f )( i[0], c[0], w[0], t->cntl );
+      // Scal
+      case FLASH_TASK_SHAPE( 0, 1, 0, 1 ):
+         return ( ( flash_task_0101_p ) f )( c[0], w[0], t->cntl );
+      // Obj_create_buffer
+      case FLASH_TASK_SHAPE( 2, 0, 0, 1 ):
+         return ( ( flash_task_2001_p ) f )( i[0], i[1], w[0], t->cntl );
+      // Obj_free_buffer
+      case FLASH_TASK_SHAPE( 0, 0, 0, 1 ):
+         return ( ( flash_task_0001_p ) f )( w[0], t->cntl );
+   }
+
+   FLA_Check_error_code( FLA_NOT_YET_IMPLEMENTED );
+   return FLA_FAILURE;
+}
+
+
+static void FLASH_Queue_ready_push( FLASH_Task* t )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_ready_push
+
+----------------------------------------------------------------------------*/
+{
+   FLASH_Queue* q = &flash_queue_ready[ t->queue ];
+
+   t->prev_wait = q->tail;
+   t->next_wait = NULL;
+
+   if ( q->head == NULL )
+      q->head = t;
+   else
+      q->tail->next_wait = t;
+   q->tail = t;
+   q->n_tasks++;
+}
+
+
+static FLASH_Task* FLASH_Queue_ready_pop( unsigned int id )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_ready_pop
+
+   Takes the oldest ready task of thread id, or else steals one from the
+   queues of the other threads.
+
+----------------------------------------------------------------------------*/
+{
+   FLASH_Queue* q = NULL;
+   FLASH_Task*  t;
+   unsigned int i;
+
+   for ( i = 0; i < flash_queue_n_ready; i++ )
+   {
+      q = &flash_queue_ready[ ( id + i ) % flash_queue_n_ready ];
+      if ( q->head != NULL )
+         break;
+   }
+   if ( q == NULL || q->head == NULL )
+      return NULL;
+
+   t = q->head;
+   q->head = t->next_wait;
+   if ( q->head == NULL )
+      q->tail = NULL;
+   else
+      q->head->prev_wait = NULL;
+   q->n_tasks--;
+
+   t->next_wait = NULL;
+
+   return t;
+}
+
+
+static void* FLASH_Queue_exec_parallel_function( void* arg )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_exec_parallel_function
+
+   Worker loop: pull a ready task, run it, then release its successors.
+   Every state change happens under flash_queue_lock.
+
+----------------------------------------------------------------------------*/
+{
+   FLASH_Thread* me = ( FLASH_Thread* ) arg;
+   FLASH_Task*   t;
+   FLASH_Dep*    d;
+   unsigned int  n_tasks = flash_queue_tasks.n_tasks;
+
+   FLASH_Queue_bind_thread( me->id );
+
+#ifdef FLA_ENABLE_MULTITHREADING
+   FLA_Lock_acquire( &flash_queue_lock );
+#endif
+
+   while ( flash_queue_n_done < n_tasks )
+   {
+      t = FLASH_Queue_ready_pop( me->id );
+
+      if ( t == NULL )
+      {
+         // Everything runnable is in flight on other threads.
+#ifdef FLA_ENABLE_MULTITHREADING
+#if FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+         pthread_cond_wait( &flash_queue_cond, &(flash_queue_lock.lock) );
+#else
+         FLA_Lock_release( &flash_queue_lock );
+         FLA_Lock_acquire( &flash_queue_lock );
+#endif
+#endif
+         continue;
+      }
+
+#ifdef FLA_ENABLE_MULTITHREADING
+      FLA_Lock_release( &flash_queue_lock );
+#endif
+
+      t->thread = me->id;
+
+      if ( flash_queue_verbose == FLASH_QUEUE_VERBOSE_READABLE )
+         printf( "thread %d: task %d %s\n", me->id, t->order, t->name );
+
+      FLASH_Queue_exec_task( t );
+
+#ifdef FLA_ENABLE_MULTITHREADING
+      FLA_Lock_acquire( &flash_queue_lock );
+#endif
+
+      for ( d = t->dep_arg_head; d != NULL; d = d->next_dep )
+      {
+         d->task->n_ready--;
+         if ( d->task->n_ready == 0 )
+            FLASH_Queue_ready_push( d->task );
+      }
+
+      flash_queue_n_done++;
+
+#if defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+      pthread_cond_broadcast( &flash_queue_cond );
+#endif
+   }
+
+#ifdef FLA_ENABLE_MULTITHREADING
+   FLA_Lock_release( &flash_queue_lock );
+#endif
+
+   return NULL;
+}
+
+
+static void FLASH_Queue_reset_args( FLA_Obj* args, int n_args )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_reset_args
+
+----------------------------------------------------------------------------*/
+{
+   int i;
+
+   for ( i = 0; i < n_args; i++ )
+   {
+      FLASH_Queue_clear_reads( args[i].base );
+      args[i].base->write_task = NULL;
+   }
+}
+
+
+void FLASH_Queue_exec( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_exec
+
+   Runs every enqueued task on flash_queue_n_threads threads, honoring the
+   RAW/WAR/WAW dependencies recorded by FLASH_Queue_push(), then empties
+   the queue. Updates of one block run in program order, so results do not
+   depend on the number of threads.
+
+----------------------------------------------------------------------------*/
+{
+   FLASH_Task*   t;
+   FLASH_Task*   t_next;
+   FLASH_Dep*    d;
+   FLASH_Dep*    d_next;
+   FLASH_Thread* thread;
+   unsigned int  n_threads = flash_queue_n_threads;
+   unsigned int  i;
+
+   if ( flash_queue_tasks.n_tasks == 0 )
+      return;
+
+#ifndef FLA_ENABLE_MULTITHREADING
+   n_threads = 1;
+#endif
+   if ( n_threads > flash_queue_tasks.n_tasks )
+      n_threads = flash_queue_tasks.n_tasks;
+
+   // Give every task to the thread owning the first block it writes (see
+   // FLASH_Queue_set_data_affinity). Round robin deals the tasks in order.
+   flash_queue_n_ready = n_threads;
+   flash_queue_ready   = ( FLASH_Queue* ) FLA_malloc( n_threads * sizeof( FLASH_Queue ) );
+   for ( i = 0; i < n_threads; i++ )
+   {
+      flash_queue_ready[i].n_tasks = 0;
+      flash_queue_ready[i].head    = NULL;
+      flash_queue_ready[i].tail    = NULL;
+   }
+   flash_queue_n_done = 0;
+
+   for ( t = flash_queue_tasks.head; t != NULL; t = t->next_task )
+   {
+      if ( flash_queue_data_affinity == FLASH_QUEUE_AFFINITY_NONE || t->n_output_args == 0 )
+         t->queue = 0;
+      else
+         t->queue = FLASH_Queue_affinity_owner( t->output_arg[0].base->m_index,
+                                                t->output_arg[0].base->n_index,
+                                                t->order, n_threads );
+   }
+
+   // Seed the ready queues with the tasks that depend on nothing.
+   for ( t = flash_queue_tasks.head; t != NULL; t = t->next_task )
+      if ( t->n_ready == 0 )
+         FLASH_Queue_ready_push( t );
+
+   thread = ( FLASH_Thread* ) FLA_malloc( n_threads * sizeof( FLASH_Thread ) );
+   for ( i = 0; i < n_threads; i++ )
+   {
+      thread[i].id   = i;
+      thread[i].args = NULL;
+   }
+
+#if defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+   // The calling thread acts as worker 0.
+   for ( i = 1; i < n_threads; i++ )
+   {
+      int r_val = pthread_create( &(thread[i].pthread_obj), NULL,
+                                  FLASH_Queue_exec_parallel_function,
+                                  ( void* ) &thread[i] );
+      FLA_Check_error_code( FLA_Check_pthread_create_result( r_val ) );
+   }
+
+   FLASH_Queue_exec_parallel_function( ( void* ) &thread[0] );
+
+   for ( i = 1; i < n_threads; i++ )
+   {
+      int r_val = pthread_join( thread[i].pthread_obj, NULL );
+      FLA_Check_error_code( FLA_Check_pthread_join_result( r_val ) );
+   }
+#elif defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_OPENMP
+   #pragma omp parallel for num_threads( n_threads )
+   for ( i = 0; i < n_threads; i++ )
+      FLASH_Queue_exec_parallel_function( ( void* ) &thread[i] );
+#else
+   FLASH_Queue_exec_parallel_function( ( void* ) &thread[0] );
+#endif
+
+   FLA_free( thread );
+   FLA_free( flash_queue_ready );
+   flash_queue_ready   = NULL;
+   flash_queue_n_ready = 0;
+
+   // Forget the dependency state on the blocks and release the tasks.
+   for ( t = flash_queue_tasks.head; t != NULL; t = t_next )
+   {
+      t_next = t->next_task;
+
+      FLASH_Queue_reset_args( t->input_arg,  t->n_input_args );
+      FLASH_Queue_reset_args( t->output_arg, t->n_output_args );
+
+      for ( d = t->dep_arg_head; d != NULL; d = d_next )
+      {
+         d_next = d->next_dep;
+         FLA_free( d );
+      }
+
+      FLA_free( t->int_arg );
+      FLA_free( t->fla_arg );
+      FLA_free( t->input_arg );
+      FLA_free( t->output_arg );
+      FLA_free( t );
+   }
+
+   flash_queue_tasks.n_tasks = 0;
+   flash_queue_tasks.head    = NULL;
+   flash_queue_tasks.tail    = NULL;
+
+   return;
+}
+
+#else // FLA_ENABLE_SUPERMATRIX
 
 static unsigned int   flash_queue_stack           = 0;
 static FLA_Bool       flash_queue_enabled         = TRUE;
+static FLASH_Data_aff flash_queue_data_affinity   = FLASH_QUEUE_AFFINITY_NONE;
+
+// Without SuperMatrix the thread count is only that of the data affinity:
+// the threads the blocks of tensors are placed across and worked on by.
+static unsigned int   flash_queue_n_threads       = 1;
 
 void FLASH_Queue_begin( void )
 /*----------------------------------------------------------------------------
@@ -99,3 +905,223 @@ FLA_Error FLASH_Queue_disable( void )
    return FLA_SUCCESS;
 }
 
+
+void FLASH_Queue_set_num_threads( unsigned int n_threads )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_set_num_threads
+
+----------------------------------------------------------------------------*/
+{
+   flash_queue_n_threads = ( n_threads < 1 ? 1 : n_threads );
+
+   return;
+}
+
+
+unsigned int FLASH_Queue_get_num_threads( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_get_num_threads
+
+----------------------------------------------------------------------------*/
+{
+   return flash_queue_n_threads;
+}
+
+#endif // FLA_ENABLE_SUPERMATRIX
+
+
+// --- Data affinity -----------------------------------------------------------
+//
+// With a data affinity set, blocks are owned by the FLASH_Queue_get_num_threads()
+// threads: blocked tensors and FLASH matrices are first touched (zeroed) by
+// the thread owning each block when they are created, so that under a
+// first-touch policy their pages land on that thread's NUMA node, and the
+// parallel kernels hand the work on a block to its owner. Thread 0 is the
+// calling thread; thread i > 0 is bound to CPU i (modulo the number of CPUs),
+// both when placing and when computing.
+//
+// Blocks are located by a row, a column and a linear index: for FLASH
+// matrices the m_index and n_index of a leaf and its position in creation
+// order, for blocked tensors the block index along the first and the last
+// mode and the linear block index.
+
+
+void FLASH_Queue_set_data_affinity( FLASH_Data_aff data_affinity )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_set_data_affinity
+
+----------------------------------------------------------------------------*/
+{
+   flash_queue_data_affinity = data_affinity;
+
+   return;
+}
+
+
+FLASH_Data_aff FLASH_Queue_get_data_affinity( void )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_get_data_affinity
+
+----------------------------------------------------------------------------*/
+{
+   return flash_queue_data_affinity;
+}
+
+
+unsigned int FLASH_Queue_affinity_owner( dim_t row, dim_t col, dim_t lin, unsigned int n_threads )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_affinity_owner
+
+   Thread owning a block among n_threads under the data affinity. The 2D
+   block cyclic grid has the largest number of rows r with r * r <= n_threads
+   that divides n_threads.
+
+----------------------------------------------------------------------------*/
+{
+   unsigned int r;
+
+   if ( n_threads <= 1 )
+      return 0;
+
+   switch ( flash_queue_data_affinity )
+   {
+      case FLASH_QUEUE_AFFINITY_2D_BLOCK_CYCLIC:
+         for ( r = 1; ( r + 1 ) * ( r + 1 ) <= n_threads; r++ );
+         while ( n_threads % r != 0 )
+            r--;
+         return ( row % r ) + ( col % ( n_threads / r ) ) * r;
+      case FLASH_QUEUE_AFFINITY_1D_ROW_BLOCK_CYCLIC:
+         return row % n_threads;
+      case FLASH_QUEUE_AFFINITY_1D_COLUMN_BLOCK_CYCLIC:
+         return col % n_threads;
+      case FLASH_QUEUE_AFFINITY_ROUND_ROBIN:
+         return lin % n_threads;
+   }
+
+   return 0;
+}
+
+
+void FLASH_Queue_bind_thread( unsigned int id )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_bind_thread
+
+   Binds the calling thread, thread id of a parallel region, to its CPU when
+   a data affinity is set. Thread 0 (the caller of the region) is left alone,
+   as are all threads without multithreading (the shares then run in turn on
+   the caller).
+
+----------------------------------------------------------------------------*/
+{
+#if defined(FLA_ENABLE_MULTITHREADING) && defined(CPU_SET) && !defined(FLA_ENABLE_WINDOWS_BUILD)
+   cpu_set_t set;
+   long      n_cpus;
+
+   if ( id == 0 || flash_queue_data_affinity == FLASH_QUEUE_AFFINITY_NONE )
+      return;
+
+   n_cpus = sysconf( _SC_NPROCESSORS_ONLN );
+   if ( n_cpus < 1 )
+      return;
+
+   CPU_ZERO( &set );
+   CPU_SET( id % n_cpus, &set );
+   sched_setaffinity( 0, sizeof( set ), &set );
+#endif
+
+   return;
+}
+
+
+typedef struct FLASH_Queue_touch_s
+{
+   unsigned int        id;
+   dim_t               n_blocks;
+   void**              buffers;
+   const size_t*       bytes;
+   const unsigned int* owner;
+#if defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+   pthread_t           pthread_obj;
+#endif
+} FLASH_Queue_touch_t;
+
+
+static void* FLASH_Queue_first_touch_function( void* arg )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_first_touch_function
+
+----------------------------------------------------------------------------*/
+{
+   FLASH_Queue_touch_t* t = ( FLASH_Queue_touch_t* ) arg;
+   dim_t                i;
+
+   FLASH_Queue_bind_thread( t->id );
+
+   for ( i = 0; i < t->n_blocks; i++ )
+      if ( t->owner[i] == t->id )
+         memset( t->buffers[i], 0, t->bytes[i] );
+
+   return NULL;
+}
+
+
+void FLASH_Queue_first_touch( dim_t n_blocks, void* buffers[], const size_t bytes[],
+                              const unsigned int owner[], unsigned int n_threads )
+/*----------------------------------------------------------------------------
+
+   FLASH_Queue_first_touch
+
+   Zeroes block i (bytes[i] bytes at buffers[i]) from thread owner[i] of
+   n_threads.
+
+----------------------------------------------------------------------------*/
+{
+   FLASH_Queue_touch_t* thread;
+   unsigned int         i;
+
+   thread = ( FLASH_Queue_touch_t* ) FLA_malloc( n_threads * sizeof( FLASH_Queue_touch_t ) );
+   for ( i = 0; i < n_threads; i++ )
+   {
+      thread[i].id       = i;
+      thread[i].n_blocks = n_blocks;
+      thread[i].buffers  = buffers;
+      thread[i].bytes    = bytes;
+      thread[i].owner    = owner;
+   }
+
+#if defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+   for ( i = 1; i < n_threads; i++ )
+   {
+      int r_val = pthread_create( &(thread[i].pthread_obj), NULL,
+                                  FLASH_Queue_first_touch_function,
+                                  ( void* ) &thread[i] );
+      FLA_Check_error_code( FLA_Check_pthread_create_result( r_val ) );
+   }
+
+   FLASH_Queue_first_touch_function( ( void* ) &thread[0] );
+
+   for ( i = 1; i < n_threads; i++ )
+   {
+      int r_val = pthread_join( thread[i].pthread_obj, NULL );
+      FLA_Check_error_code( FLA_Check_pthread_join_result( r_val ) );
+   }
+#elif defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_OPENMP
+   #pragma omp parallel for num_threads( n_threads ) schedule( static, 1 )
+   for ( i = 0; i < n_threads; i++ )
+      FLASH_Queue_first_touch_function( ( void* ) &thread[i] );
+#else
+   for ( i = 0; i < n_threads; i++ )
+      FLASH_Queue_first_touch_function( ( void* ) &thread[i] );
+#endif
+
+   FLA_free( thread );
+
+   return;
+}
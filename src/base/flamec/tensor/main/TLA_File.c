@@ -0,0 +1,287 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+//On-disk format of blocked psym tensors (host byte order):
+//
+//  "TLATENS1"                              8 byte magic
+//  version, byte order check, datatype,    uint64 words
+//  order, align, nUniques, nSymGroups
+//  flat_size[order], blk_size[order], blocked_stride[order],
+//  symGroupLens[order], symModes[order]
+//  nUniques x { linIndex, offset, bytes, isPacked }   unique-block table
+//  block data, every block at a multiple of align bytes of the file
+//
+//Unique blocks are listed in the order TLA_next_unique_index visits them,
+//which is the order FLA_Obj_attach_buffer_to_blocked_psym_tensor assigns
+//buffers in, so the data of a mapped file is attached as is (no copies).
+
+#define TLA_FILE_MAGIC      "TLATENS1"
+#define TLA_FILE_VERSION    1
+#define TLA_FILE_BYTE_ORDER 0x0102030405060708ULL
+#define TLA_FILE_NHEADER    7
+#define TLA_FILE_NENTRY     4
+
+//Header words of a file of the given order and number of unique blocks
+static size_t TLA_File_header_words( dim_t order, dim_t nUniques )
+{
+	return TLA_FILE_NHEADER + 5 * (size_t)order + TLA_FILE_NENTRY * (size_t)nUniques;
+}
+
+//Bytes of the unique block at blkIndex (packed if it is a symmetric diagonal
+//block and packed is set)
+static size_t TLA_File_block_bytes( TLA_sym sym, dim_t order, const dim_t blk_size[],
+                                    const dim_t blkIndex[], FLA_Bool packed, size_t elemSize )
+{
+	TLA_sym blkSym;
+
+	if(packed && TLA_sym_of_diagonal_block(sym, blkIndex, &blkSym))
+		return TLA_packed_sym_size(blkSym, blk_size) * elemSize;
+	return FLA_array_product(order, blk_size) * elemSize;
+}
+
+//Writes the blocked (psym) tensor A to path: its metadata, unique-block table
+//and the data of every unique block.  The whole tensor is written, whatever
+//the view A.  Returns FLA_FAILURE if A is not blocked or on I/O errors
+FLA_Error TLA_Obj_write_blocked_psym_tensor( const char* path, FLA_Obj A )
+{
+	dim_t i, u;
+	dim_t order = A.order;
+	dim_t nUniques;
+	dim_t blked_size[FLA_MAX_ORDER];
+	dim_t blk_size[FLA_MAX_ORDER];
+	dim_t curIndex[FLA_MAX_ORDER];
+	FLA_Obj* blks = (FLA_Obj*)FLA_Obj_base_buffer(A);
+	size_t elemSize;
+	size_t offset;
+	size_t nWords;
+	uint64_t* hdr;
+	uint64_t* entry;
+	FLA_Error r = FLA_SUCCESS;
+	FILE* f;
+
+	if(FLA_Obj_elemtype(A) != FLA_TENSOR)
+		return FLA_FAILURE;
+
+	elemSize = (size_t)FLA_Obj_datatype_size(FLA_Obj_datatype(A));
+	memcpy(&(blked_size[0]), &((A.base->size)[0]), order * sizeof(dim_t));
+	memcpy(&(blk_size[0]), &((blks[0].base->size)[0]), order * sizeof(dim_t));
+
+	nUniques = 1;
+	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
+	while(TLA_next_unique_index(A.sym, blked_size, curIndex))
+		nUniques++;
+
+	nWords = TLA_File_header_words(order, nUniques);
+	hdr = (uint64_t*)FLA_malloc(nWords * sizeof(uint64_t));
+	hdr[0] = TLA_FILE_VERSION;
+	hdr[1] = TLA_FILE_BYTE_ORDER;
+	hdr[2] = (uint64_t)FLA_Obj_datatype(A);
+	hdr[3] = order;
+	hdr[4] = TLA_ALIGN_PAGE;
+	hdr[5] = nUniques;
+	hdr[6] = A.sym.nSymGroups;
+	for(i = 0; i < order; i++){
+		hdr[TLA_FILE_NHEADER + i] = (uint64_t)blked_size[i] * blk_size[i];
+		hdr[TLA_FILE_NHEADER + order + i] = blk_size[i];
+		hdr[TLA_FILE_NHEADER + 2*order + i] = (A.base->stride)[i];
+		hdr[TLA_FILE_NHEADER + 3*order + i] = A.sym.symGroupLens[i];
+		hdr[TLA_FILE_NHEADER + 4*order + i] = A.sym.symModes[i];
+	}
+
+	//Unique-block table, blocks laid out page by page after the header
+	entry = &(hdr[TLA_FILE_NHEADER + 5*order]);
+	offset = strlen(TLA_FILE_MAGIC) + nWords * sizeof(uint64_t);
+	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
+	for(u = 0; u < nUniques; u++, entry += TLA_FILE_NENTRY){
+		dim_t linIndex = FLA_TIndex_to_LinIndex(order, A.base->stride, curIndex);
+		FLA_Bool isPacked = (blks[linIndex].base)->isPacked;
+
+		offset = ((offset + TLA_ALIGN_PAGE - 1) / TLA_ALIGN_PAGE) * TLA_ALIGN_PAGE;
+		entry[0] = linIndex;
+		entry[1] = offset;
+		entry[2] = TLA_File_block_bytes(A.sym, order, blk_size, curIndex, isPacked, elemSize);
+		entry[3] = isPacked;
+		offset += entry[2];
+		TLA_next_unique_index(A.sym, blked_size, curIndex);
+	}
+
+	f = fopen(path, "wb");
+	if(f == NULL){
+		FLA_free(hdr);
+		return FLA_FAILURE;
+	}
+	if(fwrite(TLA_FILE_MAGIC, 1, strlen(TLA_FILE_MAGIC), f) != strlen(TLA_FILE_MAGIC) ||
+	   fwrite(hdr, sizeof(uint64_t), nWords, f) != nWords)
+		r = FLA_FAILURE;
+
+	entry = &(hdr[TLA_FILE_NHEADER + 5*order]);
+	for(u = 0; u < nUniques && r == FLA_SUCCESS; u++, entry += TLA_FILE_NENTRY){
+		const void* data = (blks[entry[0]].base)->buffer;
+		if(fseek(f, (long)entry[1], SEEK_SET) != 0 ||
+		   fwrite(data, 1, entry[2], f) != entry[2])
+			r = FLA_FAILURE;
+	}
+	if(fclose(f) != 0)
+		r = FLA_FAILURE;
+
+	FLA_free(hdr);
+	return r;
+}
+
+static FLA_Error TLA_File_unmap_fail( void* map, size_t bytes )
+{
+	munmap(map, bytes);
+	return FLA_FAILURE;
+}
+
+//Maps a file written by TLA_Obj_write_blocked_psym_tensor and attaches the
+//blocks of obj to the data in the mapping (no copies; pages are read on first
+//touch).  With TLA_FILE_MAP_SHARED updates of the blocks go to the file,
+//with TLA_FILE_MAP_PRIVATE they stay in memory.  The mapping is released by
+//FLA_Obj_blocked_psym_tensor_free_buffer.  Returns FLA_FAILURE (obj untouched)
+//if the file cannot be mapped or is not a valid tensor file
+FLA_Error TLA_Obj_read_blocked_psym_tensor( const char* path, dim_t flags, FLA_Obj* obj )
+{
+	dim_t i, u;
+	dim_t order, nUniques;
+	dim_t flat_size[FLA_MAX_ORDER];
+	dim_t blk_size[FLA_MAX_ORDER];
+	dim_t blked_size[FLA_MAX_ORDER];
+	dim_t blocked_stride[FLA_MAX_ORDER];
+	dim_t stride[FLA_MAX_ORDER];
+	dim_t curIndex[FLA_MAX_ORDER];
+	FLA_Datatype datatype;
+	TLA_sym sym;
+	size_t elemSize;
+	size_t nHeader;
+	size_t fileBytes;
+	struct stat st;
+	const uint64_t* hdr;
+	const uint64_t* entry;
+	char* map;
+	int fd;
+	void** dataBuffers;
+	FLA_Obj* blks;
+
+	fd = open(path, (flags == TLA_FILE_MAP_SHARED) ? O_RDWR : O_RDONLY);
+	if(fd < 0)
+		return FLA_FAILURE;
+	if(fstat(fd, &st) != 0 || st.st_size < (off_t)(strlen(TLA_FILE_MAGIC) + TLA_FILE_NHEADER * sizeof(uint64_t))){
+		close(fd);
+		return FLA_FAILURE;
+	}
+	fileBytes = (size_t)st.st_size;
+	map = (char*)mmap(NULL, fileBytes, PROT_READ | PROT_WRITE,
+	                  (flags == TLA_FILE_MAP_SHARED) ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED)
+		return FLA_FAILURE;
+
+	//Header
+	hdr = (const uint64_t*)(map + strlen(TLA_FILE_MAGIC));
+	if(memcmp(map, TLA_FILE_MAGIC, strlen(TLA_FILE_MAGIC)) != 0 ||
+	   hdr[0] != TLA_FILE_VERSION || hdr[1] != TLA_FILE_BYTE_ORDER ||
+	   hdr[3] == 0 || hdr[3] > FLA_MAX_ORDER || hdr[6] == 0 || hdr[6] > hdr[3])
+		return TLA_File_unmap_fail(map, fileBytes);
+
+	datatype = (FLA_Datatype)hdr[2];
+	if(datatype != FLA_INT && datatype != FLA_FLOAT && datatype != FLA_DOUBLE &&
+	   datatype != FLA_COMPLEX && datatype != FLA_DOUBLE_COMPLEX)
+		return TLA_File_unmap_fail(map, fileBytes);
+	order = (dim_t)hdr[3];
+	nUniques = (dim_t)hdr[5];
+	nHeader = strlen(TLA_FILE_MAGIC) + TLA_File_header_words(order, nUniques) * sizeof(uint64_t);
+	if(nUniques == 0 || nHeader > fileBytes)
+		return TLA_File_unmap_fail(map, fileBytes);
+
+	sym.order = order;
+	sym.nSymGroups = (dim_t)hdr[6];
+	for(i = 0; i < order; i++){
+		flat_size[i] = (dim_t)hdr[TLA_FILE_NHEADER + i];
+		blk_size[i] = (dim_t)hdr[TLA_FILE_NHEADER + order + i];
+		blocked_stride[i] = (dim_t)hdr[TLA_FILE_NHEADER + 2*order + i];
+		sym.symGroupLens[i] = (dim_t)hdr[TLA_FILE_NHEADER + 3*order + i];
+		sym.symModes[i] = (dim_t)hdr[TLA_FILE_NHEADER + 4*order + i];
+		if(blk_size[i] == 0 || flat_size[i] % blk_size[i] != 0 || sym.symModes[i] >= order)
+			return TLA_File_unmap_fail(map, fileBytes);
+	}
+	for(i = 0, u = 0; i < sym.nSymGroups; i++)
+		u += sym.symGroupLens[i];
+	if(u != order)
+		return TLA_File_unmap_fail(map, fileBytes);
+	FLA_array_elemwise_quotient(order, flat_size, blk_size, blked_size);
+	FLA_Set_tensor_stride(order, blked_size, stride);
+	elemSize = (size_t)FLA_Obj_datatype_size(datatype);
+
+	//The table must list the unique blocks of sym, in order, inside the file
+	entry = &(hdr[TLA_FILE_NHEADER + 5*order]);
+	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
+	for(u = 0; u < nUniques; u++, entry += TLA_FILE_NENTRY){
+		if(entry[0] != FLA_TIndex_to_LinIndex(order, stride, curIndex) ||
+		   entry[2] != TLA_File_block_bytes(sym, order, blk_size, curIndex, (FLA_Bool)entry[3], elemSize) ||
+		   entry[1] < nHeader || entry[1] > fileBytes || entry[2] > fileBytes - entry[1])
+			return TLA_File_unmap_fail(map, fileBytes);
+		if(TLA_next_unique_index(sym, blked_size, curIndex) != (u + 1 < nUniques))
+			return TLA_File_unmap_fail(map, fileBytes);
+	}
+
+	//Attach the mapped blocks
+	FLA_Obj_create_blocked_psym_tensor_without_buffer(datatype, order, flat_size, blk_size, sym, obj);
+	dataBuffers = (void**)FLA_malloc(nUniques * sizeof(void*));
+	entry = &(hdr[TLA_FILE_NHEADER + 5*order]);
+	for(u = 0; u < nUniques; u++)
+		dataBuffers[u] = map + entry[TLA_FILE_NENTRY*u + 1];
+	FLA_Obj_attach_buffer_to_blocked_psym_tensor(dataBuffers, order, blocked_stride, obj);
+	obj->base->blk_slab = map;
+	obj->base->blk_slab_mapped = fileBytes;
+	obj->base->blk_slab_shared = (flags == TLA_FILE_MAP_SHARED);
+	FLA_free(dataBuffers);
+
+	//Flag the packed blocks
+	blks = (FLA_Obj*)FLA_Obj_base_buffer(*obj);
+	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
+	for(u = 0; u < nUniques; u++, entry += TLA_FILE_NENTRY){
+		FLA_Base_obj* blkBase = blks[entry[0]].base;
+		if(entry[3])
+			blkBase->isPacked = TLA_sym_of_diagonal_block(sym, curIndex, &(blkBase->packed_sym));
+		TLA_next_unique_index(sym, blked_size, curIndex);
+	}
+
+	return FLA_SUCCESS;
+}
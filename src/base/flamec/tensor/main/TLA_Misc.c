@@ -32,10 +32,28 @@
 
 #include "FLAME.h"
 
+//Prints the scalar at buffer according to the datatype of A
+static void FLA_Obj_print_scalar_elem(FLA_Obj A, void* buffer, int precision){
+	switch(FLA_Obj_datatype(A)){
+	case FLA_FLOAT:
+		printf("%.*f", precision, *((float*)buffer));
+		break;
+	case FLA_COMPLEX:
+		printf("%.*f%+.*fi", precision, ((scomplex*)buffer)->real, precision, ((scomplex*)buffer)->imag);
+		break;
+	case FLA_DOUBLE_COMPLEX:
+		printf("%.*f%+.*fi", precision, ((dcomplex*)buffer)->real, precision, ((dcomplex*)buffer)->imag);
+		break;
+	default:
+		printf("%.*f", precision, *((double*)buffer));
+		break;
+	}
+}
+
 FLA_Error FLA_Obj_print_scalar_tensor(FLA_Obj A, dim_t repart_mode_index){
 	FLA_Obj AT, AB;
 	FLA_Obj A0, A1, A2;
-	double* buffer;
+	void* buffer;
 	
 	//View could be under permutation.  Ensure print respects this
 	FLA_Part_1xmode2(A, &AT,
@@ -49,9 +67,9 @@ FLA_Error FLA_Obj_print_scalar_tensor(FLA_Obj A, dim_t repart_mode_index){
 									  AB,   &A2, 
 									  A.permutation[repart_mode_index], 1, FLA_BOTTOM);
 		/************************/
-		buffer = FLA_Obj_tensor_buffer_at_view(A1);
+		buffer = TLA_OBJ_BUFFER_AT_VIEW(A1);
 		if(repart_mode_index == 0){
-			printf("%.3f", *buffer);
+			FLA_Obj_print_scalar_elem(A1, buffer, 3);
 			printf(" ");	
 		}else{
 			FLA_Obj_print_scalar_tensor(A1, repart_mode_index - 1);
@@ -74,7 +92,7 @@ FLA_Error FLA_Obj_print_scalar_tensor_mode_at(FLA_Obj A, dim_t mode, dim_t index
 	FLA_Obj AT, AB;
 	FLA_Obj A0, A1, A2;
 	
-	double* buffer;
+	void* buffer;
 
 	dim_t order = FLA_Obj_order(A);
 	Atmp = A;
@@ -90,8 +108,8 @@ FLA_Error FLA_Obj_print_scalar_tensor_mode_at(FLA_Obj A, dim_t mode, dim_t index
 									  /**/  /**/
 									  AB,   &A2, mode, 1, FLA_BOTTOM);
 		/************************/
-		buffer = FLA_Obj_tensor_buffer_at_view(A1);
-		printf("%.6f", *buffer);
+		buffer = TLA_OBJ_BUFFER_AT_VIEW(A1);
+		FLA_Obj_print_scalar_elem(A1, buffer, 6);
 		printf(" ");
 		/************************/
 		FLA_Cont_with_1xmode3_to_1xmode2(&AT, A0,
@@ -114,7 +132,7 @@ FLA_Error FLA_Obj_print_hier_tensor_loop_scalar_mode(FLA_Obj A, dim_t mode, dim_
         if(FLA_Obj_dimsize(A,i) == 0)
             return FLA_SUCCESS;
 
-    buffer = FLA_Obj_tensor_buffer_at_view(A);
+    buffer = TLA_OBJ_BUFFER_AT_VIEW(A);
 	if(mode == 0){
 		const dim_t* permutation = buffer->permutation;
 		dim_t ipermutation[FLA_MAX_ORDER];
@@ -31,6 +31,7 @@
 */
 
 #include "FLAME.h"
+#include <sys/mman.h>
 
 FLA_Error FLA_Obj_create_tensor( FLA_Datatype datatype, dim_t order, const dim_t size[], const dim_t stride[], FLA_Obj *obj)
 {
@@ -99,6 +100,19 @@ FLA_Error FLA_Obj_create_tensor_ext( FLA_Datatype datatype, FLA_Elemtype elemtyp
   memcpy(&((obj->base->stride)[0]), &(stride[0]), order * sizeof( dim_t ) );
   memset(&((obj->base->index)[0]), 0, order * sizeof( dim_t ) );
   obj->base->n_elem_alloc = size[0] * nSecondDim;
+  obj->base->blk_bases = NULL;
+  obj->base->blk_slab = NULL;
+  obj->base->blk_slab_mapped = 0;
+  obj->base->blk_slab_shared = FALSE;
+  obj->base->blk_unique_map = NULL;
+  obj->base->isPacked = FALSE;
+
+#ifdef FLA_ENABLE_SUPERMATRIX
+  obj->base->n_read_tasks   = 0;
+  obj->base->read_task_head = NULL;
+  obj->base->read_task_tail = NULL;
+  obj->base->write_task     = NULL;
+#endif
 
   //View metadata (permutation & isStored)
   obj->isStored = TRUE;
@@ -134,6 +148,19 @@ FLA_Error FLA_Obj_create_tensor_without_buffer( FLA_Datatype datatype, dim_t ord
     memset(&((obj->base->index)[0]), 0, order * sizeof( dim_t ) );
     memset(&((obj->base->stride)[0]), 0, order * sizeof( dim_t ) );
 	obj->base->n_elem_alloc = size[0] * nSecondDim;
+	obj->base->blk_bases = NULL;
+	obj->base->blk_slab = NULL;
+	obj->base->blk_slab_mapped = 0;
+	obj->base->blk_slab_shared = FALSE;
+	obj->base->blk_unique_map = NULL;
+	obj->base->isPacked = FALSE;
+
+#ifdef FLA_ENABLE_SUPERMATRIX
+	obj->base->n_read_tasks   = 0;
+	obj->base->read_task_head = NULL;
+	obj->base->read_task_tail = NULL;
+	obj->base->write_task     = NULL;
+#endif
 
 	//View metadata (permutation & isStored)
 	obj->isStored = FALSE;
@@ -161,14 +188,55 @@ FLA_Error FLA_Obj_attach_buffer_to_tensor( void *buffer, dim_t order, const dim_
 	return FLA_SUCCESS;
 }
 
+//Frees the unique-block map of a blocked psym tensor (if any)
+static void TLA_Obj_free_unique_map( FLA_Obj *obj )
+{
+	if(obj->base->blk_unique_map == NULL)
+		return;
+	TLA_Unique_map_free(obj->base->blk_unique_map);
+	FLA_free(obj->base->blk_unique_map);
+	obj->base->blk_unique_map = NULL;
+}
+
+//Frees the slab and block bases of a blocked tensor created by one of the
+//FLA_Obj_create_blocked_*tensor routines.  Returns FALSE if the blocks were
+//allocated individually
+static FLA_Bool TLA_Obj_free_blocks( FLA_Obj *obj )
+{
+	dim_t i;
+
+	if(obj->base->blk_bases == NULL)
+		return FALSE;
+
+	if(obj->base->blk_slab_mapped > 0){
+		//Mapped from a file by TLA_Obj_read_blocked_psym_tensor
+		munmap(obj->base->blk_slab, obj->base->blk_slab_mapped);
+		obj->base->blk_slab_mapped = 0;
+		obj->base->blk_slab_shared = FALSE;
+	}else if(obj->base->blk_slab != NULL){
+		free(obj->base->blk_slab);
+	}else{
+		//Buffers were attached one by one
+		for(i = 0; i < FLA_Obj_num_elem_alloc(*obj); i++)
+			FLA_free((obj->base->blk_bases)[i].buffer);
+	}
+	FLA_free(obj->base->blk_bases);
+	obj->base->blk_slab = NULL;
+	TLA_Obj_free_unique_map(obj);
+	obj->base->blk_bases = NULL;
+	return TRUE;
+}
+
 FLA_Error FLA_Obj_blocked_tensor_free_buffer( FLA_Obj *obj)
 {
 	if(FLA_Obj_elemtype(*obj) == FLA_TENSOR || FLA_Obj_elemtype(*obj) == FLA_MATRIX){
 		dim_t i;
 		FLA_Obj* buf = (FLA_Obj*)FLA_Obj_base_buffer(*obj);
-		for(i = 0; i < FLA_Obj_num_elem_alloc(*obj); i++){
-			FLA_Obj_free_buffer(&(buf[i]));
-			FLA_Obj_free_without_buffer(&(buf[i]));
+		if(!TLA_Obj_free_blocks(obj)){
+			for(i = 0; i < FLA_Obj_num_elem_alloc(*obj); i++){
+				FLA_Obj_free_buffer(&(buf[i]));
+				FLA_Obj_free_without_buffer(&(buf[i]));
+			}
 		}
 		FLA_Obj_free_buffer(obj);
 	}
@@ -177,61 +245,122 @@ FLA_Error FLA_Obj_blocked_tensor_free_buffer( FLA_Obj *obj)
 
 FLA_Error FLA_Obj_blocked_psym_tensor_free_buffer( FLA_Obj *obj)
 {
-	dim_t order = FLA_Obj_order(*obj);
-	const dim_t* stride = obj->base->stride;
+	dim_t u;
+	TLA_unique_map* map = obj->base->blk_unique_map;
 	FLA_Obj* buf;
 
-	dim_t update_ptr;
-	const dim_t* endIndex = obj->size;
-	dim_t curIndex[FLA_MAX_ORDER];
-	dim_t linIndex;
+	//Single slab, nothing to walk
+	if(TLA_Obj_free_blocks(obj)){
+		TLA_Obj_free_unique_map(obj);
+		FLA_Obj_free_buffer(obj);
+		return FLA_SUCCESS;
+	}
 
-	//Init obj data
+	//Only the unique blocks own their data
 	buf = (FLA_Obj*)FLA_Obj_base_buffer(*obj);
-
-	//Init loop data
-	update_ptr = order - 1;
-	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
-
-	//Loop over all blocked indices, if block is stored, free it
-	while(TRUE){
-		dim_t i;
-		dim_t isUnique;
-		//For this index, find which block it is
-		linIndex = FLA_TIndex_to_LinIndex(order, curIndex, stride);
-
-		isUnique = buf[linIndex].isStored;
-		if(isUnique){
-			FLA_Obj_free_buffer(&(buf[linIndex]));
-			FLA_Obj_free_without_buffer(&(buf[linIndex]));
-		}
-		
-		//Loop Update
-		curIndex[update_ptr]++;
-		while(update_ptr < order && curIndex[update_ptr] == endIndex[update_ptr]){
-			update_ptr--;
-			if(update_ptr < order)
-				curIndex[update_ptr]++;
+	if(map != NULL){
+		for(u = 0; u < map->nUniques; u++){
+			FLA_Obj_free_buffer(&(buf[map->uniqueLinIndex[u]]));
+			FLA_Obj_free_without_buffer(&(buf[map->uniqueLinIndex[u]]));
 		}
-		if(update_ptr >= order)
-			break;
-		for(i = update_ptr+1; i < order; i++)
-			curIndex[i] = 0;
-		update_ptr = order - 1;
 	}
 
 	//Free alloc'd data
+	TLA_Obj_free_unique_map(obj);
 	FLA_Obj_free_buffer(obj);
 	return FLA_SUCCESS;
 }
 
 
+//Sets up nBlks tensor blocks (without buffers) whose base objects all live in
+//one array, returned in *bases
+static FLA_Error TLA_Obj_create_tensor_blocks( FLA_Datatype datatype, dim_t order, const dim_t blk_size[], dim_t nBlks, FLA_Obj blks[], FLA_Base_obj** bases ){
+    dim_t i;
+    FLA_Obj blk_template;
+
+    FLA_Obj_create_tensor_without_buffer( datatype, order, blk_size, &blk_template );
+
+    *bases = (FLA_Base_obj*)FLA_malloc(nBlks * sizeof(FLA_Base_obj));
+    for(i = 0; i < nBlks; i++){
+        (*bases)[i] = *(blk_template.base);
+        (*bases)[i].id = ( unsigned long ) &((*bases)[i]);
+        blks[i] = blk_template;
+        blks[i].base = &((*bases)[i]);
+    }
+
+    FLA_Obj_free_without_buffer( &blk_template );
+    return FLA_SUCCESS;
+}
+
+//Threads the blocks of shared tensors are placed across by first touch: the
+//FLASH queue threads, as for FLASH matrices (see
+//FLASH_Queue_set_data_affinity), 1 if they are not placed
+static dim_t TLA_Obj_placement_threads( void ){
+#ifdef FLA_ENABLE_MULTITHREADING
+    if(FLASH_Queue_get_data_affinity() != FLASH_QUEUE_AFFINITY_NONE)
+        return FLASH_Queue_get_num_threads();
+#endif
+    return 1;
+}
+
+//Zeroes the stored blocks of obj (buffers[u] holding bytes[u], or blockBytes
+//if bytes is NULL) from the thread owning each one.  A block is located by
+//its index along the first and the last mode and its linear index
+static void TLA_Obj_place_blocks( FLA_Obj obj, void* buffers[], const size_t bytes[], size_t blockBytes ){
+    dim_t u;
+    dim_t order = obj.order;
+    dim_t nThreads = TLA_Obj_placement_threads();
+    TLA_unique_map* map = obj.base->blk_unique_map;
+    dim_t nStored = (map != NULL) ? map->nUniques : FLA_array_product(order, obj.size);
+    dim_t stride[FLA_MAX_ORDER];
+    size_t* sizes = (size_t*)FLA_malloc(nStored * sizeof(size_t));
+    unsigned int* owner = (unsigned int*)FLA_malloc(nStored * sizeof(unsigned int));
+
+    FLA_Set_tensor_stride(order, obj.size, stride);
+    for(u = 0; u < nStored; u++){
+        dim_t lin = (map != NULL) ? map->uniqueLinIndex[u] : u;
+        dim_t row = lin % obj.size[0];
+        dim_t col = (lin / stride[order - 1]) % obj.size[order - 1];
+
+        sizes[u] = (bytes != NULL) ? bytes[u] : blockBytes;
+        owner[u] = FLASH_Queue_affinity_owner(row, col, lin, nThreads);
+    }
+    FLASH_Queue_first_touch(nStored, buffers, sizes, owner, nThreads);
+
+    FLA_free(owner);
+    FLA_free(sizes);
+}
+
+//Allocates a zeroed slab of size bytes aligned to align (at least to
+//FLA_MEMORY_ALIGNMENT_BOUNDARY, if set).  Released with free()
+//Left unzeroed for scratch tensors and if the blocks carved out of it are
+//placed afterwards
+static void* TLA_Obj_create_slab( size_t size, size_t align, FLA_Bool zero ){
+    void* slab = NULL;
+
+#ifdef FLA_ENABLE_MEMORY_ALIGNMENT
+    if(align < FLA_MEMORY_ALIGNMENT_BOUNDARY)
+        align = FLA_MEMORY_ALIGNMENT_BOUNDARY;
+#endif
+    if(align < sizeof(void*))
+        align = sizeof(void*);
+    if(size == 0)
+        size = align;
+
+    if(posix_memalign(&slab, align, size) != 0)
+        FLA_Check_error_code( FLA_MALLOC_RETURNED_NULL_POINTER );
+    if(zero && TLA_Obj_placement_threads() <= 1)
+        memset(slab, 0, size);
+
+    return slab;
+}
+
 //NOTE: This function doesn't set the offset array of the FLA_View
 FLA_Error FLA_Obj_create_blocked_tensor_without_buffer(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blk_size[], FLA_Obj *obj){
-    dim_t i;
     dim_t blked_size[FLA_MAX_ORDER];
     dim_t nTBlks;
     FLA_Obj* t_blks;
+    FLA_Base_obj* t_bases;
     dim_t stride_obj[FLA_MAX_ORDER];
 
     //Determine blocked size of tensor (size of tensor whose elements are the blocks)
@@ -240,15 +369,13 @@ FLA_Error FLA_Obj_create_blocked_tensor_without_buffer(FLA_Datatype datatype, di
 
     //Create the tensor blocks
     t_blks = (FLA_Obj*)FLA_malloc(nTBlks * sizeof(FLA_Obj));
-    for(i = 0; i < nTBlks; i++){
-        FLA_Obj *curObj = &(t_blks[i]);
-        FLA_Obj_create_tensor_without_buffer( datatype, order, blk_size, curObj);
-    }
+    TLA_Obj_create_tensor_blocks( datatype, order, blk_size, nTBlks, t_blks, &t_bases );
 
     //Buffer of tensor blocks created, set the main obj to represent this hierarchy
     //Create object
     FLA_Obj_create_tensor_without_buffer( datatype, order, blked_size, obj );
     obj->base->elemtype = FLA_TENSOR;
+    obj->base->blk_bases = t_bases;
 
     //Attach blocks to object
     FLA_Set_tensor_stride(order, blked_size, stride_obj);
@@ -259,14 +386,10 @@ FLA_Error FLA_Obj_create_blocked_tensor_without_buffer(FLA_Datatype datatype, di
 
 
 FLA_Error FLA_Obj_create_blocked_psym_tensor_without_buffer(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blk_size[], TLA_sym sym, FLA_Obj *obj){
-    dim_t i;
     dim_t blked_size[FLA_MAX_ORDER];
     dim_t nTBlks;
     FLA_Obj* t_blks;
-
-    dim_t curIndex[FLA_MAX_ORDER];
-    dim_t updateIndex;
-    dim_t objLinIndex;
+    FLA_Base_obj* t_bases;
 
     dim_t stride_obj[FLA_MAX_ORDER];
 
@@ -277,45 +400,16 @@ FLA_Error FLA_Obj_create_blocked_psym_tensor_without_buffer(FLA_Datatype datatyp
     FLA_array_elemwise_quotient(order, flat_size, blk_size, blked_size);
     nTBlks = FLA_array_product(order, blked_size);
 
-    //Create the tensor blocks
+    //Create the tensor blocks (offsets are zeroed on creation)
     t_blks = (FLA_Obj*)FLA_malloc(nTBlks * sizeof(FLA_Obj));
-
-    memset(curIndex, 0, order * sizeof(dim_t));
-    updateIndex = 0;
-    objLinIndex = 0;
-
-    //Loop over block-indexes in tensor.  Create blocks and set offsets
-    while(TRUE){
-        //Set up the FLA_Obj at this index
-        FLA_Obj *curObj = &(t_blks[objLinIndex]);
-        FLA_Obj_create_tensor_without_buffer( datatype, order, blk_size, curObj);
-
-        //Set the offset array
-        memset(&((curObj->offset)[0]), 0, order * sizeof(dim_t));
-
-        //Loop update
-        curIndex[updateIndex]++;
-        objLinIndex++;
-        //If we hit the end, loop until we find the index to update
-        while(updateIndex < order && curIndex[updateIndex] == blked_size[updateIndex]){
-            updateIndex++;
-            if(updateIndex < order)
-                curIndex[updateIndex]++;
-        }
-        //If we run off the edge, we know we are at the end, so break out
-        if(updateIndex >= order)
-            break;
-        //Otherwise, update current index, and reset all others
-        for(i = updateIndex - 1; i < order; i--)
-            curIndex[i] = 0;
-        updateIndex = 0;
-    }
+    TLA_Obj_create_tensor_blocks( datatype, order, blk_size, nTBlks, t_blks, &t_bases );
 
     //Buffer of tensor blocks created, set the main obj to represent this hierarchy
     //TODO: See if datatype can be swapped with FLA_TENSOR
     FLA_Obj_create_tensor_without_buffer( datatype, order, blked_size, obj);
     obj->sym = sym;
     obj->base->elemtype = FLA_TENSOR;
+    obj->base->blk_bases = t_bases;
 
 
     FLA_Set_tensor_stride(order, blked_size, stride_obj);
@@ -326,10 +420,16 @@ FLA_Error FLA_Obj_create_blocked_psym_tensor_without_buffer(FLA_Datatype datatyp
 
 
 FLA_Error FLA_Obj_create_blocked_tensor(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], FLA_Obj *obj){
+    return FLA_Obj_create_blocked_tensor_aligned(datatype, order, flat_size, blocked_stride, blk_size, TLA_ALIGN_NONE, obj);
+}
+
+//All blocks are carved from a single slab, zeroed unless zero is FALSE
+static FLA_Error TLA_Obj_create_blocked_tensor_slab(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], dim_t align, FLA_Bool zero, FLA_Obj *obj){
     dim_t i;
     dim_t blked_size[FLA_MAX_ORDER];
     dim_t nBlocks;
-    dim_t nBlockElems;
+    size_t blockBytes;
+    char* slab;
 
     void** dataBuffers;
 
@@ -341,34 +441,59 @@ FLA_Error FLA_Obj_create_blocked_tensor(FLA_Datatype datatype, dim_t order, cons
     FLA_Obj_create_blocked_psym_tensor_without_buffer(datatype, order, flat_size, blk_size, sym, obj);
 
     //Create each block for tensor
-    //NOTE: probably already know how many blocks there are...
     FLA_array_elemwise_quotient(order, flat_size, blk_size, blked_size);
     nBlocks = FLA_array_product(order, blked_size);
-    nBlockElems = FLA_array_product(order, blk_size);
+    blockBytes = FLA_array_product(order, blk_size) * FLA_Obj_datatype_size(datatype);
+    if(align > 0)
+        blockBytes = ((blockBytes + align - 1) / align) * align;
 
-    //Create dataBuffers for each block
+    //Carve dataBuffers for each block out of the slab
+    slab = (char*)TLA_Obj_create_slab(nBlocks * blockBytes, align, zero);
     dataBuffers = (void**) FLA_malloc( nBlocks * sizeof(void*) );
     for (i = 0; i < nBlocks; i++)
-    {
-        dataBuffers[i] = (double*) FLA_malloc( nBlockElems * sizeof(double) );
-        memset( &(((double* )dataBuffers[i])[0]), 0, nBlockElems * sizeof(double) );
-    }
+        dataBuffers[i] = slab + i * blockBytes;
 
     //Attach empty buffers to the tensor blocks
     FLA_Obj_attach_buffer_to_blocked_tensor( dataBuffers, order, blocked_stride,
             obj );
+    obj->base->blk_slab = slab;
+    //Scratch is private to a thread and left for it to touch first
+    if(zero && TLA_Obj_placement_threads() > 1)
+        TLA_Obj_place_blocks(*obj, dataBuffers, NULL, blockBytes);
 
     //Free local arrays
     FLA_free(dataBuffers);
     return FLA_SUCCESS;
 }
 
+//All blocks are carved from a single zeroed slab.  If align is nonzero, each
+//block starts on a multiple of align bytes (e.g. TLA_ALIGN_CACHE_LINE or
+//TLA_ALIGN_PAGE).  Freed (slab, bases and all) by FLA_Obj_blocked_tensor_free_buffer
+FLA_Error FLA_Obj_create_blocked_tensor_aligned(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], dim_t align, FLA_Obj *obj){
+    return TLA_Obj_create_blocked_tensor_slab(datatype, order, flat_size, blocked_stride, blk_size, align, TRUE, obj);
+}
+
+//Like FLA_Obj_create_blocked_tensor, but the blocks are not zeroed.  For
+//temporaries whose every block is overwritten before it is read (a product
+//with a zero alpha, see FLA_Ttm_single_mode).  They are not placed across
+//threads either: the first thread to write a block places it
+FLA_Error TLA_Obj_create_blocked_tensor_scratch(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], FLA_Obj *obj){
+    return TLA_Obj_create_blocked_tensor_slab(datatype, order, flat_size, blocked_stride, blk_size, TLA_ALIGN_NONE, FALSE, obj);
+}
+
 FLA_Error FLA_Obj_create_blocked_psym_tensor(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], TLA_sym sym, FLA_Obj *obj){
+	return FLA_Obj_create_blocked_psym_tensor_aligned(datatype, order, flat_size, blocked_stride, blk_size, sym, TLA_ALIGN_NONE, obj);
+}
+
+//Only the unique blocks are stored, carved from a single slab (zeroed unless
+//zero is FALSE)
+static FLA_Error TLA_Obj_create_blocked_psym_tensor_slab(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], TLA_sym sym, dim_t align, FLA_Bool zero, FLA_Obj *obj){
 	dim_t i;
-	dim_t nBlockElems;
+	size_t blockBytes;
 	dim_t blked_size[FLA_MAX_ORDER];
 	dim_t nUniques = 1;
 	dim_t modeOffset = 0;
+	char* slab;
 
 	void** dataBuffers;
 
@@ -376,7 +501,9 @@ FLA_Error FLA_Obj_create_blocked_psym_tensor(FLA_Datatype datatype, dim_t order,
 	FLA_Obj_create_blocked_psym_tensor_without_buffer(datatype, order, flat_size, blk_size, sym, obj);
 	
 	//Set up the data buffers for psym tensor
-	nBlockElems = FLA_array_product(order, blk_size);
+	blockBytes = FLA_array_product(order, blk_size) * FLA_Obj_datatype_size(datatype);
+	if(align > 0)
+		blockBytes = ((blockBytes + align - 1) / align) * align;
 
 	//Determine number of unique blocks in tensor
 	FLA_array_elemwise_quotient(order, flat_size, blk_size, blked_size);
@@ -390,21 +517,113 @@ FLA_Error FLA_Obj_create_blocked_psym_tensor(FLA_Datatype datatype, dim_t order,
 		modeOffset += symGroupLen;
 	}
 
-	//Create data arrays for each block
+	//Carve data arrays for each block out of the slab
+	slab = (char*)TLA_Obj_create_slab(nUniques * blockBytes, align, zero);
 	dataBuffers = (void**)FLA_malloc(nUniques * sizeof(void*));
-	for(i = 0; i < nUniques; i++){
-		dataBuffers[i] = (double*)FLA_malloc(nBlockElems * sizeof(double));
-		memset(&(((double*)dataBuffers[i])[0]), 0, nBlockElems * sizeof(double));
-	}
+	for(i = 0; i < nUniques; i++)
+		dataBuffers[i] = slab + i * blockBytes;
 
 	//Attach empty buffers to the sym tensor
 	FLA_Obj_attach_buffer_to_blocked_psym_tensor(dataBuffers, order, blocked_stride, obj);
+	obj->base->blk_slab = slab;
+	//Scratch is private to a thread and left for it to touch first
+	if(zero && TLA_Obj_placement_threads() > 1)
+		TLA_Obj_place_blocks(*obj, dataBuffers, NULL, blockBytes);
 
 	//Free local data
 	FLA_free(dataBuffers);
 	return FLA_SUCCESS;
 }
 
+//Only the unique blocks are stored, carved from a single zeroed slab (see
+//FLA_Obj_create_blocked_tensor_aligned)
+FLA_Error FLA_Obj_create_blocked_psym_tensor_aligned(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], TLA_sym sym, dim_t align, FLA_Obj *obj){
+	return TLA_Obj_create_blocked_psym_tensor_slab(datatype, order, flat_size, blocked_stride, blk_size, sym, align, TRUE, obj);
+}
+
+//FLA_Obj_create_blocked_psym_tensor with unzeroed blocks (see
+//TLA_Obj_create_blocked_tensor_scratch)
+FLA_Error TLA_Obj_create_blocked_psym_tensor_scratch(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], TLA_sym sym, FLA_Obj *obj){
+	return TLA_Obj_create_blocked_psym_tensor_slab(datatype, order, flat_size, blocked_stride, blk_size, sym, TLA_ALIGN_NONE, FALSE, obj);
+}
+
+
+//Like FLA_Obj_create_blocked_psym_tensor, but unique blocks on a symmetric
+//diagonal (modes of a sym group at the same block index) only store their
+//unique entries (see TLA_Pack_sym_block).  Such blocks are flagged isPacked
+//and can only be read by FLA_Psttv/FLA_Psttm or expanded with
+//FLA_Obj_unpack_blocked_psym_tensor.
+FLA_Error FLA_Obj_create_blocked_psym_tensor_packed(FLA_Datatype datatype, dim_t order, const dim_t flat_size[], const dim_t blocked_stride[], const dim_t blk_size[], TLA_sym sym, FLA_Obj *obj){
+	dim_t i, u;
+	dim_t elemSize = FLA_Obj_datatype_size(datatype);
+	dim_t denseBytes;
+	size_t slabBytes;
+	dim_t blked_size[FLA_MAX_ORDER];
+	dim_t curIndex[FLA_MAX_ORDER];
+	dim_t nUniques;
+	char* slab;
+	TLA_unique_map* map;
+	FLA_Obj* buffer_obj;
+
+	void** dataBuffers;
+	size_t* blockBytes;
+
+	FLA_Obj_create_blocked_psym_tensor_without_buffer(datatype, order, flat_size, blk_size, sym, obj);
+	FLA_array_elemwise_quotient(order, flat_size, blk_size, blked_size);
+	denseBytes = FLA_array_product(order, blk_size) * elemSize;
+
+	nUniques = 1;
+	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
+	while(TLA_next_unique_index(obj->sym, blked_size, curIndex))
+		nUniques++;
+
+	//Size every unique block (visited in the order attach assigns buffers)
+	blockBytes = (size_t*)FLA_malloc(nUniques * sizeof(size_t));
+	slabBytes = 0;
+	u = 0;
+	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
+	do{
+		TLA_sym blkSym;
+		if(TLA_sym_of_diagonal_block(obj->sym, curIndex, &blkSym))
+			blockBytes[u] = TLA_packed_sym_size(blkSym, blk_size) * elemSize;
+		else
+			blockBytes[u] = denseBytes;
+#ifdef FLA_ENABLE_MEMORY_ALIGNMENT
+		//Keep every block aligned for the vector kernels
+		blockBytes[u] = ((blockBytes[u] + FLA_MEMORY_ALIGNMENT_BOUNDARY - 1) / FLA_MEMORY_ALIGNMENT_BOUNDARY) * FLA_MEMORY_ALIGNMENT_BOUNDARY;
+#endif
+		slabBytes += blockBytes[u];
+		u++;
+	}while(TLA_next_unique_index(obj->sym, blked_size, curIndex));
+
+	slab = (char*)TLA_Obj_create_slab(slabBytes, TLA_ALIGN_NONE, TRUE);
+	dataBuffers = (void**)FLA_malloc(nUniques * sizeof(void*));
+	slabBytes = 0;
+	for(i = 0; i < nUniques; i++){
+		dataBuffers[i] = slab + slabBytes;
+		slabBytes += blockBytes[i];
+	}
+
+	FLA_Obj_attach_buffer_to_blocked_psym_tensor(dataBuffers, order, blocked_stride, obj);
+	obj->base->blk_slab = slab;
+	if(TLA_Obj_placement_threads() > 1)
+		TLA_Obj_place_blocks(*obj, dataBuffers, blockBytes, 0);
+
+	//Flag the packed blocks
+	map = obj->base->blk_unique_map;
+	buffer_obj = (FLA_Obj*)FLA_Obj_base_buffer(*obj);
+	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
+	for(u = 0; u < map->nUniques; u++){
+		FLA_Base_obj* blkBase = buffer_obj[map->uniqueLinIndex[u]].base;
+		blkBase->isPacked = TLA_sym_of_diagonal_block(obj->sym, curIndex, &(blkBase->packed_sym));
+		TLA_next_unique_index(obj->sym, blked_size, curIndex);
+	}
+
+	FLA_free(blockBytes);
+	FLA_free(dataBuffers);
+	return FLA_SUCCESS;
+}
+
 
 FLA_Error FLA_Obj_attach_buffer_to_blocked_tensor( void *buffer[], dim_t order, const dim_t stride[], FLA_Obj *obj ){
     dim_t i, j;
@@ -435,86 +654,53 @@ FLA_Error FLA_Obj_attach_buffer_to_blocked_tensor( void *buffer[], dim_t order,
     return FLA_SUCCESS;
 }
 
+//Unique blocks receive the buffers in the order TLA_next_unique_index visits
+//them, every other block shares the base of its representative.  The map
+//built here is kept with the tensor so no block index is ever sorted again
 FLA_Error FLA_Obj_attach_buffer_to_blocked_psym_tensor( void *buffer[], dim_t order, const dim_t stride[], FLA_Obj *obj ){
-	dim_t i;
+	dim_t i, j;
 	//FLA_Obj-related data
     const dim_t* size_obj = obj->size;
     const dim_t* stride_obj = obj->base->stride;
 	FLA_Obj *buffer_obj;
-
-	//Loop-related data
-	dim_t updateIndex;
-	dim_t curIndex[FLA_MAX_ORDER];
-
-	//Attach buffer-related data
-	dim_t countBuffer;
-	dim_t objLinIndex;
-	dim_t sortedIndex[FLA_MAX_ORDER];
-	dim_t permutation[FLA_MAX_ORDER];
-	dim_t ipermutation[FLA_MAX_ORDER];
-	dim_t isUniqueIndex;
+	TLA_unique_map* map;
 
 	//Set needed info of obj
     buffer_obj = (FLA_Obj*)FLA_Obj_base_buffer(*obj);
 
-    //Initialize loop information
-	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
-	countBuffer = 0;
-	objLinIndex = 0;
-
-	//Loop over indices
-	//If we hit a unique, set its buffer to the next block in the list
-	//Otherwise, find the unique index and point buffer to unique buffer (adjusting strides)
-	updateIndex = order - 1;
-	while(TRUE){
-		objLinIndex = FLA_TIndex_to_LinIndex(order, stride_obj, curIndex);
-
-		//For this index, get the needed unique-index information
-		isUniqueIndex = FLA_get_unique_info(obj->sym, curIndex, sortedIndex, permutation, ipermutation);
-		
-		if(isUniqueIndex){
-			//Index is unique:
-			//Attach block, update metadata (stride, permutation, & isStored
-			(buffer_obj[objLinIndex].base)->buffer = buffer[countBuffer];
-			FLA_Set_tensor_stride(order, (buffer_obj[objLinIndex].base)->size, (buffer_obj[objLinIndex].base)->stride);
-
-			for(i = 0; i < order; i++)
-			    ((buffer_obj[objLinIndex]).permutation)[i] = i;
-			(buffer_obj[objLinIndex]).isStored = TRUE;
-			//Ensure next unique index uses next block
-			countBuffer++;
-		}else{
-			//Index is non-unique:
-			//Find unique linear index, point buffer to unique linear index
-			//Adjust meta-data (permutation & isStored)
-			dim_t uniqueLinIndex;
-			uniqueLinIndex = FLA_TIndex_to_LinIndex(order, stride_obj, sortedIndex);
-
-			//point this non-unique FLA_Obj to the correct base
-			//WARNING: HACK
-			FLA_free(buffer_obj[objLinIndex].base);
-			(buffer_obj[objLinIndex]).base = (buffer_obj[uniqueLinIndex]).base;
-
-			memcpy(&(((buffer_obj[objLinIndex]).permutation)[0]), &(ipermutation[0]), order * sizeof(dim_t));
-			(buffer_obj[objLinIndex]).isStored = FALSE;
-		}
+	TLA_Obj_free_unique_map(obj);
+	map = (TLA_unique_map*)FLA_malloc(sizeof(TLA_unique_map));
+	TLA_Unique_map_create(obj->sym, size_obj, stride_obj, map);
 
-		//Loop update
-		curIndex[updateIndex]++;
-		//If we hit the end, loop until we find the index to update
-		while(updateIndex < order && curIndex[updateIndex] == size_obj[updateIndex]){
-			updateIndex--;
-			if(updateIndex < order)
-				curIndex[updateIndex]++;
-		}
-		//If we run off the edge, we know we are at the end, so break out
-		if(updateIndex >= order)
-			break;
-		//Otherwise, update current index, and reset all others
-		for(i = updateIndex+1; i < order; i++)
-			curIndex[i] = 0;
-		updateIndex = order - 1;
+	//Unique blocks: attach block, update metadata (stride, permutation, & isStored)
+	for(i = 0; i < map->nUniques; i++){
+		FLA_Obj* blk = &(buffer_obj[map->uniqueLinIndex[i]]);
+
+		(blk->base)->buffer = buffer[i];
+		FLA_Set_tensor_stride(order, (blk->base)->size, (blk->base)->stride);
+		for(j = 0; j < order; j++)
+			(blk->permutation)[j] = j;
+		blk->isStored = TRUE;
+	}
+
+	//Non-unique blocks: point to the unique base, adjust permutation & isStored
+	for(i = 0; i < map->nBlocks; i++){
+		dim_t uniqueLinIndex = map->uniqueLinIndex[map->repOf[i]];
+		const unsigned char* perm = &(map->perm[i * order]);
+
+		if(uniqueLinIndex == i)
+			continue;
+
+		//WARNING: HACK
+		if(obj->base->blk_bases == NULL)
+			FLA_free(buffer_obj[i].base);
+		(buffer_obj[i]).base = (buffer_obj[uniqueLinIndex]).base;
+
+		for(j = 0; j < order; j++)
+			((buffer_obj[i]).permutation)[j] = perm[j];
+		(buffer_obj[i]).isStored = FALSE;
 	}
+	obj->base->blk_unique_map = map;
 
 	//Omitting some things attach_buffer does because not sure how to extend yet
 	//obj->base->buffer = buffer;
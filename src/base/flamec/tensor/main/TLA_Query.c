@@ -102,49 +102,47 @@ dim_t FLA_Obj_base_dimsize( FLA_Obj obj, dim_t mode )
 }
 
 
-void* FLA_Obj_tensor_buffer_at_view( FLA_Obj obj )
+//Offset, in elements of its base, of the first element of the view obj
+size_t TLA_Obj_view_offset( const FLA_Obj* obj )
 {
 	dim_t i;
-	dim_t order;
-	char*  buffer;
-	size_t elem_size;
-	dim_t* offset;
-	dim_t* stride;
-	size_t byte_offset;
-	
+	const dim_t* offset = obj->offset;
+	const dim_t* stride = obj->base->stride;
+	size_t elem_offset = 0;
+
+	for(i = 0; i < obj->order; i++)
+		elem_offset += offset[i] * stride[i];
+
+	return elem_offset;
+}
+
+
+void* FLA_Obj_tensor_buffer_at_view( FLA_Obj obj )
+{
 //	if ( FLA_Check_error_level() >= FLA_MIN_ERROR_CHECKING )
 //		FLA_Obj_buffer_at_view_check( obj );
-	
-	order	    = FLA_Obj_order( obj ); 
-	elem_size   = ( size_t ) FLA_Obj_elem_size( obj );
-	stride      = ( dim_t* ) FLA_Obj_stride( obj );
-	offset      = ( dim_t* ) FLA_Obj_offset( obj );
-	
-	byte_offset = 0;
 
-	for(i = 0; i < order; i++)
-		byte_offset += offset[i] * stride[i];
+	return TLA_OBJ_BUFFER_AT_VIEW( obj );
+}
 
-	byte_offset *= elem_size;
-	
-	buffer      = ( char * ) (obj.base)->buffer;
-	
-	FLA_free(stride);
-	FLA_free(offset);
-	
-	return ( void* ) ( buffer + byte_offset );
+
+//Block -> unique block map of a blocked psym tensor (NULL if none was built)
+TLA_unique_map* FLA_Obj_unique_map( FLA_Obj obj )
+{
+	return (obj.base)->blk_unique_map;
 }
 
 
 dim_t* FLA_Obj_base_scalar_size(FLA_Obj A){
 	FLA_Elemtype elemtype = FLA_Obj_elemtype(A);
 	dim_t order = FLA_Obj_order(A);
-	dim_t* size = FLA_malloc(order * sizeof(dim_t));
+	dim_t* size;
 	dim_t i;
 	
 	if(elemtype == FLA_SCALAR){
 		return FLA_Obj_base_size(A);
 	}else{
+		size = FLA_malloc(order * sizeof(dim_t));
 		for(i = 0; i < order; i++)
 			size[i] = FLA_Obj_base_scalar_dimsize(A, i);
 		return size;
@@ -32,6 +32,18 @@
 
 #include "FLAME.h"
 
+//dst[0..order) := src[0..order), with a fixed-size copy for orders 2-6
+#define TLA_COPY_DIMS_DEF( name, ORDER ) \
+static void name( dim_t order_, dim_t* dst, const dim_t* src ) \
+{ \
+    memcpy(dst, src, (ORDER) * sizeof(dim_t)); \
+}
+
+TLA_ORDER_INSTANTIATE( TLA_COPY_DIMS_DEF, TLA_copy_dims )
+
+#define TLA_COPY_DIMS( order, dst, src ) \
+  TLA_ORDER_DISPATCH( order, TLA_copy_dims, ( order, dst, src ) )
+
 //
 // --- FLA_Part_2powm() --------------------------------------------------------
 //
@@ -64,8 +76,8 @@ FLA_Error FLA_Part_2powm( FLA_Obj A, FLA_Obj* Apart[],
         Apart[i]->order = A.order;
         Apart[i]->base = A.base;
 
-        memcpy(&(((Apart[i])->offset)[0]), &(A.offset[0]), A.order * sizeof(dim_t));
-        memcpy(&(((Apart[i])->size)[0]), &(A.size[0]), A.order * sizeof(dim_t));
+        TLA_COPY_DIMS(A.order, &(((Apart[i])->offset)[0]), &(A.offset[0]));
+        TLA_COPY_DIMS(A.order, &(((Apart[i])->size)[0]), &(A.size[0]));
     }
 
     for(i = 0; i < nModes_part; i++){
@@ -89,7 +101,7 @@ FLA_Error FLA_Part_2powm( FLA_Obj A, FLA_Obj* Apart[],
 
     //All regions need to update the symmetry of the objects
     for(i = 0; i < num_part; i++){
-        memcpy(&(((Apart[i])->permutation)[0]), &(A.permutation[0]), FLA_Obj_order(A) * sizeof(dim_t));
+        TLA_COPY_DIMS(A.order, &(((Apart[i])->permutation)[0]), &(A.permutation[0]));
         TLA_update_sym_based_offset(A.sym, Apart[i]);
     }
 
@@ -117,20 +129,20 @@ FLA_Error FLA_Part_1xmode2( FLA_Obj A,  FLA_Obj *A1,
 
   //Adjust A1 (order, size, base, & permutation)
   A1->order = A.order;
-  memcpy(&((A1->size)[0]), &(A.size[0]), A.order * sizeof(dim_t));
+  TLA_COPY_DIMS(A.order, &((A1->size)[0]), &(A.size[0]));
   (A1->size)[mode] = b;
-  memcpy(&((A1->offset)[0]), &(A.offset[0]), A.order * sizeof(dim_t));
+  TLA_COPY_DIMS(A.order, &((A1->offset)[0]), &(A.offset[0]));
   A1->base = A.base;
-  memcpy(&((A1->permutation)[0]), &(A.permutation[0]), A.order * sizeof(dim_t));
+  TLA_COPY_DIMS(A.order, &((A1->permutation)[0]), &(A.permutation[0]));
 
   //Adjust A2 (order, size, base, & permutation)
   A2->order = A.order;
-  memcpy(&((A2->size)[0]), &(A.size[0]), A.order * sizeof(dim_t));
+  TLA_COPY_DIMS(A.order, &((A2->size)[0]), &(A.size[0]));
   (A2->size)[mode] = A.size[mode] - b;
-  memcpy(&((A2->offset)[0]), &(A.offset[0]), A.order * sizeof(dim_t));
+  TLA_COPY_DIMS(A.order, &((A2->offset)[0]), &(A.offset[0]));
   (A2->offset)[mode] += b;
   A2->base = A.base;
-  memcpy(&((A2->permutation)[0]), &(A.permutation[0]), A.order * sizeof(dim_t));
+  TLA_COPY_DIMS(A.order, &((A2->permutation)[0]), &(A.permutation[0]));
 
   //Update symmetries
 
@@ -163,6 +175,7 @@ FLA_Error FLA_Repart_2powm_to_3powm( FLA_Obj* Apart[], FLA_Obj* Arepart[],
 {
     dim_t i, j, k;
     dim_t nReparts = 1;
+    dim_t part_base_store[TLA_PART_STACK_NREPART];
     dim_t* part_base;
 
     dim_t part_mode_stride;
@@ -170,7 +183,8 @@ FLA_Error FLA_Repart_2powm_to_3powm( FLA_Obj* Apart[], FLA_Obj* Arepart[],
     for(i = 0; i < nModes_repart; i++)
         nReparts *= 3;
 
-    part_base = (dim_t*)FLA_malloc(nReparts * sizeof(dim_t));
+    part_base = (nReparts <= TLA_PART_STACK_NREPART) ? part_base_store :
+                (dim_t*)FLA_malloc(nReparts * sizeof(dim_t));
     memset(&(part_base[0]), 0, nReparts * sizeof(dim_t));
 
     part_mode_stride = 1;
@@ -191,10 +205,10 @@ FLA_Error FLA_Repart_2powm_to_3powm( FLA_Obj* Apart[], FLA_Obj* Arepart[],
         Arepart[i]->order = Apart[part_base[i]]->order;
         Arepart[i]->base = Apart[part_base[i]]->base;
 		Arepart[i]->sym = Apart[part_base[i]]->sym;
-        memcpy(&((Arepart[i]->permutation)[0]), &((Apart[part_base[i]]->permutation)[0]), (Apart[part_base[i]]->order) * sizeof(dim_t));
+        TLA_COPY_DIMS(Apart[part_base[i]]->order, &((Arepart[i]->permutation)[0]), &((Apart[part_base[i]]->permutation)[0]));
         //Very well could be wrong
-        memcpy(&((Arepart[i]->size)[0]), &((Apart[part_base[i]]->size)[0]), (Apart[part_base[i]]->order) * sizeof(dim_t));
-        memcpy(&((Arepart[i]->offset)[0]), &((Apart[part_base[i]]->offset)[0]), (Apart[part_base[i]]->order) * sizeof(dim_t));
+        TLA_COPY_DIMS(Apart[part_base[i]]->order, &((Arepart[i]->size)[0]), &((Apart[part_base[i]]->size)[0]));
+        TLA_COPY_DIMS(Apart[part_base[i]]->order, &((Arepart[i]->offset)[0]), &((Apart[part_base[i]]->offset)[0]));
     }
 
     //Update size and offset arrays
@@ -220,7 +234,8 @@ FLA_Error FLA_Repart_2powm_to_3powm( FLA_Obj* Apart[], FLA_Obj* Arepart[],
         TLA_update_sym_based_offset(Arepart[i]->sym, Arepart[i]);
     }
 
-    FLA_free(part_base);
+    if(part_base != part_base_store)
+        FLA_free(part_base);
     return FLA_SUCCESS;
 }
 
@@ -247,9 +262,9 @@ FLA_Error FLA_Repart_1xmode2_to_1xmode3( FLA_Obj AT,   FLA_Obj *A0,
                               A1,    mode, b, FLA_BOTTOM );
 
     A2->order = AB.order;
-    memcpy(&((A2->size)[0]), &(AB.size[0]), AB.order * sizeof(dim_t));
-    memcpy(&((A2->offset)[0]), &(AB.offset[0]), AB.order * sizeof(dim_t));
-	memcpy(&((A2->permutation)[0]), &(AB.permutation[0]), AB.order * sizeof(dim_t));
+    TLA_COPY_DIMS(AB.order, &((A2->size)[0]), &(AB.size[0]));
+    TLA_COPY_DIMS(AB.order, &((A2->offset)[0]), &(AB.offset[0]));
+	TLA_COPY_DIMS(AB.order, &((A2->permutation)[0]), &(AB.permutation[0]));
     A2->base = AB.base;
 
     A2->sym = AB.sym;
@@ -257,9 +272,9 @@ FLA_Error FLA_Repart_1xmode2_to_1xmode3( FLA_Obj AT,   FLA_Obj *A0,
   else
   {
     A0->order = AT.order;
-    memcpy(&((A0->size)[0]), &(AT.size[0]), AT.order * sizeof(dim_t));
-    memcpy(&((A0->offset)[0]), &(AT.offset[0]), AT.order * sizeof(dim_t));
-	memcpy(&((A0->permutation)[0]), &(AT.permutation[0]), AT.order * sizeof(dim_t));
+    TLA_COPY_DIMS(AT.order, &((A0->size)[0]), &(AT.size[0]));
+    TLA_COPY_DIMS(AT.order, &((A0->offset)[0]), &(AT.offset[0]));
+	TLA_COPY_DIMS(AT.order, &((A0->permutation)[0]), &(AT.permutation[0]));
     A0->base = AT.base;
 
     A0->sym = AT.sym;
@@ -293,8 +308,10 @@ FLA_Error FLA_Cont_with_3powm_to_2powm( FLA_Obj* Apart[], FLA_Obj * Arepart[],
     dim_t part_mode_stride = 1;
     dim_t repart_mode_stride = 1;
 
-    dim_t* repart_base = (dim_t*)FLA_malloc(num_part * sizeof(dim_t));
-    dim_t* repart_update = (dim_t*)FLA_malloc(num_part * sizeof(dim_t));
+    dim_t repart_store[2 * TLA_PART_STACK_NPART];
+    FLA_Bool onStack = (num_part <= TLA_PART_STACK_NPART);
+    dim_t* repart_base = onStack ? &(repart_store[0]) : (dim_t*)FLA_malloc(num_part * sizeof(dim_t));
+    dim_t* repart_update = onStack ? &(repart_store[num_part]) : (dim_t*)FLA_malloc(num_part * sizeof(dim_t));
 
     for(i = 0; i < nModes_cont_with; i++)
         num_repart *= 3;
@@ -320,8 +337,8 @@ FLA_Error FLA_Cont_with_3powm_to_2powm( FLA_Obj* Apart[], FLA_Obj * Arepart[],
         Apart[i]->order = Arepart[repart_base[i]]->order;
         Apart[i]->sym = Arepart[repart_base[i]]->sym;
         Apart[i]->base = Arepart[repart_base[i]]->base;
-        memcpy(&((Apart[i]->permutation)[0]), &((Arepart[repart_base[i]]->permutation)[0]), (Arepart[repart_base[i]]->order) * sizeof(dim_t));
-        memcpy(&((Apart[i]->offset)[0]), &((Arepart[repart_base[i]]->offset)[0]), (Arepart[repart_base[i]]->order) * sizeof(dim_t));
+        TLA_COPY_DIMS(Arepart[repart_base[i]]->order, &((Apart[i]->permutation)[0]), &((Arepart[repart_base[i]]->permutation)[0]));
+        TLA_COPY_DIMS(Arepart[repart_base[i]]->order, &((Apart[i]->offset)[0]), &((Arepart[repart_base[i]]->offset)[0]));
         for(j = 0; j < nModes_cont_with; j++){
             (Apart[i]->size)[cont_with_modes[j]] = (Arepart[repart_base[i]]->size)[cont_with_modes[j]];
         }
@@ -337,8 +354,10 @@ FLA_Error FLA_Cont_with_3powm_to_2powm( FLA_Obj* Apart[], FLA_Obj * Arepart[],
         part_mode_stride *= 2;
     }
 
-    FLA_free(repart_base);
-    FLA_free(repart_update);
+    if(!onStack){
+        FLA_free(repart_base);
+        FLA_free(repart_update);
+    }
 
     return FLA_SUCCESS;
 }
@@ -361,36 +380,32 @@ FLA_Error FLA_Cont_with_1xmode3_to_1xmode2( FLA_Obj *AT,  FLA_Obj A0,
 
 	if (side == FLA_TOP) {
 		AT->order = A0.order;
-		memcpy(&((AT->size)[0]), &(A0.size[0]), A0.order * sizeof(dim_t));
+		TLA_COPY_DIMS(A0.order, &((AT->size)[0]), &(A0.size[0]));
 		AT->size[mode] += A1.size[mode];
-		memcpy(&((AT->offset)[0]), &(A0.offset[0]), A0.order * sizeof(dim_t));
+		TLA_COPY_DIMS(A0.order, &((AT->offset)[0]), &(A0.offset[0]));
 		AT->base = A0.base;
-		memcpy(&((AT->permutation)[0]), &(A0.permutation[0]),
-				A0.order * sizeof(dim_t));
+		TLA_COPY_DIMS(A0.order, &((AT->permutation)[0]), &(A0.permutation[0]));
 
 		AB->order = A2.order;
-		memcpy(&((AB->size)[0]), &(A2.size[0]), A2.order * sizeof(dim_t));
-		memcpy(&((AB->offset)[0]), &(A2.offset[0]), A2.order * sizeof(dim_t));
+		TLA_COPY_DIMS(A2.order, &((AB->size)[0]), &(A2.size[0]));
+		TLA_COPY_DIMS(A2.order, &((AB->offset)[0]), &(A2.offset[0]));
 		AB->base = A2.base;
-		memcpy(&((AB->permutation)[0]), &(A2.permutation[0]),
-				A2.order * sizeof(dim_t));
+		TLA_COPY_DIMS(A2.order, &((AB->permutation)[0]), &(A2.permutation[0]));
 
 		AB->sym = A2.sym;
 	} else {
 		AT->order = A0.order;
-		memcpy(&((AT->size)[0]), &(A0.size[0]), A0.order * sizeof(dim_t));
-		memcpy(&((AT->offset)[0]), &(A0.offset[0]), A0.order * sizeof(dim_t));
+		TLA_COPY_DIMS(A0.order, &((AT->size)[0]), &(A0.size[0]));
+		TLA_COPY_DIMS(A0.order, &((AT->offset)[0]), &(A0.offset[0]));
 		AT->base = A0.base;
-		memcpy(&((AT->permutation)[0]), &(A0.permutation[0]),
-				A0.order * sizeof(dim_t));
+		TLA_COPY_DIMS(A0.order, &((AT->permutation)[0]), &(A0.permutation[0]));
 
 		AB->order = A1.order;
-		memcpy(&((AB->size)[0]), &(A1.size[0]), A1.order * sizeof(dim_t));
+		TLA_COPY_DIMS(A1.order, &((AB->size)[0]), &(A1.size[0]));
 		AB->size[mode] += A2.size[mode];
-		memcpy(&((AB->offset)[0]), &(A1.offset[0]), A1.order * sizeof(dim_t));
+		TLA_COPY_DIMS(A1.order, &((AB->offset)[0]), &(A1.offset[0]));
 		AB->base = A1.base;
-		memcpy(&((AB->permutation)[0]), &(A1.permutation[0]),
-				A1.order * sizeof(dim_t));
+		TLA_COPY_DIMS(A1.order, &((AB->permutation)[0]), &(A1.permutation[0]));
 
 		AB->sym = A1.sym;
 	}
@@ -410,11 +425,11 @@ FLA_Error FLA_Merge_1xmode2( FLA_Obj AT,
                          AB,   A, mode );
 
   A->order = AT.order;
-  memcpy(&((A->size)[0]), &(AT.size[0]), AT.order * sizeof(dim_t));
+  TLA_COPY_DIMS(AT.order, &((A->size)[0]), &(AT.size[0]));
   (A->size)[mode] += AB.size[mode];
-  memcpy(&((A->offset)[0]), &(AT.offset[0]), AT.order * sizeof(dim_t));
+  TLA_COPY_DIMS(AT.order, &((A->offset)[0]), &(AT.offset[0]));
   A->base = AT.base;
-  memcpy(&((A->permutation)[0]), &(AT.permutation[0]), AT.order * sizeof(dim_t));
+  TLA_COPY_DIMS(AT.order, &((A->permutation)[0]), &(AT.permutation[0]));
 
   return FLA_SUCCESS;
 }
@@ -432,14 +447,14 @@ FLA_Error FLA_Merge_2powm(FLA_Obj* Apart[], FLA_Obj* A,
     dim_t stride = 1;
 
     A->order = Apart[0]->order;
-    memcpy(&((A->size)[0]), &(((Apart[0])->size)[0]), ((Apart[0])->order) * sizeof(dim_t));
+    TLA_COPY_DIMS(((Apart[0])->order), &((A->size)[0]), &(((Apart[0])->size)[0]));
     for(i = 0; i < nModes_merge; i++){
         (A->size)[merge_modes[i]] = ((Apart[0])->size)[merge_modes[i]] + ((Apart[stride])->size)[merge_modes[i]];
         stride *= 2;
     }
 
-    memcpy(&((A->offset)[0]), &(((Apart[0])->offset)[0]), ((Apart[0])->order) * sizeof(dim_t));
-    memcpy(&((A->permutation)[0]), &(((Apart[0])->permutation)[0]), ((Apart[0])->order) * sizeof(dim_t));
+    TLA_COPY_DIMS(((Apart[0])->order), &((A->offset)[0]), &(((Apart[0])->offset)[0]));
+    TLA_COPY_DIMS(((Apart[0])->order), &((A->permutation)[0]), &(((Apart[0])->permutation)[0]));
     for(i = 0; i < nModes_merge; i++){
         (A->offset)[merge_modes[i]] = ((Apart[0])->offset)[merge_modes[i]];
     }
@@ -448,3 +463,64 @@ FLA_Error FLA_Merge_2powm(FLA_Obj* Apart[], FLA_Obj* A,
 
     return FLA_SUCCESS;
 }
+
+//
+// --- TLA_View functions ------------------------------------------------------
+//
+//Compact views used inside the tensor kernels.  Kernels pass them by pointer
+//and only copy the order entries in use, where an FLA_Obj (with its full
+//symmetry) is copied whole on every call and partitioning step
+
+void TLA_View_from_obj( const FLA_Obj* A, TLA_View* V )
+{
+    V->order = A->order;
+    TLA_COPY_DIMS(A->order, &((V->offset)[0]), &((A->offset)[0]));
+    TLA_COPY_DIMS(A->order, &((V->size)[0]), &((A->size)[0]));
+    V->permutation = &((A->permutation)[0]);
+    V->sym = &(A->sym);
+    V->base = A->base;
+}
+
+//Expands V back to an object, for the FLA_Obj based routines.  The symmetry
+//is that of the object V was taken from
+void TLA_View_to_obj( const TLA_View* V, FLA_Obj* A )
+{
+    A->order = V->order;
+    TLA_COPY_DIMS(V->order, &((A->offset)[0]), &((V->offset)[0]));
+    TLA_COPY_DIMS(V->order, &((A->size)[0]), &((V->size)[0]));
+    TLA_COPY_DIMS(V->order, &((A->size_inner)[0]), &((V->size)[0]));
+    TLA_COPY_DIMS(V->order, &((A->permutation)[0]), V->permutation);
+    A->isStored = TRUE;
+    A->sym = *(V->sym);
+    A->base = V->base;
+    FLA_Adjust_2D_info(A);
+}
+
+//A1 := the index-th slice of A along mode (what FLA_Repart_1xmode2_to_1xmode3
+//exposes as A1 with b = 1 at that point of the loop)
+void TLA_View_slice( const TLA_View* A, dim_t mode, dim_t index, TLA_View* A1 )
+{
+    A1->order = A->order;
+    TLA_COPY_DIMS(A->order, &((A1->offset)[0]), &((A->offset)[0]));
+    TLA_COPY_DIMS(A->order, &((A1->size)[0]), &((A->size)[0]));
+    (A1->offset)[mode] += index;
+    (A1->size)[mode] = 1;
+    A1->permutation = A->permutation;
+    A1->sym = A->sym;
+    A1->base = A->base;
+}
+
+//First element of the view V (see TLA_OBJ_BUFFER_AT_VIEW)
+void* TLA_View_buffer_at_view( const TLA_View* V )
+{
+    dim_t i;
+    const dim_t* stride = (V->base)->stride;
+    size_t elem_offset = 0;
+    size_t elem_size = ((V->base)->elemtype == FLA_SCALAR) ?
+                       (size_t)FLA_Obj_datatype_size((V->base)->datatype) : sizeof(FLA_Obj);
+
+    for(i = 0; i < V->order; i++)
+        elem_offset += (V->offset)[i] * stride[i];
+
+    return (void*)((char*)((V->base)->buffer) + elem_offset * elem_size);
+}
@@ -44,15 +44,32 @@ FLA_Error FLA_Adjust_2D_info( FLA_Obj *A )
     dim_t* base_stride = A->base->stride;
     dim_t* base_size_inner = A->base->size_inner;
     dim_t* base_size = A->base->size;
+    dim_t  base_n, base_n_inner;
     
-	A->base->m = base_size[0];
-	A->base->n = base_size[1];
-	A->base->rs = base_stride[0];
-	A->base->cs = (A->base->rs == 1) ? (A->base->rs * A->base->m) : 1;
-	A->base->m_inner = base_size_inner[0];
-	A->base->n_inner = base_size_inner[1];
-	A->base->m_index = base_index[0];
-	A->base->n_index = base_index[1];
+	//The base fields are only written if they change, so views of a shared
+	//operand adjusted beforehand (TLA_Adjust_2D_info_blocks) are only read
+	base_n = base_size[1];
+	base_n_inner = base_size_inner[1];
+	for(i = 2; i < order; i++){
+		base_n *= base_size[i];
+		base_n_inner *= base_size_inner[i];
+		//A->base->n_index *= base_index[i];
+		//A->offn *= offset[i];
+	}
+
+	if(A->base->m != base_size[0] || A->base->n != base_n ||
+	   A->base->rs != base_stride[0] || A->base->cs != ((base_stride[0] == 1) ? base_size[0] : 1) ||
+	   A->base->m_inner != base_size_inner[0] || A->base->n_inner != base_n_inner ||
+	   A->base->m_index != base_index[0] || A->base->n_index != base_index[1]){
+		A->base->m = base_size[0];
+		A->base->n = base_n;
+		A->base->rs = base_stride[0];
+		A->base->cs = (base_stride[0] == 1) ? base_size[0] : 1;
+		A->base->m_inner = base_size_inner[0];
+		A->base->n_inner = base_n_inner;
+		A->base->m_index = base_index[0];
+		A->base->n_index = base_index[1];
+	}
 
 	A->offm = offset[0];
 	A->offn = offset[1];
@@ -62,10 +79,6 @@ FLA_Error FLA_Adjust_2D_info( FLA_Obj *A )
 	A->n_inner = size_inner[1];
 
 	for(i = 2; i < order; i++){
-		A->base->n *= base_size[i];
-		A->base->n_inner *= base_size_inner[i];
-		//A->base->n_index *= base_index[i];
-		//A->offn *= offset[i];
 		A->n *= size[i];
 		A->n_inner *= size_inner[i];
 	}
@@ -73,3 +86,21 @@ FLA_Error FLA_Adjust_2D_info( FLA_Obj *A )
   return FLA_SUCCESS;
 }
 
+//Adjusts the bases of the stored blocks of A (of A itself if it is flat).
+//Run before a parallel region so the leaves only read the bases of shared
+//operands
+FLA_Error TLA_Adjust_2D_info_blocks( FLA_Obj A )
+{
+	dim_t i;
+	FLA_Obj* blks;
+
+	if(FLA_Obj_elemtype(A) == FLA_SCALAR)
+		return FLA_Adjust_2D_info(&A);
+
+	blks = (FLA_Obj*)FLA_Obj_base_buffer(A);
+	for(i = 0; i < FLA_Obj_num_elem_alloc(A); i++)
+		if(blks[i].isStored)
+			FLA_Adjust_2D_info(&(blks[i]));
+
+	return FLA_SUCCESS;
+}
@@ -31,12 +31,13 @@
 */
 
 #include "FLAME.h"
-
+//Finds the unique (sorted) representative of index.  Within each sym group the
+//values are ranked directly (ties broken by mode) instead of sorted, and the
+//index is unique iff every mode already holds its own rank
 dim_t FLA_get_unique_info( TLA_sym sym, const dim_t index[], dim_t* sortedIndex, dim_t* permutation, dim_t* ipermutation)
 {
-	dim_t i, j;
+	dim_t i, j, k;
 
-	FLA_Paired_Sort index_pairs[FLA_MAX_ORDER];
 	dim_t nSymGroups = sym.nSymGroups;
 	dim_t* symGroupLens = &(sym.symGroupLens[0]);
 	dim_t* symModes = &(sym.symModes[0]);
@@ -45,47 +46,33 @@ dim_t FLA_get_unique_info( TLA_sym sym, const dim_t index[], dim_t* sortedIndex,
 	dim_t uniqueIndex = TRUE;
 
 	for(i = 0; i < nSymGroups; i++){
-		for(j = 0; j < symGroupLens[i]; j++){
-			orderedSymModes[j+modeOffset] = symModes[j+modeOffset];
-		}
-		qsort(&(orderedSymModes[modeOffset]), symGroupLens[i], sizeof(dim_t), compare_dim_t);
-
-		for(j = 0; j < symGroupLens[i]; j++){
-			index_pairs[j].index = orderedSymModes[j+modeOffset];
-			index_pairs[j].val = index[orderedSymModes[j+modeOffset]];
-		}
-		qsort(index_pairs, symGroupLens[i], sizeof(FLA_Paired_Sort), compare_pairwise_sort);
-
-
-		for(j = 0; j < symGroupLens[i]; j++){
-			permutation[orderedSymModes[j+modeOffset]] = index_pairs[j].index;
-			sortedIndex[orderedSymModes[j+modeOffset]] = index_pairs[j].val;
+		dim_t len = symGroupLens[i];
+		dim_t* om = &(orderedSymModes[modeOffset]);
+
+		//Modes of the group in increasing order (insertion, groups are tiny)
+		for(j = 0; j < len; j++){
+			dim_t mode = symModes[j+modeOffset];
+			for(k = j; k > 0 && om[k-1] > mode; k--)
+				om[k] = om[k-1];
+			om[k] = mode;
 		}
 
-		//Check if index is unique or not
-		if (symGroupLens[i] > 1) {
-			for (j = 0; j < symGroupLens[i] - 1; j++) {
-				if (index[symModes[j + modeOffset]]
-						> index[symModes[j + modeOffset + 1]]) {
-					uniqueIndex = FALSE;
-					break;
-				}
-			}
+		for(j = 0; j < len; j++){
+			dim_t rank = 0;
+			dim_t val = index[om[j]];
+			for(k = 0; k < len; k++)
+				if(index[om[k]] < val || (index[om[k]] == val && k < j))
+					rank++;
+
+			permutation[om[rank]] = om[j];
+			sortedIndex[om[rank]] = val;
+			ipermutation[om[j]] = om[rank];
+			if(rank != j)
+				uniqueIndex = FALSE;
 		}
 
-		modeOffset += symGroupLens[i];
-	}
-
-	//Set the correct ipermutation
-	memcpy(&(ipermutation[0]), &(permutation[0]), sym.order * sizeof(dim_t));
-	modeOffset = 0;
-	for(i = 0; i < nSymGroups; i++){
-		for(j = 0; j < symGroupLens[i]; j++){
-			ipermutation[permutation[symModes[j+modeOffset]]] = orderedSymModes[j+modeOffset];
-		}
-		modeOffset += symGroupLens[i];
+		modeOffset += len;
 	}
 
   return uniqueIndex;
 }
-
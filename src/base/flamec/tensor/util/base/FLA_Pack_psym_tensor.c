@@ -0,0 +1,76 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+
+//Copies one unique block between a dense and a packed blocked psym tensor
+static FLA_Error FLA_Pack_psym_block_copy( FLA_Obj dense, FLA_Obj packed, FLA_Bool pack ){
+	FLA_Base_obj* packedBase = packed.base;
+
+	if(packedBase->isPacked){
+		if(pack)
+			TLA_Pack_sym_block(dense, packedBase->packed_sym, packedBase->buffer);
+		else
+			TLA_Unpack_sym_block(packedBase->packed_sym, packedBase->buffer, dense);
+	}else{
+		size_t nBytes = FLA_array_product(FLA_Obj_order(dense), dense.size) * FLA_Obj_elem_size(dense);
+		if(pack)
+			memcpy(packedBase->buffer, FLA_Obj_base_buffer(dense), nBytes);
+		else
+			memcpy(FLA_Obj_base_buffer(dense), packedBase->buffer, nBytes);
+	}
+	return FLA_SUCCESS;
+}
+
+static FLA_Error FLA_Pack_psym_tensor_copy( FLA_Obj dense, FLA_Obj packed, FLA_Bool pack ){
+	dim_t u;
+	TLA_unique_map* map = FLA_Obj_unique_map(packed);
+	FLA_Obj* buf_dense = (FLA_Obj*)FLA_Obj_base_buffer(dense);
+	FLA_Obj* buf_packed = (FLA_Obj*)FLA_Obj_base_buffer(packed);
+
+	for(u = 0; u < map->nUniques; u++){
+		dim_t linIndex = map->uniqueLinIndex[u];
+		FLA_Pack_psym_block_copy(buf_dense[linIndex], buf_packed[linIndex], pack);
+	}
+	return FLA_SUCCESS;
+}
+
+//B := A, where A is a dense blocked psym tensor and B has the same shape but
+//was created by FLA_Obj_create_blocked_psym_tensor_packed
+FLA_Error FLA_Obj_pack_blocked_psym_tensor( FLA_Obj A, FLA_Obj B ){
+	return FLA_Pack_psym_tensor_copy(A, B, TRUE);
+}
+
+//B := A, the inverse of FLA_Obj_pack_blocked_psym_tensor
+FLA_Error FLA_Obj_unpack_blocked_psym_tensor( FLA_Obj A, FLA_Obj B ){
+	return FLA_Pack_psym_tensor_copy(B, A, FALSE);
+}
@@ -68,6 +68,7 @@ FLA_Bool next_permutation(dim_t nElem, dim_t* perm){
 FLA_Error FLA_Random_scalar_psym_tensor(FLA_Obj obj){
 	dim_t i,j;
 	dim_t order = FLA_Obj_order(obj);
+	FLA_Datatype datatype = FLA_Obj_datatype(obj);
 	FLA_Obj tmp;
 	dim_t tmpSize[FLA_MAX_ORDER];
 	dim_t tmpStride[FLA_MAX_ORDER];
@@ -80,8 +81,8 @@ FLA_Error FLA_Random_scalar_psym_tensor(FLA_Obj obj){
 		tmpSize[i] = 1;
 		tmpStride[i] = 1;
 	}
-	FLA_Obj_create_tensor(FLA_DOUBLE, order, tmpSize, tmpStride, &tmp);
-	((double*)((tmp.base)->buffer))[0] = 1;
+	FLA_Obj_create_tensor(datatype, order, tmpSize, tmpStride, &tmp);
+	FLA_Set(FLA_ONE, tmp);
 	
 	objSym = obj.sym;
 
@@ -94,7 +95,7 @@ FLA_Error FLA_Random_scalar_psym_tensor(FLA_Obj obj){
 		dim_t out_mode_size = FLA_Obj_dimsize(obj, symGroupMode);
 		dim_t vecSize[] = {out_mode_size, 1};
 		dim_t vecStride[] = {1, out_mode_size};
-		FLA_Obj_create_tensor(FLA_DOUBLE, 2, vecSize, vecStride, &vec);
+		FLA_Obj_create_tensor(datatype, 2, vecSize, vecStride, &vec);
 		FLA_Random_tensor(vec);
 
 		//Multiply in all modes of symGroup
@@ -108,11 +109,10 @@ FLA_Error FLA_Random_scalar_psym_tensor(FLA_Obj obj){
 			memcpy(&(tmpResSize[0]), &(tmp.size[0]), order * sizeof(dim_t));
 			tmpResSize[mode_mult] = out_mode_size;
 			FLA_Set_tensor_stride(order, tmpResSize, tmpResStride);
-			FLA_Obj_create_tensor(FLA_DOUBLE, order, tmpResSize, tmpResStride, &tmpRes);
-			FLA_Set_zero_tensor(tmpRes);
+			FLA_Obj_create_tensor(datatype, order, tmpResSize, tmpResStride, &tmpRes);
 
-			//Perform multiply
-			FLA_Ttm_scalar_permC(FLA_ONE, tmp, mode_mult, FLA_ONE, vec, tmpRes);
+			//Perform multiply (overwrites tmpRes)
+			FLA_Ttm_scalar_permC(FLA_ZERO, tmp, mode_mult, FLA_ONE, vec, tmpRes);
 
 			//Output is input for next iteration
 			FLA_Obj_free_buffer(&tmp);
@@ -128,7 +128,7 @@ FLA_Error FLA_Random_scalar_psym_tensor(FLA_Obj obj){
 	//Final result created, copy over to obj
 	tmpBuffer = FLA_Obj_base_buffer(tmp);
 	objBuffer = FLA_Obj_base_buffer(obj);
-	memcpy(objBuffer, tmpBuffer, FLA_Obj_num_elem_alloc(obj) * sizeof(double));
+	memcpy(objBuffer, tmpBuffer, FLA_Obj_num_elem_alloc(obj) * FLA_Obj_elem_size(obj));
 
 	//Free locally alloc'd data
 	FLA_Obj_free_buffer(&tmp);
@@ -181,6 +181,9 @@ FLA_Error FLA_Random_psym_tensor(FLA_Obj obj){
 
 			//Fill block with data
 			FLA_Random_scalar_psym_tensor(*curObj);
+
+			//Offset was only needed to determine the sym of the block
+			memset(&((curObj->offset)[0]), 0, order * sizeof(dim_t));
 		}
 	}
 
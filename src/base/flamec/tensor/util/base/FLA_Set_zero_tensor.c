@@ -46,7 +46,7 @@ FLA_Error FLA_Set_zero_tensor( FLA_Obj A )
 	//If it is a block, set it (only if stored)
 	else{
 		if(A.isStored){
-			memset(&(((double*)FLA_Obj_base_buffer(A))[0]), 0, nElem * sizeof(double));
+			memset(FLA_Obj_base_buffer(A), 0, nElem * FLA_Obj_elem_size(A));
 		}
 	}
 
@@ -32,22 +32,39 @@
 
 #include "FLAME.h"
 
+//Order-specialized instances (see TLA_ORDER_INSTANTIATE)
+#define FLA_TINDEX_TO_LININDEX_DEF( name, ORDER ) \
+static dim_t name( dim_t order_, dim_t const stride[], dim_t const index[] ) \
+{ \
+	const dim_t order = (ORDER); \
+	dim_t i; \
+	dim_t linIndex = 0; \
+	for(i = 0; i < order; i++) \
+		linIndex += index[i] * stride[i]; \
+	return linIndex; \
+}
+
+#define FLA_LININDEX_TO_TINDEX_DEF( name, ORDER ) \
+static FLA_Error name( dim_t order_, dim_t const stride[], dim_t const linIndex, dim_t index[] ) \
+{ \
+	const dim_t order = (ORDER); \
+	dim_t i; \
+	dim_t count = linIndex; \
+	for(i = order - 1; i < order; i--){ \
+		index[i] = count / stride[i]; \
+		count -= stride[i] * index[i]; \
+	} \
+	return FLA_SUCCESS; \
+}
+
+TLA_ORDER_INSTANTIATE( FLA_TINDEX_TO_LININDEX_DEF, FLA_TIndex_to_LinIndex )
+TLA_ORDER_INSTANTIATE( FLA_LININDEX_TO_TINDEX_DEF, FLA_LinIndex_to_TIndex )
+
 dim_t FLA_TIndex_to_LinIndex( dim_t order, dim_t const stride[], dim_t const index[])
 {
-	dim_t i;
-	dim_t linIndex = 0;
-	for(i = 0; i < order; i++)
-		linIndex += index[i] * stride[i];
-
-  return linIndex;
+	return TLA_ORDER_DISPATCH( order, FLA_TIndex_to_LinIndex, (order, stride, index) );
 }
 
 FLA_Error FLA_LinIndex_to_TIndex( dim_t order, dim_t const stride[], dim_t const linIndex, dim_t index[]){
-	dim_t i;
-	dim_t count = linIndex;
-	for(i = order - 1; i < order; i--){
-		index[i] = count / stride[i];
-		count -= stride[i] * index[i];
-	}
-	return FLA_SUCCESS;
+	return TLA_ORDER_DISPATCH( order, FLA_LinIndex_to_TIndex, (order, stride, linIndex, index) );
 }
@@ -44,3 +44,94 @@ dim_t FLA_Ttm_Ops( dim_t order, const dim_t size_A[], const dim_t size_B[2], dim
 	return 2*m*n*k;
 }
 
+
+//Chooses the order in which to apply the mode products of a multi-mode ttm,
+//C = A x_mode[0] B[0] x_mode[1] B[1] ...  B[i] is size_B[2*i] x size_B[2*i+1].
+//
+//Every subset of the products is costed once (dynamic programming over
+//subsets), minimizing flops and, among orders with equal flops, the largest
+//intermediate.  seq receives the indices into mode[] in the order they should
+//be applied.  Returns the predicted flops of that order.
+//
+//Products sharing a mode do not commute; if any mode repeats, the given
+//order is kept.
+dim_t FLA_Ttm_Ops_order( dim_t order, const dim_t size_A[], dim_t nModes, const dim_t mode[], const dim_t size_B[], dim_t seq[] )
+{
+	dim_t i, j;
+	dim_t S, nSubsets;
+	double* flops;
+	double* peak;
+	dim_t* last;
+	dim_t size_S[FLA_MAX_ORDER];
+	double result;
+	FLA_Bool distinct = TRUE;
+
+	for(i = 0; i < nModes; i++)
+		for(j = 0; j < i; j++)
+			if(mode[i] == mode[j])
+				distinct = FALSE;
+
+	if(!distinct || nModes < 2){
+		memcpy(size_S, size_A, order * sizeof(dim_t));
+		result = 0;
+		for(i = 0; i < nModes; i++){
+			seq[i] = i;
+			result += (double)FLA_Ttm_Ops(order, size_S, &(size_B[2*i]), mode[i]);
+			size_S[mode[i]] = size_B[2*i];
+		}
+		return (dim_t)result;
+	}
+
+	//nModes distinct modes of A, so at most 2^FLA_MAX_ORDER subsets
+	nSubsets = (dim_t)1 << nModes;
+	flops = (double*)FLA_malloc(nSubsets * sizeof(double));
+	peak = (double*)FLA_malloc(nSubsets * sizeof(double));
+	last = (dim_t*)FLA_malloc(nSubsets * sizeof(dim_t));
+
+	flops[0] = 0;
+	peak[0] = 0;
+	for(S = 1; S < nSubsets; S++){
+		flops[S] = -1;
+		for(j = 0; j < nModes; j++){
+			dim_t R = S & ~(1 << j);
+			double n, f, p;
+			if(!(S & (1 << j)))
+				continue;
+
+			//Shape before applying product j
+			memcpy(size_S, size_A, order * sizeof(dim_t));
+			for(i = 0; i < nModes; i++)
+				if(R & (1 << i))
+					size_S[mode[i]] = size_B[2*i];
+
+			n = 1;
+			for(i = 0; i < order; i++)
+				if(i != mode[j])
+					n *= size_S[i];
+			f = flops[R] + 2.0 * size_B[2*j] * size_B[2*j+1] * n;
+
+			//The result of the last product is C, not an intermediate
+			p = peak[R];
+			if(S != nSubsets - 1 && n * size_B[2*j] > p)
+				p = n * size_B[2*j];
+
+			if(flops[S] < 0 || f < flops[S] || (f == flops[S] && p < peak[S])){
+				flops[S] = f;
+				peak[S] = p;
+				last[S] = j;
+			}
+		}
+	}
+
+	for(S = nSubsets - 1, i = nModes; i > 0; i--){
+		seq[i-1] = last[S];
+		S &= ~(1 << last[S]);
+	}
+	result = flops[nSubsets - 1];
+
+	FLA_free(flops);
+	FLA_free(peak);
+	FLA_free(last);
+
+	return (dim_t)result;
+}
@@ -0,0 +1,89 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+
+//Copies the m x n matrix from (row/column strides rs_from/cs_from) to to,
+//changing the precision from dt_from to dt_to (same domain only).  Returns
+//FLA_FAILURE for unsupported pairs
+FLA_Error TLA_Copy_matrix_convert( dim_t m, dim_t n,
+                                   FLA_Datatype dt_from, void* from, dim_t rs_from, dim_t cs_from,
+                                   FLA_Datatype dt_to, void* to, dim_t rs_to, dim_t cs_to ){
+	if(m == 0 || n == 0)
+		return FLA_SUCCESS;
+
+	if(dt_from == FLA_FLOAT && dt_to == FLA_FLOAT)
+		bli_scopymt(BLIS_NO_TRANSPOSE, m, n, (float*)from, rs_from, cs_from, (float*)to, rs_to, cs_to);
+	else if(dt_from == FLA_DOUBLE && dt_to == FLA_DOUBLE)
+		bli_dcopymt(BLIS_NO_TRANSPOSE, m, n, (double*)from, rs_from, cs_from, (double*)to, rs_to, cs_to);
+	else if(dt_from == FLA_COMPLEX && dt_to == FLA_COMPLEX)
+		bli_ccopymt(BLIS_NO_TRANSPOSE, m, n, (scomplex*)from, rs_from, cs_from, (scomplex*)to, rs_to, cs_to);
+	else if(dt_from == FLA_DOUBLE_COMPLEX && dt_to == FLA_DOUBLE_COMPLEX)
+		bli_zcopymt(BLIS_NO_TRANSPOSE, m, n, (dcomplex*)from, rs_from, cs_from, (dcomplex*)to, rs_to, cs_to);
+	else if(dt_from == FLA_FLOAT && dt_to == FLA_DOUBLE)
+		bli_sdcopymt(BLIS_NO_TRANSPOSE, m, n, (float*)from, rs_from, cs_from, (double*)to, rs_to, cs_to);
+	else if(dt_from == FLA_DOUBLE && dt_to == FLA_FLOAT)
+		bli_dscopymt(BLIS_NO_TRANSPOSE, m, n, (double*)from, rs_from, cs_from, (float*)to, rs_to, cs_to);
+	else if(dt_from == FLA_COMPLEX && dt_to == FLA_DOUBLE_COMPLEX)
+		bli_czcopymt(BLIS_NO_TRANSPOSE, m, n, (scomplex*)from, rs_from, cs_from, (dcomplex*)to, rs_to, cs_to);
+	else if(dt_from == FLA_DOUBLE_COMPLEX && dt_to == FLA_COMPLEX)
+		bli_zccopymt(BLIS_NO_TRANSPOSE, m, n, (dcomplex*)from, rs_from, cs_from, (scomplex*)to, rs_to, cs_to);
+	else
+		return FLA_FAILURE;
+
+	return FLA_SUCCESS;
+}
+
+//Copies nElem contiguous elements, changing the precision from dt_from to
+//dt_to (same domain only).  Returns FLA_FAILURE for unsupported pairs
+FLA_Error TLA_Copy_buffer_convert( dim_t nElem, FLA_Datatype dt_from, void* from, FLA_Datatype dt_to, void* to ){
+	if(nElem == 0)
+		return FLA_SUCCESS;
+
+	if(dt_from == dt_to){
+		memcpy(to, from, nElem * FLA_Obj_datatype_size(dt_from));
+		return FLA_SUCCESS;
+	}
+
+	if(dt_from == FLA_FLOAT && dt_to == FLA_DOUBLE)
+		bli_sdcopymt(BLIS_NO_TRANSPOSE, nElem, 1, (float*)from, 1, nElem, (double*)to, 1, nElem);
+	else if(dt_from == FLA_DOUBLE && dt_to == FLA_FLOAT)
+		bli_dscopymt(BLIS_NO_TRANSPOSE, nElem, 1, (double*)from, 1, nElem, (float*)to, 1, nElem);
+	else if(dt_from == FLA_COMPLEX && dt_to == FLA_DOUBLE_COMPLEX)
+		bli_czcopymt(BLIS_NO_TRANSPOSE, nElem, 1, (scomplex*)from, 1, nElem, (dcomplex*)to, 1, nElem);
+	else if(dt_from == FLA_DOUBLE_COMPLEX && dt_to == FLA_COMPLEX)
+		bli_zccopymt(BLIS_NO_TRANSPOSE, nElem, 1, (dcomplex*)from, 1, nElem, (scomplex*)to, 1, nElem);
+	else
+		return FLA_FAILURE;
+
+	return FLA_SUCCESS;
+}
@@ -0,0 +1,239 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+
+//Packed layout of a block symmetric in the groups of sym:
+//Within a group of len modes (all of size n) only the entries with
+//non-decreasing indices i_0 <= ... <= i_{len-1} are kept, numbered by the
+//combinatorial number system, rank = sum_j binomial(i_j + j, j + 1).
+//Groups are combined like the modes of a dense tensor (first group fastest).
+
+//Rank of the (sorted) values of one group
+static dim_t TLA_packed_group_rank( dim_t len, const dim_t vals[] ){
+	dim_t j;
+	dim_t rank = 0;
+
+	for(j = 0; j < len; j++)
+		if(vals[j] > 0)
+			rank += binomial(vals[j] + j, j + 1);
+	return rank;
+}
+
+//Number of elements stored by a block of size size packed according to sym
+dim_t TLA_packed_sym_size( TLA_sym sym, const dim_t size[] ){
+	dim_t i;
+	dim_t nElem = 1;
+	dim_t modeOffset = 0;
+
+	for(i = 0; i < sym.nSymGroups; i++){
+		dim_t len = sym.symGroupLens[i];
+		nElem *= binomial(size[sym.symModes[modeOffset]] + len - 1, len);
+		modeOffset += len;
+	}
+	return nElem;
+}
+
+//Position in the packed buffer of the element at (any) index
+dim_t TLA_packed_sym_offset( TLA_sym sym, const dim_t size[], const dim_t index[] ){
+	dim_t i, j, k;
+	dim_t linIndex = 0;
+	dim_t stride = 1;
+	dim_t modeOffset = 0;
+	dim_t vals[FLA_MAX_ORDER];
+
+	for(i = 0; i < sym.nSymGroups; i++){
+		dim_t len = sym.symGroupLens[i];
+
+		//Sort the values of the group (insertion, groups are tiny)
+		for(j = 0; j < len; j++){
+			dim_t val = index[sym.symModes[modeOffset + j]];
+			for(k = j; k > 0 && vals[k-1] > val; k--)
+				vals[k] = vals[k-1];
+			vals[k] = val;
+		}
+		linIndex += stride * TLA_packed_group_rank(len, vals);
+		stride *= binomial(size[sym.symModes[modeOffset]] + len - 1, len);
+		modeOffset += len;
+	}
+	return linIndex;
+}
+
+//Number of entries a packed entry stands for: the distinct arrangements of
+//the values of index within each group of sym (multinomial of the values)
+dim_t TLA_sym_index_multiplicity( TLA_sym sym, const dim_t index[] ){
+	dim_t i, j, k;
+	dim_t modeOffset = 0;
+	dim_t mult = 1;
+
+	for(i = 0; i < sym.nSymGroups; i++){
+		dim_t len = sym.symGroupLens[i];
+		dim_t groupMult = 1;
+		for(j = 0; j < len; j++){
+			dim_t val = index[sym.symModes[modeOffset + j]];
+			dim_t count = 1;
+			for(k = 0; k < j; k++)
+				if(index[sym.symModes[modeOffset + k]] == val)
+					count++;
+			groupMult = groupMult * (j + 1) / count;
+		}
+		mult *= groupMult;
+		modeOffset += len;
+	}
+	return mult;
+}
+
+//Number of modes of group holding the value index has at the j-th mode of
+//the group, or 0 if an earlier mode of the group holds it too (so that every
+//value is counted once)
+dim_t TLA_sym_value_count( TLA_sym sym, dim_t group, dim_t j, const dim_t index[] ){
+	dim_t k;
+	dim_t modeOffset = TLA_sym_group_mode_offset(sym, group);
+	dim_t len = sym.symGroupLens[group];
+	dim_t val = index[sym.symModes[modeOffset + j]];
+	dim_t count = 0;
+
+	for(k = 0; k < len; k++){
+		if(index[sym.symModes[modeOffset + k]] != val)
+			continue;
+		if(k < j)
+			return 0;
+		count++;
+	}
+	return count;
+}
+
+//Symmetry inside the block at blkIndex of a tensor with symmetry sym: the modes
+//of a sym group holding the same block index.  Returns TRUE if any two modes
+//are related (the block can be packed)
+FLA_Bool TLA_sym_of_diagonal_block( TLA_sym sym, const dim_t blkIndex[], TLA_sym* blkSym ){
+	dim_t i, j, k;
+	dim_t modeOffset = 0;
+	dim_t blkModeOffset = 0;
+	FLA_Bool isDiagonal = FALSE;
+	FLA_Bool used[FLA_MAX_ORDER];
+
+	blkSym->order = sym.order;
+	blkSym->nSymGroups = 0;
+
+	for(i = 0; i < sym.nSymGroups; i++){
+		dim_t len = sym.symGroupLens[i];
+
+		memset(&(used[0]), 0, len * sizeof(FLA_Bool));
+		for(j = 0; j < len; j++){
+			dim_t mode = sym.symModes[modeOffset + j];
+			dim_t groupLen = 1;
+			if(used[j])
+				continue;
+
+			//New group of every later mode at the same block index
+			blkSym->symModes[blkModeOffset] = mode;
+			for(k = j + 1; k < len; k++){
+				dim_t other = sym.symModes[modeOffset + k];
+				if(!used[k] && blkIndex[other] == blkIndex[mode]){
+					blkSym->symModes[blkModeOffset + groupLen] = other;
+					groupLen++;
+					used[k] = TRUE;
+					isDiagonal = TRUE;
+				}
+			}
+			blkSym->symGroupLens[blkSym->nSymGroups] = groupLen;
+			blkSym->nSymGroups++;
+			blkModeOffset += groupLen;
+		}
+		modeOffset += len;
+	}
+	return isDiagonal;
+}
+
+//Copies the unique entries of the dense scalar block A (symmetric in the
+//groups of sym) into packed
+FLA_Error TLA_Pack_sym_block( FLA_Obj A, TLA_sym sym, void* packed ){
+	dim_t i;
+	dim_t order = FLA_Obj_order(A);
+	size_t elem_size = (size_t)FLA_Obj_elem_size(A);
+	const dim_t* size = A.size;
+	const dim_t* stride = (A.base)->stride;
+	char* buf_A = (char*)TLA_OBJ_BUFFER_AT_VIEW(A);
+	char* buf_P = (char*)packed;
+	dim_t index[FLA_MAX_ORDER];
+
+	if(FLA_array_product(order, size) == 0)
+		return FLA_SUCCESS;
+
+	memset(&(index[0]), 0, order * sizeof(dim_t));
+	do{
+		dim_t offA = 0;
+		for(i = 0; i < order; i++)
+			offA += index[i] * stride[i];
+		memcpy(buf_P + TLA_packed_sym_offset(sym, size, index) * elem_size,
+		       buf_A + offA * elem_size, elem_size);
+	}while(TLA_next_unique_index(sym, size, index));
+
+	return FLA_SUCCESS;
+}
+
+//Expands packed (see TLA_Pack_sym_block) into every entry of the dense
+//scalar block A
+FLA_Error TLA_Unpack_sym_block( TLA_sym sym, const void* packed, FLA_Obj A ){
+	dim_t i;
+	dim_t order = FLA_Obj_order(A);
+	size_t elem_size = (size_t)FLA_Obj_elem_size(A);
+	const dim_t* size = A.size;
+	const dim_t* stride = (A.base)->stride;
+	char* buf_A = (char*)TLA_OBJ_BUFFER_AT_VIEW(A);
+	const char* buf_P = (const char*)packed;
+	dim_t index[FLA_MAX_ORDER];
+
+	if(FLA_array_product(order, size) == 0)
+		return FLA_SUCCESS;
+
+	//Walk A in storage order (first mode fastest)
+	memset(&(index[0]), 0, order * sizeof(dim_t));
+	while(TRUE){
+		dim_t offA = 0;
+		for(i = 0; i < order; i++)
+			offA += index[i] * stride[i];
+		memcpy(buf_A + offA * elem_size,
+		       buf_P + TLA_packed_sym_offset(sym, size, index) * elem_size, elem_size);
+
+		for(i = 0; i < order; i++){
+			if(++index[i] < size[i])
+				break;
+			index[i] = 0;
+		}
+		if(i == order)
+			break;
+	}
+
+	return FLA_SUCCESS;
+}
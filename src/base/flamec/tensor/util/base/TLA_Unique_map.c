@@ -0,0 +1,217 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+
+//Lists the modes of each sym group in increasing order (no sorting needed:
+//modes are visited in order and appended to their group)
+static void TLA_sym_ordered_modes( TLA_sym sym, dim_t groupOffset[], dim_t orderedModes[] ){
+	dim_t i, j;
+	dim_t modeOffset = 0;
+	dim_t groupFill[FLA_MAX_ORDER];
+
+	for(i = 0; i < sym.nSymGroups; i++){
+		groupOffset[i] = modeOffset;
+		groupFill[i] = 0;
+		modeOffset += sym.symGroupLens[i];
+	}
+	for(i = 0; i < sym.order; i++){
+		dim_t group = TLA_sym_group_of_mode(sym, i);
+		j = groupOffset[group] + groupFill[group];
+		orderedModes[j] = i;
+		groupFill[group]++;
+	}
+}
+
+//Previous mode (in increasing order) of the sym group of each mode
+//(sym.order if none)
+static void TLA_sym_mode_predecessors( TLA_sym sym, dim_t pred[] ){
+	dim_t i, j;
+	dim_t groupOffset[FLA_MAX_ORDER];
+	dim_t orderedModes[FLA_MAX_ORDER];
+
+	TLA_sym_ordered_modes(sym, groupOffset, orderedModes);
+	for(i = 0; i < sym.nSymGroups; i++){
+		pred[orderedModes[groupOffset[i]]] = sym.order;
+		for(j = 1; j < sym.symGroupLens[i]; j++)
+			pred[orderedModes[groupOffset[i] + j]] = orderedModes[groupOffset[i] + j - 1];
+	}
+}
+
+//Next arrangement (lexicographically) of a multiset.  When the last
+//arrangement is passed, vals is reset to the first one and FALSE returned
+static FLA_Bool TLA_next_multiset_permutation( dim_t nElem, dim_t vals[] ){
+	dim_t k, l, tmp;
+	FLA_Bool wrapped;
+
+	if(nElem < 2)
+		return FALSE;
+
+	for(k = nElem - 1; k > 0 && vals[k-1] >= vals[k]; k--);
+	wrapped = (k == 0);
+
+	if(!wrapped){
+		for(l = nElem - 1; vals[l] <= vals[k-1]; l--);
+		tmp = vals[k-1];
+		vals[k-1] = vals[l];
+		vals[l] = tmp;
+	}
+
+	//Reverse the tail (whole array on wrap-around)
+	for(l = nElem - 1; k < l; k++, l--){
+		tmp = vals[k];
+		vals[k] = vals[l];
+		vals[l] = tmp;
+	}
+	return !wrapped;
+}
+
+static FLA_Bool TLA_next_unique_index_pred( dim_t order, const dim_t pred[], const dim_t blked_size[], dim_t index[] ){
+	dim_t p, q;
+
+	for(p = order; p > 0; p--){
+		if(index[p-1] + 1 < blked_size[p-1]){
+			index[p-1]++;
+			//Reset trailing modes to the smallest index keeping them unique
+			for(q = p; q < order; q++)
+				index[q] = (pred[q] < order) ? index[pred[q]] : 0;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+//Advances index to the next unique block index, i.e. the next index that is
+//non-decreasing (in increasing mode order) within each sym group.  The last
+//mode varies fastest, start from the zero index.  Returns FALSE when done.
+FLA_Bool TLA_next_unique_index( TLA_sym sym, const dim_t blked_size[], dim_t index[] ){
+	dim_t pred[FLA_MAX_ORDER];
+
+	TLA_sym_mode_predecessors(sym, pred);
+	return TLA_next_unique_index_pred(sym.order, pred, blked_size, index);
+}
+
+//Builds the block -> unique block map of a blocked psym tensor with blocked
+//size blked_size and (blocked) stride stride.  Unique blocks are numbered in
+//the order TLA_next_unique_index visits them.  Each orbit is generated from
+//its unique block, so the work is proportional to the number of blocks and
+//no sorting is done.
+FLA_Error TLA_Unique_map_create( TLA_sym sym, const dim_t blked_size[], const dim_t stride[], TLA_unique_map* map ){
+	dim_t i, j, k;
+	dim_t order = sym.order;
+	dim_t nGroups = sym.nSymGroups;
+	dim_t groupOffset[FLA_MAX_ORDER];
+	dim_t orderedModes[FLA_MAX_ORDER];
+	dim_t pred[FLA_MAX_ORDER];
+
+	dim_t index[FLA_MAX_ORDER];
+	dim_t vals[FLA_MAX_ORDER];
+	dim_t nUniques = 1;
+	dim_t u;
+
+	TLA_sym_ordered_modes(sym, groupOffset, orderedModes);
+	TLA_sym_mode_predecessors(sym, pred);
+
+	for(i = 0; i < nGroups; i++){
+		dim_t len = sym.symGroupLens[i];
+		nUniques *= binomial(len + blked_size[orderedModes[groupOffset[i]]] - 1, len);
+	}
+
+	map->order = order;
+	map->nBlocks = FLA_array_product(order, blked_size);
+	map->nUniques = nUniques;
+	map->uniqueLinIndex = (dim_t*)FLA_malloc(nUniques * sizeof(dim_t));
+	map->orbitSize = (dim_t*)FLA_malloc(nUniques * sizeof(dim_t));
+	map->repOf = (dim_t*)FLA_malloc(map->nBlocks * sizeof(dim_t));
+	map->perm = (unsigned char*)FLA_malloc(map->nBlocks * order * sizeof(unsigned char));
+
+	memset(&(index[0]), 0, order * sizeof(dim_t));
+	u = 0;
+	do{
+		dim_t count = 0;
+		FLA_Bool done = FALSE;
+
+		map->uniqueLinIndex[u] = FLA_TIndex_to_LinIndex(order, stride, index);
+
+		//Values of each group in increasing mode order (non-decreasing)
+		for(i = 0; i < order; i++)
+			vals[i] = index[orderedModes[i]];
+
+		//Visit every distinct rearrangement of the group values
+		while(!done){
+			dim_t x[FLA_MAX_ORDER];
+			dim_t linIndex;
+			unsigned char* perm;
+
+			for(i = 0; i < order; i++)
+				x[orderedModes[i]] = vals[i];
+			linIndex = FLA_TIndex_to_LinIndex(order, stride, x);
+			map->repOf[linIndex] = u;
+
+			//Mode m of the block is mode perm[m] of the unique block,
+			//where ties are broken by mode
+			perm = &(map->perm[linIndex * order]);
+			for(i = 0; i < nGroups; i++){
+				dim_t off = groupOffset[i];
+				dim_t len = sym.symGroupLens[i];
+				for(j = 0; j < len; j++){
+					dim_t rank = 0;
+					for(k = 0; k < len; k++)
+						if(vals[off+k] < vals[off+j] || (vals[off+k] == vals[off+j] && k < j))
+							rank++;
+					perm[orderedModes[off+j]] = (unsigned char)orderedModes[off+rank];
+				}
+			}
+			count++;
+
+			//Odometer over the groups, last group fastest
+			for(i = nGroups; i > 0; i--)
+				if(TLA_next_multiset_permutation(sym.symGroupLens[i-1], &(vals[groupOffset[i-1]])))
+					break;
+			done = (i == 0);
+		}
+		map->orbitSize[u] = count;
+		u++;
+	}while(TLA_next_unique_index_pred(order, pred, blked_size, index));
+
+	return FLA_SUCCESS;
+}
+
+FLA_Error TLA_Unique_map_free( TLA_unique_map* map ){
+	FLA_free(map->uniqueLinIndex);
+	FLA_free(map->orbitSize);
+	FLA_free(map->repOf);
+	FLA_free(map->perm);
+	map->nBlocks = 0;
+	map->nUniques = 0;
+	return FLA_SUCCESS;
+}
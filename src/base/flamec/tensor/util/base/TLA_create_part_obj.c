@@ -42,3 +42,14 @@ FLA_Error TLA_create_part_obj( dim_t nPart, FLA_Obj* partitions[])
   return FLA_SUCCESS;
 }
 
+
+//Points the partition blocks at caller owned storage (no allocation; nothing
+//to destroy)
+FLA_Error TLA_init_part_obj( dim_t nPart, FLA_Obj store[], FLA_Obj* partitions[])
+{
+  dim_t i;
+  for(i = 0; i < nPart; i++)
+      partitions[i] = &(store[i]);
+
+  return FLA_SUCCESS;
+}
@@ -38,19 +38,16 @@ FLA_Error TLA_Copy_col_mode(FLA_Obj A, dim_t mode_A, FLA_Obj B, dim_t mode_B){
 	dim_t stride_A = FLA_Obj_dimstride(A,mode_A);
 	dim_t stride_B = FLA_Obj_dimstride(B,mode_B);
 
-	/*
-	 *	Replace the following with better routine
-	 */
-	dim_t dt_A = FLA_Obj_datatype(A);
-	if(dt_A == FLA_DOUBLE){
-		double* buf_A = FLA_Obj_tensor_buffer_at_view(A);
-		double* buf_B = FLA_Obj_tensor_buffer_at_view(B);
+	if(FLA_Obj_elemtype(A) == FLA_SCALAR){
+		size_t elem_size = (size_t)FLA_Obj_elem_size(A);
+		char* buf_A = TLA_OBJ_BUFFER_AT_VIEW(A);
+		char* buf_B = TLA_OBJ_BUFFER_AT_VIEW(B);
 		for(i = 0; i < FLA_Obj_dimsize(A,mode_A); i++){
-			buf_B[i*stride_B] = buf_A[i*stride_A];
+			memcpy(buf_B + i*stride_B*elem_size, buf_A + i*stride_A*elem_size, elem_size);
 		}
 	}else{
-		FLA_Obj* buf_A = FLA_Obj_tensor_buffer_at_view(A);
-		FLA_Obj* buf_B = FLA_Obj_tensor_buffer_at_view(B);
+		FLA_Obj* buf_A = TLA_OBJ_BUFFER_AT_VIEW(A);
+		FLA_Obj* buf_B = TLA_OBJ_BUFFER_AT_VIEW(B);
 		for(i = 0; i < FLA_Obj_dimsize(A,mode_A); i++){
 			buf_B[i*stride_B] = buf_A[i*stride_A];
 		}
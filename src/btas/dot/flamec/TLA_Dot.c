@@ -0,0 +1,314 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+
+//Inner products and Frobenius norms of blocked tensors.
+//
+//Of a blocked psym tensor only the unique blocks are read: every block of an
+//orbit holds the same entries, so a unique block contributes its own sum
+//times the orbit size.  Packed diagonal blocks are walked by unique entry,
+//each weighted by the number of entries it stands for.  The blocks are split
+//in contiguous ranges across threads; the partial sums are accumulated in
+//double and added in thread order.
+
+//Number of threads TLA_Dot and TLA_Norm_frob split the blocks across
+static dim_t tla_dot_n_threads = 1;
+
+void TLA_Dot_set_num_threads( dim_t n_threads )
+{
+	tla_dot_n_threads = (n_threads < 1) ? 1 : n_threads;
+}
+
+dim_t TLA_Dot_get_num_threads( void )
+{
+	return tla_dot_n_threads;
+}
+
+//Blocks stored densely with the first mode fastest are one contiguous run
+static FLA_Bool TLA_Dot_block_is_contiguous( const FLA_Base_obj* blk )
+{
+	dim_t k;
+	dim_t stride = 1;
+
+	if(blk->isPacked)
+		return FALSE;
+	for(k = 0; k < blk->order; k++){
+		if(blk->size[k] > 1 && blk->stride[k] != stride)
+			return FALSE;
+		stride *= blk->size[k];
+	}
+	return TRUE;
+}
+
+//Sum of the products of the entries of the blocks a and b (of the same
+//size, one of them possibly packed).  Runs of contiguous entries keep four
+//partial sums so that the loops vectorize
+#define TLA_DOT_DEF( ctype, ch ) \
+\
+static double TLA_Dot_run_##ch( dim_t n, const ctype* a, const ctype* b ) \
+{ \
+	double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0; \
+	dim_t i; \
+	for( i = 0; i + 4 <= n; i += 4 ){ \
+		s0 += ( double ) a[i]   * ( double ) b[i]; \
+		s1 += ( double ) a[i+1] * ( double ) b[i+1]; \
+		s2 += ( double ) a[i+2] * ( double ) b[i+2]; \
+		s3 += ( double ) a[i+3] * ( double ) b[i+3]; \
+	} \
+	for( ; i < n; i++ ) \
+		s0 += ( double ) a[i] * ( double ) b[i]; \
+	return ( s0 + s1 ) + ( s2 + s3 ); \
+} \
+\
+static double TLA_Dot_block_##ch( const FLA_Base_obj* blkA, const FLA_Base_obj* blkB ) \
+{ \
+	dim_t k; \
+	dim_t order = blkA->order; \
+	const dim_t* size = blkA->size; \
+	const ctype* a = ( const ctype* ) blkA->buffer; \
+	const ctype* b = ( const ctype* ) blkB->buffer; \
+	dim_t index[FLA_MAX_ORDER]; \
+	TLA_sym sym; \
+	double sum = 0.0; \
+\
+	if( FLA_array_product( order, size ) == 0 ) \
+		return sum; \
+	if( TLA_Dot_block_is_contiguous( blkA ) && TLA_Dot_block_is_contiguous( blkB ) ) \
+		return TLA_Dot_run_##ch( FLA_array_product( order, size ), a, b ); \
+\
+	/* Unique entries of the packed one; every entry if neither is */ \
+	if( blkA->isPacked ) \
+		sym = blkA->packed_sym; \
+	else if( blkB->isPacked ) \
+		sym = blkB->packed_sym; \
+	else{ \
+		sym.order = order; \
+		sym.nSymGroups = order; \
+		for( k = 0; k < order; k++ ){ \
+			sym.symGroupLens[k] = 1; \
+			sym.symModes[k] = k; \
+		} \
+	} \
+\
+	memset( &(index[0]), 0, order * sizeof(dim_t) ); \
+	do{ \
+		size_t offA = 0, offB = 0; \
+		if( blkA->isPacked ) \
+			offA = TLA_packed_sym_offset( sym, size, index ); \
+		else \
+			for( k = 0; k < order; k++ ) \
+				offA += index[k] * blkA->stride[k]; \
+		if( blkB->isPacked ) \
+			offB = TLA_packed_sym_offset( sym, size, index ); \
+		else \
+			for( k = 0; k < order; k++ ) \
+				offB += index[k] * blkB->stride[k]; \
+		sum += ( double ) TLA_sym_index_multiplicity( sym, index ) * \
+		       ( double ) a[offA] * ( double ) b[offB]; \
+	}while( TLA_next_unique_index( sym, size, index ) ); \
+\
+	return sum; \
+}
+
+TLA_DOT_DEF( float, s )
+TLA_DOT_DEF( double, d )
+
+#undef TLA_DOT_DEF
+
+//One thread's range [first, last) of the blocks to visit
+typedef struct TLA_Dot_thread_s
+{
+	dim_t     id;
+	FLA_Obj   A;
+	FLA_Obj   B;
+	dim_t     first;
+	dim_t     last;
+	double    sum;
+#if defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+	pthread_t pthread_obj;
+#endif
+} TLA_Dot_thread_t;
+
+static void* TLA_Dot_thread_function( void* arg )
+{
+	TLA_Dot_thread_t* t = (TLA_Dot_thread_t*)arg;
+	TLA_unique_map* map = FLA_Obj_unique_map(t->A);
+	FLA_Obj* blksA = (FLA_Obj*)FLA_Obj_base_buffer(t->A);
+	FLA_Obj* blksB = (FLA_Obj*)FLA_Obj_base_buffer(t->B);
+	FLA_Datatype datatype = FLA_Obj_datatype(t->A);
+	dim_t u;
+
+	FLASH_Queue_bind_thread(t->id);
+	t->sum = 0.0;
+	for(u = t->first; u < t->last; u++){
+		dim_t linIndex = (map != NULL) ? map->uniqueLinIndex[u] : u;
+		double weight = (map != NULL) ? (double)(map->orbitSize[u]) : 1.0;
+		FLA_Base_obj* blkA = (blksA[linIndex]).base;
+		FLA_Base_obj* blkB = (blksB[linIndex]).base;
+
+		if(datatype == FLA_FLOAT)
+			t->sum += weight * TLA_Dot_block_s(blkA, blkB);
+		else
+			t->sum += weight * TLA_Dot_block_d(blkA, blkB);
+	}
+
+	return NULL;
+}
+
+//Sum of the products of the entries of A and B
+static double TLA_Dot_sum( FLA_Obj A, FLA_Obj B )
+{
+	dim_t i;
+	TLA_unique_map* map = FLA_Obj_unique_map(A);
+	dim_t nBlocks = (map != NULL) ? map->nUniques : FLA_array_product(FLA_Obj_order(A), (A.base)->size);
+	dim_t nThreads = tla_dot_n_threads;
+	TLA_Dot_thread_t* thread;
+	double sum = 0.0;
+
+	if(nThreads > nBlocks)
+		nThreads = (nBlocks > 0) ? nBlocks : 1;
+#ifndef FLA_ENABLE_MULTITHREADING
+	nThreads = 1;
+#endif
+
+	thread = (TLA_Dot_thread_t*)FLA_malloc(nThreads * sizeof(TLA_Dot_thread_t));
+	for(i = 0; i < nThreads; i++){
+		thread[i].id = i;
+		thread[i].A = A;
+		thread[i].B = B;
+		thread[i].first = nBlocks * i / nThreads;
+		thread[i].last = nBlocks * (i + 1) / nThreads;
+	}
+
+#if defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+	//The calling thread takes the first share
+	for(i = 1; i < nThreads; i++){
+		int r_val = pthread_create(&(thread[i].pthread_obj), NULL, TLA_Dot_thread_function, (void*)&thread[i]);
+		FLA_Check_error_code( FLA_Check_pthread_create_result( r_val ) );
+	}
+	TLA_Dot_thread_function((void*)&thread[0]);
+	for(i = 1; i < nThreads; i++){
+		int r_val = pthread_join(thread[i].pthread_obj, NULL);
+		FLA_Check_error_code( FLA_Check_pthread_join_result( r_val ) );
+	}
+#elif defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_OPENMP
+	#pragma omp parallel for num_threads(nThreads) schedule(static, 1)
+	for(i = 0; i < nThreads; i++)
+		TLA_Dot_thread_function((void*)&thread[i]);
+#else
+	for(i = 0; i < nThreads; i++)
+		TLA_Dot_thread_function((void*)&thread[i]);
+#endif
+
+	for(i = 0; i < nThreads; i++)
+		sum += thread[i].sum;
+	FLA_free(thread);
+
+	return sum;
+}
+
+//Only real blocked tensors of the same shape, both psym with the same
+//symmetry or neither
+static FLA_Error TLA_Dot_check( FLA_Obj A, FLA_Obj B )
+{
+	dim_t k;
+	dim_t order = FLA_Obj_order(A);
+	FLA_Datatype datatype = FLA_Obj_datatype(A);
+	TLA_unique_map* mapA = FLA_Obj_unique_map(A);
+	TLA_unique_map* mapB = FLA_Obj_unique_map(B);
+	FLA_Obj* blksA;
+	FLA_Obj* blksB;
+
+	if(datatype != FLA_FLOAT && datatype != FLA_DOUBLE)
+		return FLA_FAILURE;
+	if(FLA_Obj_datatype(B) != datatype || FLA_Obj_order(B) != order)
+		return FLA_FAILURE;
+	if(FLA_Obj_elemtype(A) == FLA_SCALAR || FLA_Obj_elemtype(B) == FLA_SCALAR)
+		return FLA_FAILURE;
+	if((mapA == NULL) != (mapB == NULL))
+		return FLA_FAILURE;
+
+	blksA = (FLA_Obj*)FLA_Obj_base_buffer(A);
+	blksB = (FLA_Obj*)FLA_Obj_base_buffer(B);
+	for(k = 0; k < order; k++)
+		if((A.base)->size[k] != (B.base)->size[k] ||
+		   (blksA[0].base)->size[k] != (blksB[0].base)->size[k])
+			return FLA_FAILURE;
+
+	if(mapA != NULL){
+		if(A.sym.nSymGroups != B.sym.nSymGroups)
+			return FLA_FAILURE;
+		for(k = 0; k < A.sym.nSymGroups; k++)
+			if(A.sym.symGroupLens[k] != B.sym.symGroupLens[k])
+				return FLA_FAILURE;
+		for(k = 0; k < order; k++)
+			if(A.sym.symModes[k] != B.sym.symModes[k])
+				return FLA_FAILURE;
+	}
+	return FLA_SUCCESS;
+}
+
+//rho := sum of the products of the entries of the blocked (psym) tensors A
+//and B
+FLA_Error TLA_Dot( FLA_Obj A, FLA_Obj B, FLA_Obj rho )
+{
+	double sum;
+
+	if(TLA_Dot_check(A, B) != FLA_SUCCESS || FLA_Obj_datatype(rho) != FLA_Obj_datatype(A))
+		return FLA_FAILURE;
+
+	sum = TLA_Dot_sum(A, B);
+	if(FLA_Obj_datatype(rho) == FLA_FLOAT)
+		*((float*)FLA_Obj_buffer_at_view(rho)) = (float)sum;
+	else
+		*((double*)FLA_Obj_buffer_at_view(rho)) = sum;
+
+	return FLA_SUCCESS;
+}
+
+//norm := Frobenius norm of the blocked (psym) tensor A
+FLA_Error TLA_Norm_frob( FLA_Obj A, FLA_Obj norm )
+{
+	double sum;
+
+	if(TLA_Dot_check(A, A) != FLA_SUCCESS || FLA_Obj_datatype(norm) != FLA_Obj_datatype(A))
+		return FLA_FAILURE;
+
+	sum = sqrt(TLA_Dot_sum(A, A));
+	if(FLA_Obj_datatype(norm) == FLA_FLOAT)
+		*((float*)FLA_Obj_buffer_at_view(norm)) = (float)sum;
+	else
+		*((double*)FLA_Obj_buffer_at_view(norm)) = sum;
+
+	return FLA_SUCCESS;
+}
@@ -0,0 +1,497 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+
+//Matricized tensor times Khatri-Rao product of a blocked (psym) tensor,
+//M(i, r) = sum of A(..., i, ...) prod_k U_k(i_k, r) over the modes k but mode.
+//
+//The blocks of A are streamed without forming the Khatri-Rao product: each
+//fiber of mode 0 (contiguous in every block) is contracted with the row of
+//it selected by the other modes, kept as partial products over modes k..
+//(the rows of U_k times those of the modes above).  Moving to the next fiber
+//only recomputes the partial products of the modes whose index changed.
+//
+//Modes of a sym group of A share the factor of the first mode of the group,
+//so only unique blocks are read: a unique block stands for its orbit, and the
+//share count / len of the orbit puts each block index held by count of the
+//len modes of the group of mode at mode (as in TLA_Sttv_all_but_one).  Packed
+//diagonal blocks are walked by unique entry the same way.
+
+//Kernels of one real datatype.  Scratch w holds the partial Khatri-Rao rows,
+//rank entries for each mode and one for the scale
+#define TLA_MTTKRP_DEF( ctype, ch ) \
+\
+static ctype TLA_Mttkrp_dot_##ch( dim_t n, const ctype* a, const ctype* u, dim_t inc ) \
+{ \
+	ctype s0 = 0, s1 = 0, s2 = 0, s3 = 0; \
+	dim_t i; \
+	if( inc == 1 ){ \
+		for( i = 0; i + 4 <= n; i += 4 ){ \
+			s0 += a[i]   * u[i]; \
+			s1 += a[i+1] * u[i+1]; \
+			s2 += a[i+2] * u[i+2]; \
+			s3 += a[i+3] * u[i+3]; \
+		} \
+		for( ; i < n; i++ ) \
+			s0 += a[i] * u[i]; \
+	}else{ \
+		for( i = 0; i < n; i++ ) \
+			s0 += a[i] * u[i * inc]; \
+	} \
+	return ( s0 + s1 ) + ( s2 + s3 ); \
+} \
+\
+/* Dense block a contracted with the rows of U[k] (at the first row of the */ \
+/* block, strides rs_U[k]/cs_U[k]) along every mode but p, scaled by scale */ \
+/* and added to the rows Mz of M along p */ \
+static void TLA_Mttkrp_block_##ch( dim_t order, dim_t rank, const ctype* a, const dim_t size[], const dim_t stride[], \
+                                   const ctype* U[], const dim_t rs_U[], const dim_t cs_U[], dim_t p, ctype scale, \
+                                   ctype* Mz, dim_t rs_M, dim_t cs_M, ctype* w ) \
+{ \
+	dim_t i, k, r; \
+	dim_t index[FLA_MAX_ORDER]; \
+	size_t off = 0; \
+\
+	if( FLA_array_product( order, size ) == 0 ) \
+		return; \
+\
+	/* w + k * rank: partial Khatri-Rao row of modes k.. */ \
+	for( r = 0; r < rank; r++ ) \
+		w[order * rank + r] = scale; \
+	for( k = order - 1; k > 0; k-- ){ \
+		index[k] = 0; \
+		for( r = 0; r < rank; r++ ) \
+			w[k * rank + r] = ( k == p ? w[(k+1) * rank + r] : w[(k+1) * rank + r] * U[k][r * cs_U[k]] ); \
+	} \
+	while( TRUE ){ \
+		const ctype* fiber = a + off; \
+		const ctype* kr = w + rank; \
+		if( p == 0 ){ \
+			for( r = 0; r < rank; r++ ){ \
+				ctype c = kr[r]; \
+				ctype* Mr = Mz + r * cs_M; \
+				if( rs_M == 1 ) \
+					for( i = 0; i < size[0]; i++ ) \
+						Mr[i] += c * fiber[i]; \
+				else \
+					for( i = 0; i < size[0]; i++ ) \
+						Mr[i * rs_M] += c * fiber[i]; \
+			} \
+		}else{ \
+			ctype* Mi = Mz + index[p] * rs_M; \
+			for( r = 0; r < rank; r++ ) \
+				Mi[r * cs_M] += kr[r] * TLA_Mttkrp_dot_##ch( size[0], fiber, U[0] + r * cs_U[0], rs_U[0] ); \
+		} \
+\
+		/* Next fiber, mode 1 fastest */ \
+		for( k = 1; k < order; k++ ){ \
+			off += stride[k]; \
+			if( ++index[k] < size[k] ) \
+				break; \
+			off -= stride[k] * size[k]; \
+			index[k] = 0; \
+		} \
+		if( k == order ) \
+			break; \
+		for( ; k > 0; k-- ){ \
+			const ctype* Uk = U[k] + index[k] * rs_U[k]; \
+			for( r = 0; r < rank; r++ ) \
+				w[k * rank + r] = ( k == p ? w[(k+1) * rank + r] : w[(k+1) * rank + r] * Uk[r * cs_U[k]] ); \
+		} \
+	} \
+} \
+\
+/* TLA_Mttkrp_block for a packed diagonal block (see TLA_Pack_sym_block) */ \
+static void TLA_Mttkrp_packed_block_##ch( const FLA_Base_obj* blk, dim_t rank, \
+                                          const ctype* U[], const dim_t rs_U[], const dim_t cs_U[], dim_t p, ctype scale, \
+                                          ctype* Mz, dim_t rs_M, dim_t cs_M ) \
+{ \
+	dim_t j, k, r; \
+	dim_t order = blk->order; \
+	TLA_sym sym = blk->packed_sym; \
+	const dim_t* size = blk->size; \
+	const ctype* a = ( const ctype* ) blk->buffer; \
+	dim_t index[FLA_MAX_ORDER]; \
+	dim_t group = TLA_sym_group_of_mode( sym, p ); \
+	dim_t groupOffset = TLA_sym_group_mode_offset( sym, group ); \
+	dim_t len = sym.symGroupLens[group]; \
+\
+	if( FLA_array_product( order, size ) == 0 ) \
+		return; \
+\
+	memset( &(index[0]), 0, order * sizeof(dim_t) ); \
+	do{ \
+		dim_t mult = TLA_sym_index_multiplicity( sym, index ); \
+		ctype v = scale * a[TLA_packed_sym_offset( sym, size, index )]; \
+\
+		/* Of the orbit, a share count / len has each value of the group */ \
+		/* of p at p; leave out U for one mode holding it */ \
+		for( j = 0; j < len; j++ ){ \
+			dim_t count = TLA_sym_value_count( sym, group, j, index ); \
+			dim_t q = sym.symModes[groupOffset + j]; \
+			ctype* Mi = Mz + index[q] * rs_M; \
+			ctype c; \
+			if( count == 0 ) \
+				continue; \
+			c = v * ( ctype )( mult * count / len ); \
+			for( r = 0; r < rank; r++ ){ \
+				ctype u = c; \
+				for( k = 0; k < order; k++ ) \
+					if( k != q ) \
+						u *= U[k][index[k] * rs_U[k] + r * cs_U[k]]; \
+				Mi[r * cs_M] += u; \
+			} \
+		} \
+	}while( TLA_next_unique_index( sym, size, index ) ); \
+} \
+\
+/* M := 0, then the contributions of the (unique) blocks of A.  U[k], */ \
+/* rs_U[k] and cs_U[k] give the factor of mode k */ \
+static void TLA_Mttkrp_##ch( FLA_Obj A, TLA_sym sym, dim_t rank, const ctype* U[], const dim_t rs_U[], const dim_t cs_U[], \
+                             dim_t mode, ctype* M, dim_t m_M, dim_t rs_M, dim_t cs_M ) \
+{ \
+	dim_t i, j, k; \
+	dim_t order = FLA_Obj_order( A ); \
+	TLA_unique_map* map = FLA_Obj_unique_map( A ); \
+	FLA_Obj* blks = ( FLA_Obj* ) FLA_Obj_base_buffer( A ); \
+	dim_t group = TLA_sym_group_of_mode( sym, mode ); \
+	dim_t groupOffset = TLA_sym_group_mode_offset( sym, group ); \
+	dim_t len = sym.symGroupLens[group]; \
+	dim_t index[FLA_MAX_ORDER]; \
+	dim_t blkIndex[FLA_MAX_ORDER]; \
+	const ctype* Ub[FLA_MAX_ORDER]; \
+	ctype* w = ( ctype* ) FLA_malloc( ( order + 1 ) * rank * sizeof( ctype ) ); \
+	dim_t u = 0; \
+\
+	for( j = 0; j < rank; j++ ) \
+		for( i = 0; i < m_M; i++ ) \
+			M[i * rs_M + j * cs_M] = 0; \
+\
+	memset( &(index[0]), 0, order * sizeof(dim_t) ); \
+	do{ \
+		dim_t linIndex; \
+		dim_t orbitSize = ( map != NULL ) ? map->orbitSize[u] : 1; \
+		FLA_Base_obj* blk; \
+\
+		/* Blocks of a view of a plain tensor are found past its offset */ \
+		if( map != NULL ) \
+			linIndex = map->uniqueLinIndex[u]; \
+		else{ \
+			for( k = 0; k < order; k++ ) \
+				blkIndex[k] = index[k] + A.offset[k]; \
+			linIndex = FLA_TIndex_to_LinIndex( order, (A.base)->stride, blkIndex ); \
+		} \
+		blk = ( blks[linIndex] ).base; \
+\
+		for( k = 0; k < order; k++ ) \
+			Ub[k] = ( U[k] != NULL ? U[k] + index[k] * blk->size[k] * rs_U[k] : NULL ); \
+\
+		for( j = 0; j < len; j++ ){ \
+			dim_t count = TLA_sym_value_count( sym, group, j, index ); \
+			dim_t p = sym.symModes[groupOffset + j]; \
+			ctype scale; \
+			ctype* Mz = M + index[p] * blk->size[p] * rs_M; \
+			if( count == 0 ) \
+				continue; \
+			scale = ( ctype )( orbitSize * count / len ); \
+			if( blk->isPacked ) \
+				TLA_Mttkrp_packed_block_##ch( blk, rank, Ub, rs_U, cs_U, p, scale, Mz, rs_M, cs_M ); \
+			else \
+				TLA_Mttkrp_block_##ch( order, rank, ( const ctype* ) blk->buffer, blk->size, blk->stride, \
+				                       Ub, rs_U, cs_U, p, scale, Mz, rs_M, cs_M, w ); \
+		} \
+		u++; \
+	}while( TLA_next_unique_index( sym, A.size, index ) ); \
+\
+	FLA_free( w ); \
+} \
+\
+/* Dense block a contracted for every mode at once: M[p] gets the block's */ \
+/* share of the mttkrp of mode p.  Each fiber of mode 0 is contracted with */ \
+/* the rows of U[0] once (t) for all modes p > 0, and the partial */ \
+/* Khatri-Rao rows below p (pre) and above it (w, as in TLA_Mttkrp_block) */ \
+/* are shared by the modes */ \
+static void TLA_Mttkrp_all_block_##ch( dim_t order, dim_t rank, const ctype* a, const dim_t size[], const dim_t stride[], \
+                                       const ctype* U[], const dim_t rs_U[], const dim_t cs_U[], \
+                                       ctype* M[], const dim_t rs_M[], const dim_t cs_M[], ctype* w ) \
+{ \
+	dim_t i, k, r; \
+	dim_t index[FLA_MAX_ORDER]; \
+	size_t off = 0; \
+	ctype* t = w + ( order + 1 ) * rank; \
+	ctype* pre = t + rank; \
+\
+	if( FLA_array_product( order, size ) == 0 ) \
+		return; \
+\
+	for( r = 0; r < rank; r++ ) \
+		w[order * rank + r] = 1; \
+	for( k = order - 1; k > 0; k-- ){ \
+		index[k] = 0; \
+		for( r = 0; r < rank; r++ ) \
+			w[k * rank + r] = w[(k+1) * rank + r] * U[k][r * cs_U[k]]; \
+	} \
+	while( TRUE ){ \
+		const ctype* fiber = a + off; \
+\
+		/* Mode 0: the fiber scaled by the Khatri-Rao row of the others */ \
+		for( r = 0; r < rank; r++ ){ \
+			ctype c = w[rank + r]; \
+			ctype* Mr = M[0] + r * cs_M[0]; \
+			for( i = 0; i < size[0]; i++ ) \
+				Mr[i * rs_M[0]] += c * fiber[i]; \
+		} \
+\
+		/* Modes p > 0: t times the rows of the modes but 0 and p */ \
+		for( r = 0; r < rank; r++ ){ \
+			t[r] = TLA_Mttkrp_dot_##ch( size[0], fiber, U[0] + r * cs_U[0], rs_U[0] ); \
+			pre[r] = t[r]; \
+		} \
+		for( k = 1; k < order; k++ ){ \
+			const ctype* Uk = U[k] + index[k] * rs_U[k]; \
+			ctype* Mi = M[k] + index[k] * rs_M[k]; \
+			for( r = 0; r < rank; r++ ){ \
+				Mi[r * cs_M[k]] += pre[r] * w[(k+1) * rank + r]; \
+				pre[r] *= Uk[r * cs_U[k]]; \
+			} \
+		} \
+\
+		/* Next fiber, mode 1 fastest */ \
+		for( k = 1; k < order; k++ ){ \
+			off += stride[k]; \
+			if( ++index[k] < size[k] ) \
+				break; \
+			off -= stride[k] * size[k]; \
+			index[k] = 0; \
+		} \
+		if( k == order ) \
+			break; \
+		for( ; k > 0; k-- ){ \
+			const ctype* Uk = U[k] + index[k] * rs_U[k]; \
+			for( r = 0; r < rank; r++ ) \
+				w[k * rank + r] = w[(k+1) * rank + r] * Uk[r * cs_U[k]]; \
+		} \
+	} \
+} \
+\
+/* M[k] := 0, then the contributions of every block of the plain blocked */ \
+/* tensor A to all modes */ \
+static void TLA_Mttkrp_all_##ch( FLA_Obj A, dim_t rank, const ctype* U[], const dim_t rs_U[], const dim_t cs_U[], \
+                                 ctype* M[], const dim_t m_M[], const dim_t rs_M[], const dim_t cs_M[] ) \
+{ \
+	dim_t i, j, k; \
+	dim_t order = FLA_Obj_order( A ); \
+	FLA_Obj* blks = ( FLA_Obj* ) FLA_Obj_base_buffer( A ); \
+	dim_t index[FLA_MAX_ORDER]; \
+	dim_t blkIndex[FLA_MAX_ORDER]; \
+	const ctype* Ub[FLA_MAX_ORDER]; \
+	ctype* Mb[FLA_MAX_ORDER]; \
+	ctype* w = ( ctype* ) FLA_malloc( ( order + 3 ) * rank * sizeof( ctype ) ); \
+\
+	for( k = 0; k < order; k++ ) \
+		for( j = 0; j < rank; j++ ) \
+			for( i = 0; i < m_M[k]; i++ ) \
+				M[k][i * rs_M[k] + j * cs_M[k]] = 0; \
+	if( FLA_array_product( order, A.size ) == 0 ){ \
+		FLA_free( w ); \
+		return; \
+	} \
+\
+	memset( &(index[0]), 0, order * sizeof(dim_t) ); \
+	do{ \
+		FLA_Base_obj* blk; \
+\
+		for( k = 0; k < order; k++ ) \
+			blkIndex[k] = index[k] + A.offset[k]; \
+		blk = ( blks[FLA_TIndex_to_LinIndex( order, (A.base)->stride, blkIndex )] ).base; \
+		for( k = 0; k < order; k++ ){ \
+			Ub[k] = U[k] + index[k] * blk->size[k] * rs_U[k]; \
+			Mb[k] = M[k] + index[k] * blk->size[k] * rs_M[k]; \
+		} \
+		TLA_Mttkrp_all_block_##ch( order, rank, ( const ctype* ) blk->buffer, blk->size, blk->stride, \
+		                           Ub, rs_U, cs_U, Mb, rs_M, cs_M, w ); \
+\
+		for( k = 0; k < order; k++ ) \
+			if( ++index[k] < A.size[k] ) \
+				break; \
+			else \
+				index[k] = 0; \
+	}while( k < order ); \
+\
+	FLA_free( w ); \
+}
+
+TLA_MTTKRP_DEF( float, s )
+TLA_MTTKRP_DEF( double, d )
+
+#undef TLA_MTTKRP_DEF
+
+//M := A_(mode) (U_{order-1} kr ... kr U_0, U_mode left out), with U_k the
+//matrix factors[k] of A's flat size along k by rank, and M the flat size
+//along mode by rank.  A is a blocked tensor, or a blocked psym tensor whose
+//modes share the factor of the first mode of their sym group
+FLA_Error TLA_Mttkrp( FLA_Obj A, const FLA_Obj factors[], dim_t mode, FLA_Obj M )
+{
+	dim_t k;
+	dim_t order = FLA_Obj_order(A);
+	FLA_Datatype datatype = FLA_Obj_datatype(A);
+	dim_t rank = FLA_Obj_width(M);
+	FLA_Obj* blks = (FLA_Obj*)FLA_Obj_base_buffer(A);
+	TLA_sym sym;
+	void* U[FLA_MAX_ORDER];
+	dim_t rs_U[FLA_MAX_ORDER];
+	dim_t cs_U[FLA_MAX_ORDER];
+
+	if(datatype != FLA_FLOAT && datatype != FLA_DOUBLE)
+		return FLA_FAILURE;
+	if(FLA_Obj_elemtype(A) == FLA_SCALAR || mode >= order || FLA_Obj_datatype(M) != datatype)
+		return FLA_FAILURE;
+	if(FLA_Obj_length(M) != A.size[mode] * (blks[0].base)->size[mode])
+		return FLA_FAILURE;
+
+	//Plain blocked tensors: every block is stored, no mode shares a factor
+	if(FLA_Obj_unique_map(A) != NULL)
+		sym = A.sym;
+	else{
+		sym.order = order;
+		sym.nSymGroups = order;
+		for(k = 0; k < order; k++){
+			sym.symGroupLens[k] = 1;
+			sym.symModes[k] = k;
+		}
+	}
+
+	for(k = 0; k < order; k++){
+		dim_t group = TLA_sym_group_of_mode(sym, k);
+		FLA_Obj Uk = factors[sym.symModes[TLA_sym_group_mode_offset(sym, group)]];
+
+		//The factor of mode is only read if another mode shares it
+		if(k == mode && sym.symGroupLens[group] == 1){
+			U[k] = NULL;
+			rs_U[k] = 0;
+			cs_U[k] = 0;
+			continue;
+		}
+		if(FLA_Obj_datatype(Uk) != datatype || FLA_Obj_width(Uk) != rank ||
+		   FLA_Obj_length(Uk) != A.size[k] * (blks[0].base)->size[k])
+			return FLA_FAILURE;
+		U[k] = FLA_Obj_buffer_at_view(Uk);
+		rs_U[k] = FLA_Obj_row_stride(Uk);
+		cs_U[k] = FLA_Obj_col_stride(Uk);
+	}
+
+	if(datatype == FLA_FLOAT)
+		TLA_Mttkrp_s(A, sym, rank, (const float**)U, rs_U, cs_U, mode,
+		             (float*)FLA_Obj_buffer_at_view(M), FLA_Obj_length(M), FLA_Obj_row_stride(M), FLA_Obj_col_stride(M));
+	else
+		TLA_Mttkrp_d(A, sym, rank, (const double**)U, rs_U, cs_U, mode,
+		             (double*)FLA_Obj_buffer_at_view(M), FLA_Obj_length(M), FLA_Obj_row_stride(M), FLA_Obj_col_stride(M));
+
+	return FLA_SUCCESS;
+}
+
+//M[k] := A_(k) (U_{order-1} kr ... kr U_0, U_k left out) for every mode k of
+//A at once, with factors and A as in TLA_Mttkrp and M[k] the flat size along
+//k by rank.  For a plain blocked tensor the blocks are streamed once: the
+//contraction of each fiber of mode 0 with U_0 and the partial Khatri-Rao
+//rows are shared by all modes.  Modes of a sym group of a psym tensor share
+//their result, so it is computed once per group (by TLA_Mttkrp) and copied
+FLA_Error TLA_Mttkrp_all( FLA_Obj A, const FLA_Obj factors[], FLA_Obj M[] )
+{
+	dim_t k;
+	dim_t order = FLA_Obj_order(A);
+	FLA_Datatype datatype = FLA_Obj_datatype(A);
+	dim_t rank;
+	FLA_Obj* blks = (FLA_Obj*)FLA_Obj_base_buffer(A);
+	void* U[FLA_MAX_ORDER];
+	dim_t rs_U[FLA_MAX_ORDER];
+	dim_t cs_U[FLA_MAX_ORDER];
+	void* Mbuf[FLA_MAX_ORDER];
+	dim_t m_M[FLA_MAX_ORDER];
+	dim_t rs_M[FLA_MAX_ORDER];
+	dim_t cs_M[FLA_MAX_ORDER];
+
+	if(datatype != FLA_FLOAT && datatype != FLA_DOUBLE)
+		return FLA_FAILURE;
+	if(FLA_Obj_elemtype(A) == FLA_SCALAR || order == 0)
+		return FLA_FAILURE;
+
+	if(FLA_Obj_unique_map(A) != NULL){
+		TLA_sym sym = A.sym;
+		dim_t g, j;
+		dim_t offset = 0;
+
+		for(g = 0; g < sym.nSymGroups; g++){
+			dim_t p = sym.symModes[offset];
+
+			if(TLA_Mttkrp(A, factors, p, M[p]) != FLA_SUCCESS)
+				return FLA_FAILURE;
+			for(j = 1; j < sym.symGroupLens[g]; j++){
+				dim_t q = sym.symModes[offset + j];
+
+				if(FLA_Obj_datatype(M[q]) != datatype || FLA_Obj_width(M[q]) != FLA_Obj_width(M[p]) ||
+				   FLA_Obj_length(M[q]) != FLA_Obj_length(M[p]))
+					return FLA_FAILURE;
+				FLA_Copy(M[p], M[q]);
+			}
+			offset += sym.symGroupLens[g];
+		}
+		return FLA_SUCCESS;
+	}
+
+	rank = FLA_Obj_width(M[0]);
+	for(k = 0; k < order; k++){
+		dim_t n_k = A.size[k] * (blks[0].base)->size[k];
+
+		if(FLA_Obj_datatype(factors[k]) != datatype || FLA_Obj_width(factors[k]) != rank ||
+		   FLA_Obj_length(factors[k]) != n_k)
+			return FLA_FAILURE;
+		if(FLA_Obj_datatype(M[k]) != datatype || FLA_Obj_width(M[k]) != rank ||
+		   FLA_Obj_length(M[k]) != n_k)
+			return FLA_FAILURE;
+		U[k] = FLA_Obj_buffer_at_view(factors[k]);
+		rs_U[k] = FLA_Obj_row_stride(factors[k]);
+		cs_U[k] = FLA_Obj_col_stride(factors[k]);
+		Mbuf[k] = FLA_Obj_buffer_at_view(M[k]);
+		m_M[k] = n_k;
+		rs_M[k] = FLA_Obj_row_stride(M[k]);
+		cs_M[k] = FLA_Obj_col_stride(M[k]);
+	}
+
+	if(datatype == FLA_FLOAT)
+		TLA_Mttkrp_all_s(A, rank, (const float**)U, rs_U, cs_U, (float**)Mbuf, m_M, rs_M, cs_M);
+	else
+		TLA_Mttkrp_all_d(A, rank, (const double**)U, rs_U, cs_U, (double**)Mbuf, m_M, rs_M, cs_M);
+
+	return FLA_SUCCESS;
+}
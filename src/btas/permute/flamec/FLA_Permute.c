@@ -34,6 +34,7 @@
 
 
 //FLAME way of permuting.... Very slow
+//Only used as a fallback by FLA_Permute (see FLA_Permute_blocked)
 FLA_Error FLA_Permute_helper(FLA_Obj A, const dim_t permutation[], FLA_Obj B, dim_t repart_mode_index){
 	dim_t repartModeA = A.permutation[permutation[repart_mode_index]];
 	dim_t repartModeB = repart_mode_index;
@@ -80,6 +81,7 @@ FLA_Error FLA_Permute_helper(FLA_Obj A, const dim_t permutation[], FLA_Obj B, di
 
 
 //Permutes a tensor via permutation (loop-based)
+//Reference implementation, superseded by FLA_Permute_blocked
 FLA_Error FLA_Permute_single( FLA_Obj A, const dim_t permutation[], FLA_Obj* B){
 	dim_t i;
 
@@ -89,8 +91,9 @@ FLA_Error FLA_Permute_single( FLA_Obj A, const dim_t permutation[], FLA_Obj* B){
 	dim_t stride_B[FLA_MAX_ORDER];
 	dim_t size_A[FLA_MAX_ORDER];
 	dim_t size_B[FLA_MAX_ORDER];
-	double* buf_A;
-	double* buf_B;
+	size_t elem_size = (size_t)FLA_Obj_elem_size(A);
+	char* buf_A;
+	char* buf_B;
 	
 	//Inverse Permutation data
 	dim_t ipermutation[FLA_MAX_ORDER];
@@ -112,8 +115,8 @@ FLA_Error FLA_Permute_single( FLA_Obj A, const dim_t permutation[], FLA_Obj* B){
 	for(i = 0; i < A.order; i++)
 		ipermutation[permutation[i]] = i;
 	
-	buf_A = (double*)FLA_Obj_base_buffer(A);
-	buf_B = (double*)FLA_Obj_base_buffer(*B);
+	buf_A = (char*)FLA_Obj_base_buffer(A);
+	buf_B = (char*)FLA_Obj_base_buffer(*B);
 	
     //Init loop data
 	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
@@ -124,7 +127,7 @@ FLA_Error FLA_Permute_single( FLA_Obj A, const dim_t permutation[], FLA_Obj* B){
 	//Loop over all entries, and explicitly permute the data
     while(TRUE){
 		//Calculate linear index fro and to
-		buf_B[linIndexTo] = buf_A[linIndexFro];
+		memcpy(buf_B + linIndexTo * elem_size, buf_A + linIndexFro * elem_size, elem_size);
 		
 		//Update index pointer and linIndices Fro and To
 		curIndex[updatePtr]++;
@@ -176,6 +179,9 @@ FLA_Error FLA_Permute(FLA_Obj A, const dim_t permutation[], FLA_Obj* B){
 	}
 	FLA_Set_tensor_stride(order, B->size, B->base->stride);
 
-	return FLA_Permute_single(A, full_perm, B);
+	if(FLA_Permute_blocked(A, full_perm, *B) == FLA_SUCCESS)
+		return FLA_SUCCESS;
+
+	return FLA_Permute_helper(A, permutation, *B, order - 1);
 }	
 
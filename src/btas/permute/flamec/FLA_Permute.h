@@ -33,3 +33,4 @@
 #include "FLAME.h"
 
 FLA_Error FLA_Permute(FLA_Obj A, const dim_t permutation[], FLA_Obj* B);
+FLA_Error FLA_Permute_blocked(FLA_Obj A, const dim_t permutation[], FLA_Obj B);
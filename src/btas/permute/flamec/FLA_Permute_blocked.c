@@ -0,0 +1,328 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLA_Permute.h"
+
+//Edge length (in elements) of the square tiles used when the fast modes of
+//A and B differ.  Two 32x32 double tiles fit comfortably in L1.
+#define FLA_PERMUTE_TILE 32
+
+//Description of a (collapsed) loop of the permutation.
+//n: extent, a: stride in A, b: stride in B (in elements)
+typedef struct{
+	dim_t n;
+	dim_t a;
+	dim_t b;
+} FLA_Permute_loop;
+
+static int compare_permute_loop(const void* x, const void* y){
+	const FLA_Permute_loop* l = (const FLA_Permute_loop*)x;
+	const FLA_Permute_loop* r = (const FLA_Permute_loop*)y;
+	dim_t costL = l->a + l->b;
+	dim_t costR = r->a + r->b;
+	return (costL > costR) - (costL < costR);
+}
+
+// --- Tile kernels ------------------------------------------------------------
+//Each kernel performs B[i + j*ldb] = A[i*lda + j*ak] for an m x n tile.
+//i is the fast mode of B, j the fast mode of A.
+
+#define FLA_PERMUTE_TILE_GENERIC( ctype, name ) \
+static void name( dim_t m, dim_t n, const ctype* a, dim_t lda, dim_t ak, ctype* b, dim_t ldb ) \
+{ \
+	dim_t i, j; \
+	for( j = 0; j < n; j++ ) \
+		for( i = 0; i < m; i++ ) \
+			b[i + j*ldb] = a[i*lda + j*ak]; \
+}
+
+FLA_PERMUTE_TILE_GENERIC( float,            FLA_Permute_tile_s_ref )
+FLA_PERMUTE_TILE_GENERIC( double,           FLA_Permute_tile_d_ref )
+FLA_PERMUTE_TILE_GENERIC( dcomplex,         FLA_Permute_tile_z_ref )
+
+#if FLA_VECTOR_INTRINSIC_TYPE == FLA_SSE_INTRINSICS
+
+//4x4 in-register transposes.  Data is only moved, never computed on, so any
+//4-byte element may go through the float path.
+static void FLA_Permute_tile_s( dim_t m, dim_t n, const float* a, dim_t lda, dim_t ak, float* b, dim_t ldb )
+{
+	dim_t i, j;
+	dim_t m4 = m & ~3u;
+	dim_t n4 = n & ~3u;
+
+	if( ak != 1 ){
+		FLA_Permute_tile_s_ref( m, n, a, lda, ak, b, ldb );
+		return;
+	}
+
+	for( j = 0; j < n4; j += 4 ){
+		for( i = 0; i < m4; i += 4 ){
+			__m128 r0 = _mm_loadu_ps( a + (i+0)*lda + j );
+			__m128 r1 = _mm_loadu_ps( a + (i+1)*lda + j );
+			__m128 r2 = _mm_loadu_ps( a + (i+2)*lda + j );
+			__m128 r3 = _mm_loadu_ps( a + (i+3)*lda + j );
+			_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+			_mm_storeu_ps( b + i + (j+0)*ldb, r0 );
+			_mm_storeu_ps( b + i + (j+1)*ldb, r1 );
+			_mm_storeu_ps( b + i + (j+2)*ldb, r2 );
+			_mm_storeu_ps( b + i + (j+3)*ldb, r3 );
+		}
+	}
+	//Fringes
+	if( m4 < m )
+		FLA_Permute_tile_s_ref( m - m4, n4, a + m4*lda, lda, 1, b + m4, ldb );
+	if( n4 < n )
+		FLA_Permute_tile_s_ref( m, n - n4, a + n4, lda, 1, b + n4*ldb, ldb );
+}
+
+//2x2 in-register transposes.  Also used for scomplex (8-byte elements).
+static void FLA_Permute_tile_d( dim_t m, dim_t n, const double* a, dim_t lda, dim_t ak, double* b, dim_t ldb )
+{
+	dim_t i, j;
+	dim_t m2 = m & ~1u;
+	dim_t n2 = n & ~1u;
+
+	if( ak != 1 ){
+		FLA_Permute_tile_d_ref( m, n, a, lda, ak, b, ldb );
+		return;
+	}
+
+	for( j = 0; j < n2; j += 2 ){
+		for( i = 0; i < m2; i += 2 ){
+			__m128d r0 = _mm_loadu_pd( a + (i+0)*lda + j );
+			__m128d r1 = _mm_loadu_pd( a + (i+1)*lda + j );
+			_mm_storeu_pd( b + i + (j+0)*ldb, _mm_unpacklo_pd( r0, r1 ) );
+			_mm_storeu_pd( b + i + (j+1)*ldb, _mm_unpackhi_pd( r0, r1 ) );
+		}
+	}
+	//Fringes
+	if( m2 < m )
+		FLA_Permute_tile_d_ref( m - m2, n2, a + m2*lda, lda, 1, b + m2, ldb );
+	if( n2 < n )
+		FLA_Permute_tile_d_ref( m, n - n2, a + n2, lda, 1, b + n2*ldb, ldb );
+}
+
+#else
+
+#define FLA_Permute_tile_s FLA_Permute_tile_s_ref
+#define FLA_Permute_tile_d FLA_Permute_tile_d_ref
+
+#endif
+
+//Copies one m x n tile, dispatching on element size
+static void FLA_Permute_tile( size_t elem_size, dim_t m, dim_t n, const char* a, dim_t lda, dim_t ak, char* b, dim_t ldb )
+{
+	dim_t i, j;
+
+	switch( elem_size ){
+	case sizeof(float):
+		FLA_Permute_tile_s( m, n, (const float*)a, lda, ak, (float*)b, ldb );
+		break;
+	case sizeof(double):
+		FLA_Permute_tile_d( m, n, (const double*)a, lda, ak, (double*)b, ldb );
+		break;
+	case sizeof(dcomplex):
+		FLA_Permute_tile_z_ref( m, n, (const dcomplex*)a, lda, ak, (dcomplex*)b, ldb );
+		break;
+	default:
+		for( j = 0; j < n; j++ )
+			for( i = 0; i < m; i++ )
+				memcpy( b + (i + j*ldb)*elem_size, a + (i*lda + j*ak)*elem_size, elem_size );
+	}
+}
+
+//Copies one run: m elements (memcpyRuns) or an m x n block of tiles
+static void FLA_Permute_run( FLA_Bool memcpyRuns, size_t elem_size,
+                             dim_t m, dim_t lda, dim_t n, dim_t ak, dim_t ldb,
+                             const char* a, char* b )
+{
+	dim_t ii, jj;
+
+	if( memcpyRuns ){
+		memcpy( b, a, m * elem_size );
+		return;
+	}
+	for( jj = 0; jj < n; jj += FLA_PERMUTE_TILE ){
+		dim_t nb = min( FLA_PERMUTE_TILE, n - jj );
+		for( ii = 0; ii < m; ii += FLA_PERMUTE_TILE ){
+			dim_t mb = min( FLA_PERMUTE_TILE, m - ii );
+			FLA_Permute_tile( elem_size, mb, nb,
+			                  a + (ii*lda + jj*ak) * elem_size, lda, ak,
+			                  b + (ii + jj*ldb) * elem_size, ldb );
+		}
+	}
+}
+
+//Odometer over the order - 1 outer loops of a tensor of order ORDER, one run
+//per step.  Instantiated for orders 2-6 (see TLA_ORDER_INSTANTIATE)
+#define FLA_PERMUTE_OUTER_DEF( name, ORDER ) \
+static void name( dim_t order_, const FLA_Permute_loop outer[], FLA_Bool memcpyRuns, size_t elem_size, \
+                  dim_t m, dim_t lda, dim_t n, dim_t ak, dim_t ldb, \
+                  const char* buf_A, char* buf_B ) \
+{ \
+	const dim_t nOuter = (ORDER) - 1; \
+	dim_t j; \
+	dim_t curIndex[FLA_MAX_ORDER]; \
+	dim_t offA = 0; \
+	dim_t offB = 0; \
+\
+	memset( curIndex, 0, nOuter * sizeof( dim_t ) ); \
+	while( TRUE ){ \
+		FLA_Permute_run( memcpyRuns, elem_size, m, lda, n, ak, ldb, \
+		                 buf_A + offA * elem_size, buf_B + offB * elem_size ); \
+\
+		for( j = 0; j < nOuter; j++ ){ \
+			curIndex[j]++; \
+			offA += outer[j].a; \
+			offB += outer[j].b; \
+			if( curIndex[j] < outer[j].n ) \
+				break; \
+			offA -= outer[j].a * outer[j].n; \
+			offB -= outer[j].b * outer[j].n; \
+			curIndex[j] = 0; \
+		} \
+		if( j == nOuter ) \
+			break; \
+	} \
+}
+
+TLA_ORDER_INSTANTIATE( FLA_PERMUTE_OUTER_DEF, FLA_Permute_outer )
+
+// --- Driver ------------------------------------------------------------------
+
+//Permutes the view A into the dense, unpermuted tensor B.
+//permutation[i] is the storage mode of A that becomes mode i of B (sizes of B
+//must already be set accordingly).  Unlike FLA_Permute_single, the offset of
+//the view A is honored.
+//
+//Algorithm:
+//  1) Drop unit modes and collapse modes that are contiguous in both A and B.
+//  2) If the fastest mode of B is also unit stride in A, copy whole runs with memcpy.
+//  3) Otherwise tile the fast mode of B together with the fast mode of A
+//     and transpose tile by tile.
+//  Remaining modes are looped over by an odometer ordered so that the
+//  innermost loop has the smallest combined stride, specialized on the order.
+FLA_Error FLA_Permute_blocked( FLA_Obj A, const dim_t permutation[], FLA_Obj B )
+{
+	dim_t i;
+	dim_t order = FLA_Obj_order( A );
+	size_t elem_size = ( size_t ) FLA_Obj_elem_size( A );
+	const char* buf_A;
+	char* buf_B;
+
+	FLA_Permute_loop loops[FLA_MAX_ORDER];
+	FLA_Permute_loop outer[FLA_MAX_ORDER];
+	dim_t nLoops = 0;
+	dim_t nOuter = 0;
+	dim_t fastA;
+
+	//Tiled inner kernel extents/strides
+	dim_t m, lda, n, ak, ldb;
+	FLA_Bool memcpyRuns;
+
+	//Element sizes without a tile kernel are left to the caller's fallback
+	if( elem_size != sizeof(float) && elem_size != sizeof(double) && elem_size != sizeof(dcomplex) )
+		return FLA_FAILURE;
+
+	buf_A = ( const char* ) (A.base)->buffer;
+	for( i = 0; i < order; i++ )
+		buf_A += A.offset[i] * ((A.base)->stride)[i] * elem_size;
+	buf_B = ( char* ) TLA_OBJ_BUFFER_AT_VIEW( B );
+
+	//Build loops in B order, dropping unit modes and merging contiguous ones
+	for( i = 0; i < order; i++ ){
+		dim_t n_i = A.size[permutation[i]];
+		dim_t a_i = ((A.base)->stride)[permutation[i]];
+		dim_t b_i = ((B.base)->stride)[i];
+
+		if( n_i == 0 )
+			return FLA_SUCCESS;
+		if( n_i == 1 )
+			continue;
+		if( nLoops > 0 &&
+			loops[nLoops-1].a * loops[nLoops-1].n == a_i &&
+			loops[nLoops-1].b * loops[nLoops-1].n == b_i ){
+			loops[nLoops-1].n *= n_i;
+			continue;
+		}
+		loops[nLoops].n = n_i;
+		loops[nLoops].a = a_i;
+		loops[nLoops].b = b_i;
+		nLoops++;
+	}
+
+	if( nLoops == 0 ){
+		memcpy( buf_B, buf_A, elem_size );
+		return FLA_SUCCESS;
+	}
+
+	//Pick the fastest mode of A (the fastest mode of B is loops[0])
+	fastA = 0;
+	for( i = 1; i < nLoops; i++ )
+		if( loops[i].a < loops[fastA].a )
+			fastA = i;
+
+	memcpyRuns = ( loops[0].a == 1 && loops[0].b == 1 );
+	if( memcpyRuns || fastA == 0 ){
+		//Single inner loop (contiguous run or strided gather)
+		m = loops[0].n;
+		lda = loops[0].a;
+		n = 1;
+		ak = 0;
+		ldb = 0;
+	}
+	else{
+		m = loops[0].n;
+		lda = loops[0].a;
+		n = loops[fastA].n;
+		ak = loops[fastA].a;
+		ldb = loops[fastA].b;
+	}
+
+	for( i = 1; i < nLoops; i++ )
+		if( n == 1 || i != fastA )
+			outer[nOuter++] = loops[i];
+	qsort( outer, nOuter, sizeof( FLA_Permute_loop ), compare_permute_loop );
+
+	//Unit loops pad the odometer to order - 1 loops, outermost so they are
+	//only stepped over once the real ones are done
+	for( ; nOuter + 1 < order; nOuter++ ){
+		outer[nOuter].n = 1;
+		outer[nOuter].a = 0;
+		outer[nOuter].b = 0;
+	}
+
+	TLA_ORDER_DISPATCH( order, FLA_Permute_outer,
+	                    ( order, outer, memcpyRuns, elem_size, m, lda, n, ak, ldb, buf_A, buf_B ) );
+
+	return FLA_SUCCESS;
+}
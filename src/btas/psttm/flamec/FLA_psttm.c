@@ -42,6 +42,12 @@ FLA_Error FLA_Psttm( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj
     FLA_Obj CT, CB;
     FLA_Obj C0, C1, C2;
 
+#ifdef FLA_ENABLE_MULTITHREADING
+    //Work-stealing mode: every slice of C is a root task
+    if(FLA_Psttv_get_num_threads() > 1)
+        return FLA_Psttm_ws(alpha, A, mode, beta, B, C);
+#endif
+
     FLA_Part_1xmode2(B, &BT,
                      &BB, 0, 0, FLA_TOP);
     FLA_Part_1xmode2(C, &CT,
@@ -73,3 +79,33 @@ FLA_Error FLA_Psttm( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj
 	return FLA_SUCCESS;
 }
 
+
+#ifdef FLA_ENABLE_MULTITHREADING
+FLA_Error FLA_Psttm_ws( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C )
+{
+    dim_t i;
+    dim_t nSlices = FLA_Obj_dimsize(C, mode);
+    FLA_Obj* B1 = (FLA_Obj*)FLA_malloc(nSlices * sizeof(FLA_Obj));
+    FLA_Obj* C1 = (FLA_Obj*)FLA_malloc(nSlices * sizeof(FLA_Obj));
+    FLA_Obj BT, BB, B2;
+    FLA_Obj CT, CB, C2;
+
+    for(i = 0; i < nSlices; i++){
+        FLA_Part_1xmode2(B, &BT,
+                         &BB, 0, i, FLA_TOP);
+        FLA_Part_1xmode2(BB, &(B1[i]),
+                         &B2, 0, 1, FLA_TOP);
+        FLA_Part_1xmode2(C, &CT,
+                         &CB, mode, i, FLA_TOP);
+        FLA_Part_1xmode2(CB, &(C1[i]),
+                         &C2, mode, 1, FLA_TOP);
+    }
+
+    FLA_Psttv_ws(alpha, A, mode, beta, nSlices, B1, C1);
+
+    FLA_free(B1);
+    FLA_free(C1);
+
+    return FLA_SUCCESS;
+}
+#endif
@@ -32,3 +32,6 @@
 #include "FLAME.h"
 
 FLA_Error FLA_Psttm( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+#ifdef FLA_ENABLE_MULTITHREADING
+FLA_Error FLA_Psttm_ws( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+#endif
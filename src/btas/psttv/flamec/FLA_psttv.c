@@ -32,12 +32,16 @@
 
 #include "FLAME.h"
 
+//Called for each subproblem FLA_Psttv_regions splits off.  The C regions of
+//the subproblems are disjoint, so they may run in any order or concurrently
+typedef FLA_Error (*FLA_Psttv_region_fn)( void* ctx, FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+
 //Note: Only retains symmetry that exists...
 //Note: Mode multiplies MUST be INORDER (so that traverse stored pieces correctly).
 //(This might could be relaxed since no matter the loop order, we will hit the unique part only once...Not sure...I think we would just have to handle the permutations)
 //Step 1: Partition unaltered symmetric groups of A and C first!!
 //Step 2: Deal with the symGroup that will be broken
-FLA_Error FLA_Psttv( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C )
+static FLA_Error FLA_Psttv_regions( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C, FLA_Psttv_region_fn region, void* ctx )
 {
     dim_t i;
 
@@ -62,14 +66,21 @@ FLA_Error FLA_Psttv( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj
 		//This is the symmetric group to split
 	    dim_t symGroupToSplitOffset = TLA_sym_group_mode_offset(symC, symGroupToSplit);
 
-	    dim_t* part_modes;
-	    dim_t* sizes;
-	    dim_t* repart_sizes;
-	    FLA_Side* sides;
-	    FLA_Side* repart_sides;
+	    dim_t part_modes[FLA_MAX_ORDER];
+	    dim_t sizes[FLA_MAX_ORDER];
+	    dim_t repart_sizes[FLA_MAX_ORDER];
+	    FLA_Side sides[FLA_MAX_ORDER];
+	    FLA_Side repart_sides[FLA_MAX_ORDER];
 
 	    dim_t isSingleBlock;
 
+	    //Views of small splits live here, larger ones on the heap
+	    FLA_Bool onStack;
+	    FLA_Obj part_store[2 * TLA_PART_STACK_NPART];
+	    FLA_Obj repart_store[2 * TLA_PART_STACK_NREPART];
+	    FLA_Obj* part_ptrs[2 * TLA_PART_STACK_NPART];
+	    FLA_Obj* repart_ptrs[2 * TLA_PART_STACK_NREPART];
+
 	    FLA_Obj** Apart;
 	    FLA_Obj** Cpart;
 	    FLA_Obj** Arepart;
@@ -104,12 +115,6 @@ FLA_Error FLA_Psttv( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj
 	        return FLA_SUCCESS;
 	    }
 
-	    part_modes = (dim_t*)FLA_malloc(nModes_part * sizeof(dim_t));
-	    sizes = (dim_t*)FLA_malloc(nModes_part * sizeof(dim_t));
-	    repart_sizes = (dim_t*)FLA_malloc(nModes_part * sizeof(dim_t));
-	    sides = (FLA_Side*)FLA_malloc(nModes_part * sizeof(dim_t));
-	    repart_sides = (FLA_Side*)FLA_malloc(nModes_part * sizeof(dim_t));
-
 	    for(i = 0; i < nModes_part; i++){
 	    	part_modes[i] = symC.symModes[symGroupToSplitOffset + i];
 	        sizes[i] = 0;
@@ -119,17 +124,31 @@ FLA_Error FLA_Psttv( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj
 	    }
 
 	    //Begin loop for general tensor case
-	    Apart = (FLA_Obj**)FLA_malloc(nPart * sizeof(FLA_Obj*));
-	    Cpart = (FLA_Obj**)FLA_malloc(nPart * sizeof(FLA_Obj*));
-
-	    Arepart = (FLA_Obj**)FLA_malloc(nRepart * sizeof(FLA_Obj*));
-	    Crepart = (FLA_Obj**)FLA_malloc(nRepart * sizeof(FLA_Obj*));
-
-	    TLA_create_part_obj(nPart, Apart);
-	    TLA_create_part_obj(nPart, Cpart);
-
-	    TLA_create_part_obj(nRepart, Arepart);
-	    TLA_create_part_obj(nRepart, Crepart);
+	    onStack = (nModes_part <= TLA_PART_STACK_MODES);
+	    if(onStack){
+	        Apart = &(part_ptrs[0]);
+	        Cpart = &(part_ptrs[nPart]);
+	        Arepart = &(repart_ptrs[0]);
+	        Crepart = &(repart_ptrs[nRepart]);
+
+	        TLA_init_part_obj(nPart, &(part_store[0]), Apart);
+	        TLA_init_part_obj(nPart, &(part_store[nPart]), Cpart);
+
+	        TLA_init_part_obj(nRepart, &(repart_store[0]), Arepart);
+	        TLA_init_part_obj(nRepart, &(repart_store[nRepart]), Crepart);
+	    }else{
+	        Apart = (FLA_Obj**)FLA_malloc(nPart * sizeof(FLA_Obj*));
+	        Cpart = (FLA_Obj**)FLA_malloc(nPart * sizeof(FLA_Obj*));
+
+	        Arepart = (FLA_Obj**)FLA_malloc(nRepart * sizeof(FLA_Obj*));
+	        Crepart = (FLA_Obj**)FLA_malloc(nRepart * sizeof(FLA_Obj*));
+
+	        TLA_create_part_obj(nPart, Apart);
+	        TLA_create_part_obj(nPart, Cpart);
+
+	        TLA_create_part_obj(nRepart, Arepart);
+	        TLA_create_part_obj(nRepart, Crepart);
+	    }
 
 	    FLA_Part_2powm(A, Apart,
 	                       nModes_part, part_modes,
@@ -160,7 +179,7 @@ FLA_Error FLA_Psttv( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj
 	        for(i = 0; i < nModes_part; i++){
                 Apass = *(Arepart[update_region]);
                 Cpass = *(Crepart[update_region]);
-	            FLA_Psttv(alpha, Apass, mode, beta, B, Cpass);
+	            region(ctx, alpha, Apass, mode, beta, B, Cpass);
 	            update_region_stride /= 3;
 	            update_region += update_region_stride;
 	        }
@@ -174,25 +193,296 @@ FLA_Error FLA_Psttv( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj
 	    }
 
 	    //Tidy up alloc'd data
-	    TLA_destroy_part_obj(nPart, Apart);
-	    TLA_destroy_part_obj(nPart, Cpart);
+	    if(!onStack){
+	        TLA_destroy_part_obj(nPart, Apart);
+	        TLA_destroy_part_obj(nPart, Cpart);
+
+	        TLA_destroy_part_obj(nRepart, Arepart);
+	        TLA_destroy_part_obj(nRepart, Crepart);
+
+	        FLA_free(Apart);
+	        FLA_free(Cpart);
+	        FLA_free(Arepart);
+	        FLA_free(Crepart);
+	    }
+	}
+
+	return FLA_SUCCESS;
+}
+
+
+static FLA_Error FLA_Psttv_serial_region( void* ctx, FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C )
+{
+	return FLA_Psttv_regions(alpha, A, mode, beta, B, C, FLA_Psttv_serial_region, ctx);
+}
+
+//Work-stealing mode: number of threads, and the C block count at or below
+//which a subproblem is finished sequentially instead of split into tasks
+static dim_t fla_psttv_n_threads = 1;
+static dim_t fla_psttv_cutoff    = 16;
+
+void FLA_Psttv_set_num_threads( dim_t n_threads )
+{
+	fla_psttv_n_threads = (n_threads < 1) ? 1 : n_threads;
+}
 
-	    TLA_destroy_part_obj(nRepart, Arepart);
-	    TLA_destroy_part_obj(nRepart, Crepart);
+dim_t FLA_Psttv_get_num_threads( void )
+{
+	return fla_psttv_n_threads;
+}
 
+void FLA_Psttv_set_cutoff( dim_t n_blocks )
+{
+	fla_psttv_cutoff = n_blocks;
+}
 
-	    FLA_free(part_modes);
-	    FLA_free(sizes);
-	    FLA_free(repart_sizes);
-	    FLA_free(sides);
-	    FLA_free(repart_sides);
+dim_t FLA_Psttv_get_cutoff( void )
+{
+	return fla_psttv_cutoff;
+}
 
-	    FLA_free(Apart);
-	    FLA_free(Cpart);
-	    FLA_free(Arepart);
-	    FLA_free(Crepart);
+FLA_Error FLA_Psttv( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C )
+{
+#ifdef FLA_ENABLE_MULTITHREADING
+	if(fla_psttv_n_threads > 1)
+		return FLA_Psttv_ws(alpha, A, mode, beta, 1, &B, &C);
+#endif
+	return FLA_Psttv_regions(alpha, A, mode, beta, B, C, FLA_Psttv_serial_region, NULL);
+}
+
+#ifdef FLA_ENABLE_MULTITHREADING
+
+typedef struct FLA_Psttv_task_s
+{
+	FLA_Obj alpha;
+	FLA_Obj A;
+	dim_t   mode;
+	FLA_Obj beta;
+	FLA_Obj B;
+	FLA_Obj C;
+} FLA_Psttv_task_t;
+
+//Tasks [top, bottom) of one thread.  The owner pushes and pops at the
+//bottom, thieves take the oldest (largest) task from the top
+typedef struct FLA_Psttv_deque_s
+{
+	FLA_Lock          lock;
+	dim_t             top;
+	dim_t             bottom;
+	dim_t             capacity;
+	FLA_Psttv_task_t* tasks;
+} FLA_Psttv_deque_t;
+
+typedef struct FLA_Psttv_ws_s
+{
+	dim_t              nThreads;
+	FLA_Psttv_deque_t* deques;
+	FLA_Lock           lock;
+	dim_t              nPending;  //Tasks pushed but not yet finished
+} FLA_Psttv_ws_t;
+
+typedef struct FLA_Psttv_worker_s
+{
+	FLA_Psttv_ws_t* ws;
+	dim_t           id;
+#if FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+	pthread_t       pthread_obj;
+#endif
+} FLA_Psttv_worker_t;
+
+static void FLA_Psttv_deque_push( FLA_Psttv_deque_t* q, FLA_Psttv_task_t* t )
+{
+	FLA_Lock_acquire(&(q->lock));
+	if(q->bottom == q->capacity){
+		if(q->top > 0){
+			memmove(&(q->tasks[0]), &(q->tasks[q->top]), (q->bottom - q->top) * sizeof(FLA_Psttv_task_t));
+			q->bottom -= q->top;
+			q->top = 0;
+		}else{
+			FLA_Psttv_task_t* tasks = (FLA_Psttv_task_t*)FLA_malloc(2 * q->capacity * sizeof(FLA_Psttv_task_t));
+			memcpy(&(tasks[0]), &(q->tasks[0]), q->bottom * sizeof(FLA_Psttv_task_t));
+			FLA_free(q->tasks);
+			q->tasks = tasks;
+			q->capacity *= 2;
+		}
+	}
+	q->tasks[q->bottom++] = *t;
+	FLA_Lock_release(&(q->lock));
+}
+
+static FLA_Bool FLA_Psttv_deque_pop( FLA_Psttv_deque_t* q, FLA_Psttv_task_t* t )
+{
+	FLA_Bool found = FALSE;
+
+	FLA_Lock_acquire(&(q->lock));
+	if(q->bottom > q->top){
+		*t = q->tasks[--(q->bottom)];
+		found = TRUE;
+	}
+	FLA_Lock_release(&(q->lock));
+
+	return found;
+}
+
+static FLA_Bool FLA_Psttv_deque_steal( FLA_Psttv_deque_t* q, FLA_Psttv_task_t* t )
+{
+	FLA_Bool found = FALSE;
+
+	FLA_Lock_acquire(&(q->lock));
+	if(q->bottom > q->top){
+		*t = q->tasks[(q->top)++];
+		found = TRUE;
+	}
+	FLA_Lock_release(&(q->lock));
+
+	return found;
+}
+
+static void FLA_Psttv_ws_spawn( FLA_Psttv_worker_t* me, FLA_Psttv_task_t* t )
+{
+	FLA_Lock_acquire(&(me->ws->lock));
+	me->ws->nPending++;
+	FLA_Lock_release(&(me->ws->lock));
+
+	FLA_Psttv_deque_push(&(me->ws->deques[me->id]), t);
+}
+
+static FLA_Error FLA_Psttv_ws_region( void* ctx, FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C )
+{
+	FLA_Psttv_task_t t;
+
+	t.alpha = alpha;
+	t.A = A;
+	t.mode = mode;
+	t.beta = beta;
+	t.B = B;
+	t.C = C;
+	FLA_Psttv_ws_spawn((FLA_Psttv_worker_t*)ctx, &t);
+
+	return FLA_SUCCESS;
+}
+
+static void FLA_Psttv_ws_run_task( FLA_Psttv_worker_t* me, FLA_Psttv_task_t* t )
+{
+	dim_t i;
+	dim_t nBlocks = 1;
+
+	for(i = 0; i < FLA_Obj_order(t->C); i++)
+		nBlocks *= FLA_Obj_dimsize(t->C, i);
+
+	//Small subproblems are not worth the scheduling overhead
+	if(nBlocks <= fla_psttv_cutoff)
+		FLA_Psttv_regions(t->alpha, t->A, t->mode, t->beta, t->B, t->C, FLA_Psttv_serial_region, NULL);
+	else
+		FLA_Psttv_regions(t->alpha, t->A, t->mode, t->beta, t->B, t->C, FLA_Psttv_ws_region, (void*)me);
+
+	FLA_Lock_acquire(&(me->ws->lock));
+	me->ws->nPending--;
+	FLA_Lock_release(&(me->ws->lock));
+}
+
+static void* FLA_Psttv_ws_thread_function( void* arg )
+{
+	FLA_Psttv_worker_t* me = (FLA_Psttv_worker_t*)arg;
+	FLA_Psttv_ws_t* ws = me->ws;
+	FLA_Psttv_task_t t;
+	dim_t i, victim;
+	dim_t nPending;
+
+	while(TRUE){
+		if(FLA_Psttv_deque_pop(&(ws->deques[me->id]), &t)){
+			FLA_Psttv_ws_run_task(me, &t);
+			continue;
+		}
+
+		//Own deque is empty; try the others, starting with the next thread
+		for(i = 1; i < ws->nThreads; i++){
+			victim = (me->id + i) % ws->nThreads;
+			if(FLA_Psttv_deque_steal(&(ws->deques[victim]), &t))
+				break;
+		}
+		if(i < ws->nThreads){
+			FLA_Psttv_ws_run_task(me, &t);
+			continue;
+		}
+
+		FLA_Lock_acquire(&(ws->lock));
+		nPending = ws->nPending;
+		FLA_Lock_release(&(ws->lock));
+		if(nPending == 0)
+			break;
+	}
+
+	return NULL;
+}
+
+//Runs FLA_Psttv(alpha, A, mode, beta, B[i], C[i]) for i < nTasks on
+//fla_psttv_n_threads threads.  Every subproblem is a task on its thread's
+//deque; idle threads steal.  The C[i] must be disjoint.  Each C region gets
+//the same operations as in the sequential code
+FLA_Error FLA_Psttv_ws( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, dim_t nTasks, FLA_Obj B[], FLA_Obj C[] )
+{
+	dim_t i;
+	FLA_Psttv_ws_t ws;
+	FLA_Psttv_worker_t* worker;
+	FLA_Psttv_task_t t;
+
+	ws.nThreads = fla_psttv_n_threads;
+	ws.nPending = 0;
+	FLA_Lock_init(&(ws.lock));
+	ws.deques = (FLA_Psttv_deque_t*)FLA_malloc(ws.nThreads * sizeof(FLA_Psttv_deque_t));
+	worker = (FLA_Psttv_worker_t*)FLA_malloc(ws.nThreads * sizeof(FLA_Psttv_worker_t));
+	for(i = 0; i < ws.nThreads; i++){
+		FLA_Lock_init(&(ws.deques[i].lock));
+		ws.deques[i].top = 0;
+		ws.deques[i].bottom = 0;
+		ws.deques[i].capacity = 64;
+		ws.deques[i].tasks = (FLA_Psttv_task_t*)FLA_malloc(64 * sizeof(FLA_Psttv_task_t));
+		worker[i].ws = &ws;
+		worker[i].id = i;
+	}
+
+	//The leaves only read the 2-D info of the blocks of B shared by all threads
+	for(i = 0; i < nTasks; i++)
+		TLA_Adjust_2D_info_blocks(B[i]);
+
+	//Deal the root tasks out round-robin
+	for(i = 0; i < nTasks; i++){
+		t.alpha = alpha;
+		t.A = A;
+		t.mode = mode;
+		t.beta = beta;
+		t.B = B[i];
+		t.C = C[i];
+		FLA_Psttv_ws_spawn(&worker[i % ws.nThreads], &t);
+	}
+
+#if FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+	//The calling thread is worker 0
+	for(i = 1; i < ws.nThreads; i++){
+		int r_val = pthread_create(&(worker[i].pthread_obj), NULL, FLA_Psttv_ws_thread_function, (void*)&worker[i]);
+		FLA_Check_error_code( FLA_Check_pthread_create_result( r_val ) );
+	}
+	FLA_Psttv_ws_thread_function((void*)&worker[0]);
+	for(i = 1; i < ws.nThreads; i++){
+		int r_val = pthread_join(worker[i].pthread_obj, NULL);
+		FLA_Check_error_code( FLA_Check_pthread_join_result( r_val ) );
+	}
+#else
+	#pragma omp parallel for num_threads(ws.nThreads) schedule(static, 1)
+	for(i = 0; i < ws.nThreads; i++)
+		FLA_Psttv_ws_thread_function((void*)&worker[i]);
+#endif
+
+	for(i = 0; i < ws.nThreads; i++){
+		FLA_Lock_destroy(&(ws.deques[i].lock));
+		FLA_free(ws.deques[i].tasks);
 	}
+	FLA_Lock_destroy(&(ws.lock));
+	FLA_free(ws.deques);
+	FLA_free(worker);
 
 	return FLA_SUCCESS;
 }
 
+#endif
@@ -34,3 +34,10 @@
 
 //FLA_Error FLA_Psttv_helper(FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C, dim_t symGroupsToPartition[], dim_t symGroupsPartitioned);
 FLA_Error FLA_Psttv( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+void      FLA_Psttv_set_num_threads( dim_t n_threads );
+dim_t     FLA_Psttv_get_num_threads( void );
+void      FLA_Psttv_set_cutoff( dim_t n_blocks );
+dim_t     FLA_Psttv_get_cutoff( void );
+#ifdef FLA_ENABLE_MULTITHREADING
+FLA_Error FLA_Psttv_ws( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, dim_t nTasks, FLA_Obj B[], FLA_Obj C[] );
+#endif
@@ -32,59 +32,41 @@
 
 #include "FLAME.h"
 
-FLA_Error FLA_Sttsm_single( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C, dim_t endIndex, FLA_Obj* temps[] )
+static void FLA_Sttsm_single_view( FLA_Obj alpha, const TLA_View* A, dim_t mode, FLA_Obj beta, const TLA_View* B, const TLA_View* C, dim_t endIndex, FLA_Obj* temps[] )
 {
-	//FOR
-	FLA_Obj BT, BB;
-	FLA_Obj B0, B1, B2;
-	FLA_Obj CT, CB;
-	FLA_Obj C0, C1, C2;
+	TLA_View B1, C1, X;
 	dim_t loopCount;
 
-	FLA_Part_1xmode2(B, &BT,
-						&BB, 0, 0, FLA_TOP);
-	FLA_Part_1xmode2(C, &CT,
-						&CB, mode, 0, FLA_TOP);
 	//Only symmetric part touched
 	//Ponder this
-	loopCount = 0;
-	while(loopCount <= endIndex){
-		dim_t b = 1;
-		FLA_Repart_1xmode2_to_1xmode3(BT, &B0,
-									/**/ /**/
-										  &B1,
-									  BB, &B2, 0, b, FLA_BOTTOM);
-		FLA_Repart_1xmode2_to_1xmode3(CT, &C0,
-									/**/ /**/
-										  &C1,
-									  CB, &C2, mode, b, FLA_BOTTOM);
+	for(loopCount = 0; loopCount <= endIndex; loopCount++){
+		TLA_View_slice(B, 0, loopCount, &B1);
+		TLA_View_slice(C, mode, loopCount, &C1);
 		/*********************************/
 		//Make sure that if we are at the bottom of the recursion,
 		//We multiply into C (not X)
 		if(mode == 0){
-			FLA_Ttm_single_mode(alpha, A, mode, beta, B1, C1);
+			FLA_Ttm_single_mode_view(alpha, A, mode, beta, &B1, &C1);
 		}else{
-			//Initialize X to 0
-			FLA_Obj X = *(temps[mode]);
-			FLA_Set_zero_tensor(X);
+			TLA_View_from_obj(temps[mode], &X);
 
-			//Compute X
-			FLA_Ttm_single_mode(alpha, A, mode, beta, B1, X);
+			//Compute X (overwriting what the last iteration left there)
+			FLA_Ttm_single_mode_view(FLA_ZERO, A, mode, FLA_ONE, &B1, &X);
 			//Use X for rest of computation
-			FLA_Sttsm_single(alpha, X, mode-1, beta, B, C1, loopCount, temps);
+			FLA_Sttsm_single_view(alpha, &X, mode-1, beta, B, &C1, loopCount, temps);
 		}
 		/*********************************/
-		FLA_Cont_with_1xmode3_to_1xmode2( &CT, C0,
-											   C1,
-										/********/
-										  &CB, C2, mode, FLA_TOP);
-		FLA_Cont_with_1xmode3_to_1xmode2( &BT, B0,
-											   B1,
-										/********/
-										  &BB, B2, 0, FLA_TOP);
-		loopCount++;
 	}
+}
 
+FLA_Error FLA_Sttsm_single( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C, dim_t endIndex, FLA_Obj* temps[] )
+{
+	TLA_View Av, Bv, Cv;
+
+	TLA_View_from_obj(&A, &Av);
+	TLA_View_from_obj(&B, &Bv);
+	TLA_View_from_obj(&C, &Cv);
+	FLA_Sttsm_single_view(alpha, &Av, mode, beta, &Bv, &Cv, endIndex, temps);
 
 	return FLA_SUCCESS;
 }
@@ -119,12 +101,10 @@ FLA_Error FLA_Sttsm_single_psttm( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj
         if(mode == 0){
             FLA_Ttm_single_mode(alpha, A, mode, beta, B1, C1);
         }else{
-			//Set X to 0
 			FLA_Obj X = *(temps[mode]);
-            FLA_Set_zero_tensor(X);
 
-            //Compute X
-            FLA_Psttm(alpha, A, mode, beta, B1, X);
+            //Compute X (overwriting what the last iteration left there)
+            FLA_Psttm(FLA_ZERO, A, mode, FLA_ONE, B1, X);
 
             //Use X for rest of computation
             FLA_Sttsm_single_psttm(alpha, X, mode-1, beta, B, C1, loopCount, temps);
@@ -144,7 +124,7 @@ FLA_Error FLA_Sttsm_single_psttm( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj
     return FLA_SUCCESS;
 }
 
-void initialize_psym_temporaries(FLA_Obj A, FLA_Obj C, FLA_Obj* temps[]){
+void FLA_Sttsm_initialize_psym_temporaries(FLA_Datatype datatype, FLA_Obj A, FLA_Obj C, FLA_Obj* temps[]){
 	dim_t i, j;
 	dim_t order = FLA_Obj_order(A);
 	dim_t temp_blocked_size[FLA_MAX_ORDER];
@@ -176,13 +156,13 @@ void initialize_psym_temporaries(FLA_Obj A, FLA_Obj C, FLA_Obj* temps[]){
 
 		//Create the temporary
 		temps[i] = (FLA_Obj*)FLA_malloc(sizeof(FLA_Obj));
-		FLA_Obj_create_blocked_psym_tensor(FLA_DOUBLE, order, temp_flat_size, temp_blocked_stride, temp_block_size, Xsym, temps[i]);
+		TLA_Obj_create_blocked_psym_tensor_scratch(datatype, order, temp_flat_size, temp_blocked_stride, temp_block_size, Xsym, temps[i]);
 		
 		tmpSym = Xsym;
 	}
 }
 
-void destroy_psym_temporaries(dim_t order, FLA_Obj* temps[]){
+void FLA_Sttsm_destroy_psym_temporaries(dim_t order, FLA_Obj* temps[]){
 	dim_t i;
 	for(i = order - 1; i > 0; i--){
 		FLA_Obj_blocked_psym_tensor_free_buffer(temps[i]);
@@ -191,7 +171,7 @@ void destroy_psym_temporaries(dim_t order, FLA_Obj* temps[]){
 	}
 }
 
-void initialize_temporaries(FLA_Obj A, FLA_Obj C, FLA_Obj* temps[]){
+void FLA_Sttsm_initialize_temporaries(FLA_Datatype datatype, FLA_Obj A, FLA_Obj C, FLA_Obj* temps[]){
 	dim_t i, j;
 	dim_t order = FLA_Obj_order(A);
 	dim_t temp_blocked_size[FLA_MAX_ORDER];
@@ -219,11 +199,11 @@ void initialize_temporaries(FLA_Obj A, FLA_Obj C, FLA_Obj* temps[]){
 
 		//Create the temporary
 		temps[i] = (FLA_Obj*)FLA_malloc(sizeof(FLA_Obj));
-		FLA_Obj_create_blocked_tensor(FLA_DOUBLE, order, temp_flat_size, temp_blocked_stride, temp_block_size, temps[i]);
+		TLA_Obj_create_blocked_tensor_scratch(datatype, order, temp_flat_size, temp_blocked_stride, temp_block_size, temps[i]);
 	}
 }
 
-void destroy_temporaries(dim_t order, FLA_Obj* temps[]){
+void FLA_Sttsm_destroy_temporaries(dim_t order, FLA_Obj* temps[]){
 	dim_t i;
 	for(i = order - 1; i > 0; i--){
 		FLA_Obj_blocked_tensor_free_buffer(temps[i]);
@@ -232,18 +212,495 @@ void destroy_temporaries(dim_t order, FLA_Obj* temps[]){
 	}
 }
 
+//Number of threads FLA_Sttsm_*_ext split the unique blocks of C across
+//when no data affinity is set
+static dim_t fla_sttsm_n_threads = 1;
+
+void FLA_Sttsm_set_num_threads( dim_t n_threads )
+{
+	fla_sttsm_n_threads = (n_threads < 1) ? 1 : n_threads;
+}
+
+dim_t FLA_Sttsm_get_num_threads( void )
+{
+	return fla_sttsm_n_threads;
+}
+
+//Threads FLA_Sttsm_par runs on: with a data affinity set, the FLASH queue
+//threads the blocks of C were placed across, whatever fla_sttsm_n_threads is
+static dim_t FLA_Sttsm_par_threads( void )
+{
+#ifdef FLA_ENABLE_MULTITHREADING
+	if(FLASH_Queue_get_data_affinity() != FLASH_QUEUE_AFFINITY_NONE)
+		return FLASH_Queue_get_num_threads();
+#endif
+	return fla_sttsm_n_threads;
+}
+
+//One thread's share of the top-level loop of FLA_Sttsm_single(_psttm): whole
+//iterations iters[], or, if subIters is not NULL, the iterations subIters[i]
+//of the loop one level down inside top-level iteration iters[i].  If blocks
+//is not NULL the share is instead nIters single unique blocks of C, block i
+//at index blocks[i*order .. i*order+order-1]
+typedef struct FLA_Sttsm_thread_s
+{
+	dim_t     id;
+	FLA_Obj   alpha;
+	FLA_Obj   A;
+	FLA_Obj   beta;
+	FLA_Obj   B;
+	FLA_Obj   C;
+	FLA_Bool  psym_temps;
+	dim_t     nIters;
+	dim_t*    iters;
+	dim_t*    subIters;
+	dim_t*    blocks;
+	FLA_Bool  haveTop;
+	dim_t     top;
+	dim_t     path[FLA_MAX_ORDER];
+	double    cost;
+	FLA_Obj*  temps[FLA_MAX_ORDER];
+#if defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+	pthread_t pthread_obj;
+#endif
+} FLA_Sttsm_thread_t;
+
+//Body of the top-level loop for block index loopCount.  Performs exactly the
+//operations of the corresponding serial iteration, so results are identical
+static void FLA_Sttsm_top_iteration( FLA_Sttsm_thread_t* t, dim_t loopCount )
+{
+	dim_t mode = FLA_Obj_order(t->C) - 1;
+	FLA_Obj BT, BB, B1, B2;
+	FLA_Obj CT, CB, C1, C2;
+	FLA_Obj X;
+
+	FLA_Part_1xmode2(t->B, &BT,
+	                       &BB, 0, loopCount, FLA_TOP);
+	FLA_Part_1xmode2(BB, &B1,
+	                     &B2, 0, 1, FLA_TOP);
+	FLA_Part_1xmode2(t->C, &CT,
+	                       &CB, mode, loopCount, FLA_TOP);
+	FLA_Part_1xmode2(CB, &C1,
+	                     &C2, mode, 1, FLA_TOP);
+
+	if(mode == 0){
+		FLA_Ttm_single_mode(t->alpha, t->A, mode, t->beta, B1, C1);
+		return;
+	}
+
+	X = *(t->temps[mode]);
+	if(t->psym_temps){
+		FLA_Psttm(FLA_ZERO, t->A, mode, FLA_ONE, B1, X);
+		FLA_Sttsm_single_psttm(t->alpha, X, mode-1, t->beta, t->B, C1, loopCount, t->temps);
+	}else{
+		FLA_Ttm_single_mode(FLA_ZERO, t->A, mode, FLA_ONE, B1, X);
+		FLA_Sttsm_single(t->alpha, X, mode-1, t->beta, t->B, C1, loopCount, t->temps);
+	}
+}
+
+//Iteration subIndex of the level-(order-2) loop inside top-level iteration
+//loopCount.  The top-level temporary is recomputed only when loopCount
+//changes; together the calls for subIndex = 0..loopCount perform exactly the
+//operations of FLA_Sttsm_top_iteration(t, loopCount)
+static void FLA_Sttsm_sub_iteration( FLA_Sttsm_thread_t* t, dim_t loopCount, dim_t subIndex )
+{
+	dim_t mode = FLA_Obj_order(t->C) - 1;
+	FLA_Obj BT, BB, B1, B2;
+	FLA_Obj CT, CB, C1, C2;
+	FLA_Obj X, Y;
+
+	X = *(t->temps[mode]);
+	if(!t->haveTop || t->top != loopCount){
+		FLA_Part_1xmode2(t->B, &BT,
+		                       &BB, 0, loopCount, FLA_TOP);
+		FLA_Part_1xmode2(BB, &B1,
+		                     &B2, 0, 1, FLA_TOP);
+		if(t->psym_temps)
+			FLA_Psttm(FLA_ZERO, t->A, mode, FLA_ONE, B1, X);
+		else
+			FLA_Ttm_single_mode(FLA_ZERO, t->A, mode, FLA_ONE, B1, X);
+		t->haveTop = TRUE;
+		t->top = loopCount;
+	}
+
+	FLA_Part_1xmode2(t->C, &CT,
+	                       &CB, mode, loopCount, FLA_TOP);
+	FLA_Part_1xmode2(CB, &C1,
+	                     &C2, mode, 1, FLA_TOP);
+	FLA_Part_1xmode2(C1, &CT,
+	                     &CB, mode-1, subIndex, FLA_TOP);
+	FLA_Part_1xmode2(CB, &C1,
+	                     &C2, mode-1, 1, FLA_TOP);
+	FLA_Part_1xmode2(t->B, &BT,
+	                       &BB, 0, subIndex, FLA_TOP);
+	FLA_Part_1xmode2(BB, &B1,
+	                     &B2, 0, 1, FLA_TOP);
+
+	if(mode == 1){
+		FLA_Ttm_single_mode(t->alpha, X, 0, t->beta, B1, C1);
+		return;
+	}
+
+	Y = *(t->temps[mode-1]);
+	if(t->psym_temps){
+		FLA_Psttm(FLA_ZERO, X, mode-1, FLA_ONE, B1, Y);
+		FLA_Sttsm_single_psttm(t->alpha, Y, mode-2, t->beta, t->B, C1, subIndex, t->temps);
+	}else{
+		FLA_Ttm_single_mode(FLA_ZERO, X, mode-1, FLA_ONE, B1, Y);
+		FLA_Sttsm_single(t->alpha, Y, mode-2, t->beta, t->B, C1, subIndex, t->temps);
+	}
+}
+
+//The block slice T1 of T at index along mode
+static void FLA_Sttsm_slice( FLA_Obj T, dim_t mode, dim_t index, FLA_Obj* T1 )
+{
+	FLA_Obj TT, TB, T2;
+
+	FLA_Part_1xmode2(T, &TT,
+	                    &TB, mode, index, FLA_TOP);
+	FLA_Part_1xmode2(TB, T1,
+	                     &T2, mode, 1, FLA_TOP);
+}
+
+//The unique block of C at index (index[0] <= ... <= index[order-1]).  The
+//temporary of each level is recomputed only when the index changes at or
+//above that level since the last block; together the calls for the blocks
+//in the order of FLA_Sttsm_next_block perform exactly the operations of the
+//serial recursion
+static void FLA_Sttsm_block_iteration( FLA_Sttsm_thread_t* t, const dim_t index[] )
+{
+	dim_t order = FLA_Obj_order(t->C);
+	dim_t mode = order - 1;
+	dim_t k;
+	FLA_Obj B1, C1, X;
+
+	//Highest level whose temporary is out of date
+	if(t->haveTop)
+		while(mode > 0 && t->path[mode] == index[mode])
+			mode--;
+	for(; mode > 0; mode--){
+		X = (mode == order - 1) ? t->A : *(t->temps[mode + 1]);
+		FLA_Sttsm_slice(t->B, 0, index[mode], &B1);
+		if(t->psym_temps)
+			FLA_Psttm(FLA_ZERO, X, mode, FLA_ONE, B1, *(t->temps[mode]));
+		else
+			FLA_Ttm_single_mode(FLA_ZERO, X, mode, FLA_ONE, B1, *(t->temps[mode]));
+		t->path[mode] = index[mode];
+	}
+	t->haveTop = TRUE;
+
+	C1 = t->C;
+	for(k = 0; k < order; k++)
+		FLA_Sttsm_slice(C1, k, index[k], &C1);
+	X = (order == 1) ? t->A : *(t->temps[1]);
+	FLA_Sttsm_slice(t->B, 0, index[0], &B1);
+	FLA_Ttm_single_mode(t->alpha, X, 0, t->beta, B1, C1);
+}
+
+//Advances index to the next unique block of C in the order the serial
+//recursion writes them (the last mode outermost), FALSE past the last
+static FLA_Bool FLA_Sttsm_next_block( dim_t order, dim_t nBlocks, dim_t index[] )
+{
+	dim_t k, j;
+
+	for(k = 0; k < order; k++){
+		dim_t bound = (k == order - 1) ? nBlocks - 1 : index[k + 1];
+
+		if(index[k] < bound){
+			index[k]++;
+			for(j = 0; j < k; j++)
+				index[j] = 0;
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static void* FLA_Sttsm_thread_function( void* arg )
+{
+	FLA_Sttsm_thread_t* t = (FLA_Sttsm_thread_t*)arg;
+	dim_t i;
+
+	FLASH_Queue_bind_thread(t->id);
+	for(i = 0; i < t->nIters; i++){
+		if(t->blocks != NULL)
+			FLA_Sttsm_block_iteration(t, &(t->blocks[i * FLA_Obj_order(t->C)]));
+		else if(t->subIters != NULL)
+			FLA_Sttsm_sub_iteration(t, t->iters[i], t->subIters[i]);
+		else
+			FLA_Sttsm_top_iteration(t, t->iters[i]);
+	}
+
+	return NULL;
+}
+
+//Flop estimate of each iteration of the loop at recursion depth level (the
+//top-level loop is level order-1), and in topTtm that of the ttm of a
+//top-level iteration alone.  The ttm at a depth costs the same for every
+//block; iteration l of a level recurses into iterations 0..l of the level below
+static void FLA_Sttsm_iteration_costs( FLA_Obj A, FLA_Obj C, dim_t level, dim_t nIters, double cost[], double* topTtm )
+{
+	dim_t i, j, l;
+	dim_t order = FLA_Obj_order(C);
+	FLA_Obj* buf_A = (FLA_Obj*)FLA_Obj_base_buffer(A);
+	FLA_Obj* buf_C = (FLA_Obj*)FLA_Obj_base_buffer(C);
+	double ttm[FLA_MAX_ORDER];
+	double* below = (double*)FLA_malloc(nIters * sizeof(double));
+	double* cur = (double*)FLA_malloc(nIters * sizeof(double));
+
+	for(i = 0; i < order; i++){
+		ttm[i] = 1.0;
+		for(j = 0; j <= i; j++)
+			ttm[i] *= (double)(A.size[j] * buf_A[0].size[j]);
+		for(j = i; j < order; j++)
+			ttm[i] *= (double)(buf_C[0].size[j]);
+	}
+
+	//below[l]: cost of the level-(i-1) loop run with endIndex l
+	for(l = 0; l < nIters; l++)
+		below[l] = 0.0;
+	for(i = 0; i <= level; i++){
+		for(l = 0; l < nIters; l++)
+			cur[l] = ttm[i] + below[l];
+		if(i == level)
+			break;
+		below[0] = cur[0];
+		for(l = 1; l < nIters; l++)
+			below[l] = below[l-1] + cur[l];
+	}
+	memcpy(&(cost[0]), &(cur[0]), nIters * sizeof(double));
+	*topTtm = ttm[order-1];
+
+	FLA_free(below);
+	FLA_free(cur);
+}
+
+//Splits sttsm across FLA_Sttsm_par_threads() threads.  Each top-level
+//iteration writes its own slice of C and the threads get private
+//temporaries.
+//
+//With at least as many top-level iterations (blocks of C along the last
+//mode) as threads, whole iterations are handed out largest first to the
+//least loaded thread.  With fewer, the work is split over the unique (l, l')
+//block index pairs of the last two modes instead, so that more threads than
+//blocks along the last mode can be kept busy: the pairs, in order, are cut
+//into contiguous runs of about equal cost, and a thread recomputes the
+//top-level temporary of l only when its run enters l (once per thread and l).
+//
+//With a data affinity set, the work is split instead over the unique blocks
+//of C, each going to the thread its block was placed on (see
+//TLA_Obj_place_blocks).  A thread walks its blocks in serial order and
+//recomputes the temporary of a level only when the block index changes at or
+//above it
+static FLA_Error FLA_Sttsm_par( FLA_Datatype datatype, FLA_Bool psym_temps, FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C )
+{
+	dim_t i, j, k, l;
+	dim_t order = FLA_Obj_order(C);
+	dim_t nIters = FLA_Obj_dimsize(C, order-1);
+	dim_t nThreads = FLA_Sttsm_par_threads();
+	dim_t nItems = nIters;
+	FLA_Bool pairs;
+	double topCost, total, acc;
+	double* cost;
+	dim_t* byCost;
+	FLA_Sttsm_thread_t* thread;
+
+	FLA_Bool placed = (FLASH_Queue_get_data_affinity() != FLASH_QUEUE_AFFINITY_NONE);
+
+#ifndef FLA_ENABLE_MULTITHREADING
+	nThreads = 1;
+#endif
+	pairs = (!placed && order > 1 && nThreads > nIters);
+	if(pairs)
+		nItems = nIters * (nIters + 1) / 2;
+
+	//Placed blocks stay with the owners tensors were created for
+	if(nThreads > nItems && !placed)
+		nThreads = nItems;
+
+	cost = (double*)FLA_malloc(nIters * sizeof(double));
+	byCost = (dim_t*)FLA_malloc(nIters * sizeof(dim_t));
+	thread = (FLA_Sttsm_thread_t*)FLA_malloc(nThreads * sizeof(FLA_Sttsm_thread_t));
+
+	//Unique blocks of C: C(nIters + order - 1, order)
+	if(placed){
+		nItems = 1;
+		for(i = 0; i < order; i++)
+			nItems = nItems * (nIters + i) / (i + 1);
+	}
+
+	for(i = 0; i < nThreads; i++){
+		thread[i].id = i;
+		thread[i].alpha = alpha;
+		thread[i].A = A;
+		thread[i].beta = beta;
+		thread[i].B = B;
+		thread[i].C = C;
+		thread[i].psym_temps = psym_temps;
+		thread[i].nIters = 0;
+		thread[i].iters = placed ? NULL : (dim_t*)FLA_malloc(nItems * sizeof(dim_t));
+		thread[i].subIters = pairs ? (dim_t*)FLA_malloc(nItems * sizeof(dim_t)) : NULL;
+		thread[i].blocks = NULL;
+		thread[i].haveTop = FALSE;
+		thread[i].top = 0;
+		thread[i].cost = 0.0;
+	}
+
+	if(placed){
+		dim_t index[FLA_MAX_ORDER] = {0};
+		dim_t stride[FLA_MAX_ORDER];
+		dim_t* owner = (dim_t*)FLA_malloc(nItems * sizeof(dim_t));
+
+		//Same owner as the placement of the block in the full tensor
+		FLA_Set_tensor_stride(order, C.base->size, stride);
+		for(l = 0; l < nItems; l++){
+			dim_t lin = 0;
+
+			for(j = 0; j < order; j++)
+				lin += (C.offset[j] + index[j]) * stride[j];
+			owner[l] = FLASH_Queue_affinity_owner(C.offset[0] + index[0], C.offset[order-1] + index[order-1], lin, nThreads);
+			thread[owner[l]].nIters++;
+			FLA_Sttsm_next_block(order, nIters, index);
+		}
+
+		for(i = 0; i < nThreads; i++){
+			if(thread[i].nIters > 0)
+				thread[i].blocks = (dim_t*)FLA_malloc(thread[i].nIters * order * sizeof(dim_t));
+			thread[i].nIters = 0;
+		}
+		memset(index, 0, order * sizeof(dim_t));
+		for(l = 0; l < nItems; l++){
+			k = owner[l];
+			memcpy(&(thread[k].blocks[thread[k].nIters * order]), index, order * sizeof(dim_t));
+			thread[k].nIters++;
+			FLA_Sttsm_next_block(order, nIters, index);
+		}
+		FLA_free(owner);
+	}else if(pairs){
+		//cost[l']: iteration l' one level down; topCost: the top-level ttm
+		FLA_Sttsm_iteration_costs(A, C, order-2, nIters, cost, &topCost);
+		total = 0.0;
+		for(l = 0; l < nIters; l++){
+			total += topCost;
+			for(j = 0; j <= l; j++)
+				total += cost[j];
+		}
+
+		k = 0;
+		acc = 0.0;
+		for(l = 0; l < nIters; l++){
+			for(j = 0; j <= l; j++){
+				FLA_Bool enters = (thread[k].nIters == 0 || thread[k].iters[thread[k].nIters-1] != l);
+				double c = cost[j] + (enters ? topCost : 0.0);
+
+				//Close the run once it has its share of the total
+				if(thread[k].nIters > 0 && k < nThreads - 1 &&
+				   acc + thread[k].cost + c / 2 > total * (k + 1) / nThreads){
+					acc += thread[k].cost;
+					k++;
+					c = cost[j] + topCost;
+				}
+				thread[k].iters[thread[k].nIters] = l;
+				thread[k].subIters[thread[k].nIters] = j;
+				thread[k].nIters++;
+				thread[k].cost += c;
+			}
+		}
+	}else{
+		FLA_Sttsm_iteration_costs(A, C, order-1, nIters, cost, &topCost);
+
+		//Later iterations are never cheaper, so descending index is descending cost
+		for(i = 0; i < nIters; i++)
+			byCost[i] = nIters - 1 - i;
+
+		for(i = 0; i < nIters; i++){
+			k = 0;
+			for(j = 1; j < nThreads; j++)
+				if(thread[j].cost < thread[k].cost)
+					k = j;
+			thread[k].iters[thread[k].nIters++] = byCost[i];
+			thread[k].cost += cost[byCost[i]];
+		}
+	}
+
+	//Threads left without iterations need no temporaries
+	for(i = 0; i < nThreads; i++){
+		if(thread[i].nIters == 0)
+			continue;
+		if(psym_temps)
+			FLA_Sttsm_initialize_psym_temporaries(datatype, A, C, thread[i].temps);
+		else
+			FLA_Sttsm_initialize_temporaries(datatype, A, C, thread[i].temps);
+	}
+
+	//The leaves only read the 2-D info of the blocks of B shared by all threads
+	TLA_Adjust_2D_info_blocks(B);
+
+#if defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_PTHREADS
+	//The calling thread takes the first share
+	for(i = 1; i < nThreads; i++){
+		int r_val = pthread_create(&(thread[i].pthread_obj), NULL, FLA_Sttsm_thread_function, (void*)&thread[i]);
+		FLA_Check_error_code( FLA_Check_pthread_create_result( r_val ) );
+	}
+	FLA_Sttsm_thread_function((void*)&thread[0]);
+	for(i = 1; i < nThreads; i++){
+		int r_val = pthread_join(thread[i].pthread_obj, NULL);
+		FLA_Check_error_code( FLA_Check_pthread_join_result( r_val ) );
+	}
+#elif defined(FLA_ENABLE_MULTITHREADING) && FLA_MULTITHREADING_MODEL == FLA_OPENMP
+	#pragma omp parallel for num_threads(nThreads) schedule(static, 1)
+	for(i = 0; i < nThreads; i++)
+		FLA_Sttsm_thread_function((void*)&thread[i]);
+#else
+	for(i = 0; i < nThreads; i++)
+		FLA_Sttsm_thread_function((void*)&thread[i]);
+#endif
+
+	for(i = 0; i < nThreads; i++){
+		if(thread[i].nIters > 0){
+			if(psym_temps)
+				FLA_Sttsm_destroy_psym_temporaries(order, thread[i].temps);
+			else
+				FLA_Sttsm_destroy_temporaries(order, thread[i].temps);
+		}
+		if(thread[i].iters != NULL)
+			FLA_free(thread[i].iters);
+		if(thread[i].subIters != NULL)
+			FLA_free(thread[i].subIters);
+		if(thread[i].blocks != NULL)
+			FLA_free(thread[i].blocks);
+	}
+	FLA_free(thread);
+	FLA_free(byCost);
+	FLA_free(cost);
+
+	return FLA_SUCCESS;
+}
+
 //No psym temps
 FLA_Error FLA_Sttsm_without_psym_temps( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C )
 {
-	//Create temporaries used in sttsm
+	return FLA_Sttsm_without_psym_temps_ext( FLA_Obj_datatype(C), alpha, A, beta, B, C );
+}
+
+//Temporaries are kept in datatype.  With float A, B & C and datatype
+//FLA_DOUBLE (or complex/double complex) the partial results are accumulated
+//in double precision; each block is converted as it is multiplied
+FLA_Error FLA_Sttsm_without_psym_temps_ext( FLA_Datatype datatype, FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C )
+{
 	FLA_Obj* temps[FLA_MAX_ORDER];
-	initialize_temporaries(A, C, temps);
+
+	if(FLA_Sttsm_par_threads() > 1)
+		return FLA_Sttsm_par(datatype, FALSE, alpha, A, beta, B, C);
+
+	//Create temporaries used in sttsm
+	FLA_Sttsm_initialize_temporaries(datatype, A, C, temps);
 	
 	//Compute
 	FLA_Sttsm_single( alpha, A, FLA_Obj_order(C)-1, beta, B, C, FLA_Obj_dimsize(C,FLA_Obj_order(C)-1)-1, temps);
 	
 	//Cleanup
-	destroy_temporaries(A.order, temps);
+	FLA_Sttsm_destroy_temporaries(A.order, temps);
 
 	return FLA_SUCCESS;
 }
@@ -253,15 +710,25 @@ FLA_Error FLA_Sttsm_without_psym_temps( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta,
 
 FLA_Error FLA_Sttsm_with_psym_temps( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C )
 {
-	//Create temporaries used in sttsm
+	return FLA_Sttsm_with_psym_temps_ext( FLA_Obj_datatype(C), alpha, A, beta, B, C );
+}
+
+//See FLA_Sttsm_without_psym_temps_ext
+FLA_Error FLA_Sttsm_with_psym_temps_ext( FLA_Datatype datatype, FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C )
+{
 	FLA_Obj* temps[FLA_MAX_ORDER];
-	initialize_psym_temporaries(A, C, temps);
+
+	if(FLA_Sttsm_par_threads() > 1)
+		return FLA_Sttsm_par(datatype, TRUE, alpha, A, beta, B, C);
+
+	//Create temporaries used in sttsm
+	FLA_Sttsm_initialize_psym_temporaries(datatype, A, C, temps);
 
 	//Compute
     FLA_Sttsm_single_psttm( alpha, A, FLA_Obj_order(C)-1, beta, B, C, FLA_Obj_dimsize(C,FLA_Obj_order(C)-1)-1, temps);
 	
     //Cleanup
-	destroy_psym_temporaries(A.order, temps);
+	FLA_Sttsm_destroy_psym_temporaries(A.order, temps);
 
 	return FLA_SUCCESS;
 }
@@ -34,3 +34,22 @@
 FLA_Error FLA_Sttsm_single( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C, dim_t maxIndex, FLA_Obj* temps[] );
 FLA_Error FLA_Sttsm_without_psym_temps( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
 FLA_Error FLA_Sttsm_with_psym_temps( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+FLA_Error FLA_Sttsm_without_psym_temps_ext( FLA_Datatype datatype, FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+FLA_Error FLA_Sttsm_with_psym_temps_ext( FLA_Datatype datatype, FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+void      FLA_Sttsm_set_num_threads( dim_t n_threads );
+dim_t     FLA_Sttsm_get_num_threads( void );
+void      FLA_Sttsm_initialize_temporaries( FLA_Datatype datatype, FLA_Obj A, FLA_Obj C, FLA_Obj* temps[] );
+void      FLA_Sttsm_destroy_temporaries( dim_t order, FLA_Obj* temps[] );
+void      FLA_Sttsm_initialize_psym_temporaries( FLA_Datatype datatype, FLA_Obj A, FLA_Obj C, FLA_Obj* temps[] );
+void      FLA_Sttsm_destroy_psym_temporaries( dim_t order, FLA_Obj* temps[] );
+FLA_Error TLA_Sttsm_plan_create( FLA_Obj A, FLA_Obj B, FLA_Obj C, dim_t flags, TLA_Sttsm_plan* plan );
+FLA_Error TLA_Sttsm_plan_execute( TLA_Sttsm_plan* plan, FLA_Obj alpha, FLA_Obj beta );
+FLA_Error TLA_Sttsm_plan_execute_ops( TLA_Sttsm_plan* plan, dim_t begin, dim_t end, FLA_Obj alpha, FLA_Obj beta );
+FLA_Error TLA_Sttsm_plan_destroy( TLA_Sttsm_plan* plan );
+FLA_Error TLA_Sttsm_plan_execute_ooc( TLA_Sttsm_plan* plan, FLA_Obj alpha, FLA_Obj beta, size_t budget );
+FLA_Error TLA_Sttsm_ooc( FLA_Obj alpha, const char* pathA, FLA_Obj beta, FLA_Obj B, const char* pathC, dim_t flags, size_t budget );
+#ifdef FLA_ENABLE_MPI
+FLA_Error FLA_Sttsm_mpi( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C, MPI_Comm comm );
+int       FLA_Sttsm_mpi_owner( FLA_Obj A, const dim_t blkIndex[], int nRanks );
+FLA_Error FLA_Obj_mpi_allgather_psym_tensor( FLA_Obj A, MPI_Comm comm );
+#endif
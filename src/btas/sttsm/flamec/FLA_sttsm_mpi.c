@@ -0,0 +1,380 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+
+#ifdef FLA_ENABLE_MPI
+
+//Distributed-memory sttsm.
+//
+//The unique blocks of the (fully symmetric) blocked psym tensors A and C are
+//spread over the ranks of a communicator.  A unique block is identified by
+//its sorted block index j_0 <= ... <= j_{order-1}, so all the blocks of an
+//orbit have the same owner, and the top-level loop of FLA_Sttsm_single
+//computes exactly the unique blocks of C with j_{order-1} = l in iteration l.
+//Iterations are dealt block-cyclically: with P ranks and n iterations, the
+//G = min(P, n) groups of ranks g, g + G, g + 2G, ... take iterations
+//g, g + G, g + 2G, ...  When P <= n every group is a single rank and owns
+//the C blocks of its iterations.
+//
+//Larger groups deal the second-level iterations (j_{order-2} = k) over their
+//members, which own the C blocks they compute.  FLA_Sttsm_mpi_owner gives
+//the owner of a block, of A (over the blocks of A) as well as of C.
+//
+//A and C stay distributed: the unique blocks a rank owns are the only ones
+//read (and, for C, written) there.  The first product of iteration l,
+//X = A x_{order-1} B(l, :), is a sum over the blocks of A: every rank
+//computes the part of it from the blocks of A it owns, and the parts are
+//summed (MPI_Reduce) onto the group of l, whose first member passes X on to
+//the others.  The memory used per rank is that of B and the temporaries,
+//besides the objects passed in.  B, which is small, is broadcast from rank
+//0.  For order 1 the only product is into C and A, a vector no longer than
+//a row of B, is gathered on every rank instead
+//(FLA_Obj_mpi_allgather_psym_tensor).
+//
+//Messages are split into pieces of at most 2^30 elements, so that their int
+//counts cannot overflow
+
+//MPI type of the real components of datatype, and their number per element
+static MPI_Datatype FLA_Sttsm_mpi_type( FLA_Datatype datatype, int* nComponents )
+{
+	*nComponents = (datatype == FLA_COMPLEX || datatype == FLA_DOUBLE_COMPLEX) ? 2 : 1;
+	if(datatype == FLA_FLOAT || datatype == FLA_COMPLEX)
+		return MPI_FLOAT;
+	return MPI_DOUBLE;
+}
+
+//Rank owning the block with block index index (any order of it) when the
+//tensor has nIters blocks along each mode
+static int FLA_Sttsm_mpi_owner_of( dim_t order, const dim_t index[], dim_t nIters, int nRanks )
+{
+	dim_t i;
+	dim_t first = 0;
+	dim_t second = 0;
+	int nGroups = (nIters < (dim_t)nRanks) ? (int)nIters : nRanks;
+	int group, groupSize;
+
+	for(i = 0; i < order; i++){
+		if(index[i] >= first){
+			second = first;
+			first = index[i];
+		}else if(index[i] > second){
+			second = index[i];
+		}
+	}
+	if(order < 2)
+		second = 0;
+
+	group = (int)(first % nGroups);
+	groupSize = (nRanks - 1 - group) / nGroups + 1;
+	return group + (int)(second % groupSize) * nGroups;
+}
+
+//Owner of the block at blkIndex of the blocked psym tensor A among nRanks
+//ranks (see above)
+int FLA_Sttsm_mpi_owner( FLA_Obj A, const dim_t blkIndex[], int nRanks )
+{
+	return FLA_Sttsm_mpi_owner_of(FLA_Obj_order(A), blkIndex, A.size[FLA_Obj_order(A)-1], nRanks);
+}
+
+//Bytes stored for a block (only the unique entries of packed blocks)
+static size_t FLA_Sttsm_mpi_block_bytes( const FLA_Base_obj* blk )
+{
+	size_t elemSize = FLA_Obj_datatype_size(blk->datatype);
+
+	if(blk->isPacked)
+		return TLA_packed_sym_size(blk->packed_sym, blk->size) * elemSize;
+	return FLA_array_product(blk->order, blk->size) * elemSize;
+}
+
+//Broadcasts bytes bytes at buf from root, in pieces of at most 2^30 bytes
+static void FLA_Sttsm_mpi_bcast_bytes( char* buf, size_t bytes, int root, MPI_Comm comm )
+{
+	while(bytes > 0){
+		int chunk = (bytes > (1U << 30)) ? (1 << 30) : (int)bytes;
+
+		MPI_Bcast(buf, chunk, MPI_BYTE, root, comm);
+		buf += chunk;
+		bytes -= chunk;
+	}
+}
+
+//Copies every unique block of the blocked psym tensor A from its owner to all
+//ranks of comm
+FLA_Error FLA_Obj_mpi_allgather_psym_tensor( FLA_Obj A, MPI_Comm comm )
+{
+	dim_t u;
+	dim_t order = FLA_Obj_order(A);
+	dim_t curIndex[FLA_MAX_ORDER];
+	TLA_unique_map* map = A.base->blk_unique_map;
+	FLA_Obj* buf_A = (FLA_Obj*)A.base->buffer;
+	int r, rank, nRanks;
+	int* owner;
+	size_t* counts;
+	size_t maxCount;
+	char* packed;
+	size_t pos;
+
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &nRanks);
+	if(nRanks == 1)
+		return FLA_SUCCESS;
+
+	//Owner of each unique block, in the order of the map, and bytes per owner
+	owner = (int*)FLA_malloc(map->nUniques * sizeof(int));
+	counts = (size_t*)FLA_malloc(nRanks * sizeof(size_t));
+	for(r = 0; r < nRanks; r++)
+		counts[r] = 0;
+	memset(&(curIndex[0]), 0, order * sizeof(dim_t));
+	for(u = 0; u < map->nUniques; u++){
+		owner[u] = FLA_Sttsm_mpi_owner(A, curIndex, nRanks);
+		counts[owner[u]] += FLA_Sttsm_mpi_block_bytes(buf_A[map->uniqueLinIndex[u]].base);
+		TLA_next_unique_index(A.sym, A.size, curIndex);
+	}
+	maxCount = 0;
+	for(r = 0; r < nRanks; r++)
+		if(counts[r] > maxCount)
+			maxCount = counts[r];
+
+	//Each owner in turn packs its blocks and broadcasts them
+	packed = (char*)FLA_malloc(maxCount + 1);
+	for(r = 0; r < nRanks; r++){
+		for(u = 0, pos = 0; r == rank && u < map->nUniques; u++){
+			FLA_Base_obj* blk = buf_A[map->uniqueLinIndex[u]].base;
+
+			if(owner[u] != r)
+				continue;
+			memcpy(packed + pos, blk->buffer, FLA_Sttsm_mpi_block_bytes(blk));
+			pos += FLA_Sttsm_mpi_block_bytes(blk);
+		}
+		FLA_Sttsm_mpi_bcast_bytes(packed, counts[r], r, comm);
+		for(u = 0, pos = 0; r != rank && u < map->nUniques; u++){
+			FLA_Base_obj* blk = buf_A[map->uniqueLinIndex[u]].base;
+
+			if(owner[u] != r)
+				continue;
+			memcpy(blk->buffer, packed + pos, FLA_Sttsm_mpi_block_bytes(blk));
+			pos += FLA_Sttsm_mpi_block_bytes(blk);
+		}
+	}
+
+	FLA_free(packed);
+	FLA_free(counts);
+	FLA_free(owner);
+	return FLA_SUCCESS;
+}
+
+//Copies all blocks of the blocked tensor B from rank root to the other ranks
+static void FLA_Sttsm_mpi_bcast_blocks( FLA_Obj B, int root, MPI_Comm comm )
+{
+	dim_t i;
+	dim_t nBlocks = FLA_array_product(B.base->order, B.base->size);
+	FLA_Obj* buf_B = (FLA_Obj*)B.base->buffer;
+	size_t bytes = 0;
+	size_t pos;
+	char* packed;
+	int rank;
+
+	MPI_Comm_rank(comm, &rank);
+	for(i = 0; i < nBlocks; i++)
+		bytes += FLA_Sttsm_mpi_block_bytes(buf_B[i].base);
+
+	packed = (char*)FLA_malloc(bytes + 1);
+	if(rank == root){
+		for(i = 0, pos = 0; i < nBlocks; pos += FLA_Sttsm_mpi_block_bytes(buf_B[i].base), i++)
+			memcpy(packed + pos, buf_B[i].base->buffer, FLA_Sttsm_mpi_block_bytes(buf_B[i].base));
+	}
+	FLA_Sttsm_mpi_bcast_bytes(packed, bytes, root, comm);
+	if(rank != root){
+		for(i = 0, pos = 0; i < nBlocks; pos += FLA_Sttsm_mpi_block_bytes(buf_B[i].base), i++)
+			memcpy(buf_B[i].base->buffer, packed + pos, FLA_Sttsm_mpi_block_bytes(buf_B[i].base));
+	}
+	FLA_free(packed);
+}
+
+//Sums the temporary X over comm onto root.  Temporaries are blocked tensors
+//carved from one unaligned slab (see FLA_Sttsm_initialize_temporaries),
+//summed as one array
+static void FLA_Sttsm_mpi_reduce_temp( FLA_Obj X, int root, MPI_Comm comm )
+{
+	int rank, nComponents;
+	MPI_Datatype type = FLA_Sttsm_mpi_type(FLA_Obj_datatype(X), &nComponents);
+	FLA_Obj* buf_X = (FLA_Obj*)X.base->buffer;
+	size_t count = FLA_array_product(X.order, X.size) * FLA_array_product(X.order, buf_X[0].base->size) * nComponents;
+	size_t elemSize = FLA_Obj_datatype_size(FLA_Obj_datatype(X)) / nComponents;
+	char* slab = (char*)X.base->blk_slab;
+
+	MPI_Comm_rank(comm, &rank);
+	while(count > 0){
+		int chunk = (count > (1U << 30)) ? (1 << 30) : (int)count;
+
+		if(rank == root)
+			MPI_Reduce(MPI_IN_PLACE, slab, chunk, type, MPI_SUM, root, comm);
+		else
+			MPI_Reduce(slab, NULL, chunk, type, MPI_SUM, root, comm);
+		slab += (size_t)chunk * elemSize;
+		count -= chunk;
+	}
+}
+
+//Copies the temporary X from root to the other ranks of comm
+static void FLA_Sttsm_mpi_bcast_temp( FLA_Obj X, int root, MPI_Comm comm )
+{
+	FLA_Obj* buf_X = (FLA_Obj*)X.base->buffer;
+	size_t bytes = FLA_array_product(X.order, X.size) * FLA_array_product(X.order, buf_X[0].base->size) * FLA_Obj_datatype_size(FLA_Obj_datatype(X));
+
+	FLA_Sttsm_mpi_bcast_bytes((char*)X.base->blk_slab, bytes, root, comm);
+}
+
+//C := alpha C + beta (A x_0 B x_1 B ... x_{order-1} B), the operation of
+//FLA_Sttsm_without_psym_temps, over the ranks of comm.  Every rank passes
+//objects of the same shapes.  On entry the unique blocks of A and C a rank
+//owns (FLA_Sttsm_mpi_owner) hold its share of them and B on rank 0 holds B;
+//the other blocks of B (and, for order 1, of A) are overwritten.  On exit the
+//unique blocks of C a rank owns hold the result; the others are left as they
+//were.  The products are those of the serial routine, except that the first
+//product of each iteration is summed over the blocks of A in another order,
+//so the result may differ from it by rounding
+FLA_Error FLA_Sttsm_mpi( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C, MPI_Comm comm )
+{
+	dim_t i, j, k, l;
+	dim_t order = FLA_Obj_order(C);
+	dim_t mode = order - 1;
+	dim_t nIters = FLA_Obj_dimsize(C, mode);
+	dim_t nContract = FLA_Obj_dimsize(A, mode);
+	dim_t nBlocksA = FLA_array_product(order, A.size);
+	dim_t nOwned = 0;
+	dim_t index[FLA_MAX_ORDER] = {0};
+	dim_t* owned;
+	int rank, nRanks, nGroups, group, member, groupSize;
+	MPI_Comm groupComm;
+	FLA_Obj* temps[FLA_MAX_ORDER];
+	TLA_View Av, Bv, Cv;
+
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &nRanks);
+	nGroups = (nIters < (dim_t)nRanks) ? (int)nIters : nRanks;
+	group = rank % nGroups;
+	member = rank / nGroups;
+	groupSize = (nRanks - 1 - group) / nGroups + 1;
+
+	FLA_Sttsm_mpi_bcast_blocks(B, 0, comm);
+	if(mode == 0)
+		FLA_Obj_mpi_allgather_psym_tensor(A, comm);
+	MPI_Comm_split(comm, group, member, &groupComm);
+
+	//Block indices (all of them, not only the unique ones) of the blocks of A
+	//whose unique block the rank owns
+	owned = (dim_t*)FLA_malloc((nBlocksA * order + 1) * sizeof(dim_t));
+	for(i = 0; mode > 0 && i < nBlocksA; i++){
+		if(FLA_Sttsm_mpi_owner(A, index, nRanks) == rank){
+			memcpy(&(owned[nOwned * order]), index, order * sizeof(dim_t));
+			nOwned++;
+		}
+		for(j = 0; j < order && ++index[j] == nContract; j++)
+			index[j] = 0;
+	}
+
+	FLA_Sttsm_initialize_temporaries(FLA_Obj_datatype(C), A, C, temps);
+	TLA_View_from_obj(&A, &Av);
+	TLA_View_from_obj(&B, &Bv);
+	TLA_View_from_obj(&C, &Cv);
+
+	for(l = 0; l < nIters; l++){
+		int lGroup = (int)(l % nGroups);
+		TLA_View B1, C1, X;
+
+		TLA_View_slice(&Bv, 0, l, &B1);
+		TLA_View_slice(&Cv, mode, l, &C1);
+
+		if(mode == 0){
+			if(lGroup == group && member == 0)
+				FLA_Ttm_single_mode_view(alpha, &Av, mode, beta, &B1, &C1);
+			continue;
+		}
+
+		//First product, summed over the owned blocks of A by every rank and
+		//then across ranks.  It overwrites X, so the parts accumulate with
+		//alpha = 1; alpha and beta apply only to the products into C below
+		FLA_Set_zero_tensor(*(temps[mode]));
+		TLA_View_from_obj(temps[mode], &X);
+		for(i = 0; i < nOwned; i++){
+			const dim_t* blk = &(owned[i * order]);
+			TLA_View A1, A2, B11, X1, X2;
+
+			A1 = Av;
+			X1 = X;
+			for(j = 0; j < mode; j++){
+				TLA_View_slice(&A1, j, blk[j], &A2);
+				TLA_View_slice(&X1, j, blk[j], &X2);
+				A1 = A2;
+				X1 = X2;
+			}
+			TLA_View_slice(&A1, mode, blk[mode], &A2);
+			TLA_View_slice(&B1, 1, blk[mode], &B11);
+			FLA_Ttm_single_mode_view(FLA_ONE, &A2, mode, FLA_ONE, &B11, &X1);
+		}
+		FLA_Sttsm_mpi_reduce_temp(*(temps[mode]), lGroup, comm);
+		if(lGroup != group)
+			continue;
+		if(groupSize > 1)
+			FLA_Sttsm_mpi_bcast_temp(*(temps[mode]), 0, groupComm);
+
+		//Second-level iterations, dealt over the group
+		for(k = member; k <= l; k += groupSize){
+			TLA_View B2, C2;
+
+			TLA_View_slice(&Bv, 0, k, &B2);
+			TLA_View_slice(&C1, mode-1, k, &C2);
+			if(mode == 1){
+				FLA_Ttm_single_mode_view(alpha, &X, mode-1, beta, &B2, &C2);
+			}else{
+				FLA_Obj X2, C2obj;
+				TLA_View X2v;
+
+				X2 = *(temps[mode-1]);
+				TLA_View_from_obj(&X2, &X2v);
+				FLA_Ttm_single_mode_view(FLA_ZERO, &X, mode-1, FLA_ONE, &B2, &X2v);
+				TLA_View_to_obj(&C2, &C2obj);
+				FLA_Sttsm_single(alpha, X2, mode-2, beta, B, C2obj, k, temps);
+			}
+		}
+	}
+
+	FLA_Sttsm_destroy_temporaries(order, temps);
+	FLA_free(owned);
+	MPI_Comm_free(&groupComm);
+
+	return FLA_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,412 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+#include <unistd.h>
+#include <sys/mman.h>
+
+//Out-of-core sttsm.
+//
+//A and C are blocked psym tensors mapped from files written by
+//TLA_Obj_write_blocked_psym_tensor, so the kernels read and write their
+//blocks in place and the kernel pages them in and out.  Left alone, it does
+//so on fault and evicts by its own policy.  Since a plan lists the mode
+//products in the order they run, the blocks each one touches are known up
+//front: TLA_Sttsm_plan_execute_ooc keeps the mapped blocks in use within a
+//byte budget, asks for the blocks of the next TLA_STTSM_OOC_LOOKAHEAD
+//products ahead of time (MADV_WILLNEED) and drops the least recently used
+//blocks no pending product needs, starting the write-back of dirty C blocks
+//(MS_ASYNC) as they leave.  If the blocks of one product exceed the budget,
+//that product still runs; the budget is exceeded for it instead of failing.
+//
+//Only mapped blocks are managed.  The temporaries of the plan, the size of A
+//contracted by one mode each, stay in memory.
+
+#define TLA_OOC_NONE ((dim_t)-1)
+
+//A mapped block, and its place in the least recently used list
+typedef struct
+{
+	FLA_Base_obj* base;
+	FLA_Base_obj* owner;    // base of the tensor the block belongs to
+	char*         addr;     // first page of the block
+	size_t        bytes;    // bytes of its pages
+	dim_t         stamp;    // last product that needs it
+	FLA_Bool      resident;
+	FLA_Bool      dirty;
+	FLA_Bool      written;  // by any product so far
+	FLA_Bool      pinned;   // written to a private mapping: never dropped
+	dim_t         prev;
+	dim_t         next;
+} TLA_Ooc_block;
+
+//Block of a product, and whether the product writes it
+typedef struct
+{
+	FLA_Base_obj* base;
+	FLA_Base_obj* owner;
+	dim_t         id;
+	FLA_Bool      write;
+} TLA_Ooc_ref;
+
+typedef struct
+{
+	dim_t          nBlocks;
+	TLA_Ooc_block* blocks;
+	dim_t*         opStart;   // [nOps + 1] first ref of each product
+	TLA_Ooc_ref*   refs;
+	dim_t          head;
+	dim_t          tail;
+	size_t         residentBytes;
+} TLA_Ooc_cache;
+
+static int TLA_Ooc_ref_compare( const void* a, const void* b )
+{
+	const TLA_Ooc_ref* ra = (const TLA_Ooc_ref*)a;
+	const TLA_Ooc_ref* rb = (const TLA_Ooc_ref*)b;
+
+	if(ra->base != rb->base)
+		return ((size_t)ra->base < (size_t)rb->base) ? -1 : 1;
+	return 0;
+}
+
+static int TLA_Ooc_block_compare( const void* a, const void* b )
+{
+	const TLA_Ooc_ref* r = (const TLA_Ooc_ref*)a;
+	const TLA_Ooc_block* blk = (const TLA_Ooc_block*)b;
+
+	if(r->base != blk->base)
+		return ((size_t)r->base < (size_t)blk->base) ? -1 : 1;
+	return 0;
+}
+
+static int TLA_Ooc_id_compare( const void* a, const void* b )
+{
+	const TLA_Ooc_ref* ra = (const TLA_Ooc_ref*)a;
+	const TLA_Ooc_ref* rb = (const TLA_Ooc_ref*)b;
+
+	if(ra->id != rb->id)
+		return (ra->id < rb->id) ? -1 : 1;
+	return 0;
+}
+
+//Appends the blocks of the view V if it is a view of a mapped tensor
+static void TLA_Ooc_add_view_refs( FLA_Obj V, FLA_Bool write, dim_t* nRefs, dim_t* capacity, TLA_Ooc_ref** refs )
+{
+	dim_t i;
+	dim_t order = V.order;
+	dim_t nBlocks = FLA_array_product(order, V.size);
+	dim_t index[FLA_MAX_ORDER];
+	const dim_t* stride = V.base->stride;
+	FLA_Obj* buffer = (FLA_Obj*)V.base->buffer;
+
+	if(V.base->elemtype != FLA_TENSOR || V.base->blk_slab_mapped == 0 || nBlocks == 0)
+		return;
+
+	memset(&(index[0]), 0, order * sizeof(dim_t));
+	for(i = 0; i < nBlocks; i++){
+		dim_t j;
+		size_t linIndex = 0;
+		TLA_Ooc_ref* ref;
+
+		for(j = 0; j < order; j++)
+			linIndex += (V.offset[j] + index[j]) * stride[j];
+
+		if(*nRefs == *capacity){
+			*capacity = (*capacity == 0) ? 64 : 2 * (*capacity);
+			*refs = (TLA_Ooc_ref*)FLA_realloc(*refs, *capacity * sizeof(TLA_Ooc_ref));
+		}
+		ref = &((*refs)[(*nRefs)++]);
+		ref->base = buffer[linIndex].base;
+		ref->owner = V.base;
+		ref->write = write;
+
+		for(j = 0; j < order && ++index[j] == V.size[j]; j++)
+			index[j] = 0;
+	}
+}
+
+//Pages spanned by a block's data (only the unique entries of packed blocks)
+static void TLA_Ooc_block_pages( FLA_Base_obj* base, size_t pageSize, char** addr, size_t* bytes )
+{
+	size_t elemSize = FLA_Obj_datatype_size(base->datatype);
+	size_t dataBytes = base->isPacked ?
+	                   TLA_packed_sym_size(base->packed_sym, base->size) * elemSize :
+	                   FLA_array_product(base->order, base->size) * elemSize;
+	size_t first = (size_t)base->buffer & ~(pageSize - 1);
+	size_t last = ((size_t)base->buffer + dataBytes + pageSize - 1) & ~(pageSize - 1);
+
+	*addr = (char*)first;
+	*bytes = last - first;
+}
+
+//Lists the mapped blocks of every product of the plan
+static void TLA_Ooc_cache_init( const TLA_Sttsm_plan* plan, TLA_Ooc_cache* cache )
+{
+	dim_t i, j;
+	dim_t nRefs = 0;
+	dim_t capacity = 0;
+	size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	TLA_Ooc_ref* sorted;
+	TLA_Ooc_ref* refs = NULL;
+
+	cache->opStart = (dim_t*)FLA_malloc((plan->nOps + 1) * sizeof(dim_t));
+	for(i = 0; i < plan->nOps; i++){
+		cache->opStart[i] = nRefs;
+		TLA_Ooc_add_view_refs(plan->ops[i].A, FALSE, &nRefs, &capacity, &refs);
+		TLA_Ooc_add_view_refs(plan->ops[i].C, TRUE, &nRefs, &capacity, &refs);
+	}
+	cache->opStart[plan->nOps] = nRefs;
+
+	//Distinct blocks
+	cache->nBlocks = 0;
+	cache->blocks = NULL;
+	if(nRefs > 0){
+		sorted = (TLA_Ooc_ref*)FLA_malloc(nRefs * sizeof(TLA_Ooc_ref));
+		memcpy(sorted, refs, nRefs * sizeof(TLA_Ooc_ref));
+		qsort(sorted, nRefs, sizeof(TLA_Ooc_ref), TLA_Ooc_ref_compare);
+
+		cache->blocks = (TLA_Ooc_block*)FLA_malloc(nRefs * sizeof(TLA_Ooc_block));
+		for(i = 0; i < nRefs; i++){
+			TLA_Ooc_block* blk;
+
+			if(i > 0 && sorted[i].base == sorted[i-1].base)
+				continue;
+			blk = &(cache->blocks[cache->nBlocks++]);
+			blk->base = sorted[i].base;
+			blk->owner = sorted[i].owner;
+			TLA_Ooc_block_pages(blk->base, pageSize, &(blk->addr), &(blk->bytes));
+			blk->stamp = 0;
+			blk->resident = FALSE;
+			blk->dirty = FALSE;
+			blk->written = FALSE;
+			blk->pinned = FALSE;
+			blk->prev = TLA_OOC_NONE;
+			blk->next = TLA_OOC_NONE;
+		}
+		FLA_free(sorted);
+	}
+
+	//Identify the blocks of each product, once each
+	for(i = 0; i < nRefs; i++){
+		TLA_Ooc_block* blk = (TLA_Ooc_block*)bsearch(&(refs[i]), cache->blocks, cache->nBlocks,
+		                                             sizeof(TLA_Ooc_block), TLA_Ooc_block_compare);
+		refs[i].id = (dim_t)(blk - cache->blocks);
+		if(refs[i].write && !(refs[i].owner->blk_slab_shared))
+			blk->pinned = TRUE;
+	}
+	capacity = 0;
+	for(i = 0; i < plan->nOps; i++){
+		dim_t first = cache->opStart[i];
+		dim_t last = cache->opStart[i+1];
+
+		qsort(&(refs[first]), last - first, sizeof(TLA_Ooc_ref), TLA_Ooc_id_compare);
+		cache->opStart[i] = capacity;
+		for(j = first; j < last; j++){
+			if(capacity > cache->opStart[i] && refs[capacity-1].id == refs[j].id)
+				refs[capacity-1].write |= refs[j].write;
+			else
+				refs[capacity++] = refs[j];
+		}
+	}
+	cache->opStart[plan->nOps] = capacity;
+
+	cache->refs = refs;
+	cache->head = TLA_OOC_NONE;
+	cache->tail = TLA_OOC_NONE;
+	cache->residentBytes = 0;
+}
+
+static void TLA_Ooc_cache_free( TLA_Ooc_cache* cache )
+{
+	if(cache->blocks != NULL)
+		FLA_free(cache->blocks);
+	if(cache->refs != NULL)
+		FLA_free(cache->refs);
+	FLA_free(cache->opStart);
+}
+
+static void TLA_Ooc_unlink( TLA_Ooc_cache* cache, dim_t id )
+{
+	TLA_Ooc_block* blk = &(cache->blocks[id]);
+
+	if(blk->prev == TLA_OOC_NONE)
+		cache->head = blk->next;
+	else
+		cache->blocks[blk->prev].next = blk->next;
+	if(blk->next == TLA_OOC_NONE)
+		cache->tail = blk->prev;
+	else
+		cache->blocks[blk->next].prev = blk->prev;
+	blk->prev = TLA_OOC_NONE;
+	blk->next = TLA_OOC_NONE;
+}
+
+//Marks the block needed by product stamp, most recently used, and asks for
+//its pages if it is not resident
+static void TLA_Ooc_touch( TLA_Ooc_cache* cache, dim_t id, dim_t stamp )
+{
+	TLA_Ooc_block* blk = &(cache->blocks[id]);
+
+	if(stamp > blk->stamp)
+		blk->stamp = stamp;
+	if(blk->resident){
+		TLA_Ooc_unlink(cache, id);
+	}else{
+		madvise(blk->addr, blk->bytes, MADV_WILLNEED);
+		blk->resident = TRUE;
+		cache->residentBytes += blk->bytes;
+	}
+	blk->prev = cache->tail;
+	if(cache->tail == TLA_OOC_NONE)
+		cache->head = id;
+	else
+		cache->blocks[cache->tail].next = id;
+	cache->tail = id;
+}
+
+//Starts writing the block back if dirty and releases its pages
+static void TLA_Ooc_drop( TLA_Ooc_cache* cache, dim_t id )
+{
+	TLA_Ooc_block* blk = &(cache->blocks[id]);
+
+	if(blk->dirty){
+		msync(blk->addr, blk->bytes, MS_ASYNC);
+		blk->dirty = FALSE;
+	}
+	madvise(blk->addr, blk->bytes, MADV_DONTNEED);
+	TLA_Ooc_unlink(cache, id);
+	blk->resident = FALSE;
+	cache->residentBytes -= blk->bytes;
+}
+
+//Drops least recently used blocks no product from cur on needs until the
+//resident blocks fit the budget (or none is left to drop)
+static void TLA_Ooc_evict( TLA_Ooc_cache* cache, dim_t cur, size_t budget )
+{
+	dim_t id = cache->head;
+
+	while(cache->residentBytes > budget && id != TLA_OOC_NONE){
+		dim_t next = cache->blocks[id].next;
+
+		if(!(cache->blocks[id].pinned) && cache->blocks[id].stamp < cur)
+			TLA_Ooc_drop(cache, id);
+		id = next;
+	}
+}
+
+//Prefetches the blocks of product op if they fit the budget next to those
+//of the products cur to op-1
+static FLA_Bool TLA_Ooc_prefetch( TLA_Ooc_cache* cache, dim_t op, dim_t cur, size_t budget )
+{
+	dim_t i;
+	size_t need = 0;
+
+	for(i = cache->opStart[op]; i < cache->opStart[op+1]; i++){
+		const TLA_Ooc_block* blk = &(cache->blocks[cache->refs[i].id]);
+		if(!(blk->resident))
+			need += blk->bytes;
+	}
+	if(cache->residentBytes + need > budget)
+		TLA_Ooc_evict(cache, cur, (need > budget) ? 0 : budget - need);
+	if(cache->residentBytes + need > budget)
+		return FALSE;
+
+	for(i = cache->opStart[op]; i < cache->opStart[op+1]; i++)
+		TLA_Ooc_touch(cache, cache->refs[i].id, op);
+	return TRUE;
+}
+
+//TLA_Sttsm_plan_execute keeping the blocks of mapped tensors among A and C
+//within budget bytes of memory (see above).  C should be mapped with
+//TLA_FILE_MAP_SHARED: blocks written through a private mapping cannot be
+//released and are kept resident.  On return all of C is written back
+FLA_Error TLA_Sttsm_plan_execute_ooc( TLA_Sttsm_plan* plan, FLA_Obj alpha, FLA_Obj beta, size_t budget )
+{
+	dim_t i, j;
+	TLA_Ooc_cache cache;
+
+	TLA_Ooc_cache_init(plan, &cache);
+
+	for(i = 0; i < plan->nOps; i++){
+		for(j = cache.opStart[i]; j < cache.opStart[i+1]; j++)
+			TLA_Ooc_touch(&cache, cache.refs[j].id, i);
+		TLA_Ooc_evict(&cache, i, budget);
+		for(j = i + 1; j <= i + TLA_STTSM_OOC_LOOKAHEAD && j < plan->nOps; j++)
+			if(!TLA_Ooc_prefetch(&cache, j, i, budget))
+				break;
+
+		TLA_Sttsm_plan_execute_ops(plan, i, i+1, alpha, beta);
+
+		for(j = cache.opStart[i]; j < cache.opStart[i+1]; j++)
+			if(cache.refs[j].write){
+				cache.blocks[cache.refs[j].id].dirty = TRUE;
+				cache.blocks[cache.refs[j].id].written = TRUE;
+			}
+	}
+
+	for(i = 0; i < cache.nBlocks; i++)
+		if(cache.blocks[i].written && cache.blocks[i].owner->blk_slab_shared)
+			msync(cache.blocks[i].addr, cache.blocks[i].bytes, MS_SYNC);
+
+	TLA_Ooc_cache_free(&cache);
+	return FLA_SUCCESS;
+}
+
+//C := alpha C + beta (A x_0 B x_1 B ... x_{order-1} B) for A and C stored in
+//the files pathA and pathC (see TLA_Obj_write_blocked_psym_tensor), holding
+//at most about budget bytes of their blocks in memory.  C is updated in its
+//file.  flags are those of TLA_Sttsm_plan_create
+FLA_Error TLA_Sttsm_ooc( FLA_Obj alpha, const char* pathA, FLA_Obj beta, FLA_Obj B, const char* pathC, dim_t flags, size_t budget )
+{
+	FLA_Obj A, C;
+	TLA_Sttsm_plan plan;
+
+	if(TLA_Obj_read_blocked_psym_tensor(pathA, TLA_FILE_MAP_PRIVATE, &A) != FLA_SUCCESS)
+		return FLA_FAILURE;
+	if(TLA_Obj_read_blocked_psym_tensor(pathC, TLA_FILE_MAP_SHARED, &C) != FLA_SUCCESS){
+		FLA_Obj_blocked_psym_tensor_free_buffer(&A);
+		FLA_Obj_free_without_buffer(&A);
+		return FLA_FAILURE;
+	}
+
+	TLA_Sttsm_plan_create(A, B, C, flags, &plan);
+	TLA_Sttsm_plan_execute_ooc(&plan, alpha, beta, budget);
+	TLA_Sttsm_plan_destroy(&plan);
+
+	FLA_Obj_blocked_psym_tensor_free_buffer(&A);
+	FLA_Obj_free_without_buffer(&A);
+	FLA_Obj_blocked_psym_tensor_free_buffer(&C);
+	FLA_Obj_free_without_buffer(&C);
+
+	return FLA_SUCCESS;
+}
@@ -0,0 +1,217 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+
+//Sttsm plans.
+//
+//Every call of FLA_Sttsm_*_psym_temps creates its temporaries, walks the
+//blocks of B and C through the FLA_Part/FLA_Repart loops of each level, walks
+//the blocks of each mode product down to its leaf block products and frees
+//the temporaries again.  A plan does all of that once for fixed A, B and C:
+//it owns the temporaries, records the mode products of the recursion on their
+//views and, through FLA_Ttm_record_begin, the leaf block products of each one
+//(the GEMM geometry and buffers, or the blocks for the products GEMM cannot
+//express), in the order the serial routine performs them.  Executing the plan
+//replays the leaves through one FLA_Ttm_batch, with no partitioning left.
+//
+//As with the buffers of an FFTW plan, the plan refers to A, B and C
+//themselves: new data is computed by overwriting their contents, and they
+//must outlive the plan.
+
+static void TLA_Sttsm_plan_add_op( TLA_Sttsm_plan* plan, dim_t* capacity, dim_t mode,
+                                   FLA_Bool overwriteC, FLA_Bool psttm,
+                                   FLA_Obj A, FLA_Obj B, FLA_Obj C )
+{
+	TLA_Sttsm_op* op;
+
+	if(plan->nOps == *capacity){
+		*capacity = (*capacity == 0) ? 16 : 2 * (*capacity);
+		plan->ops = (TLA_Sttsm_op*)FLA_realloc(plan->ops, *capacity * sizeof(TLA_Sttsm_op));
+	}
+	op = &(plan->ops[plan->nOps++]);
+	op->mode = mode;
+	op->overwriteC = overwriteC;
+	op->psttm = psttm;
+	op->A = A;
+	op->B = B;
+	op->C = C;
+	op->leafBegin = 0;
+	op->leafEnd = 0;
+}
+
+//Mirrors FLA_Sttsm_single and FLA_Sttsm_single_psttm, recording the products
+//instead of computing them
+static void TLA_Sttsm_plan_record( TLA_Sttsm_plan* plan, dim_t* capacity, FLA_Obj A, dim_t mode, FLA_Obj B, FLA_Obj C, dim_t endIndex )
+{
+	FLA_Bool psym_temps = (plan->flags & TLA_STTSM_PLAN_PSYM_TEMPS) != 0;
+	FLA_Obj BT, BB;
+	FLA_Obj B0, B1, B2;
+	FLA_Obj CT, CB;
+	FLA_Obj C0, C1, C2;
+	dim_t loopCount;
+
+	FLA_Part_1xmode2(B, &BT,
+						&BB, 0, 0, FLA_TOP);
+	FLA_Part_1xmode2(C, &CT,
+						&CB, mode, 0, FLA_TOP);
+	loopCount = 0;
+	while(loopCount <= endIndex){
+		dim_t b = 1;
+		FLA_Repart_1xmode2_to_1xmode3(BT, &B0,
+									/**/ /**/
+										  &B1,
+									  BB, &B2, 0, b, FLA_BOTTOM);
+		FLA_Repart_1xmode2_to_1xmode3(CT, &C0,
+									/**/ /**/
+										  &C1,
+									  CB, &C2, mode, b, FLA_BOTTOM);
+		/*********************************/
+		if(mode == 0){
+			TLA_Sttsm_plan_add_op(plan, capacity, mode, FALSE, FALSE, A, B1, C1);
+		}else{
+			FLA_Obj X = *(plan->temps[mode]);
+
+			TLA_Sttsm_plan_add_op(plan, capacity, mode, TRUE, psym_temps, A, B1, X);
+			TLA_Sttsm_plan_record(plan, capacity, X, mode-1, B, C1, loopCount);
+		}
+		/*********************************/
+		FLA_Cont_with_1xmode3_to_1xmode2( &CT, C0,
+											   C1,
+										/********/
+										  &CB, C2, mode, FLA_TOP);
+		FLA_Cont_with_1xmode3_to_1xmode2( &BT, B0,
+											   B1,
+										/********/
+										  &BB, B2, 0, FLA_TOP);
+		loopCount++;
+	}
+}
+
+//Plans C := alpha C + beta (A x_0 B x_1 B ... x_{order-1} B) for the given
+//objects.  flags is TLA_STTSM_PLAN_DEFAULT (the operation of
+//FLA_Sttsm_without_psym_temps) or TLA_STTSM_PLAN_PSYM_TEMPS (that of
+//FLA_Sttsm_with_psym_temps).  Temporaries are kept in the datatype of C.
+//Recording runs the mode products without computing anything, so no other
+//ttm may run meanwhile (see FLA_Ttm_record_begin)
+FLA_Error TLA_Sttsm_plan_create( FLA_Obj A, FLA_Obj B, FLA_Obj C, dim_t flags, TLA_Sttsm_plan* plan )
+{
+	dim_t order = FLA_Obj_order(C);
+	dim_t capacity = 0;
+	dim_t nThreads;
+	dim_t i;
+
+	plan->order = order;
+	plan->flags = flags;
+	plan->nOps = 0;
+	plan->ops = NULL;
+	FLA_Ttm_leaves_init(&(plan->leaves));
+
+	if(flags & TLA_STTSM_PLAN_PSYM_TEMPS)
+		FLA_Sttsm_initialize_psym_temporaries(FLA_Obj_datatype(C), A, C, plan->temps);
+	else
+		FLA_Sttsm_initialize_temporaries(FLA_Obj_datatype(C), A, C, plan->temps);
+
+	TLA_Sttsm_plan_record(plan, &capacity, A, order-1, B, C, FLA_Obj_dimsize(C, order-1)-1);
+
+	//Walk each product down to its leaves; FLA_Psttm must not hand its
+	//slices to worker threads while recording
+	nThreads = FLA_Psttv_get_num_threads();
+	FLA_Psttv_set_num_threads(1);
+	FLA_Ttm_record_begin(&(plan->leaves));
+	for(i = 0; i < plan->nOps; i++){
+		TLA_Sttsm_op* op = &(plan->ops[i]);
+
+		op->leafBegin = plan->leaves.nLeaves;
+		if(op->psttm)
+			FLA_Psttm(FLA_ONE, op->A, op->mode, FLA_ONE, op->B, op->C);
+		else
+			FLA_Ttm_single_mode(FLA_ONE, op->A, op->mode, FLA_ONE, op->B, op->C);
+		op->leafEnd = plan->leaves.nLeaves;
+	}
+	FLA_Ttm_record_end();
+	FLA_Psttv_set_num_threads(nThreads);
+
+	return FLA_SUCCESS;
+}
+
+//Computes the products ops[begin, end) of the plan on the current contents of
+//A, B and C
+FLA_Error TLA_Sttsm_plan_execute_ops( TLA_Sttsm_plan* plan, dim_t begin, dim_t end, FLA_Obj alpha, FLA_Obj beta )
+{
+	dim_t i;
+	FLA_Bool overwriteC = FALSE;
+	FLA_Ttm_batch batch;
+
+	FLA_Ttm_batch_init(alpha, beta, &batch);
+	for(i = begin; i < end; i++){
+		TLA_Sttsm_op* op = &(plan->ops[i]);
+
+		//Products into the temporaries overwrite them; alpha and beta
+		//apply only to the products into C
+		if(op->overwriteC != overwriteC){
+			FLA_Ttm_batch_flush(&batch);
+			batch.alpha = op->overwriteC ? FLA_ZERO : alpha;
+			batch.beta = op->overwriteC ? FLA_ONE : beta;
+			overwriteC = op->overwriteC;
+		}
+		FLA_Ttm_batch_add_leaves(&batch, &(plan->leaves), op->leafBegin, op->leafEnd);
+	}
+	FLA_Ttm_batch_flush(&batch);
+	FLA_Ttm_batch_free(&batch);
+
+	return FLA_SUCCESS;
+}
+
+//Computes the planned sttsm on the current contents of A, B and C.  The
+//block products are those of the serial FLA_Sttsm_*_psym_temps in the same
+//order, so the results are identical
+FLA_Error TLA_Sttsm_plan_execute( TLA_Sttsm_plan* plan, FLA_Obj alpha, FLA_Obj beta )
+{
+	return TLA_Sttsm_plan_execute_ops(plan, 0, plan->nOps, alpha, beta);
+}
+
+FLA_Error TLA_Sttsm_plan_destroy( TLA_Sttsm_plan* plan )
+{
+	if(plan->flags & TLA_STTSM_PLAN_PSYM_TEMPS)
+		FLA_Sttsm_destroy_psym_temporaries(plan->order, plan->temps);
+	else
+		FLA_Sttsm_destroy_temporaries(plan->order, plan->temps);
+
+	if(plan->ops != NULL)
+		FLA_free(plan->ops);
+	plan->ops = NULL;
+	plan->nOps = 0;
+	FLA_Ttm_leaves_free(&(plan->leaves));
+
+	return FLA_SUCCESS;
+}
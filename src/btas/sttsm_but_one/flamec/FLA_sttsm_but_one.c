@@ -75,12 +75,10 @@ FLA_Error FLA_Sttsm_but_one_single( FLA_Obj alpha, FLA_Obj A, dim_t mode, dim_t
 		if((mode == 0 && ignore_mode != 0) || (mode == 1 && ignore_mode == 0)){
 			FLA_Ttm_single_mode(alpha, A, mode, beta, B1, C1);
 		}else{
-			//Set the temporary to zero
 			FLA_Obj X = *(temps[mode]);
-            FLA_Set_zero_tensor(*(temps[mode]));
-            
-            //Compute temporary
-			FLA_Psttm(alpha, A, mode, beta, B1, X);
+
+            //Compute temporary (overwriting what the last iteration left there)
+			FLA_Psttm(FLA_ZERO, A, mode, FLA_ONE, B1, X);
 
 			//Use temporary for recursion
             FLA_Sttsm_but_one_single(alpha, X, mode-1, ignore_mode, beta, B, C1, loopCount, temps);
@@ -99,7 +97,9 @@ FLA_Error FLA_Sttsm_but_one_single( FLA_Obj alpha, FLA_Obj A, dim_t mode, dim_t
 	return FLA_SUCCESS;
 }
 
-void initialize_psym_but_one_temporaries(FLA_Obj A, FLA_Obj C, dim_t ignore_mode, FLA_Obj* temps[]){
+//Creates the temporaries of the levels below mode below (all of them if
+//below is the order of A)
+void initialize_psym_but_one_temporaries(FLA_Obj A, FLA_Obj C, dim_t ignore_mode, dim_t below, FLA_Obj* temps[]){
 	dim_t i, j;
 	dim_t order = FLA_Obj_order(A);
 	dim_t temp_blocked_size[FLA_MAX_ORDER];
@@ -132,18 +132,20 @@ void initialize_psym_but_one_temporaries(FLA_Obj A, FLA_Obj C, dim_t ignore_mode
 			FLA_Set_tensor_stride(order, temp_blocked_size, temp_blocked_stride);
 
 			//Create the temporary
-			temps[i] = (FLA_Obj*)FLA_malloc(sizeof(FLA_Obj));
-			FLA_Obj_create_blocked_psym_tensor(FLA_DOUBLE, order, temp_flat_size, temp_blocked_stride, temp_block_size, Xsym, temps[i]);
+			if(i < below){
+				temps[i] = (FLA_Obj*)FLA_malloc(sizeof(FLA_Obj));
+				TLA_Obj_create_blocked_psym_tensor_scratch(FLA_Obj_datatype(C), order, temp_flat_size, temp_blocked_stride, temp_block_size, Xsym, temps[i]);
+			}
 			tmpSym = Xsym;
 		}
 	}
 }
 
-void destroy_psym_but_one_temporaries(dim_t order, dim_t ignore_mode, FLA_Obj* temps[]){
+void destroy_psym_but_one_temporaries(dim_t order, dim_t ignore_mode, dim_t below, FLA_Obj* temps[]){
 	dim_t i;
 	for(i = order - 1; i > 0; i--){
 		//Skip the mode we didn't do anything with
-		if (i != ignore_mode){
+		if (i != ignore_mode && i < below){
 			FLA_Obj_blocked_psym_tensor_free_buffer(temps[i]);
 			FLA_Obj_free_without_buffer(temps[i]);
 			FLA_free(temps[i]);
@@ -156,7 +158,7 @@ FLA_Error FLA_Sttsm_but_one( FLA_Obj alpha, FLA_Obj A, dim_t ignore_mode, FLA_Ob
 {
 	//Create the temporaries used by sttsm
 	FLA_Obj* temps[FLA_MAX_ORDER];
-	initialize_psym_but_one_temporaries(A, C, ignore_mode, temps);
+	initialize_psym_but_one_temporaries(A, C, ignore_mode, A.order, temps);
 
 	//If we ignore the last mode, start off ar order - 2
     if(ignore_mode == A.order - 1)
@@ -166,7 +168,79 @@ FLA_Error FLA_Sttsm_but_one( FLA_Obj alpha, FLA_Obj A, dim_t ignore_mode, FLA_Ob
         FLA_Sttsm_but_one_single( alpha, A, C.order-1, ignore_mode, beta, B, C, FLA_Obj_dimsize(C,C.order-1)-1, temps);
 
     //Cleanup
-	destroy_psym_but_one_temporaries(A.order, ignore_mode, temps);
+	destroy_psym_but_one_temporaries(A.order, ignore_mode, A.order, temps);
+
+	return FLA_SUCCESS;
+}
+
+//Level mode of the dimension tree of FLA_Sttsm_but_one_all.  X is A with the
+//modes above mode multiplied in (a slice of each), C[k] the matching slice
+//of the result for ignore_mode k, for every k <= mode.  The result for k ==
+//mode branches off here; the others share the product along mode
+static void FLA_Sttsm_but_one_all_single( FLA_Obj alpha, FLA_Obj X, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C[], dim_t endIndex, FLA_Obj* temps[], FLA_Obj** kTemps[] )
+{
+	FLA_Obj C1[FLA_MAX_ORDER];
+	FLA_Obj B1;
+	dim_t k, loopCount;
+
+	//Mode is not multiplied in for k == mode: the chain of but_one from here
+	FLA_Sttsm_but_one_single(alpha, X, mode, mode, beta, B, C[mode], endIndex, kTemps[mode]);
+
+	for(loopCount = 0; loopCount <= endIndex; loopCount++){
+		FLA_Obj BT, BB, B2;
+
+		FLA_Part_1xmode2(B, &BT,
+		                    &BB, 0, loopCount, FLA_TOP);
+		FLA_Part_1xmode2(BB, &B1,
+		                     &B2, 0, 1, FLA_TOP);
+		for(k = 0; k < mode; k++){
+			FLA_Obj CT, CB, C2;
+
+			FLA_Part_1xmode2(C[k], &CT,
+			                       &CB, mode, loopCount, FLA_TOP);
+			FLA_Part_1xmode2(CB, &(C1[k]),
+			                     &C2, mode, 1, FLA_TOP);
+		}
+
+		//Bottom of the recursion for k == 0: multiply into C
+		if(mode == 1){
+			FLA_Ttm_single_mode(alpha, X, mode, beta, B1, C1[0]);
+		}else{
+			FLA_Obj Y = *(temps[mode]);
+
+			FLA_Psttm(FLA_ZERO, X, mode, FLA_ONE, B1, Y);
+			FLA_Sttsm_but_one_all_single(alpha, Y, mode-1, beta, B, C1, loopCount, temps, kTemps);
+		}
+	}
+}
+
+//FLA_Sttsm_but_one(alpha, A, k, beta, B, C[k]) for every mode k of A in one
+//pass.  The products are evaluated on a dimension tree: the result for k
+//shares with those for modes below k the products along the modes above k,
+//and only the part of the chain below k is its own.  The temporaries of the
+//shared levels are those of sttsm, each branch keeps the ones below it
+FLA_Error FLA_Sttsm_but_one_all( FLA_Obj alpha, FLA_Obj A, FLA_Obj beta, FLA_Obj B, FLA_Obj C[] )
+{
+	dim_t k;
+	dim_t order = A.order;
+	FLA_Obj* temps[FLA_MAX_ORDER];
+	FLA_Obj* kTempsStore[FLA_MAX_ORDER][FLA_MAX_ORDER];
+	FLA_Obj** kTemps[FLA_MAX_ORDER];
+
+	if(order == 1)
+		return FLA_Sttsm_but_one(alpha, A, 0, beta, B, C[0]);
+
+	FLA_Sttsm_initialize_psym_temporaries(FLA_Obj_datatype(C[0]), A, C[0], temps);
+	for(k = 0; k < order; k++){
+		kTemps[k] = kTempsStore[k];
+		initialize_psym_but_one_temporaries(A, C[k], k, k, kTemps[k]);
+	}
+
+	FLA_Sttsm_but_one_all_single(alpha, A, order-1, beta, B, C, FLA_Obj_dimsize(C[0], order-1)-1, temps, kTemps);
+
+	for(k = 0; k < order; k++)
+		destroy_psym_but_one_temporaries(order, k, k, kTemps[k]);
+	FLA_Sttsm_destroy_psym_temporaries(order, temps);
 
 	return FLA_SUCCESS;
 }
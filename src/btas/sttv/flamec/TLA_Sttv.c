@@ -0,0 +1,327 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+
+//Symmetric tensor times the same vector in every mode, A x^m (all modes) and
+//A x^(m-1) (all modes but mode 0), for blocked psym A.
+//
+//Only unique blocks are read.  A block and the blocks of its orbit hold the
+//same entries with the modes permuted, and x is the same in every mode, so
+//each unique block is contracted once and weighted by the size of its orbit.
+//Packed diagonal blocks are walked entry by entry the same way.  Dense
+//blocks are contracted one fiber of mode 0 (contiguous in every block) at a
+//time, against the product of the entries of x selected by the other modes.
+//No temporary is larger than a vector.
+
+//Kernels of one real datatype.  Dot products and updates of fibers keep
+//four partial sums so that the loops vectorize
+#define TLA_STTV_DEF( ctype, ch ) \
+\
+static ctype TLA_Sttv_dot_##ch( dim_t n, const ctype* a, const ctype* x ) \
+{ \
+	ctype s0 = 0, s1 = 0, s2 = 0, s3 = 0; \
+	dim_t i; \
+	for( i = 0; i + 4 <= n; i += 4 ){ \
+		s0 += a[i]   * x[i]; \
+		s1 += a[i+1] * x[i+1]; \
+		s2 += a[i+2] * x[i+2]; \
+		s3 += a[i+3] * x[i+3]; \
+	} \
+	for( ; i < n; i++ ) \
+		s0 += a[i] * x[i]; \
+	return ( s0 + s1 ) + ( s2 + s3 ); \
+} \
+\
+/* Dense block a contracted with xv[k] along every mode k but skip (order */ \
+/* if none), scaled by scale.  Added to z along mode skip, or returned */ \
+static ctype TLA_Sttv_block_##ch( dim_t order, const ctype* a, const dim_t size[], const dim_t stride[], \
+                                  const ctype* xv[], dim_t skip, ctype scale, ctype* z ) \
+{ \
+	dim_t i, k; \
+	dim_t index[FLA_MAX_ORDER]; \
+	ctype w[FLA_MAX_ORDER + 1]; \
+	size_t off = 0; \
+	ctype sum = 0; \
+\
+	if( FLA_array_product( order, size ) == 0 ) \
+		return sum; \
+\
+	/* w[k]: product of the entries of x selected by modes k.. */ \
+	w[order] = scale; \
+	for( k = order - 1; k > 0; k-- ){ \
+		index[k] = 0; \
+		w[k] = ( k == skip ? w[k+1] : w[k+1] * xv[k][0] ); \
+	} \
+	while( TRUE ){ \
+		const ctype* fiber = a + off; \
+		if( skip == 0 ){ \
+			for( i = 0; i < size[0]; i++ ) \
+				z[i] += w[1] * fiber[i]; \
+		}else if( skip < order ){ \
+			z[index[skip]] += w[1] * TLA_Sttv_dot_##ch( size[0], fiber, xv[0] ); \
+		}else{ \
+			sum += w[1] * TLA_Sttv_dot_##ch( size[0], fiber, xv[0] ); \
+		} \
+\
+		/* Next fiber, mode 1 fastest */ \
+		for( k = 1; k < order; k++ ){ \
+			off += stride[k]; \
+			if( ++index[k] < size[k] ) \
+				break; \
+			off -= stride[k] * size[k]; \
+			index[k] = 0; \
+		} \
+		if( k == order ) \
+			break; \
+		for( ; k > 0; k-- ) \
+			w[k] = ( k == skip ? w[k+1] : w[k+1] * xv[k][index[k]] ); \
+	} \
+	return sum; \
+} \
+\
+/* TLA_Sttv_block for a packed diagonal block (see TLA_Pack_sym_block): each */ \
+/* unique entry stands for the entries of its orbit under the block symmetry */ \
+static ctype TLA_Sttv_packed_block_##ch( const FLA_Base_obj* blk, const ctype* xv[], dim_t skip, ctype scale, ctype* z ) \
+{ \
+	dim_t j, k; \
+	dim_t order = blk->order; \
+	TLA_sym sym = blk->packed_sym; \
+	const dim_t* size = blk->size; \
+	const ctype* a = ( const ctype* ) blk->buffer; \
+	dim_t index[FLA_MAX_ORDER]; \
+	dim_t group = ( skip < order ? TLA_sym_group_of_mode( sym, skip ) : 0 ); \
+	dim_t groupOffset = ( skip < order ? TLA_sym_group_mode_offset( sym, group ) : 0 ); \
+	dim_t len = ( skip < order ? sym.symGroupLens[group] : 0 ); \
+	ctype sum = 0; \
+\
+	if( FLA_array_product( order, size ) == 0 ) \
+		return sum; \
+\
+	memset( &(index[0]), 0, order * sizeof(dim_t) ); \
+	do{ \
+		dim_t mult = TLA_sym_index_multiplicity( sym, index ); \
+		ctype v = scale * a[TLA_packed_sym_offset( sym, size, index )]; \
+\
+		if( skip == order ){ \
+			v *= ( ctype ) mult; \
+			for( k = 0; k < order; k++ ) \
+				v *= xv[k][index[k]]; \
+			sum += v; \
+			continue; \
+		} \
+\
+		/* Of the orbit, a share count / len has each value of the group */ \
+		/* of skip at skip; leave out x for one mode holding it */ \
+		for( j = 0; j < len; j++ ){ \
+			dim_t count = TLA_sym_value_count( sym, group, j, index ); \
+			dim_t q = sym.symModes[groupOffset + j]; \
+			ctype u; \
+			if( count == 0 ) \
+				continue; \
+			u = v * ( ctype )( mult * count / len ); \
+			for( k = 0; k < order; k++ ) \
+				if( k != q ) \
+					u *= xv[k][index[k]]; \
+			z[index[q]] += u; \
+		} \
+	}while( TLA_next_unique_index( sym, size, index ) ); \
+\
+	return sum; \
+} \
+\
+/* Sum over the unique blocks of A; along mode 0 into z (zeroed, the length */ \
+/* of mode 0) if z, returned otherwise */ \
+static ctype TLA_Sttv_##ch( FLA_Obj A, const ctype* x, ctype* z ) \
+{ \
+	dim_t j, k; \
+	dim_t order = FLA_Obj_order( A ); \
+	TLA_unique_map* map = FLA_Obj_unique_map( A ); \
+	FLA_Obj* blks = ( FLA_Obj* ) FLA_Obj_base_buffer( A ); \
+	dim_t group = TLA_sym_group_of_mode( A.sym, 0 ); \
+	dim_t groupOffset = TLA_sym_group_mode_offset( A.sym, group ); \
+	dim_t len = A.sym.symGroupLens[group]; \
+	dim_t index[FLA_MAX_ORDER]; \
+	const ctype* xv[FLA_MAX_ORDER]; \
+	dim_t u = 0; \
+	ctype sum = 0; \
+\
+	memset( &(index[0]), 0, order * sizeof(dim_t) ); \
+	do{ \
+		FLA_Base_obj* blk = ( blks[map->uniqueLinIndex[u]] ).base; \
+		dim_t orbitSize = map->orbitSize[u]; \
+\
+		for( k = 0; k < order; k++ ) \
+			xv[k] = x + index[k] * blk->size[k]; \
+\
+		if( z == NULL ){ \
+			if( blk->isPacked ) \
+				sum += TLA_Sttv_packed_block_##ch( blk, xv, order, ( ctype ) orbitSize, NULL ); \
+			else \
+				sum += TLA_Sttv_block_##ch( order, ( const ctype* ) blk->buffer, blk->size, blk->stride, \
+				                            xv, order, ( ctype ) orbitSize, NULL ); \
+		}else{ \
+			/* Of the orbit, a share count / len has each block index of */ \
+			/* the group of mode 0 at mode 0; contract all modes but one */ \
+			/* holding it */ \
+			for( j = 0; j < len; j++ ){ \
+				dim_t count = TLA_sym_value_count( A.sym, group, j, index ); \
+				dim_t p = A.sym.symModes[groupOffset + j]; \
+				ctype scale; \
+				if( count == 0 ) \
+					continue; \
+				scale = ( ctype )( orbitSize * count / len ); \
+				if( blk->isPacked ) \
+					TLA_Sttv_packed_block_##ch( blk, xv, p, scale, z + index[p] * blk->size[p] ); \
+				else \
+					TLA_Sttv_block_##ch( order, ( const ctype* ) blk->buffer, blk->size, blk->stride, \
+					                     xv, p, scale, z + index[p] * blk->size[p] ); \
+			} \
+		} \
+		u++; \
+	}while( TLA_next_unique_index( A.sym, A.size, index ) ); \
+\
+	return sum; \
+}
+
+TLA_STTV_DEF( float, s )
+TLA_STTV_DEF( double, d )
+
+#undef TLA_STTV_DEF
+
+//Contiguous copy of the vector x if its entries are strided (NULL if not)
+static void* TLA_Sttv_contiguous_copy( FLA_Obj x, void** buf_x ){
+	dim_t i;
+	dim_t n = FLA_Obj_vector_dim(x);
+	dim_t inc = FLA_Obj_vector_inc(x);
+	size_t elem_size = (size_t)FLA_Obj_elem_size(x);
+	char* buf = (char*)FLA_Obj_buffer_at_view(x);
+	char* copy;
+
+	*buf_x = buf;
+	if(inc == 1 || n == 0)
+		return NULL;
+
+	copy = (char*)FLA_malloc(n * elem_size);
+	for(i = 0; i < n; i++)
+		memcpy(copy + i * elem_size, buf + i * inc * elem_size, elem_size);
+	*buf_x = copy;
+	return copy;
+}
+
+//Only real A, and x matching every mode of A
+static FLA_Error TLA_Sttv_check( FLA_Obj A, FLA_Obj x ){
+	dim_t k;
+	FLA_Datatype datatype = FLA_Obj_datatype(A);
+	FLA_Obj* blks;
+
+	if(datatype != FLA_FLOAT && datatype != FLA_DOUBLE)
+		return FLA_FAILURE;
+	if(FLA_Obj_elemtype(A) == FLA_SCALAR || FLA_Obj_unique_map(A) == NULL)
+		return FLA_FAILURE;
+	if(FLA_Obj_datatype(x) != datatype)
+		return FLA_FAILURE;
+
+	blks = (FLA_Obj*)FLA_Obj_base_buffer(A);
+	for(k = 0; k < FLA_Obj_order(A); k++)
+		if(A.size[k] * (blks[0].base)->size[k] != FLA_Obj_vector_dim(x))
+			return FLA_FAILURE;
+	return FLA_SUCCESS;
+}
+
+//rho := A x^m, x times every mode of the blocked psym tensor A
+FLA_Error TLA_Sttv_all( FLA_Obj A, FLA_Obj x, FLA_Obj rho ){
+	void* buf_x;
+	void* copy;
+
+	if(TLA_Sttv_check(A, x) != FLA_SUCCESS || FLA_Obj_datatype(rho) != FLA_Obj_datatype(A))
+		return FLA_FAILURE;
+
+	copy = TLA_Sttv_contiguous_copy(x, &buf_x);
+	if(FLA_Obj_datatype(A) == FLA_FLOAT)
+		*((float*)FLA_Obj_buffer_at_view(rho)) = TLA_Sttv_s(A, (const float*)buf_x, NULL);
+	else
+		*((double*)FLA_Obj_buffer_at_view(rho)) = TLA_Sttv_d(A, (const double*)buf_x, NULL);
+	if(copy != NULL)
+		FLA_free(copy);
+
+	return FLA_SUCCESS;
+}
+
+//y := alpha y + beta A x^(m-1), x times every mode of the blocked psym tensor
+//A but mode 0 (y is overwritten if alpha is zero)
+FLA_Error TLA_Sttv_all_but_one( FLA_Obj alpha, FLA_Obj A, FLA_Obj x, FLA_Obj beta, FLA_Obj y ){
+	dim_t i;
+	dim_t n = FLA_Obj_vector_dim(y);
+	dim_t inc_y = FLA_Obj_vector_inc(y);
+	FLA_Bool overwrite = FLA_Obj_equals(alpha, FLA_ZERO);
+	size_t elem_size = (size_t)FLA_Obj_elem_size(A);
+	void* buf_x;
+	void* copy;
+	void* z;
+
+	if(TLA_Sttv_check(A, x) != FLA_SUCCESS || FLA_Obj_datatype(y) != FLA_Obj_datatype(A) ||
+	   n != FLA_Obj_vector_dim(x))
+		return FLA_FAILURE;
+
+	copy = TLA_Sttv_contiguous_copy(x, &buf_x);
+	z = FLA_malloc(n * elem_size);
+	memset(z, 0, n * elem_size);
+
+#define TLA_STTV_UPDATE( ctype, ptr, ch ) \
+	{ \
+		ctype alpha_c = *( ( ctype* ) ptr( alpha ) ); \
+		ctype beta_c = *( ( ctype* ) ptr( beta ) ); \
+		ctype* buf_y = ( ctype* ) FLA_Obj_buffer_at_view( y ); \
+		ctype* buf_z = ( ctype* ) z; \
+		TLA_Sttv_##ch( A, ( const ctype* ) buf_x, buf_z ); \
+		for( i = 0; i < n; i++ ){ \
+			if( overwrite ) \
+				buf_y[i * inc_y] = beta_c * buf_z[i]; \
+			else \
+				buf_y[i * inc_y] = alpha_c * buf_y[i * inc_y] + beta_c * buf_z[i]; \
+		} \
+	}
+
+	if(FLA_Obj_datatype(A) == FLA_FLOAT)
+		TLA_STTV_UPDATE( float, FLA_FLOAT_PTR, s )
+	else
+		TLA_STTV_UPDATE( double, FLA_DOUBLE_PTR, d )
+
+#undef TLA_STTV_UPDATE
+
+	FLA_free(z);
+	if(copy != NULL)
+		FLA_free(copy);
+
+	return FLA_SUCCESS;
+}
@@ -0,0 +1,438 @@
+/*
+   libflame
+   An object-based infrastructure for developing high-performance
+   dense linear algebra libraries.
+
+   Copyright (C) 2011, The University of Texas
+
+   libflame is free software; you can redistribute it and/or modify
+   it under the terms of the GNU Lesser General Public License as
+   published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   libflame is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public
+   License along with libflame; if you did not receive a copy, see
+   http://www.gnu.org/licenses/.
+
+   For more information, please contact us at flame@cs.utexas.edu or
+   send mail to:
+
+   Field G. Van Zee and/or
+   Robert A. van de Geijn
+   The University of Texas at Austin
+   Department of Computer Sciences
+   1 University Station C0500
+   Austin TX 78712
+*/
+
+#include "FLAME.h"
+
+//Batched leaf of the mode-n product.
+//
+//The leaves of FLA_Ttm_single_mode multiply every block of A along mode by a
+//block of B into a block of C.  Blocks are small, so issuing each product
+//through blis costs more in dispatch and packing than in flops.  The triples
+//are collected here and, once their shared geometry is known, run back to
+//back through one register blocked kernel chosen up front.
+
+//Register block of the small kernels
+#define FLA_TTM_UKR_MR 4
+#define FLA_TTM_UKR_NR 4
+
+//Largest m, k and n handled by the small kernels; larger products go to blis
+#define FLA_TTM_UKR_MAX_DIM 64
+
+//acc := B(i:i+MR, :) A(:, j:j+NR), then
+//C(i:i+MR, j:j+NR) := alpha C + beta acc (C is overwritten when alpha == 0)
+#define FLA_TTM_UKR_TILE( ctype, MR, NR ) \
+	{ \
+		ctype acc[FLA_TTM_UKR_MR][FLA_TTM_UKR_NR]; \
+		dim_t p, ii, jj; \
+		for( ii = 0; ii < MR; ii++ ) \
+			for( jj = 0; jj < NR; jj++ ) \
+				acc[ii][jj] = ( ctype ) 0; \
+		for( p = 0; p < kc; p++ ){ \
+			const ctype* Bp = B + i * rs_B + p * cs_B; \
+			const ctype* Ap = A + p * rs_A + j * cs_A; \
+			for( ii = 0; ii < MR; ii++ ){ \
+				ctype b_i = Bp[ ii * rs_B ]; \
+				for( jj = 0; jj < NR; jj++ ) \
+					acc[ii][jj] += b_i * Ap[ jj * cs_A ]; \
+			} \
+		} \
+		for( jj = 0; jj < NR; jj++ ){ \
+			ctype* Cj = C + i * rs_C + ( j + jj ) * cs_C; \
+			for( ii = 0; ii < MR; ii++ ){ \
+				if( alpha == ( ctype ) 0 ) \
+					Cj[ ii * rs_C ] = beta * acc[ii][jj]; \
+				else \
+					Cj[ ii * rs_C ] = alpha * Cj[ ii * rs_C ] + beta * acc[ii][jj]; \
+			} \
+		} \
+	}
+
+//C(m x n) := alpha C + beta B(m x k) A(k x n).  MC != 0 fixes m and KC != 0
+//fixes k at compile time, so that the tile loop along m and the k loop of
+//every tile are fully known to the compiler (MC is a multiple of MR, so
+//there are no partial tiles along m).
+#define FLA_TTM_UKR_DEF( ctype, ch, suffix, MC, KC ) \
+static void FLA_Ttm_ukr_##ch##_##suffix( dim_t m, dim_t k, dim_t n, \
+                                         ctype alpha, ctype beta, \
+                                         const ctype* B, dim_t rs_B, dim_t cs_B, \
+                                         const ctype* A, dim_t rs_A, dim_t cs_A, \
+                                         ctype* C, dim_t rs_C, dim_t cs_C ) \
+{ \
+	const dim_t mc = ( MC ? MC : m ); \
+	const dim_t kc = ( KC ? KC : k ); \
+	dim_t i, j; \
+	for( j = 0; j < n; j += FLA_TTM_UKR_NR ){ \
+		dim_t nr = ( n - j < FLA_TTM_UKR_NR ? n - j : FLA_TTM_UKR_NR ); \
+		for( i = 0; i < mc; i += FLA_TTM_UKR_MR ){ \
+			dim_t mr = ( mc - i < FLA_TTM_UKR_MR ? mc - i : FLA_TTM_UKR_MR ); \
+			if( mr == FLA_TTM_UKR_MR && nr == FLA_TTM_UKR_NR ) \
+				FLA_TTM_UKR_TILE( ctype, FLA_TTM_UKR_MR, FLA_TTM_UKR_NR ) \
+			else \
+				FLA_TTM_UKR_TILE( ctype, mr, nr ) \
+		} \
+	} \
+}
+
+typedef void (*FLA_Ttm_ukr_s_ft)( dim_t, dim_t, dim_t, float, float,
+                                  const float*, dim_t, dim_t,
+                                  const float*, dim_t, dim_t,
+                                  float*, dim_t, dim_t );
+typedef void (*FLA_Ttm_ukr_d_ft)( dim_t, dim_t, dim_t, double, double,
+                                  const double*, dim_t, dim_t,
+                                  const double*, dim_t, dim_t,
+                                  double*, dim_t, dim_t );
+
+//Kernels for every (m, k) among the common block sizes 4, 8, 16 and 32, and
+//with either or both left generic (n)
+#define FLA_TTM_UKR_DEF_M( ctype, ch, msuf, MC ) \
+FLA_TTM_UKR_DEF( ctype, ch, m##msuf##_k4,  MC, 4 ) \
+FLA_TTM_UKR_DEF( ctype, ch, m##msuf##_k8,  MC, 8 ) \
+FLA_TTM_UKR_DEF( ctype, ch, m##msuf##_k16, MC, 16 ) \
+FLA_TTM_UKR_DEF( ctype, ch, m##msuf##_k32, MC, 32 ) \
+FLA_TTM_UKR_DEF( ctype, ch, m##msuf##_kn,  MC, 0 )
+
+#define FLA_TTM_UKR_DEF_ALL( ctype, ch ) \
+FLA_TTM_UKR_DEF_M( ctype, ch, n, 0 ) \
+FLA_TTM_UKR_DEF_M( ctype, ch, 4, 4 ) \
+FLA_TTM_UKR_DEF_M( ctype, ch, 8, 8 ) \
+FLA_TTM_UKR_DEF_M( ctype, ch, 16, 16 ) \
+FLA_TTM_UKR_DEF_M( ctype, ch, 32, 32 ) \
+static const FLA_Ttm_ukr_##ch##_ft FLA_Ttm_ukr_##ch[5][5] = { \
+	{ FLA_Ttm_ukr_##ch##_mn_kn,  FLA_Ttm_ukr_##ch##_mn_k4,  FLA_Ttm_ukr_##ch##_mn_k8,  FLA_Ttm_ukr_##ch##_mn_k16,  FLA_Ttm_ukr_##ch##_mn_k32 }, \
+	{ FLA_Ttm_ukr_##ch##_m4_kn,  FLA_Ttm_ukr_##ch##_m4_k4,  FLA_Ttm_ukr_##ch##_m4_k8,  FLA_Ttm_ukr_##ch##_m4_k16,  FLA_Ttm_ukr_##ch##_m4_k32 }, \
+	{ FLA_Ttm_ukr_##ch##_m8_kn,  FLA_Ttm_ukr_##ch##_m8_k4,  FLA_Ttm_ukr_##ch##_m8_k8,  FLA_Ttm_ukr_##ch##_m8_k16,  FLA_Ttm_ukr_##ch##_m8_k32 }, \
+	{ FLA_Ttm_ukr_##ch##_m16_kn, FLA_Ttm_ukr_##ch##_m16_k4, FLA_Ttm_ukr_##ch##_m16_k8, FLA_Ttm_ukr_##ch##_m16_k16, FLA_Ttm_ukr_##ch##_m16_k32 }, \
+	{ FLA_Ttm_ukr_##ch##_m32_kn, FLA_Ttm_ukr_##ch##_m32_k4, FLA_Ttm_ukr_##ch##_m32_k8, FLA_Ttm_ukr_##ch##_m32_k16, FLA_Ttm_ukr_##ch##_m32_k32 } \
+};
+
+FLA_TTM_UKR_DEF_ALL( float, s )
+FLA_TTM_UKR_DEF_ALL( double, d )
+
+#undef FLA_TTM_UKR_DEF_ALL
+#undef FLA_TTM_UKR_DEF_M
+#undef FLA_TTM_UKR_DEF
+#undef FLA_TTM_UKR_TILE
+
+//Index of the specialized kernels for extent x (0: generic)
+static dim_t FLA_Ttm_ukr_class( dim_t x )
+{
+	switch( x ){
+	case 4:  return 1;
+	case 8:  return 2;
+	case 16: return 3;
+	case 32: return 4;
+	}
+	return 0;
+}
+
+static FLA_Bool FLA_Ttm_geom_equal( const FLA_Ttm_geom* g, const FLA_Ttm_geom* h )
+{
+	dim_t i;
+
+	if(g->datatype != h->datatype ||
+	   g->m != h->m || g->k != h->k || g->n != h->n ||
+	   g->rs_A != h->rs_A || g->cs_A != h->cs_A ||
+	   g->rs_B != h->rs_B || g->cs_B != h->cs_B ||
+	   g->rs_C != h->rs_C || g->cs_C != h->cs_C ||
+	   g->nOther != h->nOther)
+		return FALSE;
+	for(i = 0; i < g->nOther; i++)
+		if(g->n_o[i] != h->n_o[i] || g->sa_o[i] != h->sa_o[i] || g->sc_o[i] != h->sc_o[i])
+			return FALSE;
+	return TRUE;
+}
+
+void FLA_Ttm_batch_init( FLA_Obj alpha, FLA_Obj beta, FLA_Ttm_batch* batch )
+{
+	batch->alpha = alpha;
+	batch->beta = beta;
+	batch->nEntries = 0;
+	batch->capacity = FLA_TTM_BATCH_STORE;
+	batch->buf = batch->store;
+	batch->first = batch->first_store;
+}
+
+void FLA_Ttm_batch_free( FLA_Ttm_batch* batch )
+{
+	if(batch->buf != batch->store){
+		FLA_free(batch->buf);
+		FLA_free(batch->first);
+	}
+	batch->buf = batch->store;
+	batch->first = batch->first_store;
+	batch->nEntries = 0;
+	batch->capacity = FLA_TTM_BATCH_STORE;
+}
+
+//Runs every collected triple, in the order they were added
+FLA_Error FLA_Ttm_batch_flush( FLA_Ttm_batch* batch )
+{
+	FLA_Ttm_geom* geom = &(batch->geom);
+	dim_t nEntries = batch->nEntries;
+	dim_t nOther = geom->nOther;
+	dim_t m = geom->m;
+	dim_t k = geom->k;
+	dim_t n = geom->n;
+	dim_t e, i;
+	dim_t curIndex[FLA_MAX_ORDER];
+	dim_t offA, offC;
+	FLA_Bool small;
+
+	if(nEntries == 0)
+		return FLA_SUCCESS;
+	batch->nEntries = 0;
+
+	small = (m <= FLA_TTM_UKR_MAX_DIM && k <= FLA_TTM_UKR_MAX_DIM &&
+	         n <= FLA_TTM_UKR_MAX_DIM);
+
+	//Walks the collapsed modes of every entry, calling ukr on each GEMM
+#define FLA_TTM_BATCH_RUN( ctype, ptr, ch ) \
+	{ \
+		ctype alpha = *( ( ctype* ) ptr( batch->alpha ) ); \
+		ctype beta  = *( ( ctype* ) ptr( batch->beta ) ); \
+		ctype alpha_e; \
+		FLA_Ttm_ukr_##ch##_ft ukr = FLA_Ttm_ukr_##ch[ FLA_Ttm_ukr_class( m ) ][ FLA_Ttm_ukr_class( k ) ]; \
+		for( e = 0; e < nEntries; e++ ){ \
+			const ctype* buf_A = ( const ctype* ) batch->buf[3*e]; \
+			const ctype* buf_B = ( const ctype* ) batch->buf[3*e+1]; \
+			ctype* buf_C = ( ctype* ) batch->buf[3*e+2]; \
+			alpha_e = ( batch->first[e] ? alpha : ( ctype ) 1 ); \
+			memset( &(curIndex[0]), 0, nOther * sizeof(dim_t) ); \
+			offA = 0; \
+			offC = 0; \
+			while( TRUE ){ \
+				ukr( m, k, n, alpha_e, beta, \
+				     buf_B, geom->rs_B, geom->cs_B, \
+				     buf_A + offA, geom->rs_A, geom->cs_A, \
+				     buf_C + offC, geom->rs_C, geom->cs_C ); \
+				for( i = 0; i < nOther; i++ ){ \
+					curIndex[i]++; \
+					offA += geom->sa_o[i]; \
+					offC += geom->sc_o[i]; \
+					if( curIndex[i] < geom->n_o[i] ) \
+						break; \
+					offA -= geom->sa_o[i] * geom->n_o[i]; \
+					offC -= geom->sc_o[i] * geom->n_o[i]; \
+					curIndex[i] = 0; \
+				} \
+				if( i == nOther ) \
+					break; \
+			} \
+		} \
+	}
+
+	if(small && geom->datatype == FLA_FLOAT)
+		FLA_TTM_BATCH_RUN( float, FLA_FLOAT_PTR, s )
+	else if(small && geom->datatype == FLA_DOUBLE)
+		FLA_TTM_BATCH_RUN( double, FLA_DOUBLE_PTR, d )
+	else{
+		//Complex and large products: blis does better than the small kernels
+		for(e = 0; e < nEntries; e++)
+			FLA_Ttm_geom_exec_blis(geom, batch->first[e] ? batch->alpha : FLA_ONE, batch->beta,
+			                       batch->buf[3*e], batch->buf[3*e+1], batch->buf[3*e+2]);
+	}
+
+#undef FLA_TTM_BATCH_RUN
+
+	return FLA_SUCCESS;
+}
+
+//Appends a product of known geometry to the batch
+static void FLA_Ttm_batch_push( FLA_Ttm_batch* batch, const FLA_Ttm_geom* geom, char* buf_A, char* buf_B, char* buf_C, FLA_Bool first )
+{
+	if(batch->nEntries > 0 && !FLA_Ttm_geom_equal(geom, &(batch->geom)))
+		FLA_Ttm_batch_flush(batch);
+	if(batch->nEntries == 0)
+		batch->geom = *geom;
+
+	if(batch->nEntries == batch->capacity){
+		char** buf = (char**)FLA_malloc(6 * batch->capacity * sizeof(char*));
+		FLA_Bool* isFirst = (FLA_Bool*)FLA_malloc(2 * batch->capacity * sizeof(FLA_Bool));
+		memcpy(buf, batch->buf, 3 * batch->nEntries * sizeof(char*));
+		memcpy(isFirst, batch->first, batch->nEntries * sizeof(FLA_Bool));
+		if(batch->buf != batch->store){
+			FLA_free(batch->buf);
+			FLA_free(batch->first);
+		}
+		batch->buf = buf;
+		batch->first = isFirst;
+		batch->capacity *= 2;
+	}
+	batch->buf[3*batch->nEntries] = buf_A;
+	batch->buf[3*batch->nEntries+1] = buf_B;
+	batch->buf[3*batch->nEntries+2] = buf_C;
+	batch->first[batch->nEntries] = first;
+	batch->nEntries++;
+}
+
+//Adds C := alpha C + beta (B x_mode A) for scalar blocks A, B, C to the batch,
+//or C := C + beta (B x_mode A) unless first (the product is not the first one
+//into C of the operation the batch computes).  Triples GEMM cannot express on their layouts (packed or mixed precision
+//blocks, ...) are computed at once by FLA_Ttm_scalar_permC after flushing
+//what is pending, so updates of C are always applied in order.
+FLA_Error FLA_Ttm_batch_add( FLA_Ttm_batch* batch, const FLA_Obj* A, dim_t mode, const FLA_Obj* B, const FLA_Obj* C, FLA_Bool first )
+{
+	FLA_Ttm_geom geom;
+	char* buf_A;
+	char* buf_B;
+	char* buf_C;
+
+	if(FLA_Ttm_record_add(A, mode, B, C, first))
+		return FLA_SUCCESS;
+
+	if((A->base)->elemtype != FLA_SCALAR || (A->base)->isPacked ||
+	   FLA_Ttm_geometry(A, mode, B, C, &geom, &buf_A, &buf_B, &buf_C) != FLA_SUCCESS){
+		FLA_Ttm_batch_flush(batch);
+		return FLA_Ttm_scalar_permC(first ? batch->alpha : FLA_ONE, *A, mode, batch->beta, *B, *C);
+	}
+	if(geom.n == 0)
+		return FLA_SUCCESS;
+
+	FLA_Ttm_batch_push(batch, &geom, buf_A, buf_B, buf_C, first);
+
+	return FLA_SUCCESS;
+}
+
+//Recording.
+//
+//Between FLA_Ttm_record_begin and FLA_Ttm_record_end, the block products that
+//would reach FLA_Ttm_batch_add (and the scalar FLA_Ttm_single_mode) are
+//appended to a list instead of being computed, so a caller can walk its
+//recursion once and replay the products later with FLA_Ttm_batch_add_leaves.
+//The recorded buffers and block objects must outlive the list.  Recording is
+//global: it is meant to be done by one thread while no other ttm runs.
+
+static FLA_Ttm_leaves* FLA_Ttm_recording = NULL;
+
+void FLA_Ttm_leaves_init( FLA_Ttm_leaves* leaves )
+{
+	memset(leaves, 0, sizeof(FLA_Ttm_leaves));
+}
+
+void FLA_Ttm_leaves_free( FLA_Ttm_leaves* leaves )
+{
+	if(leaves->leaves != NULL)
+		FLA_free(leaves->leaves);
+	if(leaves->geoms != NULL)
+		FLA_free(leaves->geoms);
+	if(leaves->objs != NULL)
+		FLA_free(leaves->objs);
+	FLA_Ttm_leaves_init(leaves);
+}
+
+void FLA_Ttm_record_begin( FLA_Ttm_leaves* leaves )
+{
+	FLA_Ttm_recording = leaves;
+}
+
+void FLA_Ttm_record_end( void )
+{
+	FLA_Ttm_recording = NULL;
+}
+
+//Appends C := alpha C + beta (B x_mode A) to the list being recorded.
+//Returns FALSE, doing nothing, if there is none
+FLA_Bool FLA_Ttm_record_add( const FLA_Obj* A, dim_t mode, const FLA_Obj* B, const FLA_Obj* C, FLA_Bool first )
+{
+	FLA_Ttm_leaves* leaves = FLA_Ttm_recording;
+	FLA_Ttm_leaf* leaf;
+	FLA_Ttm_geom geom;
+	char* buf_A;
+	char* buf_B;
+	char* buf_C;
+	FLA_Bool useGeom;
+
+	if(leaves == NULL)
+		return FALSE;
+
+	useGeom = ((A->base)->elemtype == FLA_SCALAR && !(A->base)->isPacked &&
+	           FLA_Ttm_geometry(A, mode, B, C, &geom, &buf_A, &buf_B, &buf_C) == FLA_SUCCESS);
+	if(useGeom && geom.n == 0)
+		return TRUE;
+
+	if(leaves->nLeaves == leaves->leafCapacity){
+		leaves->leafCapacity = (leaves->leafCapacity == 0) ? 64 : 2 * leaves->leafCapacity;
+		leaves->leaves = (FLA_Ttm_leaf*)FLA_realloc(leaves->leaves, leaves->leafCapacity * sizeof(FLA_Ttm_leaf));
+	}
+	leaf = &(leaves->leaves[leaves->nLeaves++]);
+	leaf->mode = mode;
+	leaf->first = first;
+
+	if(useGeom){
+		//Consecutive products mostly share their geometry
+		if(leaves->nGeoms == 0 || !FLA_Ttm_geom_equal(&geom, &(leaves->geoms[leaves->nGeoms-1]))){
+			if(leaves->nGeoms == leaves->geomCapacity){
+				leaves->geomCapacity = (leaves->geomCapacity == 0) ? 8 : 2 * leaves->geomCapacity;
+				leaves->geoms = (FLA_Ttm_geom*)FLA_realloc(leaves->geoms, leaves->geomCapacity * sizeof(FLA_Ttm_geom));
+			}
+			leaves->geoms[leaves->nGeoms++] = geom;
+		}
+		leaf->geom = leaves->nGeoms - 1;
+		leaf->buf[0] = buf_A;
+		leaf->buf[1] = buf_B;
+		leaf->buf[2] = buf_C;
+		leaf->obj = 0;
+	}else{
+		if(leaves->nObjs + 3 > leaves->objCapacity){
+			leaves->objCapacity = (leaves->objCapacity == 0) ? 48 : 2 * leaves->objCapacity;
+			leaves->objs = (FLA_Obj*)FLA_realloc(leaves->objs, leaves->objCapacity * sizeof(FLA_Obj));
+		}
+		leaf->geom = FLA_TTM_LEAF_OBJS;
+		leaf->buf[0] = leaf->buf[1] = leaf->buf[2] = NULL;
+		leaf->obj = leaves->nObjs;
+		leaves->objs[leaves->nObjs++] = *A;
+		leaves->objs[leaves->nObjs++] = *B;
+		leaves->objs[leaves->nObjs++] = *C;
+	}
+	return TRUE;
+}
+
+//Adds the recorded products leaves[begin, end) to batch, in order
+FLA_Error FLA_Ttm_batch_add_leaves( FLA_Ttm_batch* batch, const FLA_Ttm_leaves* leaves, dim_t begin, dim_t end )
+{
+	dim_t i;
+
+	for(i = begin; i < end; i++){
+		const FLA_Ttm_leaf* leaf = &(leaves->leaves[i]);
+
+		if(leaf->geom == FLA_TTM_LEAF_OBJS){
+			const FLA_Obj* obj = &(leaves->objs[leaf->obj]);
+
+			FLA_Ttm_batch_flush(batch);
+			FLA_Ttm_scalar_permC(leaf->first ? batch->alpha : FLA_ONE, obj[0], leaf->mode, batch->beta, obj[1], obj[2]);
+		}else
+			FLA_Ttm_batch_push(batch, &(leaves->geoms[leaf->geom]),
+			                   leaf->buf[0], leaf->buf[1], leaf->buf[2], leaf->first);
+	}
+
+	return FLA_SUCCESS;
+}
@@ -32,125 +32,283 @@
 
 #include "FLAME.h"
 
-//TODO: Handle permuted C
-//Repartition until 2-D matrix (Very slow) (Ignore)
-FLA_Error FLA_Ttm_single_mode_blis( FLA_Obj alpha, FLA_Obj A,
-                                    dim_t mode,
-                                    FLA_Obj beta, FLA_Obj B,
-                                    FLA_Obj C, dim_t repart_mode )
+//C(m x n) := alpha C + beta B(m x k) A(k x n) on raw buffers.
+//A row-stored C is handled as C^T := alpha C^T + beta A^T B^T so that blis
+//never needs a temporary for C.
+static void FLA_Ttm_gemm_blis( FLA_Datatype datatype, FLA_Obj alpha, FLA_Obj beta,
+                               dim_t m, dim_t k, dim_t n,
+                               void* buf_B, dim_t rs_B, dim_t cs_B,
+                               void* buf_A, dim_t rs_A, dim_t cs_A,
+                               void* buf_C, dim_t rs_C, dim_t cs_C )
 {
+	FLA_Bool transC = (rs_C != 1 && cs_C == 1);
+
+#define FLA_TTM_GEMM_BLIS( ctype, ptr, gemm ) \
+	{ \
+		ctype* buff_alpha = ( ctype* ) ptr( alpha ); \
+		ctype* buff_beta  = ( ctype* ) ptr( beta ); \
+		if( transC ) \
+			gemm( BLIS_TRANSPOSE, BLIS_TRANSPOSE, n, k, m, \
+			      buff_beta, ( ctype* ) buf_A, rs_A, cs_A, \
+			      ( ctype* ) buf_B, rs_B, cs_B, \
+			      buff_alpha, ( ctype* ) buf_C, cs_C, rs_C ); \
+		else \
+			gemm( BLIS_NO_TRANSPOSE, BLIS_NO_TRANSPOSE, m, k, n, \
+			      buff_beta, ( ctype* ) buf_B, rs_B, cs_B, \
+			      ( ctype* ) buf_A, rs_A, cs_A, \
+			      buff_alpha, ( ctype* ) buf_C, rs_C, cs_C ); \
+	}
 
-	dim_t* permA = FLA_Obj_permutation(A);
-
-	if((mode == 0 && repart_mode == 1) || repart_mode == 0){
-		FLA_Obj A_2D, C_2D;
-		dim_t size_A_2D[2];
-		dim_t size_C_2D[2];
-		dim_t stride_A_2D[2];
-		dim_t stride_C_2D[2];
-		dim_t firstModeA, firstModeC;
-
-		void* A_buf;
-		void* C_buf;
-
-		if(permA[mode] < permA[repart_mode]){
-			size_A_2D[0] = FLA_Obj_dimsize(A, permA[mode]);
-			size_A_2D[1] = FLA_Obj_dimsize(A, permA[repart_mode]);
-			stride_A_2D[0] = FLA_Obj_dimstride(A, permA[mode]);
-			stride_A_2D[1] = FLA_Obj_dimstride(A, permA[repart_mode]);
-			firstModeA = mode;
-		}else{
-			size_A_2D[0] = FLA_Obj_dimsize(A, permA[repart_mode]);
-			size_A_2D[1] = FLA_Obj_dimsize(A, permA[mode]);
-			stride_A_2D[0] = FLA_Obj_dimstride(A, permA[repart_mode]);
-			stride_A_2D[1] = FLA_Obj_dimstride(A, permA[mode]);
-			firstModeA = repart_mode;
-		}
-	
-		if(mode < repart_mode){
-			size_C_2D[0] = FLA_Obj_dimsize(C, mode);
-			size_C_2D[1] = FLA_Obj_dimsize(C, repart_mode);
-			stride_C_2D[0] = FLA_Obj_dimstride(C, mode);
-			stride_C_2D[1] = FLA_Obj_dimstride(C, repart_mode);
-			firstModeC = mode;
-		}else{
-			size_C_2D[0] = FLA_Obj_dimsize(C, repart_mode);
-			size_C_2D[1] = FLA_Obj_dimsize(C, mode);
-			stride_C_2D[0] = FLA_Obj_dimstride(C, repart_mode);
-			stride_C_2D[1] = FLA_Obj_dimstride(C, mode);
-			firstModeC = repart_mode;
-		}	
-
-		A_buf = FLA_Obj_tensor_buffer_at_view(A);
-		C_buf = FLA_Obj_tensor_buffer_at_view(C);
-		
-		FLA_Obj_create_without_buffer(FLA_DOUBLE, size_A_2D[0], size_A_2D[1], &A_2D);
-		FLA_Obj_attach_buffer(A_buf, stride_A_2D[0], stride_A_2D[1], &A_2D);
-		
-		FLA_Obj_create_without_buffer(FLA_DOUBLE, size_C_2D[0], size_C_2D[1], &C_2D);
-		FLA_Obj_attach_buffer(C_buf, stride_C_2D[0], stride_C_2D[1], &C_2D);
+	switch( datatype ){
+	case FLA_FLOAT:
+		FLA_TTM_GEMM_BLIS( float, FLA_FLOAT_PTR, bli_sgemm );
+		break;
+	case FLA_DOUBLE:
+		FLA_TTM_GEMM_BLIS( double, FLA_DOUBLE_PTR, bli_dgemm );
+		break;
+	case FLA_COMPLEX:
+		FLA_TTM_GEMM_BLIS( scomplex, FLA_COMPLEX_PTR, bli_cgemm );
+		break;
+	case FLA_DOUBLE_COMPLEX:
+		FLA_TTM_GEMM_BLIS( dcomplex, FLA_DOUBLE_COMPLEX_PTR, bli_zgemm );
+		break;
+	}
 
+#undef FLA_TTM_GEMM_BLIS
+}
 
-		if (mode < repart_mode) {
-			if(firstModeC == firstModeA){
-				FLA_Gemm(FLA_NO_TRANSPOSE, FLA_NO_TRANSPOSE, alpha, B, A_2D, beta, C_2D);				
-			}else{
-				FLA_Gemm(FLA_NO_TRANSPOSE, FLA_TRANSPOSE, alpha, B, A_2D, beta, C_2D);				
-			}
+//Element offsets of the views A and C, and the modes other than mode with
+//extent > 1 sorted by increasing stride of C (n_o/sa_o/sc_o, nOther of them).
+//Returns FALSE if some mode is empty.  Instantiated for orders 2-6 (see
+//TLA_ORDER_INSTANTIATE) as it runs for every leaf product
+#define FLA_TTM_GATHER_MODES_DEF( name, ORDER ) \
+static FLA_Bool name( dim_t order_, dim_t mode, const FLA_Obj* A, const FLA_Obj* C, \
+                      dim_t* nOther, dim_t n_o[], dim_t sa_o[], dim_t sc_o[], \
+                      size_t* off_A, size_t* off_C ) \
+{ \
+	const dim_t order = (ORDER); \
+	const dim_t* stride_A = (A->base)->stride; \
+	const dim_t* stride_C = (C->base)->stride; \
+	dim_t i, j; \
+	dim_t nO = 0; \
+\
+	*off_A = 0; \
+	*off_C = 0; \
+	for(i = 0; i < order; i++){ \
+		*off_A += A->offset[i] * stride_A[i]; \
+		*off_C += C->offset[i] * stride_C[i]; \
+	} \
+\
+	for(i = 0; i < order; i++){ \
+		dim_t n_i, sa_i, sc_i; \
+		if(i == mode) \
+			continue; \
+		n_i = C->size[C->permutation[i]]; \
+		if(n_i == 0) \
+			return FALSE; \
+		if(n_i == 1) \
+			continue; \
+		sa_i = stride_A[A->permutation[i]]; \
+		sc_i = stride_C[C->permutation[i]]; \
+		for(j = nO; j > 0 && sc_o[j-1] > sc_i; j--){ \
+			n_o[j] = n_o[j-1]; \
+			sa_o[j] = sa_o[j-1]; \
+			sc_o[j] = sc_o[j-1]; \
+		} \
+		n_o[j] = n_i; \
+		sa_o[j] = sa_i; \
+		sc_o[j] = sc_i; \
+		nO++; \
+	} \
+	*nOther = nO; \
+	return TRUE; \
+}
+
+TLA_ORDER_INSTANTIATE( FLA_TTM_GATHER_MODES_DEF, FLA_Ttm_gather_modes )
+
+//Layout of the GEMMs of FLA_Ttm_geometry, for operands of any datatype
+//(buffers are offset by the element size of their own object).  Unless
+//unitC, g may be any mode; the caller then packs C itself
+static FLA_Error FLA_Ttm_geometry_layout( const FLA_Obj* A, dim_t mode, const FLA_Obj* B, const FLA_Obj* C,
+                                          FLA_Bool unitC, FLA_Ttm_geom* geom,
+                                          char** buf_A, char** buf_B, char** buf_C )
+{
+	dim_t i, j;
+	dim_t order = A->order;
+
+	//Collapsed non-contracted modes: extent and strides in A and C
+	dim_t nOther = 0;
+	dim_t* n_o = geom->n_o;
+	dim_t* sa_o = geom->sa_o;
+	dim_t* sc_o = geom->sc_o;
+	size_t off_A, off_C;
+	dim_t g;
+
+	//GEMM data
+	dim_t m_C, k_A;
+	dim_t rs_A, rs_C;
+
+	if((A->base)->elemtype != FLA_SCALAR || (C->base)->elemtype != FLA_SCALAR)
+		return FLA_FAILURE;
+
+	geom->datatype = (A->base)->datatype;
+	m_C = C->size[C->permutation[mode]];
+	k_A = A->size[A->permutation[mode]];
+	rs_A = ((A->base)->stride)[A->permutation[mode]];
+	rs_C = ((C->base)->stride)[C->permutation[mode]];
+	geom->rs_B = ((B->base)->stride)[B->permutation[0]];
+	geom->cs_B = ((B->base)->stride)[B->permutation[1]];
+
+	//Gather the other modes in order of increasing stride of C
+	if(!TLA_ORDER_DISPATCH(order, FLA_Ttm_gather_modes,
+	                       (order, mode, A, C, &nOther, n_o, sa_o, sc_o, &off_A, &off_C))){
+		geom->m = m_C;
+		geom->k = k_A;
+		geom->n = 0;
+		geom->nOther = 0;
+		return FLA_SUCCESS;
+	}
+
+	//Merge modes contiguous in both A and C
+	for(i = 1, j = 0; i < nOther; i++){
+		if(sc_o[i] == sc_o[j] * n_o[j] && sa_o[i] == sa_o[j] * n_o[j]){
+			n_o[j] *= n_o[i];
 		}else{
-			if(firstModeC == firstModeA){
-				FLA_Gemm(FLA_NO_TRANSPOSE, FLA_TRANSPOSE, alpha, A_2D, B, beta, C_2D);				
-			}else{
-				FLA_Gemm(FLA_TRANSPOSE, FLA_TRANSPOSE, alpha, A_2D, B, beta, C_2D);				
-			}
+			j++;
+			n_o[j] = n_o[i];
+			sa_o[j] = sa_o[i];
+			sc_o[j] = sc_o[i];
 		}
-		FLA_Obj_free_without_buffer(&A_2D);
-		FLA_Obj_free_without_buffer(&C_2D);
+	}
+	if(nOther > 0)
+		nOther = j + 1;
+
+	//Unit extents may take any stride
+	if(m_C == 1)
+		rs_C = 1;
+	if(k_A == 1)
+		rs_A = 1;
+
+	//Pick the mode giving a unit stride C matrix, preferring those that also
+	//give a unit stride A matrix (otherwise blis packs A), then the largest
+	g = nOther;
+	for(i = 0; i < nOther; i++){
+		FLA_Bool unitA_i = (rs_A == 1 || sa_o[i] == 1);
+		FLA_Bool unitA_g = (g < nOther && (rs_A == 1 || sa_o[g] == 1));
+		if(unitC && rs_C != 1 && sc_o[i] != 1)
+			continue;
+		if(g == nOther || (unitA_i && !unitA_g) ||
+		   (unitA_i == unitA_g && n_o[i] > n_o[g]))
+			g = i;
+	}
+	if(g == nOther){
+		if(nOther > 0)
+			return FLA_FAILURE;
+		//A and C are vectors
+		geom->n = 1;
+		geom->cs_A = k_A * rs_A;
+		geom->cs_C = m_C * rs_C;
 	}else{
-	
-		//FOR
-		FLA_Obj AT, AB;
-		FLA_Obj A0, A1, A2;
-		FLA_Obj CT, CB;
-		FLA_Obj C0, C1, C2;
-
-		FLA_Part_1xmode2(A, &AT,
-							&AB, permA[repart_mode], 0, FLA_TOP);	
-		FLA_Part_1xmode2(C, &CT,
-							&CB, repart_mode, 0, FLA_TOP);	
-		//Only symmetric part touched
-		//Ponder this
-		while(FLA_Obj_dimsize(CT, repart_mode) < FLA_Obj_dimsize(C, repart_mode)){
-
-			//Check this mathc out.  I think it is correct, Mode-1 of B matches mode-n of A
-			//Mode-0 of B matches Mode-n of C
-			dim_t b = 1;
-			FLA_Repart_1xmode2_to_1xmode3(AT, &A0,
-										/**/ /**/
-											  &A1,
-										  AB, &A2, permA[repart_mode], b, FLA_BOTTOM); 
-			FLA_Repart_1xmode2_to_1xmode3(CT, &C0,
-										/**/ /**/
-											  &C1,
-										  CB, &C2, repart_mode, b, FLA_BOTTOM);
-
-	/********************/
-			if(mode == repart_mode - 1)
-				FLA_Ttm_single_mode_blis(alpha, A1, mode, beta, B, C1, repart_mode - 2);
-			else
-				FLA_Ttm_single_mode_blis(alpha, A1, mode, beta, B, C1, repart_mode - 1);
-	/********************/
-
-			FLA_Cont_with_1xmode3_to_1xmode2( &AT, A0,
-												   A1,
-											/********/
-											  &AB, A2, permA[repart_mode], FLA_TOP);
-			FLA_Cont_with_1xmode3_to_1xmode2( &CT, C0,
-												   C1,
-											/********/
-											  &CB, C2, repart_mode, FLA_TOP);
+		geom->n = n_o[g];
+		geom->cs_A = sa_o[g];
+		geom->cs_C = sc_o[g];
+		nOther--;
+		for(i = g; i < nOther; i++){
+			n_o[i] = n_o[i+1];
+			sa_o[i] = sa_o[i+1];
+			sc_o[i] = sc_o[i+1];
 		}
 	}
+	geom->m = m_C;
+	geom->k = k_A;
+	geom->rs_A = rs_A;
+	geom->rs_C = rs_C;
+	geom->nOther = nOther;
+
+	*buf_A = (char*)((A->base)->buffer) + off_A * TLA_OBJ_ELEM_SIZE(*A);
+	*buf_B = (char*)((B->base)->buffer);
+	*buf_C = (char*)((C->base)->buffer) + off_C * TLA_OBJ_ELEM_SIZE(*C);
+	for(i = 0; i < 2; i++)
+		*buf_B += B->offset[i] * ((B->base)->stride)[i] * TLA_OBJ_ELEM_SIZE(*B);
+
+	return FLA_SUCCESS;
+}
+
+//Mode-n product computed directly on the layouts of A and C (no permutes)
+//C := alpha C + beta (B x_mode A)
+//
+//The modes of A/C other than mode are collapsed where they are contiguous in
+//both objects.  One of them (g) becomes the column dimension of a GEMM
+//
+//  C(mode, g) := alpha C(mode, g) + beta B A(mode, g)
+//
+//and the rest are looped over.  Returns FLA_FAILURE when no g gives a unit
+//stride C matrix, in which case the caller must fall back to the permute
+//based path.  geom->n == 0 means there is nothing to compute
+FLA_Error FLA_Ttm_geometry( const FLA_Obj* A, dim_t mode, const FLA_Obj* B, const FLA_Obj* C,
+                            FLA_Ttm_geom* geom, char** buf_A, char** buf_B, char** buf_C )
+{
+	FLA_Datatype datatype = (A->base)->datatype;
+
+	if(datatype != (B->base)->datatype || datatype != (C->base)->datatype)
+		return FLA_FAILURE;
+
+	return FLA_Ttm_geometry_layout(A, mode, B, C, TRUE, geom, buf_A, buf_B, buf_C);
+}
+
+//Runs the GEMMs described by geom (see FLA_Ttm_geometry) through blis
+void FLA_Ttm_geom_exec_blis( FLA_Ttm_geom* geom, FLA_Obj alpha, FLA_Obj beta,
+                             char* buf_A, char* buf_B, char* buf_C )
+{
+	dim_t i;
+	dim_t nOther = geom->nOther;
+	size_t elem_size = (size_t)FLA_Obj_datatype_size(geom->datatype);
+	dim_t curIndex[FLA_MAX_ORDER];
+	dim_t offA, offC;
+
+	if(geom->n == 0)
+		return;
+
+	memset(&(curIndex[0]), 0, nOther * sizeof(dim_t));
+	offA = 0;
+	offC = 0;
+	while(TRUE){
+		FLA_Ttm_gemm_blis(geom->datatype, alpha, beta,
+		                  geom->m, geom->k, geom->n,
+		                  buf_B, geom->rs_B, geom->cs_B,
+		                  buf_A + offA * elem_size, geom->rs_A, geom->cs_A,
+		                  buf_C + offC * elem_size, geom->rs_C, geom->cs_C);
+
+		for(i = 0; i < nOther; i++){
+			curIndex[i]++;
+			offA += geom->sa_o[i];
+			offC += geom->sc_o[i];
+			if(curIndex[i] < geom->n_o[i])
+				break;
+			offA -= geom->sa_o[i] * geom->n_o[i];
+			offC -= geom->sc_o[i] * geom->n_o[i];
+			curIndex[i] = 0;
+		}
+		if(i == nOther)
+			break;
+	}
+}
+
+FLA_Error FLA_Ttm_single_mode_blis( FLA_Obj alpha, FLA_Obj A,
+                                    dim_t mode,
+                                    FLA_Obj beta, FLA_Obj B,
+                                    FLA_Obj C )
+{
+	FLA_Ttm_geom geom;
+	char* buf_A;
+	char* buf_B;
+	char* buf_C;
+
+	if(FLA_Ttm_geometry(&A, mode, &B, &C, &geom, &buf_A, &buf_B, &buf_C) != FLA_SUCCESS)
+		return FLA_FAILURE;
+
+	FLA_Ttm_geom_exec_blis(&geom, alpha, beta, buf_A, buf_B, buf_C);
+
 	return FLA_SUCCESS;
 }
 
@@ -193,7 +351,7 @@ FLA_Error FLA_Ttm_scalar_no_permC( FLA_Obj alpha, FLA_Obj A,
 	FLA_Adjust_2D_info(&P);
 
 	/*********************************/
-	FLASH_Gemm(FLA_NO_TRANSPOSE, FLA_NO_TRANSPOSE, beta, B, P, alpha, C);
+	FLA_Gemm_external(FLA_NO_TRANSPOSE, FLA_NO_TRANSPOSE, beta, B, P, alpha, C);
 	/*********************************/
 
 	FLA_Obj_free_buffer(&P);
@@ -202,7 +360,127 @@ FLA_Error FLA_Ttm_scalar_no_permC( FLA_Obj alpha, FLA_Obj A,
 	return FLA_SUCCESS;
 }
 
-//Original form that permutes C
+//Scalar ttm with A a packed diagonal block (see TLA_Pack_sym_block).  The
+//block is expanded into a dense scratch tensor that takes the place of its
+//base, so the view of A (offsets/permutation) is used unchanged
+static FLA_Error FLA_Ttm_scalar_packedA( FLA_Obj alpha, FLA_Obj A,
+                                         dim_t mode,
+                                         FLA_Obj beta, FLA_Obj B,
+                                         FLA_Obj C )
+{
+    dim_t order = FLA_Obj_order(A);
+    dim_t stride[FLA_MAX_ORDER];
+    FLA_Obj T, Aview;
+
+    FLA_Set_tensor_stride(order, (A.base)->size, stride);
+    FLA_Obj_create_tensor(FLA_Obj_datatype(A), order, (A.base)->size, stride, &T);
+    TLA_Unpack_sym_block((A.base)->packed_sym, (A.base)->buffer, T);
+
+    Aview = A;
+    Aview.base = T.base;
+    FLA_Ttm_scalar_permC(alpha, Aview, mode, beta, B, C);
+
+    FLA_Obj_free_buffer(&T);
+    FLA_Obj_free_without_buffer(&T);
+
+    return FLA_SUCCESS;
+}
+
+//Scalar ttm on operands of different precision, computed in the widest
+//datatype.  The GEMMs of FLA_Ttm_geometry_layout run on small contiguous
+//panels, and the conversion is fused into packing them: B is widened once,
+//each A(mode, g) and C(mode, g) panel right before its GEMM, and the C panel
+//is narrowed back into C right after it.  Only the elements of the views are
+//touched, and an overwritten C (zero alpha) is not read
+static FLA_Error FLA_Ttm_scalar_mixed( FLA_Obj alpha, FLA_Obj A,
+                                       dim_t mode,
+                                       FLA_Obj beta, FLA_Obj B,
+                                       FLA_Obj C )
+{
+    dim_t i;
+    FLA_Datatype dt_A = FLA_Obj_datatype(A);
+    FLA_Datatype dt_B = FLA_Obj_datatype(B);
+    FLA_Datatype dt_C = FLA_Obj_datatype(C);
+    FLA_Datatype datatype = dt_C;
+    size_t elem_size, es_A, es_C;
+    FLA_Bool readC = !FLA_Obj_equals(alpha, FLA_ZERO);
+    FLA_Ttm_geom geom;
+    char* buf_A;
+    char* buf_B;
+    char* buf_C;
+    char* work;
+    char* wB;
+    char* wA;
+    char* wC;
+    dim_t m, k, n;
+    dim_t curIndex[FLA_MAX_ORDER];
+    dim_t offA, offC;
+
+    if(FLA_Obj_datatype_size(dt_A) > FLA_Obj_datatype_size(datatype))
+        datatype = dt_A;
+    if(FLA_Obj_datatype_size(dt_B) > FLA_Obj_datatype_size(datatype))
+        datatype = dt_B;
+
+    if(FLA_Ttm_geometry_layout(&A, mode, &B, &C, FALSE, &geom, &buf_A, &buf_B, &buf_C) != FLA_SUCCESS)
+        return FLA_FAILURE;
+    if(geom.n == 0)
+        return FLA_SUCCESS;
+
+    m = geom.m;
+    k = geom.k;
+    n = geom.n;
+    elem_size = (size_t)FLA_Obj_datatype_size(datatype);
+    es_A = (size_t)FLA_Obj_datatype_size(dt_A);
+    es_C = (size_t)FLA_Obj_datatype_size(dt_C);
+
+    work = (char*)FLA_malloc((m * k + k * n + m * n) * elem_size);
+    wB = work;
+    wA = wB + m * k * elem_size;
+    wC = wA + k * n * elem_size;
+
+    if(TLA_Copy_matrix_convert(m, k, dt_B, buf_B, geom.rs_B, geom.cs_B, datatype, wB, 1, m) != FLA_SUCCESS){
+        FLA_free(work);
+        return FLA_FAILURE;
+    }
+
+    //Keeps an overwritten panel finite for an empty (k == 0) product
+    if(!readC)
+        memset(wC, 0, m * n * elem_size);
+
+    memset(&(curIndex[0]), 0, geom.nOther * sizeof(dim_t));
+    offA = 0;
+    offC = 0;
+    while(TRUE){
+        TLA_Copy_matrix_convert(k, n, dt_A, buf_A + offA * es_A, geom.rs_A, geom.cs_A, datatype, wA, 1, k);
+        if(readC)
+            TLA_Copy_matrix_convert(m, n, dt_C, buf_C + offC * es_C, geom.rs_C, geom.cs_C, datatype, wC, 1, m);
+        FLA_Ttm_gemm_blis(datatype, alpha, beta, m, k, n,
+                          wB, 1, m, wA, 1, k, wC, 1, m);
+        TLA_Copy_matrix_convert(m, n, datatype, wC, 1, m, dt_C, buf_C + offC * es_C, geom.rs_C, geom.cs_C);
+
+        for(i = 0; i < geom.nOther; i++){
+            curIndex[i]++;
+            offA += geom.sa_o[i];
+            offC += geom.sc_o[i];
+            if(curIndex[i] < geom.n_o[i])
+                break;
+            offA -= geom.sa_o[i] * geom.n_o[i];
+            offC -= geom.sc_o[i] * geom.n_o[i];
+            curIndex[i] = 0;
+        }
+        if(i == geom.nOther)
+            break;
+    }
+
+    FLA_free(work);
+
+    return FLA_SUCCESS;
+}
+
+//Scalar ttm.  Computed in place by FLA_Ttm_single_mode_blis when GEMM can
+//express the layouts of A and C, otherwise by permuting A and C (original form).
+//With alpha zero C is overwritten without being read
+//(C := beta (B x_mode A)), as GEMM does for a zero beta
 FLA_Error FLA_Ttm_scalar_permC( FLA_Obj alpha, FLA_Obj A,
                                 dim_t mode,
                                 FLA_Obj beta, FLA_Obj B,
@@ -226,6 +504,14 @@ FLA_Error FLA_Ttm_scalar_permC( FLA_Obj alpha, FLA_Obj A,
         return FLA_SUCCESS;
     }
 
+    if((A.base)->isPacked)
+        return FLA_Ttm_scalar_packedA(alpha, A, mode, beta, B, C);
+    if(FLA_Obj_datatype(A) != FLA_Obj_datatype(C) || FLA_Obj_datatype(B) != FLA_Obj_datatype(C))
+        return FLA_Ttm_scalar_mixed(alpha, A, mode, beta, B, C);
+
+    if(FLA_Ttm_single_mode_blis(alpha, A, mode, beta, B, C) == FLA_SUCCESS)
+        return FLA_SUCCESS;
+
     permutation[0] = mode;
     for(i = 0; i < mode; i++)
         permutation[i+1] = i;
@@ -236,12 +522,13 @@ FLA_Error FLA_Ttm_scalar_permC( FLA_Obj alpha, FLA_Obj A,
   FLA_Obj_create_tensor(datatype, order, size_C, stride_C, &tmpC);
 
   FLA_Permute(A, permutation, &P);
-  FLA_Permute(C, permutation, &tmpC);
+  if(!FLA_Obj_equals(alpha, FLA_ZERO))
+      FLA_Permute(C, permutation, &tmpC);
 
   FLA_Adjust_2D_info(&P);
   FLA_Adjust_2D_info(&tmpC);
 	FLA_Adjust_2D_info(&B);
-  FLASH_Gemm(FLA_NO_TRANSPOSE, FLA_NO_TRANSPOSE, beta, B, P, alpha, tmpC);
+  FLA_Gemm_external(FLA_NO_TRANSPOSE, FLA_NO_TRANSPOSE, beta, B, P, alpha, tmpC);
 
   for(i = 0; i < order; i++)
       ipermutation[permutation[i]] = i;
@@ -255,81 +542,167 @@ FLA_Error FLA_Ttm_scalar_permC( FLA_Obj alpha, FLA_Obj A,
 
     return FLA_SUCCESS;
 }
-/*
-FLA_Error FLA_Ttm( FLA_Obj alpha, FLA_Obj A,
-                   dim_t nModes, dim_t mode[nModes],
-                   FLA_Obj beta, FLA_Obj B[nModes],
-                   FLA_Obj C )
+//Logical flat sizes of A and, for a blocked A, the size of its blocks
+static void FLA_Ttm_flat_size( FLA_Obj A, dim_t flat_size[], dim_t blk_size[] )
 {
-	dim_t i, j;
-	FLA_Obj tmpA, tmpC;
-	FLA_Datatype datatype = FLA_Obj_datatype( A );
-	dim_t order;
-	dim_t* size_tmpC;
-	dim_t* size_tmpA;
-	dim_t* stride_tmpC;
-	dim_t* stride_tmpA;
-	//When we mode-mult, we get B's second dim size
-	dim_t  newdimsize[nModes];
-	for(i = 0; i < nModes; i++)
-		newdimsize[i] =  FLA_Obj_dimsize(B[i], 0);
-
-	//Setup tmpA
-	order = FLA_Obj_order(A);
-	size_tmpA = FLA_Obj_size(A);
-	stride_tmpA = FLA_Obj_stride(A);
-
-	//WARNING: DOUBLE ATTACHMENT.  FIX THIS
-	FLA_Obj_create_tensor_without_buffer(datatype, order, size_tmpA, &tmpA);
-	double* tmpA_buf = (double*)FLA_malloc(FLA_Obj_num_elem_alloc(A) * sizeof(double*));
-	memcpy(&(tmpA_buf[0]), &(((double*)FLA_Obj_base_buffer(A))[0]), FLA_Obj_num_elem_alloc(A) * sizeof(double));
-    FLA_Obj_attach_buffer_to_tensor(tmpA_buf, order, stride_tmpA, &tmpA);
+	dim_t i;
+	dim_t order = FLA_Obj_order(A);
 
-	for(i = 0; i < nModes; i++){
-		//Setup tmpC
-		size_tmpC = FLA_Obj_size(tmpA);
-		size_tmpC[mode[i]] = newdimsize[i];
-		stride_tmpC = FLA_Obj_stride(tmpA);
-		dim_t nElem = size_tmpC[0];
-		stride_tmpC[0] = 1;
-		for(j = 1; j < order; j++){
-			nElem *= size_tmpC[j];
-			stride_tmpC[j] = stride_tmpC[j-1]*size_tmpC[j-1];
+	for(i = 0; i < order; i++){
+		flat_size[i] = A.size[A.permutation[i]];
+		blk_size[i] = 1;
+	}
+	if(FLA_Obj_elemtype(A) != FLA_SCALAR){
+		FLA_Obj blk = *((FLA_Obj*)TLA_OBJ_BUFFER_AT_VIEW(A));
+		for(i = 0; i < order; i++){
+			blk_size[i] = blk.size[blk.permutation[i]];
+			flat_size[i] *= blk_size[i];
 		}
+	}
+}
 
-		double* data = (double*)FLA_malloc(nElem * sizeof(double));
-		memset(&(data[0]), 0, nElem * sizeof(double));
+//Sets up T (flat or blocked like A) on the caller owned buffer buf.  T is
+//left as is; the product into it overwrites it
+static void FLA_Ttm_create_intermediate( FLA_Obj A, dim_t order, const dim_t flat_size[], const dim_t blk_size[],
+                                         void* buf, FLA_Obj* T )
+{
+	dim_t i;
+	FLA_Datatype datatype = FLA_Obj_datatype(A);
+	size_t elem_size = (size_t)FLA_Obj_datatype_size(datatype);
+	dim_t stride[FLA_MAX_ORDER];
 
-		FLA_Obj_create_tensor_without_buffer(datatype, order, size_tmpC, &tmpC);
-	    FLA_Obj_attach_buffer_to_tensor(data, order, stride_tmpC, &tmpC);
+	if(FLA_Obj_elemtype(A) == FLA_SCALAR){
+		FLA_Set_tensor_stride(order, flat_size, stride);
+		FLA_Obj_create_tensor_without_buffer(datatype, order, flat_size, T);
+		FLA_Obj_attach_buffer_to_tensor(buf, order, stride, T);
+	}else{
+		dim_t blked_size[FLA_MAX_ORDER];
+		dim_t nBlocks;
+		size_t blockBytes;
+		void** dataBuffers;
+
+		FLA_Obj_create_blocked_tensor_without_buffer(datatype, order, flat_size, blk_size, T);
+		FLA_array_elemwise_quotient(order, flat_size, blk_size, blked_size);
+		FLA_Set_tensor_stride(order, blked_size, stride);
+		nBlocks = FLA_array_product(order, blked_size);
+		blockBytes = FLA_array_product(order, blk_size) * elem_size;
+
+		dataBuffers = (void**)FLA_malloc(nBlocks * sizeof(void*));
+		for(i = 0; i < nBlocks; i++)
+			dataBuffers[i] = (char*)buf + i * blockBytes;
+		FLA_Obj_attach_buffer_to_blocked_tensor(dataBuffers, order, stride, T);
+		FLA_free(dataBuffers);
+	}
+}
 
-		FLA_Ttm_single_mode(alpha, tmpA, mode[i], beta, B[i], tmpC);
+//Frees T but not the buffer it was given
+static void FLA_Ttm_free_intermediate( FLA_Obj* T )
+{
+	if(FLA_Obj_elemtype(*T) != FLA_SCALAR){
+		FLA_free(T->base->blk_bases);
+		FLA_Obj_free_buffer(T);
+	}
+	FLA_Obj_free_without_buffer(T);
+}
 
-		//Make tmpA = tmpC and clear tmpC for next iteration
-		memcpy(&(tmpA.size[0]), &(tmpC.size[0]), order * sizeof(dim_t));
-		memcpy(&((tmpA.base)->size[0]), &(tmpC.size[0]), order * sizeof(dim_t));
-		memcpy(&(((tmpA.base)->stride)[0]), &(((tmpC.base)->stride)[0]), order * sizeof(dim_t));
-		//Clear tmpA's buffer since we will point it elsewhere
-		FLA_free((tmpA.base)->buffer);
+//C := alpha C + beta (A x_mode[0] B[0] x_mode[1] B[1] ... x_mode[nModes-1] B[nModes-1])
+//
+//The products are applied in the order chosen by FLA_Ttm_Ops_order (fewest
+//flops, then smallest intermediate).  Intermediates alternate between two
+//buffers, each sized for the largest intermediate it holds, so nothing is
+//allocated per mode.  A, C and the intermediates are either all flat or all
+//blocked; blocked intermediates take the blocking of A, and that of B[i]
+//along the modes already multiplied.
+FLA_Error FLA_Ttm( FLA_Obj alpha, FLA_Obj A,
+                   dim_t nModes, const dim_t mode[],
+                   FLA_Obj beta, const FLA_Obj B[],
+                   FLA_Obj C )
+{
+	return FLA_Ttm_ext(alpha, A, nModes, mode, beta, B, C, NULL, NULL);
+}
 
-		tmpA.base->buffer = FLA_malloc(tmpC.base->n_elem_alloc * sizeof(double));
-		memcpy(&(((double*)tmpA.base->buffer)[0]), &(((double*)tmpC.base->buffer)[0]), tmpC.base->n_elem_alloc * sizeof(double));
-		tmpA.base->n_elem_alloc = tmpC.base->n_elem_alloc;
-		FLA_Adjust_2D_info(&tmpA);
+//FLA_Ttm that also reports the order the products were applied in (order[s]
+//is the index into mode[] and B[] of step s) and the flops FLA_Ttm_Ops_order
+//predicted for it.  Either may be NULL.  Returns FLA_FAILURE, touching
+//nothing, for more than FLA_MAX_ORDER products or a mode past the order of A
+FLA_Error FLA_Ttm_ext( FLA_Obj alpha, FLA_Obj A,
+                       dim_t nModes, const dim_t mode[],
+                       FLA_Obj beta, const FLA_Obj B[],
+                       FLA_Obj C, dim_t order_out[], dim_t* flops )
+{
+	dim_t i, s;
+	dim_t order = FLA_Obj_order(A);
+	size_t elem_size = (size_t)FLA_Obj_datatype_size(FLA_Obj_datatype(A));
+	dim_t seq[FLA_MAX_ORDER];
+	dim_t nFlops;
+	dim_t size_B[2*FLA_MAX_ORDER];
+	dim_t blk_B[FLA_MAX_ORDER];
+	dim_t flat_size[FLA_MAX_ORDER];
+	dim_t blk_size[FLA_MAX_ORDER];
+	dim_t cap[2] = {0, 0};
+	void* buf[2];
+	FLA_Obj T, Tprev;
+
+	//seq and size_B hold at most FLA_MAX_ORDER products, and the order is
+	//chosen over the 2^nModes subsets of them, indexed by mode
+	if(nModes > FLA_MAX_ORDER)
+		return FLA_FAILURE;
+	for(i = 0; i < nModes; i++)
+		if(mode[i] >= order)
+			return FLA_FAILURE;
 
-		FLA_Obj_free(&tmpC);
-		FLA_free(size_tmpC);
-		FLA_free(stride_tmpC);
+	for(i = 0; i < nModes; i++){
+		dim_t flat_B[2], bsz_B[2];
+		FLA_Ttm_flat_size(B[i], flat_B, bsz_B);
+		size_B[2*i] = flat_B[0];
+		size_B[2*i+1] = flat_B[1];
+		blk_B[i] = bsz_B[0];
 	}
+	FLA_Ttm_flat_size(A, flat_size, blk_size);
+	nFlops = FLA_Ttm_Ops_order(order, flat_size, nModes, mode, size_B, seq);
+	if(order_out != NULL)
+		memcpy(&(order_out[0]), &(seq[0]), nModes * sizeof(dim_t));
+	if(flops != NULL)
+		*flops = nFlops;
+
+	if(nModes == 0)
+		return FLA_SUCCESS;
+	if(nModes == 1)
+		return FLA_Ttm_single_mode(alpha, A, mode[0], beta, B[0], C);
+
+	//Size the two buffers: intermediate s lives in buf[s % 2]
+	for(s = 0; s < nModes - 1; s++){
+		dim_t nElem;
+		flat_size[mode[seq[s]]] = size_B[2*seq[s]];
+		nElem = FLA_array_product(order, flat_size);
+		if(nElem > cap[s % 2])
+			cap[s % 2] = nElem;
+	}
+	buf[0] = FLA_malloc(cap[0] * elem_size);
+	buf[1] = (cap[1] > 0) ? FLA_malloc(cap[1] * elem_size) : NULL;
+
+	FLA_Ttm_flat_size(A, flat_size, blk_size);
+	Tprev = A;
+	for(s = 0; s < nModes - 1; s++){
+		dim_t j = seq[s];
+		flat_size[mode[j]] = size_B[2*j];
+		blk_size[mode[j]] = blk_B[j];
+
+		FLA_Ttm_create_intermediate(A, order, flat_size, blk_size, buf[s % 2], &T);
+		FLA_Ttm_single_mode(FLA_ZERO, Tprev, mode[j], FLA_ONE, B[j], T);
+		if(s > 0)
+			FLA_Ttm_free_intermediate(&Tprev);
+		Tprev = T;
+	}
+	FLA_Ttm_single_mode(alpha, Tprev, mode[seq[nModes-1]], beta, B[seq[nModes-1]], C);
+	FLA_Ttm_free_intermediate(&Tprev);
 
-	memcpy(&(((double*)C.base->buffer)[0]), &(((double*)tmpA.base->buffer)[0]), FLA_Obj_num_elem_alloc(C) * sizeof(double));
+	FLA_free(buf[0]);
+	if(buf[1] != NULL)
+		FLA_free(buf[1]);
 
-	FLA_Obj_free(&tmpA);
-	FLA_free(size_tmpA);
-	FLA_free(stride_tmpA);
 	return FLA_SUCCESS;
 }
-*/
 
 /*****************
 *****    NOTE: ASSUMES THIS IS COMPUTING STATIONARY C ALGORITHM!!!!!
@@ -474,54 +847,49 @@ FLA_Error FLA_Ttm_hierCB_single_repart_mode( FLA_Obj alpha, FLA_Obj A,
 }
 */
 
-FLA_Error FLA_Ttm_hierCA_single_repart_mode( FLA_Obj alpha, FLA_Obj A,
-                                             dim_t mode,
-                                             FLA_Obj beta, FLA_Obj B,
-                                             dim_t repart_mode, FLA_Obj C )
+static void FLA_Ttm_single_mode_batch( FLA_Ttm_batch* batch, const TLA_View* A,
+                                       dim_t mode, const TLA_View* B,
+                                       const TLA_View* C );
+
+static void FLA_Ttm_hierCA_single_repart_mode_batch( FLA_Ttm_batch* batch, const TLA_View* A,
+                                                     dim_t mode, const TLA_View* B,
+                                                     dim_t repart_mode, const TLA_View* C )
 {
-	//FOR
-	FLA_Obj AT, AB;
-	FLA_Obj A0, A1, A2;
-	FLA_Obj CT, CB;
-	FLA_Obj C0, C1, C2;
-	
+	TLA_View A1, C1;
 	dim_t loopCount;
 
-	FLA_Part_1xmode2(A, &AT,
-						&AB, repart_mode, 0, FLA_TOP);	
-	FLA_Part_1xmode2(C, &CT,
-						&CB, repart_mode, 0, FLA_TOP);	
 	//Only symmetric part touched
 	//Ponder this
-	loopCount = 0;
-	while(loopCount < FLA_Obj_dimsize(C, repart_mode)){
-		dim_t b = 1;
-		FLA_Repart_1xmode2_to_1xmode3(AT, &A0,
-									/**/ /**/
-										  &A1,
-									  AB, &A2, repart_mode, b, FLA_BOTTOM); 
-		FLA_Repart_1xmode2_to_1xmode3(CT, &C0,
-									/**/ /**/
-										  &C1,
-									  CB, &C2, repart_mode, b, FLA_BOTTOM);
+	for(loopCount = 0; loopCount < (C->size)[repart_mode]; loopCount++){
+		TLA_View_slice(A, repart_mode, loopCount, &A1);
+		TLA_View_slice(C, repart_mode, loopCount, &C1);
 
-		FLA_Ttm_single_mode(alpha, A1, mode, beta, B, C1);
-
-		FLA_Cont_with_1xmode3_to_1xmode2( &CT, C0,
-											   C1,
-										/********/
-										  &CB, C2, repart_mode, FLA_TOP);
-		FLA_Cont_with_1xmode3_to_1xmode2( &AT, A0,
-											   A1,
-										/********/
-										  &AB, A2, repart_mode, FLA_TOP);
-		loopCount++;
+		FLA_Ttm_single_mode_batch(batch, &A1, mode, B, &C1);
 	}
+}
+
+FLA_Error FLA_Ttm_hierCA_single_repart_mode( FLA_Obj alpha, FLA_Obj A,
+                                             dim_t mode,
+                                             FLA_Obj beta, FLA_Obj B,
+                                             dim_t repart_mode, FLA_Obj C )
+{
+	FLA_Ttm_batch batch;
+	TLA_View Av, Bv, Cv;
+
+	TLA_View_from_obj(&A, &Av);
+	TLA_View_from_obj(&B, &Bv);
+	TLA_View_from_obj(&C, &Cv);
+
+	FLA_Ttm_batch_init(alpha, beta, &batch);
+	FLA_Ttm_hierCA_single_repart_mode_batch(&batch, &Av, mode, &Bv, repart_mode, &Cv);
+	FLA_Ttm_batch_flush(&batch);
+	FLA_Ttm_batch_free(&batch);
 
 	return FLA_SUCCESS;
 }
 
-//Assumes C is already permuted (hence nopermC)
+//Assumes C is already permuted (hence nopermC).  Only the first block product
+//scales C by alpha (overwriting it if alpha is zero); the others accumulate
 FLA_Error FLA_Tensor_innerprod_nopermC( FLA_Obj alpha, FLA_Obj A,
                                         dim_t mode,
                                         FLA_Obj beta, FLA_Obj B,
@@ -558,9 +926,9 @@ FLA_Error FLA_Tensor_innerprod_nopermC( FLA_Obj alpha, FLA_Obj A,
                                           &A1,
                                       AB, &A2, mode, b, FLA_BOTTOM);
         /*********************/
-        A1blk = *((FLA_Obj*)FLA_Obj_tensor_buffer_at_view(A1));
-        B1blk = *((FLA_Obj*)FLA_Obj_tensor_buffer_at_view(B1));
-        FLA_Ttm_scalar_no_permC(alpha, A1blk, mode, beta, B1blk, C);
+        A1blk = *((FLA_Obj*)TLA_OBJ_BUFFER_AT_VIEW(A1));
+        B1blk = *((FLA_Obj*)TLA_OBJ_BUFFER_AT_VIEW(B1));
+        FLA_Ttm_scalar_no_permC(loopCount == 0 ? alpha : FLA_ONE, A1blk, mode, beta, B1blk, C);
 		/*********************/
         FLA_Cont_with_1xmode3_to_1xmode2( &AT, A0,
                                                A1,
@@ -575,113 +943,115 @@ FLA_Error FLA_Tensor_innerprod_nopermC( FLA_Obj alpha, FLA_Obj A,
     return FLA_SUCCESS;
 }
 
-//C is a vector, B a matrix, A a vector.
-FLA_Error FLA_Tensor_mvmult_nopermC( FLA_Obj alpha, FLA_Obj A,
-                                     dim_t mode,
-                                     FLA_Obj beta, FLA_Obj B,
-                                     FLA_Obj C )
+//Adds the products of all blocks of A (and B) along mode into the scalar
+//block C to batch.  C is used in its own layout; only the first product
+//scales it by alpha
+static void FLA_Tensor_innerprod_batch( FLA_Ttm_batch* batch, const TLA_View* A,
+                                        dim_t mode, const TLA_View* B,
+                                        const FLA_Obj* C )
 {
-    FLA_Obj BT, BB;
-    FLA_Obj B0, B1, B2;
-    FLA_Obj CT, CB;
-    FLA_Obj C0, C1, C2;
+    TLA_View A1, B1;
+    dim_t loopCount;
+
+    //Only symmetric part touched
+    //Ponder this
+    for(loopCount = 0; loopCount < (A->size)[mode]; loopCount++){
+        //Mode-1 of B matches mode-n of A
+        //Mode-0 of B matches Mode-n of C
+        TLA_View_slice(B, 1, loopCount, &B1);
+        TLA_View_slice(A, mode, loopCount, &A1);
+        /*********************/
+        FLA_Ttm_batch_add(batch, (FLA_Obj*)TLA_View_buffer_at_view(&A1), mode,
+                          (FLA_Obj*)TLA_View_buffer_at_view(&B1), C, loopCount == 0);
+        /*********************/
+    }
+}
+
+//Accumulates all blocks of A (and B) along mode into the scalar block C
+//C is used in its own layout
+FLA_Error FLA_Tensor_innerprod( FLA_Obj alpha, FLA_Obj A,
+                                dim_t mode,
+                                FLA_Obj beta, FLA_Obj B,
+                                FLA_Obj C )
+{
+    FLA_Ttm_batch batch;
+    TLA_View Av, Bv;
+
+    TLA_View_from_obj(&A, &Av);
+    TLA_View_from_obj(&B, &Bv);
+
+    FLA_Ttm_batch_init(alpha, beta, &batch);
+    FLA_Tensor_innerprod_batch(&batch, &Av, mode, &Bv, &C);
+    FLA_Ttm_batch_flush(&batch);
+    FLA_Ttm_batch_free(&batch);
+
+    return FLA_SUCCESS;
+}
 
+//C is a vector, B a matrix, A a vector.
+static void FLA_Tensor_mvmult_nopermC_batch( FLA_Ttm_batch* batch, const TLA_View* A,
+                                             dim_t mode, const TLA_View* B,
+                                             const TLA_View* C )
+{
+    TLA_View B1, C1;
     dim_t loopCount;
 
-    //Normally each block of output vector would be re-permuted for each contribution.
-    //To avoid this, we permute the output block once and compute assuming the data is
-    //already permuted, then permute back.  This saves lots of mem-ops
-	FLA_Obj tmpC1;
+    //Each block of C is updated in place (strided GEMMs on the layout of C),
+    //so no permuted copy of C is needed.
 
-	
-    FLA_Part_1xmode2(B, &BT,
-                        &BB, 0, 0, FLA_TOP);
-    FLA_Part_1xmode2(C, &CT,
-                        &CB, mode, 0, FLA_TOP);
     //Only symmetric part touched
     //Ponder this
-    loopCount = 0;
-    while(loopCount < FLA_Obj_dimsize(C, mode)){
-
-        //Check this mathc out.  I think it is correct, Mode-1 of B matches mode-n of A
+    for(loopCount = 0; loopCount < (C->size)[mode]; loopCount++){
+        //Mode-1 of B matches mode-n of A
         //Mode-0 of B matches Mode-n of C
-        dim_t b = 1;
-        FLA_Repart_1xmode2_to_1xmode3(BT, &B0,
-                                    /**/ /**/
-                                          &B1,
-                                      BB, &B2, 0, b, FLA_BOTTOM);
-        FLA_Repart_1xmode2_to_1xmode3(CT, &C0,
-                                    /**/ /**/
-                                          &C1,
-                                      CB, &C2, mode, b, FLA_BOTTOM);
-
-        //NOTE: Curly braces for C89 compliance.  Find a better way to fix this
-        {
-			//Permute this block of C
-			FLA_Obj* C1blk = (FLA_Obj*)FLA_Obj_tensor_buffer_at_view(C1);
-			dim_t i;
-			dim_t order = FLA_Obj_order(*C1blk);
-			const dim_t* size_C1blk = C1blk->size;
-			const dim_t* stride_C1blk = C1blk->base->stride;
-			dim_t permutation[FLA_MAX_ORDER];
-			dim_t ipermutation[FLA_MAX_ORDER];
-			permutation[0] = mode;
-			for(i = 0; i < mode; i++)
-				permutation[i+1] = i;
-			for(i = mode+1; i < order; i++)
-				permutation[i] = i;
-			if(loopCount == 0)
-				FLA_Obj_create_tensor(FLA_DOUBLE, C1blk->order, size_C1blk, stride_C1blk, &tmpC1);
-			FLA_Permute(*C1blk, permutation, &tmpC1);
-			//Done permuting
-
-			/***********************************************/
-			//Compute
-			FLA_Tensor_innerprod_nopermC(alpha, A, mode, beta, B1, tmpC1);
-			/***********************************************/
-
-			//Permute the block back
-			for(i = 0; i < order; i++)
-				ipermutation[permutation[i]] = i;
-			FLA_Permute(tmpC1, ipermutation, C1blk);
-			//Done permuting
-        }
-        FLA_Cont_with_1xmode3_to_1xmode2( &CT, C0,
-                                               C1,
-                                        /********/
-                                          &CB, C2, mode, FLA_TOP);
-        FLA_Cont_with_1xmode3_to_1xmode2( &BT, B0,
-                                               B1,
-                                        /********/
-                                          &BB, B2, 0, FLA_TOP);
-        loopCount++;
+        TLA_View_slice(B, 0, loopCount, &B1);
+        TLA_View_slice(C, mode, loopCount, &C1);
+
+        /***********************************************/
+        FLA_Tensor_innerprod_batch(batch, A, mode, &B1,
+                                   (FLA_Obj*)TLA_View_buffer_at_view(&C1));
+        /***********************************************/
     }
-	
-	FLA_Obj_free_buffer(&tmpC1);
-	FLA_Obj_free_without_buffer(&tmpC1);
+}
+
+FLA_Error FLA_Tensor_mvmult_nopermC( FLA_Obj alpha, FLA_Obj A,
+                                     dim_t mode,
+                                     FLA_Obj beta, FLA_Obj B,
+                                     FLA_Obj C )
+{
+    FLA_Ttm_batch batch;
+    TLA_View Av, Bv, Cv;
+
+    TLA_View_from_obj(&A, &Av);
+    TLA_View_from_obj(&B, &Bv);
+    TLA_View_from_obj(&C, &Cv);
+
+    FLA_Ttm_batch_init(alpha, beta, &batch);
+    FLA_Tensor_mvmult_nopermC_batch(&batch, &Av, mode, &Bv, &Cv);
+    FLA_Ttm_batch_flush(&batch);
+    FLA_Ttm_batch_free(&batch);
+
     return FLA_SUCCESS;
 }
 
-FLA_Error FLA_Ttm_single_mode( FLA_Obj alpha, FLA_Obj A,
-                               dim_t mode,
-                               FLA_Obj beta, FLA_Obj B,
-                               FLA_Obj C )
+//Collects the block products of C := alpha C + beta (B x_mode A) into batch.
+//The blocks of C are disjoint and the products of each one are added in
+//order, so the batch may run them once the whole of C has been walked.
+static void FLA_Ttm_single_mode_batch( FLA_Ttm_batch* batch, const TLA_View* A,
+                                       dim_t mode, const TLA_View* B,
+                                       const TLA_View* C )
 {
 	dim_t i;
 	dim_t do_repart;
 	dim_t repart_mode;
 
-	//If A is a scalar, call the scalar version
-	if(FLA_Obj_elemtype(A) == FLA_SCALAR){
-		return FLA_Ttm_scalar_permC(alpha, A, mode, beta, B, C);
-	}
 	//Repartition C & A as much as you can before multiplying
 	do_repart = FALSE;
 	repart_mode = 0;
-	for(i = 0; i < FLA_Obj_order(C); i++){
+	for(i = 0; i < C->order; i++){
 		if(i == mode)
 			continue;
-		else if(FLA_Obj_dimsize(C,i) > 1){
+		else if((C->size)[i] > 1){
 			repart_mode = i;
 			do_repart = TRUE;
 			break;
@@ -690,9 +1060,61 @@ FLA_Error FLA_Ttm_single_mode( FLA_Obj alpha, FLA_Obj A,
 
 	//Multiply if can't repartition anymore
     if(do_repart == FALSE)
-        return FLA_Tensor_mvmult_nopermC(alpha, A, mode, beta, B, C);
+        FLA_Tensor_mvmult_nopermC_batch(batch, A, mode, B, C);
     else
-        return FLA_Ttm_hierCA_single_repart_mode(alpha, A, mode, beta, B, repart_mode, C);
+        FLA_Ttm_hierCA_single_repart_mode_batch(batch, A, mode, B, repart_mode, C);
+}
+
+//FLA_Ttm_single_mode on views (see TLA_View_from_obj)
+FLA_Error FLA_Ttm_single_mode_view( FLA_Obj alpha, const TLA_View* A,
+                                    dim_t mode,
+                                    FLA_Obj beta, const TLA_View* B,
+                                    const TLA_View* C )
+{
+	FLA_Ttm_batch batch;
+
+	//A scalar A is a single product, no batch needed
+	if((A->base)->elemtype == FLA_SCALAR){
+		FLA_Obj Ao, Bo, Co;
+
+		TLA_View_to_obj(A, &Ao);
+		TLA_View_to_obj(B, &Bo);
+		TLA_View_to_obj(C, &Co);
+		if(FLA_Ttm_record_add(&Ao, mode, &Bo, &Co, TRUE))
+			return FLA_SUCCESS;
+		return FLA_Ttm_scalar_permC(alpha, Ao, mode, beta, Bo, Co);
+	}
+
+	FLA_Ttm_batch_init(alpha, beta, &batch);
+	FLA_Ttm_single_mode_batch(&batch, A, mode, B, C);
+	FLA_Ttm_batch_flush(&batch);
+	FLA_Ttm_batch_free(&batch);
+
+	return FLA_SUCCESS;
+}
+
+//C := alpha C + beta (B x_mode A).  A zero alpha overwrites C without
+//reading it: the first product into each block of C sets it and the products
+//of the other blocks of A along mode are added to it
+FLA_Error FLA_Ttm_single_mode( FLA_Obj alpha, FLA_Obj A,
+                               dim_t mode,
+                               FLA_Obj beta, FLA_Obj B,
+                               FLA_Obj C )
+{
+	TLA_View Av, Bv, Cv;
+
+	//A scalar A is a single product, no batch needed
+	if(FLA_Obj_elemtype(A) == FLA_SCALAR){
+		if(FLA_Ttm_record_add(&A, mode, &B, &C, TRUE))
+			return FLA_SUCCESS;
+		return FLA_Ttm_scalar_permC(alpha, A, mode, beta, B, C);
+	}
+
+	TLA_View_from_obj(&A, &Av);
+	TLA_View_from_obj(&B, &Bv);
+	TLA_View_from_obj(&C, &Cv);
+
+	return FLA_Ttm_single_mode_view(alpha, &Av, mode, beta, &Bv, &Cv);
 }
 
 //Single ttm without permuting C
@@ -33,7 +33,21 @@
 
 
 
-FLA_Error FLA_Ttm_single_mode_blis( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C, dim_t repart_mode );
+FLA_Error FLA_Ttm_single_mode_blis( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+FLA_Error FLA_Ttm_geometry( const FLA_Obj* A, dim_t mode, const FLA_Obj* B, const FLA_Obj* C, FLA_Ttm_geom* geom, char** buf_A, char** buf_B, char** buf_C );
+void      FLA_Ttm_geom_exec_blis( FLA_Ttm_geom* geom, FLA_Obj alpha, FLA_Obj beta, char* buf_A, char* buf_B, char* buf_C );
+
+//Batched leaf products
+void      FLA_Ttm_batch_init( FLA_Obj alpha, FLA_Obj beta, FLA_Ttm_batch* batch );
+FLA_Error FLA_Ttm_batch_add( FLA_Ttm_batch* batch, const FLA_Obj* A, dim_t mode, const FLA_Obj* B, const FLA_Obj* C, FLA_Bool first );
+FLA_Error FLA_Ttm_batch_flush( FLA_Ttm_batch* batch );
+void      FLA_Ttm_batch_free( FLA_Ttm_batch* batch );
+FLA_Error FLA_Ttm_batch_add_leaves( FLA_Ttm_batch* batch, const FLA_Ttm_leaves* leaves, dim_t begin, dim_t end );
+void      FLA_Ttm_leaves_init( FLA_Ttm_leaves* leaves );
+void      FLA_Ttm_leaves_free( FLA_Ttm_leaves* leaves );
+void      FLA_Ttm_record_begin( FLA_Ttm_leaves* leaves );
+void      FLA_Ttm_record_end( void );
+FLA_Bool  FLA_Ttm_record_add( const FLA_Obj* A, dim_t mode, const FLA_Obj* B, const FLA_Obj* C, FLA_Bool first );
 FLA_Error FLA_Ttm_single_mode_no_permC( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
 FLA_Error FLA_Ttm_single_mode_permC( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
 
@@ -41,7 +55,10 @@ FLA_Error FLA_Ttm_single_mode_permC( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_O
 // Needed routines
 //**************************
 FLA_Error FLA_Ttm_single_mode( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+FLA_Error FLA_Ttm_single_mode_view( FLA_Obj alpha, const TLA_View* A, dim_t mode, FLA_Obj beta, const TLA_View* B, const TLA_View* C );
 FLA_Error FLA_Ttm_scalar_permC( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
 FLA_Error FLA_Ttm_scalar_no_permC( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
+FLA_Error FLA_Tensor_innerprod( FLA_Obj alpha, FLA_Obj A, dim_t mode, FLA_Obj beta, FLA_Obj B, FLA_Obj C );
 
-//FLA_Error FLA_Ttm( FLA_Obj alpha, FLA_Obj A, dim_t nModes, const dim_t mode[], FLA_Obj beta, const FLA_Obj B[], FLA_Obj C );
+FLA_Error FLA_Ttm( FLA_Obj alpha, FLA_Obj A, dim_t nModes, const dim_t mode[], FLA_Obj beta, const FLA_Obj B[], FLA_Obj C );
+FLA_Error FLA_Ttm_ext( FLA_Obj alpha, FLA_Obj A, dim_t nModes, const dim_t mode[], FLA_Obj beta, const FLA_Obj B[], FLA_Obj C, dim_t order_out[], dim_t* flops );
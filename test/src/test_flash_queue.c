@@ -0,0 +1,120 @@
+#include "FLAME.h"
+#include "stdio.h"
+#include "math.h"
+
+//Compares FLASH_Gemm run through the SuperMatrix queue, under every data
+//affinity, against FLA_Gemm on the flat matrices.  The queue only uses threads in a multithreaded build; it
+//runs its tasks in order otherwise.  Without SuperMatrix there is nothing to
+//test and the test exits with 77, which 'make check' reports as SKIPPED: run
+//it from a library configured with
+//  ./configure --enable-supermatrix --enable-multithreading=pthreads
+
+#ifdef FLA_ENABLE_SUPERMATRIX
+
+//Number of entries of the hierarchical X further than tol (relative) from
+//the flat ref
+dim_t countErrors(FLA_Obj X, FLA_Obj ref, double tol){
+	dim_t m = FLA_Obj_length(ref);
+	dim_t n = FLA_Obj_width(ref);
+	dim_t i, j;
+	FLA_Obj x;
+	double* buf_x;
+	double* buf_ref = (double*)FLA_Obj_buffer_at_view(ref);
+	dim_t nErrors = 0;
+
+	FLA_Obj_create(FLA_DOUBLE, m, n, 0, 0, &x);
+	FLASH_Obj_flatten(X, x);
+	buf_x = (double*)FLA_Obj_buffer_at_view(x);
+	for(j = 0; j < n; j++)
+		for(i = 0; i < m; i++){
+			double a = buf_x[i + j * FLA_Obj_col_stride(x)];
+			double b = buf_ref[i + j * FLA_Obj_col_stride(ref)];
+
+			if(!(fabs(a - b) <= tol * (1.0 + fabs(b))))
+				nErrors++;
+		}
+	FLA_Obj_free(&x);
+	return nErrors;
+}
+
+dim_t test_flash_gemm(dim_t n, dim_t nb, FLASH_Data_aff affinity, unsigned int nThreads){
+	FLA_Obj A, B, C, Af, Bf, Cf;
+	dim_t nErrors;
+
+	//Blocks are placed when they are created
+	FLASH_Queue_set_num_threads(nThreads);
+	FLASH_Queue_set_data_affinity(affinity);
+
+	FLASH_Obj_create(FLA_DOUBLE, n, n, 1, &nb, &A);
+	FLASH_Obj_create(FLA_DOUBLE, n, n, 1, &nb, &B);
+	FLASH_Obj_create(FLA_DOUBLE, n, n, 1, &nb, &C);
+	FLASH_Random_matrix(A);
+	FLASH_Random_matrix(B);
+	FLASH_Random_matrix(C);
+
+	FLA_Obj_create(FLA_DOUBLE, n, n, 0, 0, &Af);
+	FLA_Obj_create(FLA_DOUBLE, n, n, 0, 0, &Bf);
+	FLA_Obj_create(FLA_DOUBLE, n, n, 0, 0, &Cf);
+	FLASH_Obj_flatten(A, Af);
+	FLASH_Obj_flatten(B, Bf);
+	FLASH_Obj_flatten(C, Cf);
+	FLA_Gemm(FLA_NO_TRANSPOSE, FLA_TRANSPOSE, FLA_MINUS_ONE, Af, Bf, FLA_ONE, Cf);
+
+	FLASH_Queue_enable();
+	FLASH_Gemm(FLA_NO_TRANSPOSE, FLA_TRANSPOSE, FLA_MINUS_ONE, A, B, FLA_ONE, C);
+	FLASH_Queue_disable();
+
+	nErrors = countErrors(C, Cf, 1e-12);
+	//Every task has run
+	if(FLASH_Queue_get_num_tasks() != 0)
+		nErrors++;
+
+	FLASH_Obj_free(&A);
+	FLASH_Obj_free(&B);
+	FLASH_Obj_free(&C);
+	FLA_Obj_free(&Af);
+	FLA_Obj_free(&Bf);
+	FLA_Obj_free(&Cf);
+
+	return nErrors;
+}
+
+int main(int argc, char* argv[]){
+	FLASH_Data_aff affinities[] = {FLASH_QUEUE_AFFINITY_NONE,
+	                               FLASH_QUEUE_AFFINITY_2D_BLOCK_CYCLIC,
+	                               FLASH_QUEUE_AFFINITY_1D_ROW_BLOCK_CYCLIC,
+	                               FLASH_QUEUE_AFFINITY_1D_COLUMN_BLOCK_CYCLIC,
+	                               FLASH_QUEUE_AFFINITY_ROUND_ROBIN};
+	unsigned int threads[] = {1, 4};
+	dim_t a, t;
+	int failures = 0;
+
+	FLA_Init();
+
+	for(a = 0; a < 5; a++)
+		for(t = 0; t < 2; t++){
+			dim_t nErrors = test_flash_gemm(192, 32, affinities[a], threads[t]);
+
+			if(nErrors > 0){
+				printf("FLASH_Gemm, affinity %d, %u threads: %d wrong entries\n",
+				       (int)affinities[a], threads[t], (int)nErrors);
+				failures++;
+			}
+		}
+	FLASH_Queue_set_data_affinity(FLASH_QUEUE_AFFINITY_NONE);
+
+	printf("flash queue: %s\n", failures == 0 ? "PASS" : "FAIL");
+
+	FLA_Finalize();
+
+	return failures == 0 ? 0 : 1;
+}
+
+#else
+
+int main(int argc, char* argv[]){
+	printf("flash queue: libflame was configured without SuperMatrix\n");
+	return 77;
+}
+
+#endif
@@ -0,0 +1,154 @@
+#include "FLAME.h"
+#include "stdio.h"
+#include "string.h"
+
+//Compares FLA_Permute (through FLA_Permute_blocked) against a reference
+//that copies entry by entry, on random shapes and permutations of orders 1
+//to 8 (past the orders the loops are specialized on), in every datatype, for
+//whole tensors and for views with an offset.
+//The entries are random bytes: permuting only moves data, so the result
+//must match bit for bit.
+
+#define N_TRIALS 200
+
+//Address of the entry of the flat T at index (in the modes of T)
+char* entryAddress(FLA_Obj T, const dim_t index[]){
+	dim_t i;
+	dim_t offset = 0;
+
+	for(i = 0; i < T.order; i++)
+		offset += (T.offset[i] + index[i]) * T.base->stride[i];
+	return (char*)T.base->buffer + offset * FLA_Obj_datatype_size(FLA_Obj_datatype(T));
+}
+
+//Advances index over size in column-major order, FALSE past the end
+FLA_Bool nextIndex(dim_t order, const dim_t size[], dim_t index[]){
+	dim_t i;
+
+	for(i = 0; i < order; i++){
+		if(++index[i] < size[i])
+			return TRUE;
+		index[i] = 0;
+	}
+	return FALSE;
+}
+
+void initTensor(FLA_Datatype datatype, dim_t order, const dim_t size[], FLA_Obj* obj){
+	dim_t stride[FLA_MAX_ORDER];
+
+	FLA_Set_tensor_stride(order, size, stride);
+	FLA_Obj_create_tensor(datatype, order, size, stride, obj);
+}
+
+void freeTensor(FLA_Obj* obj){
+	FLA_Obj_free_buffer(obj);
+	FLA_Obj_free_without_buffer(obj);
+}
+
+//Random shape of order order: long modes for low orders, so that the tiles
+//and their fringes are exercised, short ones otherwise
+void randomShape(dim_t order, dim_t size[]){
+	dim_t maxSize = (order <= 2) ? 70 : (order <= 3) ? 16 : (order <= 6) ? 6 : 3;
+	dim_t i;
+
+	for(i = 0; i < order; i++)
+		size[i] = 1 + rand() % maxSize;
+}
+
+void randomPermutation(dim_t order, dim_t perm[]){
+	dim_t i;
+
+	for(i = 0; i < order; i++)
+		perm[i] = i;
+	for(i = order - 1; i > 0; i--){
+		dim_t j = rand() % (i + 1);
+		dim_t t = perm[i];
+
+		perm[i] = perm[j];
+		perm[j] = t;
+	}
+}
+
+//Permutes a random tensor, or the view of it past the first entries along
+//one mode, and counts the entries of the result that differ from the
+//reference B(i_0, ..., i_order-1) = A(j) with j[perm[k]] = i_k
+dim_t test_permute(FLA_Datatype datatype, dim_t order, FLA_Bool view){
+	dim_t i;
+	dim_t size[FLA_MAX_ORDER];
+	dim_t sizeB[FLA_MAX_ORDER];
+	dim_t perm[FLA_MAX_ORDER];
+	dim_t indexA[FLA_MAX_ORDER];
+	dim_t indexB[FLA_MAX_ORDER] = {0};
+	dim_t elemSize = FLA_Obj_datatype_size(datatype);
+	dim_t nBytes;
+	unsigned char* buf;
+	FLA_Obj A, AT, AB, Av, B;
+	dim_t nErrors = 0;
+
+	randomShape(order, size);
+	randomPermutation(order, perm);
+
+	initTensor(datatype, order, size, &A);
+	nBytes = FLA_array_product(order, size) * elemSize;
+	buf = (unsigned char*)A.base->buffer;
+	for(i = 0; i < nBytes; i++)
+		buf[i] = (unsigned char)(rand() & 0xff);
+
+	Av = A;
+	if(view){
+		dim_t mode = rand() % order;
+
+		FLA_Part_1xmode2(A, &AT,
+		                    &AB, mode, size[mode] / 2, FLA_TOP);
+		Av = AB;
+	}
+
+	for(i = 0; i < order; i++)
+		sizeB[i] = Av.size[perm[i]];
+	initTensor(datatype, order, sizeB, &B);
+
+	FLA_Permute(Av, perm, &B);
+
+	if(FLA_array_product(order, sizeB) > 0){
+		do{
+			for(i = 0; i < order; i++)
+				indexA[perm[i]] = indexB[i];
+			if(memcmp(entryAddress(B, indexB), entryAddress(Av, indexA), elemSize) != 0)
+				nErrors++;
+		}while(nextIndex(order, sizeB, indexB));
+	}
+
+	freeTensor(&A);
+	freeTensor(&B);
+
+	return nErrors;
+}
+
+int main(int argc, char* argv[]){
+	FLA_Datatype datatypes[] = {FLA_FLOAT, FLA_DOUBLE, FLA_COMPLEX, FLA_DOUBLE_COMPLEX};
+	const char* names[] = {"float", "double", "complex", "double complex"};
+	dim_t d, t, view;
+	int failures = 0;
+
+	FLA_Init();
+	srand(5);
+
+	for(d = 0; d < 4; d++)
+		for(view = 0; view < 2; view++)
+			for(t = 0; t < N_TRIALS; t++){
+				dim_t order = 1 + t % 8;
+				dim_t nErrors = test_permute(datatypes[d], order, view);
+
+				if(nErrors > 0){
+					printf("permute (%s, view = %d), order %d, trial %d: %d wrong entries\n",
+					       names[d], (int)view, (int)order, (int)t, (int)nErrors);
+					failures++;
+				}
+			}
+
+	printf("permute: %s\n", failures == 0 ? "PASS" : "FAIL");
+
+	FLA_Finalize();
+
+	return failures == 0 ? 0 : 1;
+}
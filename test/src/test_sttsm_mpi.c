@@ -0,0 +1,214 @@
+#include "FLAME.h"
+#include "stdio.h"
+#include "math.h"
+
+//Compares FLA_Sttsm_mpi against the serial FLA_Sttsm_without_psym_temps.
+//Every rank builds the same operands (same seed), computes the serial result
+//and then the distributed one, whose inputs not owned by the rank are
+//overwritten first.  The unique blocks of C a rank owns must match the
+//serial result and the others must be left as they were.  Run it with
+//several process counts, e.g. mpirun -np 4 ./test_sttsm_mpi: more ranks
+//than blocks along a mode exercises the groups that split the second-level
+//iterations.
+//Without MPI the test exits with 77, which 'make check_mpi' reports as
+//SKIPPED: run it from a library configured with --enable-mpi --with-cc=mpicc
+
+#ifdef FLA_ENABLE_MPI
+
+void initSymmTensor(dim_t order, dim_t size[], dim_t b, FLA_Obj* obj){
+    dim_t i;
+    dim_t blocked_stride[FLA_MAX_ORDER];
+	dim_t block_size[FLA_MAX_ORDER];
+	dim_t blocked_size[FLA_MAX_ORDER];
+	TLA_sym sym;
+
+	for(i = 0; i < order; i++){
+		block_size[i] = b;
+	}
+
+	FLA_array_elemwise_quotient(order, size, block_size, blocked_size);
+	FLA_Set_tensor_stride(order, blocked_size, blocked_stride);
+
+    sym.order = order;
+    sym.nSymGroups = 1;
+    sym.symGroupLens[0] = sym.order;
+    for(i = 0; i < sym.order; i++)
+        (sym.symModes)[i] = i;
+  FLA_Obj_create_blocked_psym_tensor(FLA_DOUBLE, order, size, blocked_stride, block_size, sym, obj);
+}
+
+void initMatrix(dim_t size[2], dim_t bC, dim_t bA, FLA_Obj* obj){
+  dim_t order = 2;
+  dim_t sizeObj[2] = {size[0] / bC, size[1] / bA};
+  dim_t strideObj[2] = {1, sizeObj[0]};
+  dim_t sizeBlk[] = {bC, bA};
+
+  FLA_Obj_create_blocked_tensor(FLA_DOUBLE, order, size, strideObj, sizeBlk, obj);
+}
+
+void freeSymmTensor(FLA_Obj* obj){
+  FLA_Obj_blocked_psym_tensor_free_buffer(obj);
+  FLA_Obj_free_without_buffer(obj);
+}
+
+//Entries stored for a block (only the unique ones of packed diagonal blocks)
+dim_t blockEntries(FLA_Base_obj* blk){
+	if(blk->isPacked)
+		return TLA_packed_sym_size(blk->packed_sym, blk->size);
+	return FLA_array_product(blk->order, blk->size);
+}
+
+//Sets the unique blocks of the blocked psym tensor T that rank does not own
+//to value
+void overwriteNotOwned(FLA_Obj T, double value, int rank, int nRanks){
+	TLA_unique_map* map = T.base->blk_unique_map;
+	FLA_Obj* buf_T = (FLA_Obj*)T.base->buffer;
+	dim_t curIndex[FLA_MAX_ORDER] = {0};
+	dim_t u, e;
+
+	for(u = 0; u < map->nUniques; u++){
+		FLA_Base_obj* blk = buf_T[map->uniqueLinIndex[u]].base;
+		double* buf = (double*)blk->buffer;
+		dim_t nElem = blockEntries(blk);
+
+		if(FLA_Sttsm_mpi_owner(T, curIndex, nRanks) != rank)
+			for(e = 0; e < nElem; e++)
+				buf[e] = value;
+		TLA_next_unique_index(T.sym, T.size, curIndex);
+	}
+}
+
+//Number of entries of C that are wrong: owned blocks must match Cref, the
+//others must equal Cprev
+dim_t countErrors(FLA_Obj C, FLA_Obj Cref, FLA_Obj Cprev, int rank, int nRanks){
+	TLA_unique_map* map = C.base->blk_unique_map;
+	FLA_Obj* buf_C = (FLA_Obj*)C.base->buffer;
+	FLA_Obj* buf_Cref = (FLA_Obj*)Cref.base->buffer;
+	FLA_Obj* buf_Cprev = (FLA_Obj*)Cprev.base->buffer;
+	dim_t curIndex[FLA_MAX_ORDER] = {0};
+	dim_t u, e;
+	dim_t nErrors = 0;
+
+	for(u = 0; u < map->nUniques; u++){
+		dim_t l = map->uniqueLinIndex[u];
+		double* c = (double*)buf_C[l].base->buffer;
+		double* cref = (double*)buf_Cref[l].base->buffer;
+		double* cprev = (double*)buf_Cprev[l].base->buffer;
+		dim_t nElem = blockEntries(buf_C[l].base);
+		FLA_Bool owned = (FLA_Sttsm_mpi_owner(C, curIndex, nRanks) == rank);
+
+		for(e = 0; e < nElem; e++){
+			if(owned && fabs(c[e] - cref[e]) > 1e-10 * (1.0 + fabs(cref[e])))
+				nErrors++;
+			if(!owned && c[e] != cprev[e])
+				nErrors++;
+		}
+		TLA_next_unique_index(C.sym, C.size, curIndex);
+	}
+	return nErrors;
+}
+
+dim_t test_sttsm_mpi(dim_t m, dim_t nA, dim_t nC, dim_t bA, dim_t bC, double alphaValue, double betaValue, int rank, int nRanks){
+	dim_t i;
+	dim_t aSize[FLA_MAX_ORDER];
+	dim_t bSize[] = {nC, nA};
+	dim_t cSize[FLA_MAX_ORDER];
+	FLA_Obj alpha, beta;
+	FLA_Obj A, B, C, Cref, Cprev;
+	dim_t nErrors;
+
+	for(i = 0; i < m; i++)
+		aSize[i] = nA;
+	for(i = 0; i < m; i++)
+		cSize[i] = nC;
+
+	FLA_Obj_create(FLA_DOUBLE, 1, 1, 0, 0, &alpha);
+	FLA_Obj_create(FLA_DOUBLE, 1, 1, 0, 0, &beta);
+	*((double*)FLA_Obj_buffer_at_view(alpha)) = alphaValue;
+	*((double*)FLA_Obj_buffer_at_view(beta)) = betaValue;
+
+	//Same operands on every rank
+	srand(7);
+	initSymmTensor(m, aSize, bA, &A);
+	FLA_Random_psym_tensor(A);
+	initMatrix(bSize, bC, bA, &B);
+	FLA_Random_tensor(B);
+	initSymmTensor(m, cSize, bC, &C);
+	FLA_Random_psym_tensor(C);
+	initSymmTensor(m, cSize, bC, &Cref);
+	FLA_Obj_unpack_blocked_psym_tensor(C, Cref);
+	initSymmTensor(m, cSize, bC, &Cprev);
+
+	FLA_Sttsm_without_psym_temps(alpha, A, beta, B, Cref);
+
+	//Only the owned blocks of A and C and B on rank 0 are inputs
+	overwriteNotOwned(A, 1e300, rank, nRanks);
+	overwriteNotOwned(C, 1e300, rank, nRanks);
+	FLA_Obj_unpack_blocked_psym_tensor(C, Cprev);
+	if(rank != 0)
+		FLA_Random_tensor(B);
+
+	FLA_Sttsm_mpi(alpha, A, beta, B, C, MPI_COMM_WORLD);
+
+	nErrors = countErrors(C, Cref, Cprev, rank, nRanks);
+
+	FLA_Obj_blocked_tensor_free_buffer(&B);
+	FLA_Obj_free_without_buffer(&B);
+	freeSymmTensor(&A);
+	freeSymmTensor(&C);
+	freeSymmTensor(&Cref);
+	freeSymmTensor(&Cprev);
+	FLA_Obj_free(&alpha);
+	FLA_Obj_free(&beta);
+
+	return nErrors;
+}
+
+int main(int argc, char* argv[]){
+	dim_t m, s, a;
+	int rank, nRanks;
+	int failures = 0;
+	int totalFailures;
+	//Blocks along each mode of C: 5 splits iterations over ranks, 2 groups
+	//ranks as soon as there are more than 2.  A has 4 blocks along each
+	//mode, spread over the ranks, which sum their parts of the first product
+	dim_t nC[] = {10, 4};
+	double alphas[] = {1.0, 0.0, 0.5};
+	double betas[] = {1.0, -2.0, 3.0};
+
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+	FLA_Init();
+
+	for(m = 1; m <= 4; m++)
+		for(s = 0; s < 2; s++)
+			for(a = 0; a < 3; a++){
+				dim_t nErrors = test_sttsm_mpi(m, 12, nC[s], 3, 2, alphas[a], betas[a], rank, nRanks);
+
+				if(nErrors > 0){
+					printf("rank %d: m = %d, nC = %d, alpha = %g, beta = %g: %d wrong entries\n",
+					       rank, (int)m, (int)nC[s], alphas[a], betas[a], (int)nErrors);
+					failures++;
+				}
+			}
+
+	MPI_Reduce(&failures, &totalFailures, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+	if(rank == 0)
+		printf("sttsm_mpi on %d ranks: %s\n", nRanks, totalFailures == 0 ? "PASS" : "FAIL");
+	MPI_Bcast(&totalFailures, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+	FLA_Finalize();
+	MPI_Finalize();
+
+	return totalFailures == 0 ? 0 : 1;
+}
+
+#else
+
+int main(int argc, char* argv[]){
+	printf("sttsm_mpi: libflame was configured without MPI\n");
+	return 77;
+}
+
+#endif
@@ -0,0 +1,669 @@
+#include "FLAME.h"
+#include "stdio.h"
+#include "math.h"
+#include "string.h"
+
+//Compares every way of running sttsm against a dense reference computed
+//entry by entry, in every datatype: serial with and without psym
+//temporaries, split across threads, with work-stealing psttv, through a
+//plan (executed twice), out of core from files, on blocks placed by data
+//affinity and in single precision with double accumulation.  Also checks
+//FLA_Sttsm_but_one_all, the file format round trip, and that only shared
+//mappings write block updates through to the file.  The threaded variants
+//only use threads in a multithreaded build; they run serially (and must
+//still be right) otherwise.  The reference is computed in double complex whatever the
+//datatype.
+//C := alpha C + beta (A x_0 B ... x_m-1 B), where a zero alpha overwrites C
+//without reading it: C starts out as NaN then.
+
+#define VARIANT_WITHOUT_PSYM_TEMPS  0
+#define VARIANT_WITH_PSYM_TEMPS     1
+#define VARIANT_THREADS             2
+#define VARIANT_THREADS_PSYM_TEMPS  3
+#define VARIANT_PSTTV_WS            4
+#define VARIANT_PLAN                5
+#define VARIANT_PLAN_PSYM_TEMPS     6
+#define VARIANT_OOC                 7
+#define VARIANT_PLACED              8
+#define N_VARIANTS                  9
+
+const char* variantNames[] = {"without psym temps", "with psym temps", "threads", "threads, psym temps",
+                              "psttv work stealing", "plan", "plan, psym temps", "out of core",
+                              "placed blocks"};
+
+#define FILE_A  "test_sttsm_variants_A.tla"
+#define FILE_C  "test_sttsm_variants_C.tla"
+
+//Address of the entry of T at (flat) index, T flat or blocked
+void* entryAddress(FLA_Obj T, const dim_t index[]){
+	dim_t i;
+	dim_t offset = 0;
+
+	if(FLA_Obj_elemtype(T) != FLA_SCALAR){
+		FLA_Obj* buf = (FLA_Obj*)T.base->buffer;
+		dim_t blkIndex[FLA_MAX_ORDER];
+		dim_t linIndex = 0;
+
+		for(i = 0; i < T.order; i++){
+			dim_t b = buf[0].size[i];
+			linIndex += (index[i] / b) * T.base->stride[i];
+			blkIndex[i] = index[i] % b;
+		}
+		return entryAddress(buf[linIndex], blkIndex);
+	}
+	for(i = 0; i < T.order; i++)
+		offset += (T.offset[T.permutation[i]] + index[i]) * T.base->stride[T.permutation[i]];
+	return (char*)T.base->buffer + offset * FLA_Obj_datatype_size(FLA_Obj_datatype(T));
+}
+
+//Entry of T at index, widened to double complex
+dcomplex getEntry(FLA_Obj T, const dim_t index[]){
+	void* p = entryAddress(T, index);
+	dcomplex z = {0.0, 0.0};
+
+	switch(FLA_Obj_datatype(T)){
+	case FLA_FLOAT:
+		z.real = *(float*)p;
+		break;
+	case FLA_DOUBLE:
+		z.real = *(double*)p;
+		break;
+	case FLA_COMPLEX:
+		z.real = ((scomplex*)p)->real;
+		z.imag = ((scomplex*)p)->imag;
+		break;
+	default:
+		z = *(dcomplex*)p;
+	}
+	return z;
+}
+
+dcomplex cmul(dcomplex a, dcomplex b){
+	dcomplex z;
+
+	z.real = a.real * b.real - a.imag * b.imag;
+	z.imag = a.real * b.imag + a.imag * b.real;
+	return z;
+}
+
+//Advances index over size in column-major order, FALSE past the end
+FLA_Bool nextIndex(dim_t order, const dim_t size[], dim_t index[]){
+	dim_t i;
+
+	for(i = 0; i < order; i++){
+		if(++index[i] < size[i])
+			return TRUE;
+		index[i] = 0;
+	}
+	return FALSE;
+}
+
+//Column-major copy of T, flat size size
+dcomplex* toDense(FLA_Obj T, const dim_t size[]){
+	dim_t index[FLA_MAX_ORDER] = {0};
+	dcomplex* dense = (dcomplex*)malloc(FLA_array_product(T.order, size) * sizeof(dcomplex));
+	dim_t e = 0;
+
+	do{
+		dense[e++] = getEntry(T, index);
+	}while(nextIndex(T.order, size, index));
+	return dense;
+}
+
+//out := A x_mode B for dense column-major A of size size and B of size
+//p x size[mode]
+void denseTtm(dim_t order, const dim_t size[], const dcomplex* A, dim_t mode, dim_t p, const dcomplex* B, dcomplex* out){
+	dim_t index[FLA_MAX_ORDER] = {0};
+	dim_t outSize[FLA_MAX_ORDER];
+	dim_t modeStride = FLA_array_product(mode, size);
+	dim_t i, j;
+	dim_t e = 0;
+
+	for(i = 0; i < order; i++)
+		outSize[i] = size[i];
+	outSize[mode] = p;
+
+	do{
+		dim_t offset = 0;
+		dim_t stride = 1;
+		dcomplex sum = {0.0, 0.0};
+
+		for(i = 0; i < order; i++){
+			if(i != mode)
+				offset += index[i] * stride;
+			stride *= size[i];
+		}
+		for(j = 0; j < size[mode]; j++){
+			dcomplex t = cmul(B[index[mode] + j * p], A[offset + j * modeStride]);
+
+			sum.real += t.real;
+			sum.imag += t.imag;
+		}
+		out[e++] = sum;
+	}while(nextIndex(order, outSize, index));
+}
+
+//Dense alpha C + beta (A x_k B for every mode k but ignore), ignore = order
+//for none.  C has the size of the result
+dcomplex* denseSttsm(double alpha, FLA_Obj A, dim_t ignore, double beta, FLA_Obj B, FLA_Obj C){
+	dim_t order = A.order;
+	dim_t sizeA[FLA_MAX_ORDER];
+	dim_t sizeB[] = {FLA_Obj_dimsize(B, 0) * FLA_Obj_dimsize(((FLA_Obj*)B.base->buffer)[0], 0),
+	                 FLA_Obj_dimsize(B, 1) * FLA_Obj_dimsize(((FLA_Obj*)B.base->buffer)[0], 1)};
+	dim_t sizeC[FLA_MAX_ORDER];
+	dcomplex* dB = toDense(B, sizeB);
+	dcomplex* dC;
+	dcomplex* ref;
+	dim_t i, nC;
+
+	for(i = 0; i < order; i++){
+		sizeA[i] = sizeB[1];
+		sizeC[i] = (i == ignore) ? sizeB[1] : sizeB[0];
+	}
+	ref = toDense(A, sizeA);
+	for(i = 0; i < order; i++){
+		dcomplex* next;
+
+		if(i == ignore)
+			continue;
+		sizeA[i] = sizeB[0];
+		next = (dcomplex*)malloc(FLA_array_product(order, sizeA) * sizeof(dcomplex));
+		sizeA[i] = sizeB[1];
+		denseTtm(order, sizeA, ref, i, sizeB[0], dB, next);
+		sizeA[i] = sizeB[0];
+		free(ref);
+		ref = next;
+	}
+
+	nC = FLA_array_product(order, sizeC);
+	dC = toDense(C, sizeC);
+	for(i = 0; i < nC; i++){
+		ref[i].real = (alpha == 0.0 ? 0.0 : alpha * dC[i].real) + beta * ref[i].real;
+		ref[i].imag = (alpha == 0.0 ? 0.0 : alpha * dC[i].imag) + beta * ref[i].imag;
+	}
+
+	free(dB);
+	free(dC);
+	return ref;
+}
+
+//Number of entries of T further than tol (relative) from the dense ref
+dim_t countErrors(FLA_Obj T, const dcomplex* ref, double tol){
+	dim_t sizeT[FLA_MAX_ORDER];
+	FLA_Obj* buf = (FLA_Obj*)T.base->buffer;
+	dim_t i, n;
+	dcomplex* dT;
+	dim_t nErrors = 0;
+
+	for(i = 0; i < T.order; i++)
+		sizeT[i] = T.size[i] * buf[0].size[i];
+	n = FLA_array_product(T.order, sizeT);
+	dT = toDense(T, sizeT);
+	for(i = 0; i < n; i++)
+		if(!(hypot(dT[i].real - ref[i].real, dT[i].imag - ref[i].imag) <=
+		     tol * (1.0 + hypot(ref[i].real, ref[i].imag))))
+			nErrors++;
+	free(dT);
+	return nErrors;
+}
+
+void initSymmTensor(FLA_Datatype datatype, dim_t order, dim_t size[], dim_t b, FLA_Obj* obj){
+    dim_t i;
+    dim_t blocked_stride[FLA_MAX_ORDER];
+	dim_t block_size[FLA_MAX_ORDER];
+	dim_t blocked_size[FLA_MAX_ORDER];
+	TLA_sym sym;
+
+	for(i = 0; i < order; i++){
+		block_size[i] = b;
+	}
+
+	FLA_array_elemwise_quotient(order, size, block_size, blocked_size);
+	FLA_Set_tensor_stride(order, blocked_size, blocked_stride);
+
+    sym.order = order;
+    sym.nSymGroups = 1;
+    sym.symGroupLens[0] = sym.order;
+    for(i = 0; i < sym.order; i++)
+        (sym.symModes)[i] = i;
+  FLA_Obj_create_blocked_psym_tensor(datatype, order, size, blocked_stride, block_size, sym, obj);
+  FLA_Random_psym_tensor(*obj);
+}
+
+void initMatrix(FLA_Datatype datatype, dim_t size[2], dim_t bC, dim_t bA, FLA_Obj* obj){
+  dim_t order = 2;
+  dim_t sizeObj[2] = {size[0] / bC, size[1] / bA};
+  dim_t strideObj[2] = {1, sizeObj[0]};
+  dim_t sizeBlk[] = {bC, bA};
+
+  FLA_Obj_create_blocked_tensor(datatype, order, size, strideObj, sizeBlk, obj);
+  FLA_Random_tensor(*obj);
+}
+
+//Scalar of datatype with real part value
+void initScalar(FLA_Datatype datatype, double value, FLA_Obj* obj){
+	void* p;
+
+	FLA_Obj_create(datatype, 1, 1, 0, 0, obj);
+	p = FLA_Obj_buffer_at_view(*obj);
+	switch(datatype){
+	case FLA_FLOAT:
+		*(float*)p = (float)value;
+		break;
+	case FLA_DOUBLE:
+		*(double*)p = value;
+		break;
+	case FLA_COMPLEX:
+		((scomplex*)p)->real = (float)value;
+		((scomplex*)p)->imag = 0.0f;
+		break;
+	default:
+		((dcomplex*)p)->real = value;
+		((dcomplex*)p)->imag = 0.0;
+	}
+}
+
+void freeSymmTensor(FLA_Obj* obj){
+  FLA_Obj_blocked_psym_tensor_free_buffer(obj);
+  FLA_Obj_free_without_buffer(obj);
+}
+
+void freeMatrix(FLA_Obj* obj){
+  FLA_Obj_blocked_tensor_free_buffer(obj);
+  FLA_Obj_free_without_buffer(obj);
+}
+
+//Copies the unique blocks of the psym tensor S into those of T
+void copyUniqueBlocks(FLA_Obj S, FLA_Obj T){
+	TLA_unique_map* map = FLA_Obj_unique_map(S);
+	FLA_Obj* buf_S = (FLA_Obj*)S.base->buffer;
+	FLA_Obj* buf_T = (FLA_Obj*)T.base->buffer;
+	dim_t u;
+
+	for(u = 0; u < map->nUniques; u++){
+		FLA_Base_obj* blk = buf_S[map->uniqueLinIndex[u]].base;
+
+		memcpy(buf_T[map->uniqueLinIndex[u]].base->buffer, blk->buffer,
+		       FLA_array_product(blk->order, blk->size) * FLA_Obj_datatype_size(blk->datatype));
+	}
+}
+
+//Sets every entry of the unique blocks of the psym tensor T to value
+void setUniqueBlocks(FLA_Obj T, double value){
+	TLA_unique_map* map = FLA_Obj_unique_map(T);
+	FLA_Obj* buf = (FLA_Obj*)T.base->buffer;
+	dim_t u, i;
+
+	for(u = 0; u < map->nUniques; u++){
+		FLA_Base_obj* blk = buf[map->uniqueLinIndex[u]].base;
+		dim_t n = FLA_array_product(blk->order, blk->size);
+
+		//Complex entries are pairs of reals
+		if(blk->datatype == FLA_COMPLEX || blk->datatype == FLA_DOUBLE_COMPLEX)
+			n *= 2;
+		for(i = 0; i < n; i++){
+			if(blk->datatype == FLA_FLOAT || blk->datatype == FLA_COMPLEX)
+				((float*)blk->buffer)[i] = (float)value;
+			else
+				((double*)blk->buffer)[i] = value;
+		}
+	}
+}
+
+dim_t test_sttsm_variant(dim_t variant, FLA_Datatype datatype, dim_t m, dim_t nA, dim_t nC, dim_t bA, dim_t bC, double alphaValue, double betaValue){
+	dim_t i;
+	dim_t aSize[FLA_MAX_ORDER];
+	dim_t bSize[] = {nC, nA};
+	dim_t cSize[FLA_MAX_ORDER];
+	double tol = (datatype == FLA_FLOAT || datatype == FLA_COMPLEX) ? 1e-4 : 1e-10;
+	FLA_Obj alpha, beta;
+	FLA_Obj A, B, C, C0;
+	TLA_Sttsm_plan plan;
+	dcomplex* ref;
+	dim_t nErrors = 0;
+
+	for(i = 0; i < m; i++){
+		aSize[i] = nA;
+		cSize[i] = nC;
+	}
+
+	//Blocks are placed (and first touched) across the FLASH queue threads
+	//when they are created; sttsm then runs on those threads
+	if(variant == VARIANT_PLACED){
+		FLASH_Queue_set_data_affinity(FLASH_QUEUE_AFFINITY_2D_BLOCK_CYCLIC);
+		FLASH_Queue_set_num_threads(4);
+	}
+	initScalar(datatype, alphaValue, &alpha);
+	initScalar(datatype, betaValue, &beta);
+	initSymmTensor(datatype, m, aSize, bA, &A);
+	initMatrix(datatype, bSize, bC, bA, &B);
+	initSymmTensor(datatype, m, cSize, bC, &C);
+	initSymmTensor(datatype, m, cSize, bC, &C0);
+	if(alphaValue == 0.0)
+		setUniqueBlocks(C, NAN);
+	copyUniqueBlocks(C, C0);
+
+	ref = denseSttsm(alphaValue, A, m, betaValue, B, C);
+
+	switch(variant){
+	case VARIANT_WITHOUT_PSYM_TEMPS:
+		FLA_Sttsm_without_psym_temps(alpha, A, beta, B, C);
+		break;
+	case VARIANT_WITH_PSYM_TEMPS:
+		FLA_Sttsm_with_psym_temps(alpha, A, beta, B, C);
+		break;
+	case VARIANT_THREADS:
+		FLA_Sttsm_set_num_threads(4);
+		FLA_Sttsm_without_psym_temps(alpha, A, beta, B, C);
+		FLA_Sttsm_set_num_threads(1);
+		break;
+	case VARIANT_THREADS_PSYM_TEMPS:
+		FLA_Sttsm_set_num_threads(4);
+		FLA_Sttsm_with_psym_temps(alpha, A, beta, B, C);
+		FLA_Sttsm_set_num_threads(1);
+		break;
+	case VARIANT_PSTTV_WS:
+		FLA_Psttv_set_num_threads(4);
+		FLA_Psttv_set_cutoff(1);
+		FLA_Sttsm_with_psym_temps(alpha, A, beta, B, C);
+		FLA_Psttv_set_num_threads(1);
+		break;
+	case VARIANT_PLAN:
+	case VARIANT_PLAN_PSYM_TEMPS:
+		TLA_Sttsm_plan_create(A, B, C, variant == VARIANT_PLAN ? TLA_STTSM_PLAN_DEFAULT : TLA_STTSM_PLAN_PSYM_TEMPS, &plan);
+		TLA_Sttsm_plan_execute(&plan, alpha, beta);
+		nErrors += countErrors(C, ref, tol);
+		//Again from the same C: executing must not change the plan
+		copyUniqueBlocks(C0, C);
+		TLA_Sttsm_plan_execute(&plan, alpha, beta);
+		TLA_Sttsm_plan_destroy(&plan);
+		break;
+	case VARIANT_OOC:
+		TLA_Obj_write_blocked_psym_tensor(FILE_A, A);
+		TLA_Obj_write_blocked_psym_tensor(FILE_C, C);
+		freeSymmTensor(&C);
+		//A budget of a few blocks, so that blocks are dropped and reloaded
+		if(TLA_Sttsm_ooc(alpha, FILE_A, beta, B, FILE_C, TLA_STTSM_PLAN_DEFAULT, 4 * 4096) != FLA_SUCCESS)
+			nErrors++;
+		TLA_Obj_read_blocked_psym_tensor(FILE_C, TLA_FILE_MAP_PRIVATE, &C);
+		break;
+	case VARIANT_PLACED:
+		FLA_Sttsm_with_psym_temps(alpha, A, beta, B, C);
+		FLASH_Queue_set_data_affinity(FLASH_QUEUE_AFFINITY_NONE);
+		FLASH_Queue_set_num_threads(1);
+		break;
+	}
+
+	nErrors += countErrors(C, ref, tol);
+
+	if(variant == VARIANT_OOC){
+		remove(FILE_A);
+		remove(FILE_C);
+	}
+
+	free(ref);
+	freeSymmTensor(&A);
+	freeMatrix(&B);
+	freeSymmTensor(&C);
+	freeSymmTensor(&C0);
+	FLA_Obj_free(&alpha);
+	FLA_Obj_free(&beta);
+
+	return nErrors;
+}
+
+//Single-precision operands with double accumulation (FLA_Sttsm_*_ext):
+//datatype is FLA_FLOAT or FLA_COMPLEX, the scalars are in the accumulation
+//datatype
+dim_t test_sttsm_mixed(FLA_Bool psym, FLA_Datatype datatype, dim_t m, dim_t nA, dim_t nC, dim_t bA, dim_t bC, double alphaValue, double betaValue){
+	dim_t i;
+	dim_t aSize[FLA_MAX_ORDER];
+	dim_t bSize[] = {nC, nA};
+	dim_t cSize[FLA_MAX_ORDER];
+	FLA_Datatype accumulation = (datatype == FLA_FLOAT) ? FLA_DOUBLE : FLA_DOUBLE_COMPLEX;
+	FLA_Obj alpha, beta;
+	FLA_Obj A, B, C;
+	dcomplex* ref;
+	dim_t nErrors;
+
+	for(i = 0; i < m; i++){
+		aSize[i] = nA;
+		cSize[i] = nC;
+	}
+
+	initScalar(accumulation, alphaValue, &alpha);
+	initScalar(accumulation, betaValue, &beta);
+	initSymmTensor(datatype, m, aSize, bA, &A);
+	initMatrix(datatype, bSize, bC, bA, &B);
+	initSymmTensor(datatype, m, cSize, bC, &C);
+	if(alphaValue == 0.0)
+		setUniqueBlocks(C, NAN);
+
+	ref = denseSttsm(alphaValue, A, m, betaValue, B, C);
+
+	if(psym)
+		FLA_Sttsm_with_psym_temps_ext(accumulation, alpha, A, beta, B, C);
+	else
+		FLA_Sttsm_without_psym_temps_ext(accumulation, alpha, A, beta, B, C);
+
+	//Only the roundings of C to single precision, once per block product
+	//accumulated into it
+	nErrors = countErrors(C, ref, 5e-6);
+
+	free(ref);
+	freeSymmTensor(&A);
+	freeMatrix(&B);
+	freeSymmTensor(&C);
+	FLA_Obj_free(&alpha);
+	FLA_Obj_free(&beta);
+
+	return nErrors;
+}
+
+//FLA_Sttsm_but_one_all against the dense product along all modes but each
+dim_t test_sttsm_but_one_all(FLA_Datatype datatype, dim_t m, dim_t nA, dim_t nC, dim_t bA, dim_t bC, double alphaValue, double betaValue){
+	dim_t i, k;
+	dim_t aSize[FLA_MAX_ORDER];
+	dim_t bSize[] = {nC, nA};
+	double tol = (datatype == FLA_FLOAT || datatype == FLA_COMPLEX) ? 1e-4 : 1e-10;
+	FLA_Obj alpha, beta;
+	FLA_Obj A, B, C[FLA_MAX_ORDER];
+	dcomplex* ref[FLA_MAX_ORDER];
+	dim_t nErrors = 0;
+
+	for(i = 0; i < m; i++)
+		aSize[i] = nA;
+
+	initScalar(datatype, alphaValue, &alpha);
+	initScalar(datatype, betaValue, &beta);
+	initSymmTensor(datatype, m, aSize, bA, &A);
+	initMatrix(datatype, bSize, bC, bA, &B);
+
+	//C[k] is symmetric in the modes but k
+	for(k = 0; k < m; k++){
+		dim_t cSize[FLA_MAX_ORDER];
+		dim_t blkSize[FLA_MAX_ORDER];
+		dim_t blockedSize[FLA_MAX_ORDER];
+		dim_t blockedStride[FLA_MAX_ORDER];
+		dim_t s = 1;
+		TLA_sym sym;
+
+		for(i = 0; i < m; i++){
+			cSize[i] = (i == k) ? nA : nC;
+			blkSize[i] = (i == k) ? bA : bC;
+		}
+		sym.order = m;
+		sym.nSymGroups = 2;
+		sym.symGroupLens[0] = 1;
+		sym.symGroupLens[1] = m - 1;
+		for(i = 0; i < m; i++){
+			if(i == k)
+				sym.symModes[0] = i;
+			else
+				sym.symModes[s++] = i;
+		}
+		FLA_array_elemwise_quotient(m, cSize, blkSize, blockedSize);
+		FLA_Set_tensor_stride(m, blockedSize, blockedStride);
+		FLA_Obj_create_blocked_psym_tensor(datatype, m, cSize, blockedStride, blkSize, sym, &C[k]);
+		FLA_Random_psym_tensor(C[k]);
+		if(alphaValue == 0.0)
+			setUniqueBlocks(C[k], NAN);
+		ref[k] = denseSttsm(alphaValue, A, k, betaValue, B, C[k]);
+	}
+
+	FLA_Sttsm_but_one_all(alpha, A, beta, B, C);
+
+	for(k = 0; k < m; k++){
+		nErrors += countErrors(C[k], ref[k], tol);
+		free(ref[k]);
+		freeSymmTensor(&C[k]);
+	}
+	freeSymmTensor(&A);
+	freeMatrix(&B);
+	FLA_Obj_free(&alpha);
+	FLA_Obj_free(&beta);
+
+	return nErrors;
+}
+
+//Doubles every entry of the block blk
+void doubleBlock(FLA_Obj blk){
+	FLA_Datatype datatype = FLA_Obj_datatype(blk);
+	dim_t n = FLA_array_product(blk.base->order, blk.base->size);
+	dim_t e;
+
+	if(datatype == FLA_COMPLEX || datatype == FLA_DOUBLE_COMPLEX)
+		n *= 2;
+	for(e = 0; e < n; e++)
+		if(datatype == FLA_FLOAT || datatype == FLA_COMPLEX)
+			((float*)blk.base->buffer)[e] *= 2.0f;
+		else
+			((double*)blk.base->buffer)[e] *= 2.0;
+}
+
+//Writes a psym tensor and reads it back through both kinds of mapping.
+//Then scales the first unique block of each mapping and reads the file
+//again: the update must be there after the shared mapping only
+dim_t test_file_round_trip(FLA_Datatype datatype, dim_t m, dim_t n, dim_t b){
+	dim_t i, f;
+	dim_t size[FLA_MAX_ORDER];
+	dim_t flags[] = {TLA_FILE_MAP_PRIVATE, TLA_FILE_MAP_SHARED};
+	FLA_Obj A, Ar, Aw;
+	dcomplex* ref;
+	dim_t nErrors = 0;
+
+	for(i = 0; i < m; i++)
+		size[i] = n;
+	initSymmTensor(datatype, m, size, b, &A);
+	ref = toDense(A, size);
+
+	if(TLA_Obj_write_blocked_psym_tensor(FILE_A, A) != FLA_SUCCESS)
+		nErrors++;
+	for(f = 0; f < 2; f++){
+		FLA_Obj* buf;
+		dim_t l;
+
+		if(TLA_Obj_read_blocked_psym_tensor(FILE_A, flags[f], &Ar) != FLA_SUCCESS){
+			nErrors++;
+			continue;
+		}
+		nErrors += countErrors(Ar, ref, 0.0);
+
+		buf = (FLA_Obj*)Ar.base->buffer;
+		l = FLA_Obj_unique_map(Ar)->uniqueLinIndex[0];
+		doubleBlock(buf[l]);
+		freeSymmTensor(&Ar);
+
+		if(TLA_Obj_read_blocked_psym_tensor(FILE_A, TLA_FILE_MAP_PRIVATE, &Aw) != FLA_SUCCESS){
+			nErrors++;
+			continue;
+		}
+		if(flags[f] == TLA_FILE_MAP_SHARED){
+			buf = (FLA_Obj*)A.base->buffer;
+			doubleBlock(buf[l]);
+			free(ref);
+			ref = toDense(A, size);
+		}
+		nErrors += countErrors(Aw, ref, 0.0);
+		freeSymmTensor(&Aw);
+	}
+	remove(FILE_A);
+
+	free(ref);
+	freeSymmTensor(&A);
+
+	return nErrors;
+}
+
+int main(int argc, char* argv[]){
+	FLA_Datatype datatypes[] = {FLA_FLOAT, FLA_DOUBLE, FLA_COMPLEX, FLA_DOUBLE_COMPLEX};
+	const char* names[] = {"float", "double", "complex", "double complex"};
+	dim_t m, s, v, d, a;
+	int failures = 0;
+	double alphas[] = {1.0, 0.0, 0.5};
+	double betas[] = {1.0, -2.0, 3.0};
+	//Several blocks along each mode of A and C, and a single one
+	dim_t nA[] = {6, 3};
+	dim_t nC[] = {4, 2};
+
+	FLA_Init();
+	srand(13);
+
+	for(d = 0; d < 4; d++)
+		for(m = 2; m <= 4; m++)
+			for(s = 0; s < 2; s++)
+				for(v = 0; v < N_VARIANTS; v++)
+					for(a = 0; a < 3; a++){
+						dim_t nErrors = test_sttsm_variant(v, datatypes[d], m, nA[s], nC[s], 3, 2, alphas[a], betas[a]);
+
+						if(nErrors > 0){
+							printf("sttsm (%s, %s), m = %d, nA = %d, nC = %d, alpha = %g, beta = %g: %d wrong entries\n",
+							       variantNames[v], names[d], (int)m, (int)nA[s], (int)nC[s], alphas[a], betas[a], (int)nErrors);
+							failures++;
+						}
+					}
+
+	//Single and single complex operands
+	for(d = 0; d < 4; d += 2)
+		for(m = 2; m <= 4; m++)
+			for(s = 0; s < 2; s++)
+				for(v = 0; v < 2; v++)
+					for(a = 0; a < 3; a++){
+						dim_t nErrors = test_sttsm_mixed(v, datatypes[d], m, nA[s], nC[s], 3, 2, alphas[a], betas[a]);
+
+						if(nErrors > 0){
+							printf("sttsm (%s, double accumulation, psym temps = %d), m = %d, nA = %d, nC = %d, alpha = %g, beta = %g: %d wrong entries\n",
+							       names[d], (int)v, (int)m, (int)nA[s], (int)nC[s], alphas[a], betas[a], (int)nErrors);
+							failures++;
+						}
+					}
+
+	for(d = 0; d < 4; d++)
+		for(m = 2; m <= 4; m++)
+			for(s = 0; s < 2; s++)
+				for(a = 0; a < 3; a++){
+					dim_t nErrors = test_sttsm_but_one_all(datatypes[d], m, nA[s], nC[s], 3, 2, alphas[a], betas[a]);
+
+					if(nErrors > 0){
+						printf("sttsm_but_one_all (%s), m = %d, nA = %d, nC = %d, alpha = %g, beta = %g: %d wrong entries\n",
+						       names[d], (int)m, (int)nA[s], (int)nC[s], alphas[a], betas[a], (int)nErrors);
+						failures++;
+					}
+				}
+
+	for(d = 0; d < 4; d++)
+		for(m = 2; m <= 4; m++){
+			dim_t nErrors = test_file_round_trip(datatypes[d], m, 6, 2);
+
+			if(nErrors > 0){
+				printf("file round trip (%s), m = %d: %d wrong entries\n", names[d], (int)m, (int)nErrors);
+				failures++;
+			}
+		}
+
+	printf("sttsm variants: %s\n", failures == 0 ? "PASS" : "FAIL");
+
+	FLA_Finalize();
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,523 @@
+#include "FLAME.h"
+#include "stdio.h"
+#include "string.h"
+#include "math.h"
+
+//Checks the storage of blocked and blocked psym tensors in every datatype
+//and with several block alignments: the stored blocks are carved from a
+//single zeroed slab, start on the requested boundary and do not overlap, and
+//every block of a psym tensor shares the storage of the block at its sorted
+//index.  Also checks the block -> unique block map of psym tensors of
+//several symmetries against the blocks and TLA_next_unique_index, and that
+//packing keeps the unique entries of diagonal blocks, unpacks back to the
+//same tensor and gives the same ttm.  Random psym blocks are symmetric only
+//up to rounding, so packed entries are compared with a tolerance.  Finally
+//checks the allocation-free view queries on nested views of flat and
+//blocked tensors.
+
+//Advances index over size in column-major order, FALSE past the end
+FLA_Bool nextIndex(dim_t order, const dim_t size[], dim_t index[]){
+	dim_t i;
+
+	for(i = 0; i < order; i++){
+		if(++index[i] < size[i])
+			return TRUE;
+		index[i] = 0;
+	}
+	return FALSE;
+}
+
+dim_t linearIndex(FLA_Obj T, const dim_t index[]){
+	dim_t i;
+	dim_t linIndex = 0;
+
+	for(i = 0; i < T.order; i++)
+		linIndex += index[i] * T.base->stride[i];
+	return linIndex;
+}
+
+//Symmetry of an order-m tensor: kind 0 is fully symmetric, 1 has mode 0 on
+//its own and the others symmetric, 2 has no symmetry and 3 makes the even
+//modes and the odd modes symmetric
+void initSym(dim_t m, dim_t kind, TLA_sym* sym){
+	dim_t i;
+	dim_t s = 0;
+
+	sym->order = m;
+	for(i = 0; i < m; i++)
+		sym->symModes[i] = i;
+	if(kind == 0){
+		sym->nSymGroups = 1;
+		sym->symGroupLens[0] = m;
+	}else if(kind == 1){
+		sym->nSymGroups = 2;
+		sym->symGroupLens[0] = 1;
+		sym->symGroupLens[1] = m - 1;
+	}else if(kind == 2){
+		sym->nSymGroups = m;
+		for(i = 0; i < m; i++)
+			sym->symGroupLens[i] = 1;
+	}else{
+		sym->nSymGroups = 2;
+		sym->symGroupLens[0] = (m + 1) / 2;
+		sym->symGroupLens[1] = m / 2;
+		for(i = 0; i < m; i += 2)
+			sym->symModes[s++] = i;
+		for(i = 1; i < m; i += 2)
+			sym->symModes[s++] = i;
+	}
+}
+
+//Blocked psym tensor of order m, n x ... x n in b x ... x b blocks
+void initSymmTensor(FLA_Datatype datatype, dim_t m, dim_t n, dim_t b, TLA_sym sym, dim_t align, FLA_Obj* obj){
+	dim_t i;
+	dim_t size[FLA_MAX_ORDER];
+	dim_t blkSize[FLA_MAX_ORDER];
+	dim_t blockedSize[FLA_MAX_ORDER];
+	dim_t blockedStride[FLA_MAX_ORDER];
+
+	for(i = 0; i < m; i++){
+		size[i] = n;
+		blkSize[i] = b;
+	}
+	FLA_array_elemwise_quotient(m, size, blkSize, blockedSize);
+	FLA_Set_tensor_stride(m, blockedSize, blockedStride);
+	FLA_Obj_create_blocked_psym_tensor_aligned(datatype, m, size, blockedStride, blkSize, sym, align, obj);
+}
+
+//Number of the stored blocks that are not zero, not aligned to align, not
+//in the slab of T or that overlap another one.  Each stored block is filled
+//with its own byte first; blocks that overlap overwrite each other
+dim_t checkStoredBlocks(FLA_Obj T, dim_t nStored, FLA_Base_obj* stored[], dim_t align){
+	dim_t nBytes = FLA_array_product(T.order, stored[0]->size) * FLA_Obj_datatype_size(FLA_Obj_datatype(T));
+	dim_t padded = (align > 0) ? ((nBytes + align - 1) / align) * align : nBytes;
+	char* slab = (char*)T.base->blk_slab;
+	dim_t u, e;
+	dim_t nErrors = 0;
+
+	for(u = 0; u < nStored; u++){
+		char* buf = (char*)stored[u]->buffer;
+
+		if(buf < slab || buf + nBytes > slab + nStored * padded)
+			nErrors++;
+		if(align > 0 && ((size_t)buf) % align != 0)
+			nErrors++;
+		for(e = 0; e < nBytes; e++)
+			if(buf[e] != 0)
+				nErrors++;
+	}
+	for(u = 0; u < nStored; u++)
+		memset(stored[u]->buffer, (int)(u % 255) + 1, nBytes);
+	for(u = 0; u < nStored; u++){
+		char* buf = (char*)stored[u]->buffer;
+
+		for(e = 0; e < nBytes; e++)
+			if(buf[e] != (char)((u % 255) + 1))
+				nErrors++;
+	}
+	return nErrors;
+}
+
+dim_t test_blocked_tensor(FLA_Datatype datatype, dim_t align){
+	dim_t order = 3;
+	dim_t size[] = {6, 4, 6};
+	dim_t blkSize[] = {3, 2, 2};
+	dim_t blockedSize[FLA_MAX_ORDER];
+	dim_t blockedStride[FLA_MAX_ORDER];
+	FLA_Base_obj* stored[64];
+	FLA_Obj* buf;
+	dim_t nBlocks, i;
+	dim_t nErrors = 0;
+	FLA_Obj T;
+
+	FLA_array_elemwise_quotient(order, size, blkSize, blockedSize);
+	FLA_Set_tensor_stride(order, blockedSize, blockedStride);
+	FLA_Obj_create_blocked_tensor_aligned(datatype, order, size, blockedStride, blkSize, align, &T);
+
+	nBlocks = FLA_array_product(order, blockedSize);
+	buf = (FLA_Obj*)T.base->buffer;
+	for(i = 0; i < nBlocks; i++)
+		stored[i] = buf[i].base;
+	if(T.base->blk_slab == NULL)
+		nErrors++;
+	else
+		nErrors += checkStoredBlocks(T, nBlocks, stored, align);
+
+	FLA_Obj_blocked_tensor_free_buffer(&T);
+	FLA_Obj_free_without_buffer(&T);
+
+	return nErrors;
+}
+
+//Order-m fully symmetric tensor, n / b blocks along each mode
+dim_t test_psym_tensor(FLA_Datatype datatype, dim_t m, dim_t n, dim_t b, dim_t align){
+	dim_t i;
+	dim_t blockedSize[FLA_MAX_ORDER];
+	dim_t index[FLA_MAX_ORDER] = {0};
+	FLA_Base_obj* stored[64];
+	dim_t nStored = 0;
+	FLA_Obj* buf;
+	dim_t nErrors = 0;
+	TLA_sym sym;
+	FLA_Obj T;
+
+	initSym(m, 0, &sym);
+	initSymmTensor(datatype, m, n, b, sym, align, &T);
+	buf = (FLA_Obj*)T.base->buffer;
+	for(i = 0; i < m; i++)
+		blockedSize[i] = n / b;
+
+	//Blocks at sorted indices are stored, the others share their storage
+	do{
+		dim_t sorted[FLA_MAX_ORDER];
+		FLA_Bool isSorted = TRUE;
+
+		memcpy(sorted, index, m * sizeof(dim_t));
+		for(i = 1; i < m; i++)
+			if(index[i] < index[i-1])
+				isSorted = FALSE;
+		if(isSorted){
+			stored[nStored++] = buf[linearIndex(T, index)].base;
+		}else{
+			dim_t j;
+
+			for(i = 1; i < m; i++)
+				for(j = i; j > 0 && sorted[j] < sorted[j-1]; j--){
+					dim_t t = sorted[j];
+
+					sorted[j] = sorted[j-1];
+					sorted[j-1] = t;
+				}
+			if(buf[linearIndex(T, index)].base != buf[linearIndex(T, sorted)].base)
+				nErrors++;
+		}
+	}while(nextIndex(m, blockedSize, index));
+
+	if(T.base->blk_slab == NULL)
+		nErrors++;
+	else
+		nErrors += checkStoredBlocks(T, nStored, stored, align);
+
+	FLA_Obj_blocked_psym_tensor_free_buffer(&T);
+	FLA_Obj_free_without_buffer(&T);
+
+	return nErrors;
+}
+
+//Order-m psym tensor of symmetry kind, n / b blocks along each mode.  Unique
+//blocks are numbered in the order of TLA_next_unique_index.  Mode k of every
+//block is mode perm[k] of its unique block, in the same sym group, and the
+//block shares its storage
+dim_t test_unique_map(dim_t m, dim_t n, dim_t b, dim_t kind){
+	dim_t i, l, u;
+	dim_t blockedSize[FLA_MAX_ORDER];
+	dim_t index[FLA_MAX_ORDER] = {0};
+	dim_t nBlocks;
+	dim_t nOrbit = 0;
+	TLA_unique_map* map;
+	FLA_Obj* buf;
+	dim_t nErrors = 0;
+	TLA_sym sym;
+	FLA_Obj T;
+
+	initSym(m, kind, &sym);
+	initSymmTensor(FLA_DOUBLE, m, n, b, sym, TLA_ALIGN_NONE, &T);
+	buf = (FLA_Obj*)T.base->buffer;
+	map = FLA_Obj_unique_map(T);
+	for(i = 0; i < m; i++)
+		blockedSize[i] = n / b;
+	nBlocks = FLA_array_product(m, blockedSize);
+
+	if(map == NULL || map->nBlocks != nBlocks){
+		FLA_Obj_blocked_psym_tensor_free_buffer(&T);
+		FLA_Obj_free_without_buffer(&T);
+		return 1;
+	}
+
+	u = 0;
+	do{
+		if(u >= map->nUniques || map->uniqueLinIndex[u] != linearIndex(T, index))
+			nErrors++;
+		u++;
+	}while(TLA_next_unique_index(sym, blockedSize, index));
+	if(u != map->nUniques)
+		nErrors++;
+
+	for(l = 0; l < nBlocks; l++){
+		dim_t rep = map->repOf[l];
+		dim_t uniqueIndex[FLA_MAX_ORDER];
+
+		if(rep >= map->nUniques){
+			nErrors++;
+			continue;
+		}
+		for(i = 0; i < m; i++){
+			index[i] = (l / T.base->stride[i]) % blockedSize[i];
+			uniqueIndex[i] = (map->uniqueLinIndex[rep] / T.base->stride[i]) % blockedSize[i];
+		}
+		for(i = 0; i < m; i++){
+			dim_t p = map->perm[l * m + i];
+
+			if(p >= m || TLA_sym_group_of_mode(sym, p) != TLA_sym_group_of_mode(sym, i) ||
+			   index[i] != uniqueIndex[p])
+				nErrors++;
+		}
+		if(buf[l].base != buf[map->uniqueLinIndex[rep]].base)
+			nErrors++;
+	}
+
+	for(u = 0; u < map->nUniques; u++)
+		nOrbit += map->orbitSize[u];
+	if(nOrbit != nBlocks)
+		nErrors++;
+
+	FLA_Obj_blocked_psym_tensor_free_buffer(&T);
+	FLA_Obj_free_without_buffer(&T);
+
+	return nErrors;
+}
+
+void initBlockedTensor(dim_t order, const dim_t size[], const dim_t blkSize[], FLA_Obj* obj){
+	dim_t blockedSize[FLA_MAX_ORDER];
+	dim_t blockedStride[FLA_MAX_ORDER];
+
+	FLA_array_elemwise_quotient(order, size, blkSize, blockedSize);
+	FLA_Set_tensor_stride(order, blockedSize, blockedStride);
+	FLA_Obj_create_blocked_tensor(FLA_DOUBLE, order, size, blockedStride, blkSize, obj);
+}
+
+void freeBlockedTensor(FLA_Obj* obj){
+	FLA_Obj_blocked_tensor_free_buffer(obj);
+	FLA_Obj_free_without_buffer(obj);
+}
+
+//Order-m psym tensor of symmetry kind, n / b blocks along each mode, packed
+//into Tp.  Diagonal blocks of Tp hold the entries of T at their packed
+//offsets, the other blocks are copied as they are.  Unpacking gives back T,
+//and the mode-0 products of T and Tp with the same B agree
+dim_t test_packed(dim_t m, dim_t n, dim_t b, dim_t kind){
+	dim_t i, u;
+	dim_t size[FLA_MAX_ORDER];
+	dim_t blkSize[FLA_MAX_ORDER];
+	dim_t blockedSize[FLA_MAX_ORDER];
+	dim_t blockedStride[FLA_MAX_ORDER];
+	dim_t blkStride[FLA_MAX_ORDER];
+	dim_t sizeB[] = {3, n};
+	dim_t blkSizeB[] = {3, b};
+	dim_t sizeC[FLA_MAX_ORDER];
+	dim_t blkSizeC[FLA_MAX_ORDER];
+	TLA_unique_map* map;
+	FLA_Obj *buf_T, *buf_Tp, *buf_Tu, *buf_C, *buf_Cp;
+	dim_t nErrors = 0;
+	TLA_sym sym;
+	FLA_Obj T, Tp, Tu, B, C, Cp;
+
+	for(i = 0; i < m; i++){
+		size[i] = n;
+		blkSize[i] = b;
+		blockedSize[i] = n / b;
+		sizeC[i] = n;
+		blkSizeC[i] = b;
+	}
+	sizeC[0] = sizeB[0];
+	blkSizeC[0] = blkSizeB[0];
+	FLA_Set_tensor_stride(m, blkSize, blkStride);
+
+	initSym(m, kind, &sym);
+	initSymmTensor(FLA_DOUBLE, m, n, b, sym, TLA_ALIGN_NONE, &T);
+	FLA_Random_psym_tensor(T);
+	initSymmTensor(FLA_DOUBLE, m, n, b, sym, TLA_ALIGN_NONE, &Tu);
+	FLA_Set_tensor_stride(m, blockedSize, blockedStride);
+	FLA_Obj_create_blocked_psym_tensor_packed(FLA_DOUBLE, m, size, blockedStride, blkSize, sym, &Tp);
+	FLA_Obj_pack_blocked_psym_tensor(T, Tp);
+	FLA_Obj_unpack_blocked_psym_tensor(Tp, Tu);
+
+	map = FLA_Obj_unique_map(T);
+	buf_T = (FLA_Obj*)T.base->buffer;
+	buf_Tp = (FLA_Obj*)Tp.base->buffer;
+	buf_Tu = (FLA_Obj*)Tu.base->buffer;
+	for(u = 0; u < map->nUniques; u++){
+		dim_t l = map->uniqueLinIndex[u];
+		dim_t blkIndex[FLA_MAX_ORDER];
+		dim_t index[FLA_MAX_ORDER] = {0};
+		FLA_Base_obj* dense = buf_T[l].base;
+		FLA_Base_obj* packed = buf_Tp[l].base;
+		TLA_sym blkSym;
+		FLA_Bool diagonal;
+
+		for(i = 0; i < m; i++)
+			blkIndex[i] = (l / T.base->stride[i]) % blockedSize[i];
+		diagonal = TLA_sym_of_diagonal_block(sym, blkIndex, &blkSym);
+		if(packed->isPacked != diagonal)
+			nErrors++;
+		do{
+			dim_t e = FLA_TIndex_to_LinIndex(m, blkStride, index);
+			dim_t pe = diagonal ? TLA_packed_sym_offset(blkSym, blkSize, index) : e;
+
+			double d = ((double*)dense->buffer)[e];
+
+			if(!(fabs(((double*)packed->buffer)[pe] - d) <= 1e-12 * (1.0 + fabs(d))))
+				nErrors++;
+			if(!(fabs(((double*)buf_Tu[l].base->buffer)[e] - d) <= 1e-12 * (1.0 + fabs(d))))
+				nErrors++;
+		}while(nextIndex(m, blkSize, index));
+	}
+
+	initBlockedTensor(2, sizeB, blkSizeB, &B);
+	FLA_Random_tensor(B);
+	initBlockedTensor(m, sizeC, blkSizeC, &C);
+	initBlockedTensor(m, sizeC, blkSizeC, &Cp);
+	FLA_Ttm_single_mode(FLA_ONE, T, 0, FLA_ONE, B, C);
+	FLA_Ttm_single_mode(FLA_ONE, Tp, 0, FLA_ONE, B, Cp);
+	buf_C = (FLA_Obj*)C.base->buffer;
+	buf_Cp = (FLA_Obj*)Cp.base->buffer;
+	for(u = 0; u < FLA_Obj_num_elem_alloc(C); u++){
+		double* c = (double*)buf_C[u].base->buffer;
+		double* cp = (double*)buf_Cp[u].base->buffer;
+		dim_t e;
+
+		for(e = 0; e < FLA_array_product(m, blkSizeC); e++)
+			if(!(fabs(cp[e] - c[e]) <= 1e-12 * (1.0 + fabs(c[e]))))
+				nErrors++;
+	}
+
+	FLA_Obj_blocked_psym_tensor_free_buffer(&T);
+	FLA_Obj_free_without_buffer(&T);
+	FLA_Obj_blocked_psym_tensor_free_buffer(&Tp);
+	FLA_Obj_free_without_buffer(&Tp);
+	FLA_Obj_blocked_psym_tensor_free_buffer(&Tu);
+	FLA_Obj_free_without_buffer(&Tu);
+	freeBlockedTensor(&B);
+	freeBlockedTensor(&C);
+	freeBlockedTensor(&Cp);
+
+	return nErrors;
+}
+
+//Takes nested views of a flat (or blocked) order-4 tensor, each past the
+//first entries along a random mode, and checks the view queries against
+//the offsets accumulated here
+dim_t test_view_queries(FLA_Datatype datatype, FLA_Bool blocked){
+	dim_t order = 4;
+	dim_t size[] = {12, 8, 4, 12};
+	dim_t blkSize[] = {3, 2, 2, 3};
+	dim_t blockedSize[FLA_MAX_ORDER];
+	dim_t stride[FLA_MAX_ORDER];
+	dim_t offset[FLA_MAX_ORDER] = {0};
+	dim_t t, i;
+	dim_t nErrors = 0;
+	FLA_Obj T, V;
+
+	if(blocked){
+		FLA_array_elemwise_quotient(order, size, blkSize, blockedSize);
+		FLA_Set_tensor_stride(order, blockedSize, stride);
+		FLA_Obj_create_blocked_tensor(datatype, order, size, stride, blkSize, &T);
+	}else{
+		FLA_Set_tensor_stride(order, size, stride);
+		FLA_Obj_create_tensor(datatype, order, size, stride, &T);
+	}
+
+	V = T;
+	for(t = 0; t < 6; t++){
+		dim_t mode = rand() % order;
+		dim_t k = (V.size[mode] > 1) ? 1 + rand() % (V.size[mode] - 1) : 0;
+		dim_t elemOffset = 0;
+		char* expected;
+		FLA_Obj VT, VB;
+
+		FLA_Part_1xmode2(V, &VT,
+		                    &VB, mode, k, FLA_TOP);
+		V = VB;
+		offset[mode] += k;
+
+		for(i = 0; i < order; i++)
+			elemOffset += offset[i] * stride[i];
+		expected = (char*)T.base->buffer + elemOffset * TLA_OBJ_ELEM_SIZE(T);
+
+		if(TLA_OBJ_BUFFER_AT_VIEW(V) != (void*)expected)
+			nErrors++;
+		if(FLA_Obj_tensor_buffer_at_view(V) != (void*)expected)
+			nErrors++;
+		if(TLA_Obj_view_offset(&V) != elemOffset)
+			nErrors++;
+		if(TLA_OBJ_STRIDE(V) != T.base->stride || TLA_OBJ_BASE_SIZE(V) != T.base->size)
+			nErrors++;
+		for(i = 0; i < order; i++)
+			if(TLA_OBJ_OFFSET(V)[i] != offset[i] || TLA_OBJ_SIZE(V)[i] != V.size[i])
+				nErrors++;
+	}
+
+	if(blocked)
+		FLA_Obj_blocked_tensor_free_buffer(&T);
+	else
+		FLA_Obj_free_buffer(&T);
+	FLA_Obj_free_without_buffer(&T);
+
+	return nErrors;
+}
+
+int main(int argc, char* argv[]){
+	FLA_Datatype datatypes[] = {FLA_FLOAT, FLA_DOUBLE, FLA_COMPLEX, FLA_DOUBLE_COMPLEX};
+	const char* names[] = {"float", "double", "complex", "double complex"};
+	dim_t aligns[] = {TLA_ALIGN_NONE, TLA_ALIGN_CACHE_LINE, TLA_ALIGN_PAGE};
+	dim_t d, a, m, blocked;
+	int failures = 0;
+
+	FLA_Init();
+
+	for(d = 0; d < 4; d++)
+		for(a = 0; a < 3; a++){
+			dim_t nErrors = test_blocked_tensor(datatypes[d], aligns[a]);
+
+			if(nErrors > 0){
+				printf("blocked tensor (%s), align %d: %d errors\n",
+				       names[d], (int)aligns[a], (int)nErrors);
+				failures++;
+			}
+			for(m = 2; m <= 4; m++){
+				nErrors = test_psym_tensor(datatypes[d], m, 6, 2, aligns[a]);
+				if(nErrors > 0){
+					printf("psym tensor (%s), m = %d, align %d: %d errors\n",
+					       names[d], (int)m, (int)aligns[a], (int)nErrors);
+					failures++;
+				}
+			}
+		}
+
+	for(m = 2; m <= 5; m++){
+		dim_t kind;
+
+		for(kind = 0; kind < 4; kind++){
+			dim_t nErrors = test_unique_map(m, 6, 2, kind);
+
+			if(nErrors > 0){
+				printf("unique map, m = %d, symmetry %d: %d errors\n",
+				       (int)m, (int)kind, (int)nErrors);
+				failures++;
+			}
+			nErrors = test_packed(m, 6, 3, kind);
+			if(nErrors > 0){
+				printf("packed, m = %d, symmetry %d: %d errors\n",
+				       (int)m, (int)kind, (int)nErrors);
+				failures++;
+			}
+		}
+	}
+
+	for(d = 0; d < 4; d++)
+		for(blocked = 0; blocked < 2; blocked++){
+			dim_t nErrors = test_view_queries(datatypes[d], blocked);
+
+			if(nErrors > 0){
+				printf("view queries (%s, blocked = %d): %d errors\n",
+				       names[d], (int)blocked, (int)nErrors);
+				failures++;
+			}
+		}
+
+	printf("tensor blocks: %s\n", failures == 0 ? "PASS" : "FAIL");
+
+	FLA_Finalize();
+
+	return failures == 0 ? 0 : 1;
+}
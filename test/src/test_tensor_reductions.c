@@ -0,0 +1,504 @@
+#include "FLAME.h"
+#include "stdio.h"
+#include "math.h"
+#include "string.h"
+
+//Compares TLA_Sttv_all, TLA_Sttv_all_but_one, TLA_Dot, TLA_Norm_frob,
+//TLA_Mttkrp and TLA_Mttkrp_all against dense references computed entry by
+//entry in double, on fully, partially and non-symmetric psym tensors with and
+//without packed diagonal blocks, and on views of plain blocked tensors, in
+//both real datatypes.  Outputs that are overwritten (M,
+//and y for a zero alpha) start out as NaN.
+
+//Address of the entry of T at (flat) index, T flat or blocked
+void* entryAddress(FLA_Obj T, const dim_t index[]){
+	dim_t i;
+	dim_t offset = 0;
+
+	if(FLA_Obj_elemtype(T) != FLA_SCALAR){
+		FLA_Obj* buf = (FLA_Obj*)T.base->buffer;
+		dim_t blkIndex[FLA_MAX_ORDER];
+		dim_t linIndex = 0;
+
+		for(i = 0; i < T.order; i++){
+			dim_t b = buf[0].size[i];
+			linIndex += (T.offset[i] + index[i] / b) * T.base->stride[i];
+			blkIndex[i] = index[i] % b;
+		}
+		return entryAddress(buf[linIndex], blkIndex);
+	}
+	for(i = 0; i < T.order; i++)
+		offset += (T.offset[T.permutation[i]] + index[i]) * T.base->stride[T.permutation[i]];
+	return (char*)T.base->buffer + offset * FLA_Obj_datatype_size(FLA_Obj_datatype(T));
+}
+
+//Advances index over size in column-major order, FALSE past the end
+FLA_Bool nextIndex(dim_t order, const dim_t size[], dim_t index[]){
+	dim_t i;
+
+	for(i = 0; i < order; i++){
+		if(++index[i] < size[i])
+			return TRUE;
+		index[i] = 0;
+	}
+	return FALSE;
+}
+
+//Entry at p of a float or double object, widened to double
+double getReal(FLA_Datatype datatype, const void* p){
+	return (datatype == FLA_FLOAT) ? *(const float*)p : *(const double*)p;
+}
+
+void setReal(FLA_Datatype datatype, void* p, double value){
+	if(datatype == FLA_FLOAT)
+		*(float*)p = (float)value;
+	else
+		*(double*)p = value;
+}
+
+//Column-major copy in double of the (unpacked) T, flat size size
+double* toDense(FLA_Obj T, const dim_t size[]){
+	dim_t index[FLA_MAX_ORDER] = {0};
+	double* dense = (double*)malloc(FLA_array_product(T.order, size) * sizeof(double));
+	dim_t e = 0;
+
+	do{
+		dense[e++] = getReal(FLA_Obj_datatype(T), entryAddress(T, index));
+	}while(nextIndex(T.order, size, index));
+	return dense;
+}
+
+void* matrixEntry(FLA_Obj M, dim_t i, dim_t j){
+	return (char*)FLA_Obj_buffer_at_view(M) +
+	       (i * FLA_Obj_row_stride(M) + j * FLA_Obj_col_stride(M)) * FLA_Obj_datatype_size(FLA_Obj_datatype(M));
+}
+
+double getMatrixEntry(FLA_Obj M, dim_t i, dim_t j){
+	return getReal(FLA_Obj_datatype(M), matrixEntry(M, i, j));
+}
+
+void setMatrix(FLA_Obj M, double value){
+	dim_t i, j;
+
+	for(j = 0; j < FLA_Obj_width(M); j++)
+		for(i = 0; i < FLA_Obj_length(M); i++)
+			setReal(FLA_Obj_datatype(M), matrixEntry(M, i, j), value);
+}
+
+//Number of entries of x further than tol (relative) from ref
+dim_t countErrors(dim_t n, const double* x, const double* ref, double tol){
+	dim_t i;
+	dim_t nErrors = 0;
+
+	for(i = 0; i < n; i++)
+		if(!(fabs(x[i] - ref[i]) <= tol * (1.0 + fabs(ref[i]))))
+			nErrors++;
+	return nErrors;
+}
+
+//Symmetry of an order-m tensor: kind 0 is fully symmetric, 1 has mode 0 on
+//its own and the others symmetric, 2 has no symmetry
+void initSym(dim_t m, dim_t kind, TLA_sym* sym){
+	dim_t i;
+
+	sym->order = m;
+	for(i = 0; i < m; i++)
+		sym->symModes[i] = i;
+	if(kind == 0){
+		sym->nSymGroups = 1;
+		sym->symGroupLens[0] = m;
+	}else if(kind == 1){
+		sym->nSymGroups = 2;
+		sym->symGroupLens[0] = 1;
+		sym->symGroupLens[1] = m - 1;
+	}else{
+		sym->nSymGroups = m;
+		for(i = 0; i < m; i++)
+			sym->symGroupLens[i] = 1;
+	}
+}
+
+//A random psym tensor T, and in Tp the same tensor with packed diagonal
+//blocks if packed (T otherwise)
+void initSymmTensor(FLA_Datatype datatype, dim_t m, dim_t n, dim_t b, TLA_sym sym, FLA_Bool packed, FLA_Obj* T, FLA_Obj* Tp){
+	dim_t i;
+	dim_t size[FLA_MAX_ORDER];
+	dim_t blkSize[FLA_MAX_ORDER];
+	dim_t blockedSize[FLA_MAX_ORDER];
+	dim_t blockedStride[FLA_MAX_ORDER];
+
+	for(i = 0; i < m; i++){
+		size[i] = n;
+		blkSize[i] = b;
+	}
+	FLA_array_elemwise_quotient(m, size, blkSize, blockedSize);
+	FLA_Set_tensor_stride(m, blockedSize, blockedStride);
+	FLA_Obj_create_blocked_psym_tensor(datatype, m, size, blockedStride, blkSize, sym, T);
+	FLA_Random_psym_tensor(*T);
+	*Tp = *T;
+	if(packed){
+		FLA_Obj_create_blocked_psym_tensor_packed(datatype, m, size, blockedStride, blkSize, sym, Tp);
+		FLA_Obj_pack_blocked_psym_tensor(*T, *Tp);
+	}
+}
+
+void freeSymmTensor(FLA_Bool packed, FLA_Obj* T, FLA_Obj* Tp){
+	if(packed){
+		FLA_Obj_blocked_psym_tensor_free_buffer(Tp);
+		FLA_Obj_free_without_buffer(Tp);
+	}
+	FLA_Obj_blocked_psym_tensor_free_buffer(T);
+	FLA_Obj_free_without_buffer(T);
+}
+
+void initScalar(FLA_Datatype datatype, double value, FLA_Obj* obj){
+	FLA_Obj_create(datatype, 1, 1, 0, 0, obj);
+	setReal(datatype, FLA_Obj_buffer_at_view(*obj), value);
+}
+
+//TLA_Sttv_all (rho = A x_0 x ... x_m-1 x) and TLA_Sttv_all_but_one
+//(y := alpha y + beta A x_1 x ... x_m-1 x) on a fully symmetric tensor
+dim_t test_sttv(FLA_Datatype datatype, dim_t m, dim_t n, dim_t b, FLA_Bool packed, double alphaValue, double betaValue){
+	dim_t i, k;
+	dim_t size[FLA_MAX_ORDER];
+	dim_t index[FLA_MAX_ORDER] = {0};
+	double tol = (datatype == FLA_FLOAT) ? 1e-5 : 1e-12;
+	TLA_sym sym;
+	FLA_Obj A, Ap, x, y, rho, alpha, beta;
+	double *dA, *dx, *dy, *refy;
+	double refRho = 0.0;
+	double r;
+	dim_t e = 0;
+	dim_t nErrors = 0;
+
+	for(i = 0; i < m; i++)
+		size[i] = n;
+	initSym(m, 0, &sym);
+	initSymmTensor(datatype, m, n, b, sym, packed, &A, &Ap);
+	FLA_Obj_create(datatype, n, 1, 0, 0, &x);
+	FLA_Obj_create(datatype, n, 1, 0, 0, &y);
+	FLA_Random_matrix(x);
+	FLA_Random_matrix(y);
+	if(alphaValue == 0.0)
+		setMatrix(y, NAN);
+	initScalar(datatype, 0.0, &rho);
+	initScalar(datatype, alphaValue, &alpha);
+	initScalar(datatype, betaValue, &beta);
+
+	dA = toDense(A, size);
+	dx = (double*)malloc(n * sizeof(double));
+	dy = (double*)malloc(n * sizeof(double));
+	refy = (double*)malloc(n * sizeof(double));
+	for(i = 0; i < n; i++){
+		dx[i] = getMatrixEntry(x, i, 0);
+		refy[i] = (alphaValue == 0.0) ? 0.0 : alphaValue * getMatrixEntry(y, i, 0);
+	}
+	do{
+		double prod = dA[e++];
+
+		for(k = 1; k < m; k++)
+			prod *= dx[index[k]];
+		refy[index[0]] += betaValue * prod;
+		refRho += prod * dx[index[0]];
+	}while(nextIndex(m, size, index));
+
+	if(TLA_Sttv_all(Ap, x, rho) != FLA_SUCCESS ||
+	   TLA_Sttv_all_but_one(alpha, Ap, x, beta, y) != FLA_SUCCESS)
+		nErrors++;
+
+	r = getMatrixEntry(rho, 0, 0);
+	nErrors += countErrors(1, &r, &refRho, tol);
+	for(i = 0; i < n; i++)
+		dy[i] = getMatrixEntry(y, i, 0);
+	nErrors += countErrors(n, dy, refy, tol);
+
+	free(dA);
+	free(dx);
+	free(dy);
+	free(refy);
+	freeSymmTensor(packed, &A, &Ap);
+	FLA_Obj_free(&x);
+	FLA_Obj_free(&y);
+	FLA_Obj_free(&rho);
+	FLA_Obj_free(&alpha);
+	FLA_Obj_free(&beta);
+
+	return nErrors;
+}
+
+//TLA_Dot of two tensors of the same symmetry and TLA_Norm_frob of the first
+dim_t test_dot_norm(FLA_Datatype datatype, dim_t m, dim_t n, dim_t b, dim_t symKind, FLA_Bool packed){
+	dim_t i, t;
+	dim_t size[FLA_MAX_ORDER];
+	dim_t N;
+	double tol = (datatype == FLA_FLOAT) ? 1e-5 : 1e-12;
+	TLA_sym sym;
+	FLA_Obj A, Ap, B, Bp, rho, norm;
+	double *dA, *dB;
+	double refDot = 0.0;
+	double refNorm = 0.0;
+	double r;
+	dim_t nErrors = 0;
+
+	for(i = 0; i < m; i++)
+		size[i] = n;
+	N = FLA_array_product(m, size);
+	initSym(m, symKind, &sym);
+	initSymmTensor(datatype, m, n, b, sym, packed, &A, &Ap);
+	initSymmTensor(datatype, m, n, b, sym, packed, &B, &Bp);
+	initScalar(datatype, 0.0, &rho);
+	initScalar(datatype, 0.0, &norm);
+
+	dA = toDense(A, size);
+	dB = toDense(B, size);
+	for(i = 0; i < N; i++){
+		refDot += dA[i] * dB[i];
+		refNorm += dA[i] * dA[i];
+	}
+	refNorm = sqrt(refNorm);
+
+	//Serially and split across threads (in a multithreaded build)
+	for(t = 1; t <= 4; t += 3){
+		TLA_Dot_set_num_threads(t);
+		if(TLA_Dot(Ap, Bp, rho) != FLA_SUCCESS || TLA_Norm_frob(Ap, norm) != FLA_SUCCESS)
+			nErrors++;
+
+		r = getMatrixEntry(rho, 0, 0);
+		nErrors += countErrors(1, &r, &refDot, tol);
+		r = getMatrixEntry(norm, 0, 0);
+		nErrors += countErrors(1, &r, &refNorm, tol);
+	}
+	TLA_Dot_set_num_threads(1);
+
+	free(dA);
+	free(dB);
+	freeSymmTensor(packed, &A, &Ap);
+	freeSymmTensor(packed, &B, &Bp);
+	FLA_Obj_free(&rho);
+	FLA_Obj_free(&norm);
+
+	return nErrors;
+}
+
+//Dense M(:, r) = A x_k factors[k](:, r) for every mode k but mode
+void denseMttkrp(dim_t m, const dim_t size[], const double* A, const FLA_Obj factors[], dim_t mode, dim_t R, double* M){
+	dim_t index[FLA_MAX_ORDER] = {0};
+	dim_t k, r;
+	dim_t e = 0;
+
+	memset(M, 0, size[mode] * R * sizeof(double));
+	do{
+		for(r = 0; r < R; r++){
+			double prod = A[e];
+
+			for(k = 0; k < m; k++)
+				if(k != mode)
+					prod *= getMatrixEntry(factors[k], index[k], r);
+			M[index[mode] + r * size[mode]] += prod;
+		}
+		e++;
+	}while(nextIndex(m, size, index));
+}
+
+//TLA_Mttkrp along every mode and TLA_Mttkrp_all.  The modes of a symmetry
+//group share the factor of its first mode
+dim_t test_mttkrp(FLA_Datatype datatype, dim_t m, dim_t n, dim_t b, dim_t symKind, FLA_Bool packed, dim_t R){
+	dim_t i, k, mode;
+	dim_t size[FLA_MAX_ORDER];
+	double tol = (datatype == FLA_FLOAT) ? 1e-5 : 1e-12;
+	TLA_sym sym;
+	FLA_Obj A, Ap, F[FLA_MAX_ORDER], factors[FLA_MAX_ORDER], M[FLA_MAX_ORDER];
+	double *dA, *ref, *got;
+	dim_t nErrors = 0;
+
+	for(i = 0; i < m; i++)
+		size[i] = n;
+	initSym(m, symKind, &sym);
+	initSymmTensor(datatype, m, n, b, sym, packed, &A, &Ap);
+	for(k = 0; k < m; k++){
+		FLA_Obj_create(datatype, n, R, 0, 0, &F[k]);
+		FLA_Random_matrix(F[k]);
+		FLA_Obj_create(datatype, n, R, 0, 0, &M[k]);
+	}
+	for(k = 0; k < m; k++){
+		dim_t group = TLA_sym_group_of_mode(sym, k);
+		factors[k] = F[sym.symModes[TLA_sym_group_mode_offset(sym, group)]];
+	}
+
+	dA = toDense(A, size);
+	ref = (double*)malloc(n * R * sizeof(double));
+	got = (double*)malloc(n * R * sizeof(double));
+
+	//One mode at a time, then all of them
+	for(i = 0; i < 2; i++){
+		for(k = 0; k < m; k++)
+			setMatrix(M[k], NAN);
+		if(i == 0){
+			for(mode = 0; mode < m; mode++)
+				if(TLA_Mttkrp(Ap, factors, mode, M[mode]) != FLA_SUCCESS)
+					nErrors++;
+		}else{
+			if(TLA_Mttkrp_all(Ap, factors, M) != FLA_SUCCESS)
+				nErrors++;
+		}
+		for(mode = 0; mode < m; mode++){
+			dim_t r;
+
+			denseMttkrp(m, size, dA, factors, mode, R, ref);
+			for(r = 0; r < R; r++)
+				for(k = 0; k < n; k++)
+					got[k + r * n] = getMatrixEntry(M[mode], k, r);
+			nErrors += countErrors(n * R, got, ref, tol);
+		}
+	}
+
+	free(dA);
+	free(ref);
+	free(got);
+	for(k = 0; k < m; k++){
+		FLA_Obj_free(&F[k]);
+		FLA_Obj_free(&M[k]);
+	}
+	freeSymmTensor(packed, &A, &Ap);
+
+	return nErrors;
+}
+
+//TLA_Mttkrp along every mode and TLA_Mttkrp_all on the view of a plain
+//blocked tensor past its first block along vmode
+dim_t test_mttkrp_view(FLA_Datatype datatype, dim_t m, dim_t n, dim_t b, dim_t vmode, dim_t R){
+	dim_t i, k, mode;
+	dim_t size[FLA_MAX_ORDER];
+	dim_t sizeV[FLA_MAX_ORDER];
+	dim_t blkSize[FLA_MAX_ORDER];
+	dim_t blockedSize[FLA_MAX_ORDER];
+	dim_t blockedStride[FLA_MAX_ORDER];
+	double tol = (datatype == FLA_FLOAT) ? 1e-5 : 1e-12;
+	FLA_Obj A, AT, Av, factors[FLA_MAX_ORDER], M[FLA_MAX_ORDER];
+	double *dA, *ref, *got;
+	dim_t nErrors = 0;
+
+	for(i = 0; i < m; i++){
+		size[i] = n;
+		blkSize[i] = b;
+	}
+	FLA_array_elemwise_quotient(m, size, blkSize, blockedSize);
+	FLA_Set_tensor_stride(m, blockedSize, blockedStride);
+	FLA_Obj_create_blocked_tensor(datatype, m, size, blockedStride, blkSize, &A);
+	FLA_Random_tensor(A);
+	FLA_Part_1xmode2(A, &AT,
+	                    &Av, vmode, 1, FLA_TOP);
+	for(i = 0; i < m; i++)
+		sizeV[i] = (i == vmode) ? n - b : n;
+	for(k = 0; k < m; k++){
+		FLA_Obj_create(datatype, sizeV[k], R, 0, 0, &factors[k]);
+		FLA_Random_matrix(factors[k]);
+		FLA_Obj_create(datatype, sizeV[k], R, 0, 0, &M[k]);
+	}
+
+	dA = toDense(Av, sizeV);
+	ref = (double*)malloc(n * R * sizeof(double));
+	got = (double*)malloc(n * R * sizeof(double));
+
+	//One mode at a time, then all of them
+	for(i = 0; i < 2; i++){
+		for(k = 0; k < m; k++)
+			setMatrix(M[k], NAN);
+		if(i == 0){
+			for(mode = 0; mode < m; mode++)
+				if(TLA_Mttkrp(Av, factors, mode, M[mode]) != FLA_SUCCESS)
+					nErrors++;
+		}else{
+			if(TLA_Mttkrp_all(Av, factors, M) != FLA_SUCCESS)
+				nErrors++;
+		}
+		for(mode = 0; mode < m; mode++){
+			dim_t r;
+
+			denseMttkrp(m, sizeV, dA, factors, mode, R, ref);
+			for(r = 0; r < R; r++)
+				for(k = 0; k < sizeV[mode]; k++)
+					got[k + r * sizeV[mode]] = getMatrixEntry(M[mode], k, r);
+			nErrors += countErrors(sizeV[mode] * R, got, ref, tol);
+		}
+	}
+
+	free(dA);
+	free(ref);
+	free(got);
+	for(k = 0; k < m; k++){
+		FLA_Obj_free(&factors[k]);
+		FLA_Obj_free(&M[k]);
+	}
+	FLA_Obj_blocked_tensor_free_buffer(&A);
+	FLA_Obj_free_without_buffer(&A);
+
+	return nErrors;
+}
+
+int main(int argc, char* argv[]){
+	FLA_Datatype datatypes[] = {FLA_FLOAT, FLA_DOUBLE};
+	const char* names[] = {"float", "double"};
+	dim_t d, m, s, p, a, kind;
+	int failures = 0;
+	//Several blocks along each mode, and a single one
+	dim_t n[] = {6, 3};
+	dim_t b[] = {2, 3};
+	double alphas[] = {1.0, 0.0, 0.5};
+	double betas[] = {1.0, -2.0, 3.0};
+
+	FLA_Init();
+	srand(17);
+
+	for(d = 0; d < 2; d++)
+		for(m = 2; m <= 4; m++)
+			for(s = 0; s < 2; s++)
+				for(p = 0; p < 2; p++)
+					for(a = 0; a < 3; a++){
+						dim_t nErrors = test_sttv(datatypes[d], m, n[s], b[s], p, alphas[a], betas[a]);
+
+						if(nErrors > 0){
+							printf("sttv (%s), m = %d, n = %d, packed = %d, alpha = %g, beta = %g: %d wrong entries\n",
+							       names[d], (int)m, (int)n[s], (int)p, alphas[a], betas[a], (int)nErrors);
+							failures++;
+						}
+					}
+
+	for(d = 0; d < 2; d++)
+		for(m = 2; m <= 4; m++)
+			for(s = 0; s < 2; s++)
+				for(p = 0; p < 2; p++)
+					for(kind = 0; kind < 3; kind++){
+						dim_t nErrors = test_dot_norm(datatypes[d], m, n[s], b[s], kind, p);
+
+						if(nErrors > 0){
+							printf("dot and norm (%s), m = %d, n = %d, symmetry %d, packed = %d: %d wrong entries\n",
+							       names[d], (int)m, (int)n[s], (int)kind, (int)p, (int)nErrors);
+							failures++;
+						}
+						nErrors = test_mttkrp(datatypes[d], m, n[s], b[s], kind, p, 3);
+						if(nErrors > 0){
+							printf("mttkrp (%s), m = %d, n = %d, symmetry %d, packed = %d: %d wrong entries\n",
+							       names[d], (int)m, (int)n[s], (int)kind, (int)p, (int)nErrors);
+							failures++;
+						}
+					}
+
+	for(d = 0; d < 2; d++)
+		for(m = 2; m <= 4; m++)
+			for(a = 0; a < m; a++){
+				dim_t nErrors = test_mttkrp_view(datatypes[d], m, n[0], b[0], a, 3);
+
+				if(nErrors > 0){
+					printf("mttkrp on views (%s), m = %d, view along mode %d: %d wrong entries\n",
+					       names[d], (int)m, (int)a, (int)nErrors);
+					failures++;
+				}
+			}
+
+	printf("tensor reductions: %s\n", failures == 0 ? "PASS" : "FAIL");
+
+	FLA_Finalize();
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,637 @@
+#include "FLAME.h"
+#include "stdio.h"
+#include "math.h"
+
+//Compares FLA_Ttm_single_mode against a dense reference computed entry by
+//entry, along every mode of flat and blocked tensors, in every datatype, and
+//FLA_Ttm along several modes against the products taken one at a time,
+//with the product order and flops FLA_Ttm_ext reports (and its rejection of
+//out of range products).
+//The block sizes of the blocked shapes hit every k the batched leaf kernels
+//specialize on as well as the generic kernel, and the orders run from 2 to
+//8, past the orders the leaf loops are specialized on.  Views of blocked
+//tensors are run through FLA_Ttm_single_mode and FLA_Ttm_single_mode_view,
+//and C must not change outside its view.  The reference is computed in
+//double complex whatever the datatype.
+//C := alpha C + beta (A x_mode B), where a zero alpha overwrites C without
+//reading it: C starts out as NaN then.
+
+//Address of the entry of T at (flat) index, T flat or blocked
+void* entryAddress(FLA_Obj T, const dim_t index[]){
+	dim_t i;
+	dim_t offset = 0;
+
+	if(FLA_Obj_elemtype(T) != FLA_SCALAR){
+		FLA_Obj* buf = (FLA_Obj*)T.base->buffer;
+		dim_t blkIndex[FLA_MAX_ORDER];
+		dim_t linIndex = 0;
+
+		for(i = 0; i < T.order; i++){
+			dim_t b = buf[0].size[i];
+			linIndex += (T.offset[i] + index[i] / b) * T.base->stride[i];
+			blkIndex[i] = index[i] % b;
+		}
+		return entryAddress(buf[linIndex], blkIndex);
+	}
+	for(i = 0; i < T.order; i++)
+		offset += (T.offset[T.permutation[i]] + index[i]) * T.base->stride[T.permutation[i]];
+	return (char*)T.base->buffer + offset * FLA_Obj_datatype_size(FLA_Obj_datatype(T));
+}
+
+//Entry of T at index, widened to double complex
+dcomplex getEntry(FLA_Obj T, const dim_t index[]){
+	void* p = entryAddress(T, index);
+	dcomplex z = {0.0, 0.0};
+
+	switch(FLA_Obj_datatype(T)){
+	case FLA_FLOAT:
+		z.real = *(float*)p;
+		break;
+	case FLA_DOUBLE:
+		z.real = *(double*)p;
+		break;
+	case FLA_COMPLEX:
+		z.real = ((scomplex*)p)->real;
+		z.imag = ((scomplex*)p)->imag;
+		break;
+	default:
+		z = *(dcomplex*)p;
+	}
+	return z;
+}
+
+dcomplex cmul(dcomplex a, dcomplex b){
+	dcomplex z;
+
+	z.real = a.real * b.real - a.imag * b.imag;
+	z.imag = a.real * b.imag + a.imag * b.real;
+	return z;
+}
+
+//Advances index over size in column-major order, FALSE past the end
+FLA_Bool nextIndex(dim_t order, const dim_t size[], dim_t index[]){
+	dim_t i;
+
+	for(i = 0; i < order; i++){
+		if(++index[i] < size[i])
+			return TRUE;
+		index[i] = 0;
+	}
+	return FALSE;
+}
+
+//Column-major copy of T, flat size size
+dcomplex* toDense(FLA_Obj T, const dim_t size[]){
+	dim_t index[FLA_MAX_ORDER] = {0};
+	dcomplex* dense = (dcomplex*)malloc(FLA_array_product(T.order, size) * sizeof(dcomplex));
+	dim_t e = 0;
+
+	do{
+		dense[e++] = getEntry(T, index);
+	}while(nextIndex(T.order, size, index));
+	return dense;
+}
+
+//out := A x_mode B for dense column-major A of size size and B of size
+//p x size[mode]
+void denseTtm(dim_t order, const dim_t size[], const dcomplex* A, dim_t mode, dim_t p, const dcomplex* B, dcomplex* out){
+	dim_t index[FLA_MAX_ORDER] = {0};
+	dim_t outSize[FLA_MAX_ORDER];
+	dim_t modeStride = FLA_array_product(mode, size);
+	dim_t i, j;
+	dim_t e = 0;
+
+	for(i = 0; i < order; i++)
+		outSize[i] = size[i];
+	outSize[mode] = p;
+
+	do{
+		dim_t offset = 0;
+		dim_t stride = 1;
+		dcomplex sum = {0.0, 0.0};
+
+		for(i = 0; i < order; i++){
+			if(i != mode)
+				offset += index[i] * stride;
+			stride *= size[i];
+		}
+		for(j = 0; j < size[mode]; j++){
+			dcomplex t = cmul(B[index[mode] + j * p], A[offset + j * modeStride]);
+
+			sum.real += t.real;
+			sum.imag += t.imag;
+		}
+		out[e++] = sum;
+	}while(nextIndex(order, outSize, index));
+}
+
+//Number of entries of x further than tol (relative) from ref
+dim_t countErrors(dim_t n, const dcomplex* x, const dcomplex* ref, double tol){
+	dim_t i;
+	dim_t nErrors = 0;
+
+	for(i = 0; i < n; i++)
+		if(!(hypot(x[i].real - ref[i].real, x[i].imag - ref[i].imag) <=
+		     tol * (1.0 + hypot(ref[i].real, ref[i].imag))))
+			nErrors++;
+	return nErrors;
+}
+
+void initTensor(FLA_Datatype datatype, FLA_Bool blocked, dim_t order, const dim_t size[], const dim_t blkSize[], FLA_Obj* obj){
+	dim_t stride[FLA_MAX_ORDER];
+	dim_t blockedSize[FLA_MAX_ORDER];
+
+	if(blocked){
+		FLA_array_elemwise_quotient(order, size, blkSize, blockedSize);
+		FLA_Set_tensor_stride(order, blockedSize, stride);
+		FLA_Obj_create_blocked_tensor(datatype, order, size, stride, blkSize, obj);
+	}else{
+		FLA_Set_tensor_stride(order, size, stride);
+		FLA_Obj_create_tensor(datatype, order, size, stride, obj);
+	}
+	FLA_Random_tensor(*obj);
+}
+
+void freeTensor(FLA_Obj* obj){
+	if(FLA_Obj_elemtype(*obj) == FLA_SCALAR)
+		FLA_Obj_free_buffer(obj);
+	else
+		FLA_Obj_blocked_tensor_free_buffer(obj);
+	FLA_Obj_free_without_buffer(obj);
+}
+
+//Sets every entry of T, of flat size size, to value
+void setAll(FLA_Obj T, const dim_t size[], double value){
+	dim_t index[FLA_MAX_ORDER] = {0};
+
+	do{
+		void* p = entryAddress(T, index);
+
+		switch(FLA_Obj_datatype(T)){
+		case FLA_FLOAT:
+			*(float*)p = (float)value;
+			break;
+		case FLA_DOUBLE:
+			*(double*)p = value;
+			break;
+		case FLA_COMPLEX:
+			((scomplex*)p)->real = ((scomplex*)p)->imag = (float)value;
+			break;
+		default:
+			((dcomplex*)p)->real = ((dcomplex*)p)->imag = value;
+		}
+	}while(nextIndex(T.order, size, index));
+}
+
+//Scalar of datatype with real part value
+void initScalar(FLA_Datatype datatype, double value, FLA_Obj* obj){
+	void* p;
+
+	FLA_Obj_create(datatype, 1, 1, 0, 0, obj);
+	p = FLA_Obj_buffer_at_view(*obj);
+	switch(datatype){
+	case FLA_FLOAT:
+		*(float*)p = (float)value;
+		break;
+	case FLA_DOUBLE:
+		*(double*)p = value;
+		break;
+	case FLA_COMPLEX:
+		((scomplex*)p)->real = (float)value;
+		((scomplex*)p)->imag = 0.0f;
+		break;
+	default:
+		((dcomplex*)p)->real = value;
+		((dcomplex*)p)->imag = 0.0;
+	}
+}
+
+//FLA_Ttm_single_mode along every mode of a tensor of size size (blocks of
+//blkSize when blocked), B has p rows (blocks of bp rows)
+dim_t test_ttm_single_mode(FLA_Datatype datatype, FLA_Bool blocked, dim_t order, const dim_t size[], const dim_t blkSize[],
+                           dim_t p, dim_t bp, double alphaValue, double betaValue){
+	dim_t mode, i;
+	dim_t nErrors = 0;
+	double tol = (datatype == FLA_FLOAT || datatype == FLA_COMPLEX) ? 1e-5 : 1e-12;
+	FLA_Obj alpha, beta;
+	FLA_Obj A;
+
+	initScalar(datatype, alphaValue, &alpha);
+	initScalar(datatype, betaValue, &beta);
+	initTensor(datatype, blocked, order, size, blkSize, &A);
+
+	for(mode = 0; mode < order; mode++){
+		dim_t sizeB[] = {p, size[mode]};
+		dim_t blkSizeB[] = {bp, blkSize[mode]};
+		dim_t sizeC[FLA_MAX_ORDER];
+		dim_t blkSizeC[FLA_MAX_ORDER];
+		dim_t nC;
+		dcomplex *dA, *dB, *dC, *ref;
+		FLA_Obj B, C;
+
+		for(i = 0; i < order; i++){
+			sizeC[i] = size[i];
+			blkSizeC[i] = blkSize[i];
+		}
+		sizeC[mode] = p;
+		blkSizeC[mode] = bp;
+		nC = FLA_array_product(order, sizeC);
+
+		initTensor(datatype, blocked, 2, sizeB, blkSizeB, &B);
+		initTensor(datatype, blocked, order, sizeC, blkSizeC, &C);
+		if(alphaValue == 0.0)
+			setAll(C, sizeC, NAN);
+
+		dA = toDense(A, size);
+		dB = toDense(B, sizeB);
+		dC = toDense(C, sizeC);
+		ref = (dcomplex*)malloc(nC * sizeof(dcomplex));
+		denseTtm(order, size, dA, mode, p, dB, ref);
+		for(i = 0; i < nC; i++){
+			ref[i].real = (alphaValue == 0.0 ? 0.0 : alphaValue * dC[i].real) + betaValue * ref[i].real;
+			ref[i].imag = (alphaValue == 0.0 ? 0.0 : alphaValue * dC[i].imag) + betaValue * ref[i].imag;
+		}
+
+		FLA_Ttm_single_mode(alpha, A, mode, beta, B, C);
+
+		free(dC);
+		dC = toDense(C, sizeC);
+		nErrors += countErrors(nC, dC, ref, tol);
+
+		free(dA);
+		free(dB);
+		free(dC);
+		free(ref);
+		freeTensor(&B);
+		freeTensor(&C);
+	}
+
+	freeTensor(&A);
+	FLA_Obj_free(&alpha);
+	FLA_Obj_free(&beta);
+
+	return nErrors;
+}
+
+//Flops of applying the products mode[seq[0]], mode[seq[1]], ... to A of
+//size size, product i taking mode[i] from its size to p[i]
+double ttmOrderFlops(dim_t order, const dim_t size[], dim_t nModes, const dim_t mode[], const dim_t p[], const dim_t seq[]){
+	dim_t sizeT[FLA_MAX_ORDER];
+	dim_t i, s;
+	double flops = 0.0;
+
+	for(i = 0; i < order; i++)
+		sizeT[i] = size[i];
+	for(s = 0; s < nModes; s++){
+		double n = 2.0 * p[seq[s]];
+
+		for(i = 0; i < order; i++)
+			n *= sizeT[i];
+		flops += n;
+		sizeT[mode[seq[s]]] = p[seq[s]];
+	}
+	return flops;
+}
+
+//FLA_Ttm (through FLA_Ttm_ext) along three of the modes of an order-4
+//tensor.  The reported order must be a permutation of the products, and the
+//reported flops its cost, the least of any order
+dim_t test_ttm_multi_mode(FLA_Datatype datatype, FLA_Bool blocked, double alphaValue, double betaValue){
+	dim_t order = 4;
+	dim_t nModes = 3;
+	dim_t size[] = {6, 8, 4, 6};
+	dim_t blkSize[] = {3, 4, 2, 3};
+	dim_t mode[] = {0, 1, 3};
+	dim_t p[] = {2, 4, 9};
+	dim_t bp[] = {1, 2, 3};
+	dim_t sizeC[FLA_MAX_ORDER];
+	dim_t blkSizeC[FLA_MAX_ORDER];
+	dim_t sizeT[FLA_MAX_ORDER];
+	dim_t orderOut[FLA_MAX_ORDER];
+	dim_t seen[FLA_MAX_ORDER] = {0};
+	dim_t flops;
+	dim_t nC, i;
+	dim_t nErrors = 0;
+	double tol = (datatype == FLA_FLOAT || datatype == FLA_COMPLEX) ? 1e-5 : 1e-12;
+	dcomplex *dC, *ref;
+	FLA_Obj alpha, beta;
+	FLA_Obj A, B[FLA_MAX_ORDER], C;
+
+	initScalar(datatype, alphaValue, &alpha);
+	initScalar(datatype, betaValue, &beta);
+	initTensor(datatype, blocked, order, size, blkSize, &A);
+	for(i = 0; i < order; i++){
+		sizeC[i] = size[i];
+		blkSizeC[i] = blkSize[i];
+		sizeT[i] = size[i];
+	}
+	for(i = 0; i < nModes; i++){
+		dim_t sizeB[] = {p[i], size[mode[i]]};
+		dim_t blkSizeB[] = {bp[i], blkSize[mode[i]]};
+
+		initTensor(datatype, blocked, 2, sizeB, blkSizeB, &B[i]);
+		sizeC[mode[i]] = p[i];
+		blkSizeC[mode[i]] = bp[i];
+	}
+	initTensor(datatype, blocked, order, sizeC, blkSizeC, &C);
+	if(alphaValue == 0.0)
+		setAll(C, sizeC, NAN);
+
+	//Reference: the products one mode at a time
+	ref = toDense(A, size);
+	for(i = 0; i < nModes; i++){
+		dim_t sizeB[] = {p[i], size[mode[i]]};
+		dcomplex* dB = toDense(B[i], sizeB);
+		dcomplex* next;
+
+		sizeT[mode[i]] = p[i];
+		next = (dcomplex*)malloc(FLA_array_product(order, sizeT) * sizeof(dcomplex));
+		sizeT[mode[i]] = size[mode[i]];
+		denseTtm(order, sizeT, ref, mode[i], p[i], dB, next);
+		sizeT[mode[i]] = p[i];
+		free(dB);
+		free(ref);
+		ref = next;
+	}
+	nC = FLA_array_product(order, sizeC);
+	dC = toDense(C, sizeC);
+	for(i = 0; i < nC; i++){
+		ref[i].real = (alphaValue == 0.0 ? 0.0 : alphaValue * dC[i].real) + betaValue * ref[i].real;
+		ref[i].imag = (alphaValue == 0.0 ? 0.0 : alphaValue * dC[i].imag) + betaValue * ref[i].imag;
+	}
+
+	if(FLA_Ttm_ext(alpha, A, nModes, mode, beta, B, C, orderOut, &flops) != FLA_SUCCESS)
+		nErrors++;
+	for(i = 0; i < nModes; i++)
+		seen[orderOut[i] < nModes ? orderOut[i] : 0]++;
+	for(i = 0; i < nModes; i++)
+		if(seen[i] != 1)
+			nErrors++;
+	if(nErrors == 0){
+		//Every order of three products
+		dim_t perms[][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+		double best = ttmOrderFlops(order, size, nModes, mode, p, perms[0]);
+
+		for(i = 1; i < 6; i++)
+			if(ttmOrderFlops(order, size, nModes, mode, p, perms[i]) < best)
+				best = ttmOrderFlops(order, size, nModes, mode, p, perms[i]);
+		if((double)flops != ttmOrderFlops(order, size, nModes, mode, p, orderOut) || (double)flops != best)
+			nErrors++;
+	}
+
+	free(dC);
+	dC = toDense(C, sizeC);
+	nErrors += countErrors(nC, dC, ref, tol);
+
+	free(dC);
+	free(ref);
+	freeTensor(&A);
+	for(i = 0; i < nModes; i++)
+		freeTensor(&B[i]);
+	freeTensor(&C);
+	FLA_Obj_free(&alpha);
+	FLA_Obj_free(&beta);
+
+	return nErrors;
+}
+
+//FLA_Ttm_ext must reject more than FLA_MAX_ORDER products and modes past
+//the order of A without touching C
+dim_t test_ttm_ext_bounds(void){
+	dim_t size[] = {4, 4, 4};
+	dim_t sizeB[] = {4, 4};
+	dim_t mode[FLA_MAX_ORDER + 1] = {0};
+	dim_t badMode[] = {0, 3};
+	dim_t orderOut[FLA_MAX_ORDER + 1];
+	dim_t flops = 0;
+	dim_t nErrors = 0;
+	dim_t i;
+	dcomplex *before, *after;
+	FLA_Obj alpha, beta;
+	FLA_Obj A, B[FLA_MAX_ORDER + 1], C;
+
+	initScalar(FLA_DOUBLE, 1.0, &alpha);
+	initScalar(FLA_DOUBLE, 1.0, &beta);
+	initTensor(FLA_DOUBLE, FALSE, 3, size, size, &A);
+	initTensor(FLA_DOUBLE, FALSE, 2, sizeB, sizeB, &B[0]);
+	for(i = 1; i <= FLA_MAX_ORDER; i++)
+		B[i] = B[0];
+	initTensor(FLA_DOUBLE, FALSE, 3, size, size, &C);
+	before = toDense(C, size);
+
+	if(FLA_Ttm_ext(alpha, A, FLA_MAX_ORDER + 1, mode, beta, B, C, orderOut, &flops) != FLA_FAILURE)
+		nErrors++;
+	if(FLA_Ttm_ext(alpha, A, 2, badMode, beta, B, C, orderOut, &flops) != FLA_FAILURE)
+		nErrors++;
+	after = toDense(C, size);
+	nErrors += countErrors(FLA_array_product(3, size), after, before, 0.0);
+	if(flops != 0)
+		nErrors++;
+
+	free(before);
+	free(after);
+	freeTensor(&A);
+	freeTensor(&B[0]);
+	freeTensor(&C);
+	FLA_Obj_free(&alpha);
+	FLA_Obj_free(&beta);
+
+	return nErrors;
+}
+
+//Flat size of the (flat or blocked) view T
+void flatSize(FLA_Obj T, dim_t size[]){
+	dim_t i;
+
+	for(i = 0; i < T.order; i++)
+		size[i] = T.size[i];
+	if(FLA_Obj_elemtype(T) != FLA_SCALAR)
+		for(i = 0; i < T.order; i++)
+			size[i] *= ((FLA_Obj*)T.base->buffer)[0].size[i];
+}
+
+//FLA_Ttm_single_mode (or FLA_Ttm_single_mode_view) along mode on the view
+//of a blocked order-4 tensor past its first block along vmode.  When vmode
+//is the product mode only A and B are views; otherwise A and C are
+dim_t test_ttm_view(FLA_Datatype datatype, FLA_Bool kernelView, dim_t mode, dim_t vmode, double alphaValue, double betaValue){
+	dim_t order = 4;
+	dim_t size[] = {6, 4, 4, 6};
+	dim_t blkSize[] = {3, 2, 2, 3};
+	dim_t p = 4;
+	dim_t bp = 2;
+	dim_t sizeB[] = {p, size[mode]};
+	dim_t blkSizeB[] = {bp, blkSize[mode]};
+	dim_t sizeC[FLA_MAX_ORDER];
+	dim_t blkSizeC[FLA_MAX_ORDER];
+	dim_t sizeAv[FLA_MAX_ORDER];
+	dim_t sizeCv[FLA_MAX_ORDER];
+	dim_t index[FLA_MAX_ORDER] = {0};
+	dim_t i, e, nC;
+	dim_t nErrors = 0;
+	double tol = (datatype == FLA_FLOAT || datatype == FLA_COMPLEX) ? 1e-5 : 1e-12;
+	dcomplex *dA, *dB, *dC, *prod, *ref;
+	FLA_Obj alpha, beta;
+	FLA_Obj A, B, C, AT, Av, BL, Bv, CT, Cv;
+
+	for(i = 0; i < order; i++){
+		sizeC[i] = size[i];
+		blkSizeC[i] = blkSize[i];
+	}
+	sizeC[mode] = p;
+	blkSizeC[mode] = bp;
+	nC = FLA_array_product(order, sizeC);
+
+	initScalar(datatype, alphaValue, &alpha);
+	initScalar(datatype, betaValue, &beta);
+	initTensor(datatype, TRUE, order, size, blkSize, &A);
+	initTensor(datatype, TRUE, 2, sizeB, blkSizeB, &B);
+	initTensor(datatype, TRUE, order, sizeC, blkSizeC, &C);
+
+	FLA_Part_1xmode2(A, &AT,
+	                    &Av, vmode, 1, FLA_TOP);
+	Bv = B;
+	Cv = C;
+	if(vmode == mode){
+		FLA_Part_1xmode2(B, &BL,
+		                    &Bv, 1, 1, FLA_TOP);
+	}else{
+		FLA_Part_1xmode2(C, &CT,
+		                    &Cv, vmode, 1, FLA_TOP);
+	}
+	flatSize(Av, sizeAv);
+	flatSize(Cv, sizeCv);
+	sizeB[1] = sizeAv[mode];
+	if(alphaValue == 0.0)
+		setAll(Cv, sizeCv, NAN);
+
+	//Reference: C outside the view as it is, the view updated
+	dA = toDense(Av, sizeAv);
+	dB = toDense(Bv, sizeB);
+	dC = toDense(C, sizeC);
+	ref = toDense(C, sizeC);
+	prod = (dcomplex*)malloc(FLA_array_product(order, sizeCv) * sizeof(dcomplex));
+	denseTtm(order, sizeAv, dA, mode, p, dB, prod);
+	e = 0;
+	do{
+		dim_t full = 0;
+		dim_t stride = 1;
+
+		for(i = 0; i < order; i++){
+			full += (index[i] + Cv.offset[i] * blkSizeC[i]) * stride;
+			stride *= sizeC[i];
+		}
+		ref[full].real = (alphaValue == 0.0 ? 0.0 : alphaValue * dC[full].real) + betaValue * prod[e].real;
+		ref[full].imag = (alphaValue == 0.0 ? 0.0 : alphaValue * dC[full].imag) + betaValue * prod[e].imag;
+		e++;
+	}while(nextIndex(order, sizeCv, index));
+
+	if(kernelView){
+		TLA_View vA, vB, vC;
+
+		TLA_View_from_obj(&Av, &vA);
+		TLA_View_from_obj(&Bv, &vB);
+		TLA_View_from_obj(&Cv, &vC);
+		FLA_Ttm_single_mode_view(alpha, &vA, mode, beta, &vB, &vC);
+	}else{
+		FLA_Ttm_single_mode(alpha, Av, mode, beta, Bv, Cv);
+	}
+
+	free(dC);
+	dC = toDense(C, sizeC);
+	nErrors += countErrors(nC, dC, ref, tol);
+
+	free(dA);
+	free(dB);
+	free(dC);
+	free(prod);
+	free(ref);
+	freeTensor(&A);
+	freeTensor(&B);
+	freeTensor(&C);
+	FLA_Obj_free(&alpha);
+	FLA_Obj_free(&beta);
+
+	return nErrors;
+}
+
+int main(int argc, char* argv[]){
+	FLA_Datatype datatypes[] = {FLA_FLOAT, FLA_DOUBLE, FLA_COMPLEX, FLA_DOUBLE_COMPLEX};
+	const char* names[] = {"float", "double", "complex", "double complex"};
+	//Shapes of A and their blocks: several blocks along every mode, then
+	//blocks with 4, 8, 16 and 32 entries along the modes of length 2 blocks
+	dim_t sizes[][4] = {{6, 4, 2, 6}, {8, 4, 2, 3}, {16, 8, 2, 3}, {32, 16, 2, 3}, {64, 32, 2, 1}};
+	dim_t blkSizes[][4] = {{3, 2, 2, 3}, {4, 4, 2, 3}, {8, 8, 2, 3}, {16, 16, 2, 3}, {32, 32, 2, 1}};
+	dim_t a, d, s, m, blocked;
+	int failures = 0;
+	double alphas[] = {1.0, 0.0, 0.5};
+	double betas[] = {1.0, -2.0, 3.0};
+
+	FLA_Init();
+	srand(11);
+
+	for(d = 0; d < 4; d++)
+		for(blocked = 0; blocked < 2; blocked++)
+			for(a = 0; a < 3; a++){
+				dim_t nErrors;
+
+				//The flat tensors only differ in shape
+				for(s = 0; s < (blocked ? 5 : 1); s++){
+					nErrors = test_ttm_single_mode(datatypes[d], blocked, 4, sizes[s], blkSizes[s], 4, 2, alphas[a], betas[a]);
+					if(nErrors > 0){
+						printf("ttm single mode (%s, blocked = %d), shape %d, alpha = %g, beta = %g: %d wrong entries\n",
+						       names[d], (int)blocked, (int)s, alphas[a], betas[a], (int)nErrors);
+						failures++;
+					}
+				}
+				nErrors = test_ttm_multi_mode(datatypes[d], blocked, alphas[a], betas[a]);
+				if(nErrors > 0){
+					printf("ttm multi mode (%s, blocked = %d), alpha = %g, beta = %g: %d wrong entries\n",
+					       names[d], (int)blocked, alphas[a], betas[a], (int)nErrors);
+					failures++;
+				}
+			}
+
+	//Orders the leaf loops are specialized on, and past them
+	for(d = 0; d < 4; d++)
+		for(m = 2; m <= 8; m++)
+			for(a = 0; a < 2; a++){
+				dim_t size[FLA_MAX_ORDER];
+				dim_t blkSize[FLA_MAX_ORDER];
+				dim_t nErrors;
+
+				for(s = 0; s < m; s++){
+					size[s] = (m <= 6) ? 4 : 2;
+					blkSize[s] = 2;
+				}
+				nErrors = test_ttm_single_mode(datatypes[d], a, m, size, blkSize, 3, 3, 1.0, betas[2]);
+				if(nErrors > 0){
+					printf("ttm single mode (%s, blocked = %d), order %d: %d wrong entries\n",
+					       names[d], (int)a, (int)m, (int)nErrors);
+					failures++;
+				}
+			}
+
+	for(d = 0; d < 4; d++)
+		for(s = 0; s < 4; s++)
+			for(m = 0; m < 4; m++)
+				for(a = 0; a < 6; a++){
+					dim_t nErrors = test_ttm_view(datatypes[d], a % 2, m, s, alphas[a / 2], betas[2]);
+
+					if(nErrors > 0){
+						printf("ttm %s (%s), mode %d, view along mode %d, alpha = %g: %d wrong entries\n",
+						       (a % 2) ? "view kernel" : "single mode on views", names[d], (int)m, (int)s, alphas[a / 2], (int)nErrors);
+						failures++;
+					}
+				}
+
+	if(test_ttm_ext_bounds() > 0){
+		printf("ttm ext: out of range products accepted\n");
+		failures++;
+	}
+
+	printf("ttm: %s\n", failures == 0 ? "PASS" : "FAIL");
+
+	FLA_Finalize();
+
+	return failures == 0 ? 0 : 1;
+}